@@ -17,6 +17,12 @@ CONFIG += c++1z
 SOURCES += main.cpp \
     prebuiltSources/floatspecial.c \
     protocolfloatspecial.cpp \
+    protocolflatmap.cpp \
+    protocolbenchmark.cpp \
+    protocolpacketstats.cpp \
+    protocolbatch.cpp \
+    protocolratereport.cpp \
+    protocoljsoncbor.cpp \
     protocolparser.cpp \
     protocolpacket.cpp \
     protocolfield.cpp \
@@ -33,11 +39,20 @@ SOURCES += main.cpp \
     protocolcode.cpp \
     protocolbitfield.cpp \
     protocoldocumentation.cpp \
+    protocolcache.cpp \
+    protocolstats.cpp \
+    protocolwatcher.cpp \
     tinyxml/tinyxml2.cpp
 
 HEADERS += \
     prebuiltSources/floatspecial.h \
     protocolfloatspecial.h \
+    protocolflatmap.h \
+    protocolbenchmark.h \
+    protocolpacketstats.h \
+    protocolbatch.h \
+    protocolratereport.h \
+    protocoljsoncbor.h \
     protocolparser.h \
     protocolpacket.h \
     protocolfield.h \
@@ -54,6 +69,9 @@ HEADERS += \
     protocolcode.h \
     protocolbitfield.h \
     protocoldocumentation.h \
+    protocolcache.h \
+    protocolstats.h \
+    protocolwatcher.h \
     tinyxml/tinyxml2.h
 
 RESOURCES +=
@@ -35,15 +35,21 @@ SOURCES += main.cpp \
     scaleddecode.c \
     scaledencode.c \
     TelemetryPacket.c \
+    Encodings.c \
     linkcode.c \
     packetinterface.c \
     bitfieldtest.c \
     definitions/verify.c \
     verify/dateverify.c \
     DemolinkProtocol.c \
+    DemolinkBenchmark.c \
+    DemolinkPacketStats.c \
+    DemolinkBatch.c \
     compare/compareDemolink.cpp \
     compare/printDemolink.cpp \
-    map/mapDemolink.cpp
+    map/mapDemolink.cpp \
+    json/base_json.cpp \
+    json/jsonDemolink.cpp
 
 HEADERS += \
     base_types.h \
@@ -52,6 +58,10 @@ HEADERS += \
     globaldependson.h \
     indices.h \
     DemolinkProtocol.h \
+    DemolinkBenchmark.h \
+    DemolinkPacketStats.h \
+    DemolinkBatch.h \
+    Encodings.h \
     Engine.h \
     fielddecode.h \
     fieldencode.h \
@@ -71,7 +81,10 @@ HEADERS += \
     verify/dateverify.h \
     compare/compareDemolink.hpp \
     compare/printDemolink.hpp \
-    map/mapDemolink.hpp
+    map/mapDemolink.hpp \
+    json/base_json.hpp \
+    json/jsonDemolink.hpp \
+    jsoncbor.hpp
 
 OTHER_FILES += \
     Doxyfile
@@ -80,7 +93,8 @@ INCLUDEPATH += ./ \
                ./definitions \
                ./verify \
                ./compare \
-               ./map
+               ./map \
+               ./json
 
 #protogen.target = $$PWD/Demolink.markdown
 #protogen.commands = $$PWD/../ProtoGenInstall/ProtoGen.exe $$PWD/../exampleprotocol.xml $$PWD -no-doxygen
@@ -6,11 +6,19 @@
 #include "GPS.h"
 #include "Engine.h"
 #include "TelemetryPacket.h"
+#include "Encodings.h"
+#include "DemolinkBatch.h"
+#include "verify.h"
 #include "packetinterface.h"
 #include "linkcode.h"
 #include "compareDemolink.hpp"
 #include "printDemolink.hpp"
+#include "mapDemolink.hpp"
+#include "jsonDemolink.hpp"
+#include "DemolinkBenchmark.h"
+#include "DemolinkPacketStats.h"
 #include "fieldencode.h"
+#include "fielddecode.h"
 
 #define PI 3.141592653589793
 #define PIf 3.141592653589793f
@@ -36,6 +44,23 @@ static int testZeroLengthPacket(void);
 static int testBitfieldGroupPacket(void);
 static int testMultiDimensionPacket(void);
 static int testDefaultStringsPacket(void);
+static int testTextReadCursor(void);
+static int testQtMap(void);
+static int testJsonCbor(void);
+static int testInitTemplate(void);
+static int testVerifyClamp(void);
+static int testBenchmark(void);
+static int testPacketStats(void);
+static int testVarintsPacket(void);
+static int testDeltasPacket(void);
+static int testBitpackedPacket(void);
+static int testResolutionPacket(void);
+static int testCompressedPacket(void);
+static int testChangesPacket(void);
+static int testBatchPacket(void);
+static int testStreamedPacket(void);
+static int testGatheredPacket(void);
+static int testTrackedPacket(void);
 
 static int fcompare(double input1, double input2, double epsilon);
 
@@ -103,6 +128,57 @@ int main(int argc, char *argv[])
     if(testDefaultStringsPacket() == 0)
         Return = 0;
 
+    if(testTextReadCursor() == 0)
+        Return = 0;
+
+    if(testQtMap() == 0)
+        Return = 0;
+
+    if(testJsonCbor() == 0)
+        Return = 0;
+
+    if(testInitTemplate() == 0)
+        Return = 0;
+
+    if(testVerifyClamp() == 0)
+        Return = 0;
+
+    if(testBenchmark() == 0)
+        Return = 0;
+
+    if(testPacketStats() == 0)
+        Return = 0;
+
+    if(testVarintsPacket() == 0)
+        Return = 0;
+
+    if(testDeltasPacket() == 0)
+        Return = 0;
+
+    if(testBitpackedPacket() == 0)
+        Return = 0;
+
+    if(testResolutionPacket() == 0)
+        Return = 0;
+
+    if(testCompressedPacket() == 0)
+        Return = 0;
+
+    if(testChangesPacket() == 0)
+        Return = 0;
+
+    if(testBatchPacket() == 0)
+        Return = 0;
+
+    if(testStreamedPacket() == 0)
+        Return = 0;
+
+    if(testGatheredPacket() == 0)
+        Return = 0;
+
+    if(testTrackedPacket() == 0)
+        Return = 0;
+
     if(Return == 1)
         std::cout << "All tests passed" << std::endl;
 
@@ -1169,6 +1245,1330 @@ int testDefaultStringsPacket(void)
 }
 
 
+int testTextReadCursor(void)
+{
+    testPacket_t pkt;
+    GPS_t gps = GPS_t();
+    std::size_t cursor = 0;
+
+    // Decode first, so the data are those that survive the encoding
+    fillOutGPSTest(gps);
+    encodeGPSPacketStructure(&pkt, &gps);
+    memset(&gps, 0, sizeof(gps));
+    decodeGPSPacketStructure(&pkt, &gps);
+
+    // Two reports back to back, which differ only in the week
+    std::string first = textPrintGPS_t("GPS", &gps);
+    gps.Week = 4321;
+    std::string report = first + textPrintGPS_t("GPS", &gps);
+
+    memset(&gps, 0, sizeof(gps));
+    int fieldcount = textReadGPS_t("GPS", report, &gps, &cursor);
+    if((fieldcount == 0) || !verifyGPSData(gps) || (cursor == 0) || (cursor > first.size()))
+    {
+        std::cout << "textReadGPS_t() of the first report yielded incorrect data" << std::endl;
+        return 0;
+    }
+
+    // The cursor continues from the end of the first report
+    memset(&gps, 0, sizeof(gps));
+    if((textReadGPS_t("GPS", report, &gps, &cursor) != fieldcount) || (gps.Week != 4321) || (cursor <= first.size()))
+    {
+        std::cout << "textReadGPS_t() of the second report yielded incorrect data" << std::endl;
+        return 0;
+    }
+
+    // Reverse the order of the lines, every key is then out of order
+    std::string reversed;
+    std::string::size_type start = 0;
+    while(start < first.size())
+    {
+        std::string::size_type end = first.find('\n', start) + 1;
+        reversed = first.substr(start, end - start) + reversed;
+        start = end;
+    }
+
+    memset(&gps, 0, sizeof(gps));
+    if((textReadGPS_t("GPS", reversed, &gps) != fieldcount) || !verifyGPSData(gps))
+    {
+        std::cout << "textReadGPS_t() of an out of order report yielded incorrect data" << std::endl;
+        return 0;
+    }
+
+    return 1;
+
+}// testTextReadCursor
+
+
+int testQtMap(void)
+{
+    testPacket_t pkt;
+    GPS_t gps = GPS_t();
+    QVariantMap map;
+
+    // Decode first, so the data are those that survive the encoding
+    fillOutGPSTest(gps);
+    encodeGPSPacketStructure(&pkt, &gps);
+    memset(&gps, 0, sizeof(gps));
+    decodeGPSPacketStructure(&pkt, &gps);
+
+    // Two structures in one map, named by different parents
+    mapEncodeGPS_t("GPS", map, &gps);
+    gps.Week = 4321;
+    mapEncodeGPS_t("Telemetry", map, &gps);
+
+    memset(&gps, 0, sizeof(gps));
+    mapDecodeGPS_t("GPS", map, &gps);
+    if(!verifyGPSData(gps))
+    {
+        std::cout << "mapDecodeGPS_t() yielded incorrect data" << std::endl;
+        return 0;
+    }
+
+    mapDecodeGPS_t("Telemetry", map, &gps);
+    if(gps.Week != 4321)
+    {
+        std::cout << "mapDecodeGPS_t() of the second parent yielded incorrect data" << std::endl;
+        return 0;
+    }
+
+    // The keys are the parent and field names
+    if(!map.contains("GPS:ITOW") || !map.contains("Telemetry:PosLLA:latitude"))
+    {
+        std::cout << "mapEncodeGPS_t() did not use the expected keys" << std::endl;
+        return 0;
+    }
+
+    // Fields that are not in the map are not changed
+    map.clear();
+    mapDecodeGPS_t("GPS", map, &gps);
+    if(gps.Week != 4321)
+    {
+        std::cout << "mapDecodeGPS_t() of an empty map changed the data" << std::endl;
+        return 0;
+    }
+
+    return 1;
+
+}// testQtMap
+
+
+int testJsonCbor(void)
+{
+    testPacket_t pkt;
+    GPS_t gps = GPS_t();
+    pgJsonWriter jsonwriter;
+    pgCborWriter cborwriter;
+
+    // Decode first, so the data are those that survive the encoding
+    fillOutGPSTest(gps);
+    encodeGPSPacketStructure(&pkt, &gps);
+    memset(&gps, 0, sizeof(gps));
+    decodeGPSPacketStructure(&pkt, &gps);
+
+    toJsonGPS_t(jsonwriter, &gps);
+    toCborGPS_t(cborwriter, &gps);
+
+    memset(&gps, 0, sizeof(gps));
+    pgJsonReader jsonreader(jsonwriter.output);
+    int fieldcount = fromJsonGPS_t(jsonreader, &gps);
+    if((fieldcount == 0) || !verifyGPSData(gps))
+    {
+        std::cout << "toJsonGPS_t() to fromJsonGPS_t() yielded incorrect data" << std::endl;
+        return 0;
+    }
+
+    memset(&gps, 0, sizeof(gps));
+    pgCborReader cborreader(cborwriter.output);
+    if((fromCborGPS_t(cborreader, &gps) != fieldcount) || !verifyGPSData(gps))
+    {
+        std::cout << "toCborGPS_t() to fromCborGPS_t() yielded incorrect data" << std::endl;
+        return 0;
+    }
+
+    // Every truncation of the CBOR data must be read without going past the end
+    for(std::size_t length = 0; length < cborwriter.output.size(); length++)
+    {
+        pgCborReader reader(std::string_view(cborwriter.output).substr(0, length));
+        if(fromCborGPS_t(reader, &gps) > fieldcount)
+        {
+            std::cout << "fromCborGPS_t() of truncated data read too many fields" << std::endl;
+            return 0;
+        }
+    }
+
+    // Malformed CBOR: not a map, a key longer than the data, and a key with no break
+    const std::string malformed[] = {std::string("\x9F\xFF", 2),
+                                     std::string("\xBF\x7B\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF", 10),
+                                     std::string("\xBF\x7F\x61", 3)};
+
+    for(const std::string& data : malformed)
+    {
+        gps = GPS_t();
+        gps.Week = 1234;
+        pgCborReader reader(data);
+        if((fromCborGPS_t(reader, &gps) != 0) || (gps.Week != 1234))
+        {
+            std::cout << "fromCborGPS_t() of malformed data yielded a field" << std::endl;
+            return 0;
+        }
+    }
+
+    return 1;
+
+}// testJsonCbor
+
+
+int testInitTemplate(void)
+{
+    ThrottleSettings_t settings;
+    SensorCalibration_t calibration;
+
+    // Fill with garbage, the init must overwrite every field
+    memset(&settings, 0xFF, sizeof(settings));
+    initThrottleSettings_t(&settings);
+
+    if((settings.numCurvePoints != 0) || (settings.enableCurve != 0) || (settings.lowPWM != 1100) || (settings.highPWM != 1900))
+    {
+        std::cout << "initThrottleSettings_t() yielded incorrect data" << std::endl;
+        return 0;
+    }
+
+    for(int i = 0; i < 10; i++)
+    {
+        if((settings.curvePoint[i].PWM != 1500) || (settings.curvePoint[i].throttle != 0.0f))
+        {
+            std::cout << "initThrottleSettings_t() yielded incorrect curve point " << i << std::endl;
+            return 0;
+        }
+    }
+
+    // Fields without an initial value are zeroed by the init template
+    memset(&calibration, 0xFF, sizeof(calibration));
+    initSensorCalibration_t(&calibration);
+
+    if((calibration.numSensors != N3D) || (calibration.serialNumber != 0))
+    {
+        std::cout << "initSensorCalibration_t() yielded incorrect data" << std::endl;
+        return 0;
+    }
+
+    for(int i = 0; i < N3D; i++)
+    {
+        if((calibration.gain[i] != 1.0f) || (calibration.offset[i] != 0))
+        {
+            std::cout << "initSensorCalibration_t() yielded incorrect sensor " << i << std::endl;
+            return 0;
+        }
+
+        for(int j = 0; j < N3D; j++)
+        {
+            if(calibration.crossAxis[i][j] != 0.0)
+            {
+                std::cout << "initSensorCalibration_t() yielded incorrect cross axis " << i << ", " << j << std::endl;
+                return 0;
+            }
+        }
+    }
+
+    // A redefinition cannot use the template, but it still zeroes the fields without an initial value
+    memset(&calibration, 0xFF, sizeof(calibration));
+    initSensorCalibrationLow_t(&calibration);
+
+    if((calibration.numSensors != N3D) || (calibration.serialNumber != 0) || (calibration.gain[N3D-1] != 1.0f) ||
+        (calibration.offset[0] != 0) || (calibration.offset[N3D-1] != 0) || (calibration.crossAxis[N3D-1][N3D-1] != 0.0))
+    {
+        std::cout << "initSensorCalibrationLow_t() yielded incorrect data" << std::endl;
+        return 0;
+    }
+
+    return 1;
+
+}// testInitTemplate
+
+
+int testVerifyClamp(void)
+{
+    SensorCalibration_t calibration;
+
+    // In range data verify good and are unchanged
+    initSensorCalibration_t(&calibration);
+    calibration.gain[2] = 2.0f;
+    calibration.offset[1] = -1000;
+    calibration.crossAxis[1][2] = 0.05;
+
+    if(!verifySensorCalibration_t(&calibration) || (calibration.gain[2] != 2.0f) || (calibration.offset[1] != -1000) || (calibration.crossAxis[1][2] != 0.05))
+    {
+        std::cout << "verifySensorCalibration_t() of in range data yielded incorrect data" << std::endl;
+        return 0;
+    }
+
+    // Out of range data verify bad and are clamped. The offset beyond the
+    // variable array length is not verified.
+    calibration.numSensors = 1;
+    calibration.gain[1] = 3.0f;
+    calibration.offset[0] = 2000;
+    calibration.offset[2] = 5000;
+    calibration.crossAxis[2][0] = -0.5;
+
+    if(verifySensorCalibration_t(&calibration))
+    {
+        std::cout << "verifySensorCalibration_t() of out of range data did not fail" << std::endl;
+        return 0;
+    }
+
+    if((calibration.gain[1] != 2.0f) || (calibration.gain[0] != 1.0f) || (calibration.offset[0] != 1000) || (calibration.offset[2] != 5000) || (calibration.crossAxis[2][0] != -0.1) || (calibration.crossAxis[1][2] != 0.05))
+    {
+        std::cout << "verifySensorCalibration_t() of out of range data yielded incorrect data" << std::endl;
+        return 0;
+    }
+
+    // The clamped data now verify good
+    if(!verifySensorCalibration_t(&calibration))
+    {
+        std::cout << "verifySensorCalibration_t() of clamped data failed" << std::endl;
+        return 0;
+    }
+
+    // A variable array length beyond the array is clamped too
+    calibration.numSensors = N3D + 1;
+    if(verifySensorCalibration_t(&calibration) || (calibration.numSensors != N3D) || (calibration.offset[2] != 1000))
+    {
+        std::cout << "verifySensorCalibration_t() of too many sensors yielded incorrect data" << std::endl;
+        return 0;
+    }
+
+    return 1;
+
+}// testVerifyClamp
+
+
+int testBenchmark(void)
+{
+    // Random data which have been decoded and encoded again must always decode
+    if(runDemolinkBenchmark(10, 0.001) != 0)
+    {
+        std::cout << "runDemolinkBenchmark() reported decode failures" << std::endl;
+        return 0;
+    }
+
+    return 1;
+
+}// testBenchmark
+
+
+int testPacketStats(void)
+{
+    testPacket_t pkt;
+    GPS_t gps = GPS_t();
+    ThrottleSettings_t settings;
+    DemolinkPacketStats_t* stats = getDemolinkPacketStats(GPS);
+
+    if((stats == NULL) || (getDemolinkPacketStats(THROTTLESETTINGS) == NULL) || (getDemolinkPacketStats(0xFFFF) != NULL))
+    {
+        std::cout << "getDemolinkPacketStats() yielded incorrect table entries" << std::endl;
+        return 0;
+    }
+
+    resetDemolinkPacketStats();
+
+    fillOutGPSTest(gps);
+    encodeGPSPacketStructure(&pkt, &gps);
+    int size = getDemolinkPacketSize(&pkt);
+
+    if((stats->encoded != 1) || (stats->bytesEncoded != (uint64_t)size) || (stats->decoded != 0))
+    {
+        std::cout << "Packet stats yielded incorrect encode counters" << std::endl;
+        return 0;
+    }
+
+    if(!decodeGPSPacketStructure(&pkt, &gps) || !decodeGPSPacketStructure(&pkt, &gps) || (stats->decoded != 2) || (stats->bytesDecoded != 2*(uint64_t)size))
+    {
+        std::cout << "Packet stats yielded incorrect decode counters" << std::endl;
+        return 0;
+    }
+
+    // A truncated packet fails as too short
+    finishDemolinkPacket(&pkt, 3, GPS);
+    if(decodeGPSPacketStructure(&pkt, &gps) || (stats->tooShort != 1) || (stats->decoded != 2) || (stats->bytesDecoded != 2*(uint64_t)size))
+    {
+        std::cout << "Packet stats yielded incorrect too short counters" << std::endl;
+        return 0;
+    }
+
+    // A packet with the wrong identifier is not counted at all
+    finishDemolinkPacket(&pkt, size, VERSION);
+    if(decodeGPSPacketStructure(&pkt, &gps) || (stats->tooShort != 1) || (stats->invalid != 0) || (stats->decoded != 2))
+    {
+        std::cout << "Packet stats counted a packet with the wrong identifier" << std::endl;
+        return 0;
+    }
+
+    // A packet without its default fields is counted as decoded
+    initThrottleSettings_t(&settings);
+    encodeThrottleSettingsPacketStructure(&pkt, &settings);
+    finishDemolinkPacket(&pkt, getThrottleSettingsMinDataLength(), THROTTLESETTINGS);
+    if(!decodeThrottleSettingsPacketStructure(&pkt, &settings) || (getDemolinkPacketStats(THROTTLESETTINGS)->decoded != 1))
+    {
+        std::cout << "Packet stats did not count a packet without its default fields" << std::endl;
+        return 0;
+    }
+
+    // Only the verifies that change data are counted
+    verifyThrottleSettings_t(&settings);
+    settings.lowPWM = 500;
+    verifyThrottleSettings_t(&settings);
+    if((getDemolinkPacketStats(THROTTLESETTINGS)->clamped != 1) || (settings.lowPWM != 900))
+    {
+        std::cout << "Packet stats yielded incorrect verify counters" << std::endl;
+        return 0;
+    }
+
+    resetDemolinkPacketStats();
+    if((stats->encoded != 0) || (stats->decoded != 0) || (stats->tooShort != 0) || (stats->bytesDecoded != 0) || (getDemolinkPacketStats(THROTTLESETTINGS)->clamped != 0))
+    {
+        std::cout << "resetDemolinkPacketStats() did not clear the counters" << std::endl;
+        return 0;
+    }
+
+    return 1;
+
+}// testPacketStats
+
+
+int testVarintsPacket(void)
+{
+    testPacket_t pkt, pkt2;
+    Varints_t varints = Varints_t();
+    Varints_t decoded = Varints_t();
+
+    varints.small = 1;
+    varints.large = UINT64_MAX;
+    varints.signedValue = -1;
+    varints.signedLarge = INT64_MIN;
+    varints.scaled = -12.345;
+    varints.narrow = -300;
+    varints.numValues = 5;
+    varints.values[0] = 0;
+    varints.values[1] = 127;
+    varints.values[2] = 128;
+    varints.values[3] = UINT32_MAX;
+    varints.values[4] = 16384;
+    varints.optional = UINT32_MAX;
+
+    encodeVarintsPacketStructure(&pkt, &varints);
+
+    // 1 + 10 + 1 + 10 + 3 + 2 + 1 + (1 + 1 + 2 + 5 + 3) + 5 bytes
+    if(getDemolinkPacketSize(&pkt) != 45)
+    {
+        std::cout << "Varints packet has the wrong size of " << getDemolinkPacketSize(&pkt) << std::endl;
+        return 0;
+    }
+
+    // The maximum length varints, 10 bytes for 64 bits and 5 bytes for 32 bits
+    const uint8_t* data = getDemolinkPacketData(&pkt);
+    const uint8_t large[10] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01};
+    const uint8_t optional[5] = {0xFF, 0xFF, 0xFF, 0xFF, 0x0F};
+    if((data[0] != 1) || (memcmp(&data[1], large, sizeof(large)) != 0) || (memcmp(&data[40], optional, sizeof(optional)) != 0))
+    {
+        std::cout << "Varints packet has the wrong encoding of the maximum length varints" << std::endl;
+        return 0;
+    }
+
+    if(!decodeVarintsPacketStructure(&pkt, &decoded) ||
+        (decoded.small != varints.small) ||
+        (decoded.large != varints.large) ||
+        (decoded.signedValue != varints.signedValue) ||
+        (decoded.signedLarge != varints.signedLarge) ||
+        fcompare(decoded.scaled, varints.scaled, 0.0005) ||
+        (decoded.narrow != varints.narrow) ||
+        (decoded.numValues != varints.numValues) ||
+        (memcmp(decoded.values, varints.values, 5*sizeof(uint32_t)) != 0) ||
+        (decoded.optional != varints.optional))
+    {
+        std::cout << "Varints packet failed to decode correctly" << std::endl;
+        return 0;
+    }
+
+    // The decoded data encode the same, a shorter varint is reported
+    encodeVarintsPacketStructure(&pkt2, &decoded);
+    std::string report = compareVarintsPacket("Varints", &pkt, &pkt2);
+    decoded.optional = 7;
+    encodeVarintsPacketStructure(&pkt2, &decoded);
+    if(!report.empty() || (compareVarintsPacket("Varints", &pkt, &pkt2) != "Varints packet sizes are different\nVarints:optional '4294967295' '7'\n"))
+    {
+        std::cout << "Varints packet comparison yielded an incorrect report: " << report << std::endl;
+        return 0;
+    }
+
+    // Without the optional field the default value is used
+    finishDemolinkPacket(&pkt, 40, VARINTS);
+    decoded = Varints_t();
+    if(!decodeVarintsPacketStructure(&pkt, &decoded) || (decoded.optional != 300) || (decoded.values[4] != 16384))
+    {
+        std::cout << "Varints packet without the optional field failed to decode correctly" << std::endl;
+        return 0;
+    }
+
+    // The optional field is truncated within its varint. The checksum of the
+    // shorter packet overwrote the data, so encode again
+    encodeVarintsPacketStructure(&pkt, &varints);
+    finishDemolinkPacket(&pkt, 42, VARINTS);
+    uint32_t tooShort = getDemolinkPacketStats(VARINTS)->tooShort;
+    if(decodeVarintsPacketStructure(&pkt, &decoded) || (getDemolinkPacketStats(VARINTS)->tooShort != tooShort + 1))
+    {
+        std::cout << "Varints packet with a truncated optional field did not fail as too short" << std::endl;
+        return 0;
+    }
+
+    // The packet is truncated within the array
+    encodeVarintsPacketStructure(&pkt, &varints);
+    finishDemolinkPacket(&pkt, 32, VARINTS);
+    if(decodeVarintsPacketStructure(&pkt, &decoded))
+    {
+        std::cout << "Varints packet truncated within the array did not fail" << std::endl;
+        return 0;
+    }
+
+    // A narrow in-memory integer is limited to its range, rather than truncated
+    const uint8_t outofrange[9] = {0x80, 0x80, 0x04, 0x81, 0x80, 0x04, 0x80, 0x80, 0x04};
+    int index = 0;
+    if((int16FromVarBytes(outofrange, &index) != INT16_MAX) || (int16FromVarBytes(outofrange, &index) != INT16_MIN) ||
+        (uint8FromVarBytes(outofrange, &index) != UINT8_MAX) || (index != 9))
+    {
+        std::cout << "Varints packet did not limit a narrow variable length integer" << std::endl;
+        return 0;
+    }
+
+    return 1;
+
+}// testVarintsPacket
+
+
+int testDeltasPacket(void)
+{
+    testPacket_t pkt;
+    Deltas_t deltas = Deltas_t();
+    Deltas_t decoded = Deltas_t();
+
+    // Differences which wrap around the in-memory type are still exact
+    const int32_t exact[8] = {1000, 1001, 1003, 1000, -5, INT32_MIN, INT32_MAX, 0};
+    memcpy(deltas.exact, exact, sizeof(exact));
+
+    // The jump from 100 to 300 is more than a signed8 can hold
+    const uint16_t samples[6] = {0, 100, 300, 300, 300, 290};
+    const uint16_t decodedSamples[6] = {0, 100, 227, 300, 300, 290};
+    deltas.numSamples = 6;
+    memcpy(deltas.samples, samples, sizeof(samples));
+
+    // The jump from the end of the first row to the start of the second
+    const int16_t table[2][3] = {{-1, -2, -3}, {200, 199, 198}};
+    const int16_t decodedTable[2][3] = {{-1, -2, -3}, {124, 199, 198}};
+    memcpy(deltas.table, table, sizeof(table));
+
+    encodeDeltasPacketStructure(&pkt, &deltas);
+
+    if(!decodeDeltasPacketStructure(&pkt, &decoded))
+    {
+        std::cout << "Deltas packet failed to decode" << std::endl;
+        return 0;
+    }
+
+    if(memcmp(decoded.exact, exact, sizeof(exact)) != 0)
+    {
+        std::cout << "Deltas packet yielded incorrect exact differences" << std::endl;
+        return 0;
+    }
+
+    // The limited difference is caught up by the next element
+    if((decoded.numSamples != 6) || (memcmp(decoded.samples, decodedSamples, sizeof(decodedSamples)) != 0))
+    {
+        std::cout << "Deltas packet yielded incorrect limited differences" << std::endl;
+        return 0;
+    }
+
+    if(memcmp(decoded.table, decodedTable, sizeof(decodedTable)) != 0)
+    {
+        std::cout << "Deltas packet yielded incorrect two dimensional differences" << std::endl;
+        return 0;
+    }
+
+    // Only the elements which were limited are reported
+    std::string report = compareDeltas_t("Deltas", &decoded, &deltas);
+    if(report != "Deltas:samples[2] '227' '300'\nDeltas:table[1][0] '124' '200'\n")
+    {
+        std::cout << "Deltas packet comparison yielded an incorrect report: " << report << std::endl;
+        return 0;
+    }
+
+    return 1;
+
+}// testDeltasPacket
+
+
+int testBitpackedPacket(void)
+{
+    testPacket_t pkt, pkt2;
+    Bitpacked_t bitpacked = Bitpacked_t();
+    Bitpacked_t decoded = Bitpacked_t();
+    const uint8_t* data = getDemolinkPacketData(&pkt);
+
+    // All the bits of the altitude, which spans the first two bytes
+    bitpacked.altitude = 7191;
+    bitpacked.temperature = -1024;
+    encodeBitpackedPacketStructure(&pkt, &bitpacked);
+
+    // 1 + 13 + 5 + 11 bits, 3 bytes, 10 bits, and 4 bytes
+    if((getDemolinkPacketSize(&pkt) != 13) || (data[0] != 0x7F) || (data[1] != 0xFC) || (data[2] != 0) || (data[3] != 0))
+    {
+        std::cout << "Bitpacked packet has the wrong encoding of the altitude" << std::endl;
+        return 0;
+    }
+
+    // All the bits of the temperature, which spans the third and fourth bytes
+    bitpacked.altitude = -1000;
+    bitpacked.temperature = 1023;
+    encodeBitpackedPacketStructure(&pkt, &bitpacked);
+
+    if((data[0] != 0) || (data[1] != 0) || (data[2] != 0x1F) || (data[3] != 0xFC))
+    {
+        std::cout << "Bitpacked packet has the wrong encoding of the temperature" << std::endl;
+        return 0;
+    }
+
+    // Full width signed values keep their two's complement bytes
+    const int32_t offsets[3] = {INT32_MAX, INT32_MIN, -5};
+    for(int i = 0; i < 3; i++)
+    {
+        bitpacked.offset = offsets[i];
+        encodeBitpackedPacketStructure(&pkt, &bitpacked);
+        if(!decodeBitpackedPacketStructure(&pkt, &decoded) || (decoded.offset != offsets[i]))
+        {
+            std::cout << "Bitpacked packet failed to decode the full width value " << offsets[i] << std::endl;
+            return 0;
+        }
+    }
+
+    bitpacked.flag = true;
+    bitpacked.altitude = 1234;
+    bitpacked.count = 17;
+    bitpacked.temperature = -300;
+    bitpacked.numbers[0] = 1;
+    bitpacked.numbers[1] = 2;
+    bitpacked.numbers[2] = 3;
+    bitpacked.last = 1000;
+    encodeBitpackedPacketStructure(&pkt, &bitpacked);
+
+    if(!decodeBitpackedPacketStructure(&pkt, &decoded) ||
+        (decoded.flag != true) ||
+        (decoded.altitude != 1234) ||
+        (decoded.count != 17) ||
+        (decoded.temperature != -300) ||
+        (memcmp(decoded.numbers, bitpacked.numbers, sizeof(decoded.numbers)) != 0) ||
+        (decoded.last != 1000) ||
+        (decoded.offset != -5))
+    {
+        std::cout << "Bitpacked packet failed to decode correctly" << std::endl;
+        return 0;
+    }
+
+    // Every field survives, a change of a field within the bits is reported
+    std::string report = compareBitpacked_t("Bitpacked", &decoded, &bitpacked);
+    decoded.temperature = 301;
+    encodeBitpackedPacketStructure(&pkt2, &decoded);
+    if(!report.empty() || (compareBitpackedPacket("Bitpacked", &pkt, &pkt2) != "Bitpacked:temperature '-300' '301'\n"))
+    {
+        std::cout << "Bitpacked packet comparison yielded an incorrect report: " << report << std::endl;
+        return 0;
+    }
+
+    return 1;
+
+}// testBitpackedPacket
+
+
+int testResolutionPacket(void)
+{
+    testPacket_t pkt, pkt2;
+    Resolution_t resolution = Resolution_t();
+    Resolution_t decoded = Resolution_t();
+    const double latitudes[3] = {-90.0, 37.12345, 90.0};
+    const float voltages[3] = {0.0f, 12.345f, 50.0f};
+    const float headings[3] = {0.0f, 123.4f, 360.0f};
+
+    for(int i = 0; i < 3; i++)
+    {
+        resolution.latitude = latitudes[i];
+        resolution.voltage = voltages[i];
+        resolution.heading = headings[i];
+        resolution.mode = 42;
+        encodeResolutionPacketStructure(&pkt, &resolution);
+
+        // 3 + 2 bytes, and 10 + 6 bits
+        if(getDemolinkPacketSize(&pkt) != 7)
+        {
+            std::cout << "Resolution packet has the wrong size of " << getDemolinkPacketSize(&pkt) << std::endl;
+            return 0;
+        }
+
+        // The quantization error is no more than half the resolution
+        if(!decodeResolutionPacketStructure(&pkt, &decoded) ||
+            fcompare(decoded.latitude, latitudes[i], 0.00005) ||
+            fcompare(decoded.voltage, voltages[i], 0.005) ||
+            fcompare(decoded.heading, headings[i], 0.25) ||
+            (decoded.mode != 42))
+        {
+            std::cout << "Resolution packet failed to decode correctly" << std::endl;
+            return 0;
+        }
+    }
+
+    // The decoded data are already quantized, so encode the same
+    encodeResolutionPacketStructure(&pkt2, &decoded);
+    std::string report = compareResolutionPacket("Resolution", &pkt, &pkt2);
+    if(!report.empty())
+    {
+        std::cout << "Resolution packet of the decoded data is different: " << report << std::endl;
+        return 0;
+    }
+
+    // A change larger than the resolution is reported
+    decoded.voltage -= 1.0f;
+    encodeResolutionPacketStructure(&pkt2, &decoded);
+    report = compareResolutionPacket("Resolution", &pkt, &pkt2);
+    if((report.find(":voltage") == std::string::npos) || (report.find(":latitude") != std::string::npos))
+    {
+        std::cout << "Resolution packet comparison yielded an incorrect report: " << report << std::endl;
+        return 0;
+    }
+
+    // Values beyond the range are limited
+    resolution.latitude = 100.0;
+    resolution.voltage = -1.0f;
+    encodeResolutionPacketStructure(&pkt, &resolution);
+    if(!decodeResolutionPacketStructure(&pkt, &decoded) || fcompare(decoded.latitude, 90.0, 0.00005) || fcompare(decoded.voltage, 0.0, 0.005))
+    {
+        std::cout << "Resolution packet failed to limit the values" << std::endl;
+        return 0;
+    }
+
+    return 1;
+
+}// testResolutionPacket
+
+
+int testCompressedPacket(void)
+{
+    testPacket_t pkt;
+    Compressed_t compressed = Compressed_t();
+    Compressed_t decoded = Compressed_t();
+    uint8_t* data = getDemolinkPacketData(&pkt);
+
+    // Two runs of zeroes, and copied bytes on either side of a run
+    const uint8_t pattern[16] = {1, 2, 3, 4, 5, 5, 5, 5, 5, 5, 5, 5, 9, 10, 11, 12};
+    compressed.numBytes = 200;
+    memcpy(compressed.pattern, pattern, sizeof(pattern));
+    pgstrncpy(compressed.state, "running", sizeof(compressed.state));
+    encodeCompressedPacketStructure(&pkt, &compressed);
+
+    // 1 + (2 + 2) + (5 + 2 + 5) + 1 bytes
+    if((getDemolinkPacketSize(&pkt) != 18) || (data[1] != 255) || (data[2] != 0) || (data[3] != 195) || (data[4] != 0) || (data[17] != 1))
+    {
+        std::cout << "Compressed packet has the wrong encoding of runs and dictionary entries" << std::endl;
+        return 0;
+    }
+
+    if(!decodeCompressedPacketStructure(&pkt, &decoded) || !compareCompressed_t("Compressed", &decoded, &compressed).empty())
+    {
+        std::cout << "Compressed packet of runs failed to decode correctly" << std::endl;
+        return 0;
+    }
+
+    // A dictionary index beyond the dictionary fails
+    data[17] = 3;
+    if(decodeCompressedPacketStructure(&pkt, &decoded))
+    {
+        std::cout << "Compressed packet with a bad dictionary index did not fail" << std::endl;
+        return 0;
+    }
+
+    // A run longer than the pattern fails
+    data[17] = 1;
+    data[5] = 255;
+    if(decodeCompressedPacketStructure(&pkt, &decoded))
+    {
+        std::cout << "Compressed packet with a run longer than the array did not fail" << std::endl;
+        return 0;
+    }
+
+    // Incompressible data, which is the largest packet
+    for(int i = 0; i < 200; i++)
+        compressed.block[i] = (uint8_t)(i*7);
+    for(int i = 0; i < 16; i++)
+        compressed.pattern[i] = (uint8_t)i;
+    pgstrncpy(compressed.state, "not in the list", sizeof(compressed.state));
+    encodeCompressedPacketStructure(&pkt, &compressed);
+
+    // 1 + (1 + 128 + 1 + 72) + (1 + 16) + (1 + 16) bytes
+    if((getDemolinkPacketSize(&pkt) != 237) || (getDemolinkPacketSize(&pkt) != getCompressedMaxDataLength()))
+    {
+        std::cout << "Compressed packet of incompressible data has the wrong size of " << getDemolinkPacketSize(&pkt) << std::endl;
+        return 0;
+    }
+
+    decoded = Compressed_t();
+    if(!decodeCompressedPacketStructure(&pkt, &decoded) || !compareCompressed_t("Compressed", &decoded, &compressed).empty())
+    {
+        std::cout << "Compressed packet of incompressible data failed to decode correctly" << std::endl;
+        return 0;
+    }
+
+    return 1;
+
+}// testCompressedPacket
+
+
+int testChangesPacket(void)
+{
+    testPacket_t pkt, pkt2;
+    Changes_t changes = Changes_t();
+    Changes_t state = Changes_t();
+    Changes_t retained = Changes_t();
+    const uint8_t* data = getDemolinkPacketData(&pkt);
+
+    // Everything changed from the initial state
+    changes.counter = 1;
+    changes.mode = 2;
+    changes.enabled = 1;
+    changes.voltage = 12.5f;
+    changes.numValues = 2;
+    changes.values[0] = -5;
+    changes.values[1] = 7;
+    pgstrncpy(changes.name, "engine", sizeof(changes.name));
+    encodeChangesPacketStructureDiff(&pkt, &changes, &state);
+
+    // 1 + 4 + 1 + 1 + 2 + 1 + 4 + 7 bytes
+    if((getDemolinkPacketSize(&pkt) != 21) || (data[0] != 0x3F) || !decodeChangesPacketStructureDiff(&pkt, &retained) ||
+        (retained.counter != 1) || (retained.mode != 2) || (retained.enabled != 1) || fcompare(retained.voltage, 12.5, 0.001) ||
+        (retained.numValues != 2) || (retained.values[0] != -5) || (retained.values[1] != 7) || (strcmp(retained.name, "engine") != 0))
+    {
+        std::cout << "Changes packet with every field failed to encode or decode correctly" << std::endl;
+        return 0;
+    }
+
+    // Nothing changed, only the bitmap and the bitfields are sent
+    encodeChangesPacketStructureDiff(&pkt, &changes, &state);
+    if((getDemolinkPacketSize(&pkt) != 2) || (data[0] != 0) || !decodeChangesPacketStructureDiff(&pkt, &retained) ||
+        (retained.counter != 1) || (retained.mode != 2) || (retained.enabled != 1) || (retained.numValues != 2) || (strcmp(retained.name, "engine") != 0))
+    {
+        std::cout << "Changes packet with no changes failed to encode or decode correctly" << std::endl;
+        return 0;
+    }
+
+    // The counter changed, and the bitfield is sent anyway
+    changes.counter = 2;
+    changes.enabled = 0;
+    encodeChangesPacketStructureDiff(&pkt, &changes, &state);
+    if((getDemolinkPacketSize(&pkt) != 6) || (data[0] != 0x01) || !decodeChangesPacketStructureDiff(&pkt, &retained) ||
+        (retained.counter != 2) || (retained.mode != 2) || (retained.enabled != 0) || (retained.values[1] != 7))
+    {
+        std::cout << "Changes packet with one change failed to encode or decode correctly" << std::endl;
+        return 0;
+    }
+
+    // The number of values changed, so the values are sent too
+    changes.numValues = 3;
+    changes.values[2] = 9;
+    encodeChangesPacketStructureDiff(&pkt, &changes, &state);
+    if((getDemolinkPacketSize(&pkt) != 9) || (data[0] != 0x18) || !decodeChangesPacketStructureDiff(&pkt, &retained) ||
+        (retained.numValues != 3) || (retained.values[0] != -5) || (retained.values[1] != 7) || (retained.values[2] != 9))
+    {
+        std::cout << "Changes packet with a new array length failed to encode or decode correctly" << std::endl;
+        return 0;
+    }
+
+    // The retained data are the same as the sender's data
+    encodeChangesPacketStructure(&pkt, &changes);
+    encodeChangesPacketStructure(&pkt2, &retained);
+    std::string report = compareChangesPacket("Changes", &pkt, &pkt2);
+    if(!report.empty())
+    {
+        std::cout << "Changes packet retained data are different: " << report << std::endl;
+        return 0;
+    }
+
+    // A frame which is too short for the fields of its bitmap leaves the retained data unchanged
+    Changes_t before = retained;
+    uint8_t* bytes = getDemolinkPacketData(&pkt2);
+    bytes[0] = 0x1F;
+    finishDemolinkPacket(&pkt2, 1, CHANGES);
+    if(decodeChangesPacketStructureDiff(&pkt2, &retained) || !compareChanges_t("Changes", &retained, &before).empty())
+    {
+        std::cout << "Changes packet decoded a frame which is too short for its bitmap" << std::endl;
+        return 0;
+    }
+
+    // The counter is complete, but the frame ends before the mode
+    changes.counter = 3;
+    changes.mode = 5;
+    encodeChangesPacketStructureDiff(&pkt2, &changes, &state);
+    finishDemolinkPacket(&pkt2, 6, CHANGES);
+    if(decodeChangesPacketStructureDiff(&pkt2, &retained) || (retained.counter != 2) || !compareChanges_t("Changes", &retained, &before).empty())
+    {
+        std::cout << "Changes packet kept part of a truncated frame" << std::endl;
+        return 0;
+    }
+
+    // Bits of the bitmap which do not belong to a field
+    bytes[0] = 0x40;
+    finishDemolinkPacket(&pkt2, 2, CHANGES);
+    if(decodeChangesPacketStructureDiff(&pkt2, &retained) || !compareChanges_t("Changes", &retained, &before).empty())
+    {
+        std::cout << "Changes packet decoded a bitmap bit which does not belong to a field" << std::endl;
+        return 0;
+    }
+
+    return 1;
+
+}// testChangesPacket
+
+
+//! Packets received from a batch by batchHandler()
+typedef struct
+{
+    int count;
+    uint32_t ids[4];
+    const uint8_t* data[4];
+    int sizes[4];
+}BatchContents_t;
+
+
+/*!
+ * Record the packets of a batch
+ * \param id is the identifier of the packet.
+ * \param data points to the data of the packet, inside the batch.
+ * \param size is the number of data bytes of the packet.
+ * \param context is the BatchContents_t which records the packets.
+ */
+static void batchHandler(uint32_t id, const uint8_t* data, int size, void* context)
+{
+    BatchContents_t* contents = (BatchContents_t*)context;
+
+    if(contents->count < 4)
+    {
+        contents->ids[contents->count] = id;
+        contents->data[contents->count] = data;
+        contents->sizes[contents->count] = size;
+    }
+
+    contents->count++;
+
+}// batchHandler
+
+
+//! Packets decoded from a batch by decodeDemolinkBatch()
+typedef struct
+{
+    int bitpacked;
+    int changes;
+    uint32_t counter;
+    int others;
+    uint32_t otherid;
+}BatchDecoded_t;
+
+
+//! Record a Bitpacked packet decoded from a batch
+static void batchBitpacked(const Bitpacked_t* user, void* context)
+{
+    (void)user;
+    ((BatchDecoded_t*)context)->bitpacked++;
+
+}// batchBitpacked
+
+
+//! Record a Changes packet decoded from a batch
+static void batchChanges(const Changes_t* user, void* context)
+{
+    BatchDecoded_t* decoded = (BatchDecoded_t*)context;
+
+    decoded->changes++;
+    decoded->counter = (uint32_t)user->counter;
+
+}// batchChanges
+
+
+//! Record a packet from a batch which was not decoded
+static void batchOther(uint32_t id, const uint8_t* data, int size, void* context)
+{
+    BatchDecoded_t* decoded = (BatchDecoded_t*)context;
+
+    (void)data;
+    (void)size;
+    decoded->others++;
+    decoded->otherid = id;
+
+}// batchOther
+
+
+int testBatchPacket(void)
+{
+    testPacket_t frame, pkts[3];
+    Bitpacked_t bitpacked = Bitpacked_t();
+    Resolution_t resolution = Resolution_t();
+    Changes_t changes = Changes_t();
+    BatchContents_t contents = BatchContents_t();
+    DemolinkBatchDecoders_t decoders = DemolinkBatchDecoders_t();
+    BatchDecoded_t decoded = BatchDecoded_t();
+    int byteindex = 0;
+    int numbytes = 0;
+    uint32_t id = 0;
+    const uint8_t* data = 0;
+    int size = 0;
+
+    changes.counter = 7;
+    pgstrncpy(changes.name, "batch", sizeof(changes.name));
+    encodeBitpackedPacketStructure(&pkts[0], &bitpacked);
+    encodeResolutionPacketStructure(&pkts[1], &resolution);
+    encodeChangesPacketStructure(&pkts[2], &changes);
+
+    for(int i = 0; i < 3; i++)
+    {
+        // Each sub header is 2 bytes, the identifiers and sizes are less than 128
+        numbytes += 2 + getDemolinkPacketSize(&pkts[i]);
+        if(!addDemolinkBatchPacket(&frame, &byteindex, 255, &pkts[i]))
+        {
+            std::cout << "Batch packet failed to add packet " << i << std::endl;
+            return 0;
+        }
+    }
+
+    // A packet which does not fit is not added, even by one byte
+    if((byteindex != numbytes) || addDemolinkBatchPacket(&frame, &byteindex, numbytes + 2 + getDemolinkPacketSize(&pkts[0]) - 1, &pkts[0]) || (byteindex != numbytes))
+    {
+        std::cout << "Batch packet has the wrong size or overfilled" << std::endl;
+        return 0;
+    }
+
+    finishDemolinkBatch(&frame, byteindex);
+
+    if((getDemolinkPacketID(&frame) != BATCH) || (getDemolinkPacketSize(&frame) != numbytes))
+    {
+        std::cout << "Batch packet has the wrong identifier or size" << std::endl;
+        return 0;
+    }
+
+    // Iterate the packets, which are not copied out of the batch
+    byteindex = 0;
+    for(int i = 0; i < 3; i++)
+    {
+        if(!nextDemolinkBatchPacket(&frame, &byteindex, &id, &data, &size) || (id != getDemolinkPacketID(&pkts[i])) ||
+            (size != getDemolinkPacketSize(&pkts[i])) || (data < getDemolinkPacketDataConst(&frame)) ||
+            (memcmp(data, getDemolinkPacketDataConst(&pkts[i]), (size_t)size) != 0))
+        {
+            std::cout << "Batch packet failed to iterate packet " << i << std::endl;
+            return 0;
+        }
+    }
+
+    if(nextDemolinkBatchPacket(&frame, &byteindex, &id, &data, &size) || (byteindex != numbytes))
+    {
+        std::cout << "Batch packet iterated past its last packet" << std::endl;
+        return 0;
+    }
+
+    if((dispatchDemolinkBatch(&frame, batchHandler, &contents) != 3) || (contents.count != 3))
+    {
+        std::cout << "Batch packet failed to dispatch its packets" << std::endl;
+        return 0;
+    }
+
+    for(int i = 0; i < 3; i++)
+    {
+        if((contents.ids[i] != getDemolinkPacketID(&pkts[i])) || (contents.sizes[i] != getDemolinkPacketSize(&pkts[i])) ||
+            (memcmp(contents.data[i], getDemolinkPacketDataConst(&pkts[i]), (size_t)contents.sizes[i]) != 0))
+        {
+            std::cout << "Batch packet dispatched packet " << i << " incorrectly" << std::endl;
+            return 0;
+        }
+    }
+
+    // Decode the packets, the Resolution packet has no handler
+    decoders.handleBitpacked = batchBitpacked;
+    decoders.handleChanges = batchChanges;
+    decoders.handleOther = batchOther;
+    if((decodeDemolinkBatch(&frame, &decoders, &decoded) != 3) || (decoded.bitpacked != 1) || (decoded.changes != 1) ||
+        (decoded.counter != 7) || (decoded.others != 1) || (decoded.otherid != RESOLUTION))
+    {
+        std::cout << "Batch packet failed to decode its packets" << std::endl;
+        return 0;
+    }
+
+    // A packet which is not a batch
+    contents = BatchContents_t();
+    finishDemolinkPacket(&frame, numbytes, CHANGES);
+    if((dispatchDemolinkBatch(&frame, batchHandler, &contents) != -1) || (contents.count != 0))
+    {
+        std::cout << "Batch packet dispatched a packet which is not a batch" << std::endl;
+        return 0;
+    }
+
+    // A batch whose last packet is truncated, the packets before it are still dispatched
+    finishDemolinkBatch(&frame, numbytes - 1);
+    if((dispatchDemolinkBatch(&frame, batchHandler, &contents) != -1) || (contents.count != 2))
+    {
+        std::cout << "Truncated batch packet was not detected" << std::endl;
+        return 0;
+    }
+
+    // A batch with no packets, the checksum overwrites the packets so this is last
+    contents = BatchContents_t();
+    finishDemolinkBatch(&frame, 0);
+    if((dispatchDemolinkBatch(&frame, batchHandler, &contents) != 0) || (contents.count != 0))
+    {
+        std::cout << "Empty batch packet failed to dispatch" << std::endl;
+        return 0;
+    }
+
+    return 1;
+
+}// testBatchPacket
+
+
+int testStreamedPacket(void)
+{
+    testPacket_t pkt, pkt2;
+    Streamed_t streamed = Streamed_t();
+    Streamed_t decoded = Streamed_t();
+    DemolinkStream_t state;
+    uint8_t chunks[64];
+    const uint8_t* data;
+    int size;
+
+    streamed.counter = 0x12345678;
+    streamed.temperature = 21.5f;
+    streamed.numSamples = 3;
+    streamed.samples[0] = -1;
+    streamed.samples[1] = 100000;
+    streamed.samples[2] = -7;
+    streamed.table[0][0] = 1;
+    streamed.table[0][1] = 2;
+    streamed.table[0][2] = 3;
+    streamed.table[1][0] = 400;
+    streamed.table[1][1] = 500;
+    streamed.table[1][2] = 65535;
+
+    // The streamed data must be the same as the normal packet data
+    encodeStreamedPacketStructure(&pkt, &streamed);
+    data = getDemolinkPacketDataConst(&pkt);
+    size = getDemolinkPacketSize(&pkt);
+    if(size != 32)
+    {
+        std::cout << "Streamed packet has the wrong size " << size << std::endl;
+        return 0;
+    }
+
+    // Every chunk size, so that each element is split at every byte
+    for(int chunk = 1; chunk <= size + 1; chunk++)
+    {
+        int numbytes = 0;
+        int calls = 0;
+
+        state = DemolinkStream_t();
+        while(!state.complete && (calls++ < 100))
+            numbytes += encodeStreamedPacketStructureStream(chunks + numbytes, (numbytes + chunk <= size) ? chunk : size - numbytes, &streamed, &state);
+
+        if(!state.complete || (numbytes != size) || (memcmp(chunks, data, (size_t)size) != 0))
+        {
+            std::cout << "Streamed packet failed to encode in chunks of " << chunk << " bytes" << std::endl;
+            return 0;
+        }
+
+        numbytes = 0;
+        calls = 0;
+        state = DemolinkStream_t();
+        decoded = Streamed_t();
+        while(!state.complete && (calls++ < 100))
+        {
+            int used = decodeStreamedPacketStructureStream(chunks + numbytes, (numbytes + chunk <= size) ? chunk : size - numbytes, &decoded, &state);
+            if(used < 0)
+                break;
+
+            numbytes += used;
+        }
+
+        encodeStreamedPacketStructure(&pkt2, &decoded);
+        std::string report = compareStreamedPacket("Streamed", &pkt, &pkt2);
+        if(!state.complete || (numbytes != size) || (decoded.numSamples != 3) || (decoded.samples[1] != 100000) ||
+            (decoded.table[1][2] != 65535) || fcompare(decoded.temperature, 21.5, 0.01) || !report.empty())
+        {
+            std::cout << "Streamed packet failed to decode in chunks of " << chunk << " bytes: " << report << std::endl;
+            return 0;
+        }
+    }
+
+    // The decode stops at the end of the chunk, and resumes with the next one
+    state = DemolinkStream_t();
+    decoded = Streamed_t();
+    if((decodeStreamedPacketStructureStream(chunks, 6, &decoded, &state) != 6) || state.complete ||
+        (decoded.counter != 0x12345678) || (decodeStreamedPacketStructureStream(chunks + 6, size, &decoded, &state) != size - 6) || !state.complete)
+    {
+        std::cout << "Streamed packet failed to resume its decode" << std::endl;
+        return 0;
+    }
+
+    // The marker constant is checked
+    chunks[0] = 0x5A;
+    state = DemolinkStream_t();
+    if(decodeStreamedPacketStructureStream(chunks, size, &decoded, &state) != -1)
+    {
+        std::cout << "Streamed packet decoded a bad marker" << std::endl;
+        return 0;
+    }
+
+    return 1;
+
+}// testStreamedPacket
+
+
+int testGatheredPacket(void)
+{
+    testPacket_t pkt, pkt2, rx;
+    Gathered_t gathered = Gathered_t();
+    Gathered_t decoded = Gathered_t();
+    DemolinkSegment_t segments[getGatheredMaxSegments()];
+    uint8_t bytes[TEST_PKT_MAX_DATA + TEST_PKT_OVERHEAD];
+    int numsegments, numbytes = 0, found = 0;
+
+    gathered.sequence = 0x1234;
+    strcpy(gathered.label, "gathered");
+    gathered.numBytes = 40;
+    for(int i = 0; i < gathered.numBytes; i++)
+        gathered.payload[i] = (uint8_t)(3*i + 1);
+    gathered.check = 0xBEEF;
+
+    // The segments laid end to end are a complete packet, with the same data as the normal encode
+    encodeGatheredPacketStructure(&pkt, &gathered);
+    numsegments = encodeGatheredPacketStructureGather(&pkt2, &gathered, segments);
+    if((numsegments != getGatheredMaxSegments()) || (segments[0].data != (const uint8_t*)&pkt2) || (segments[2].data != (const uint8_t*)gathered.label))
+    {
+        std::cout << "Gathered packet has the wrong segments " << numsegments << std::endl;
+        return 0;
+    }
+
+    for(int i = 0; i < numsegments; i++)
+    {
+        memcpy(bytes + numbytes, segments[i].data, (size_t)segments[i].size);
+        numbytes += segments[i].size;
+    }
+
+    rx = testPacket_t();
+    for(int i = 0; i < numbytes; i++)
+        found += lookForDemolinkPacket(&rx, bytes[i]);
+
+    std::string report = compareGatheredPacket("Gathered", &pkt, &rx);
+    if((found != 1) || (numbytes != getDemolinkPacketSize(&pkt) + TEST_PKT_OVERHEAD) || !report.empty() || !decodeGatheredPacketStructure(&rx, &decoded) ||
+        (strcmp(decoded.label, "gathered") != 0) || (decoded.numBytes != 40) || (decoded.payload[39] != 118) || (decoded.check != 0xBEEF))
+    {
+        std::cout << "Gathered packet failed the round trip: " << report << std::endl;
+        return 0;
+    }
+
+    // Empty fields do not get a segment
+    gathered.label[0] = 0;
+    gathered.numBytes = 0;
+    numsegments = encodeGatheredPacketStructureGather(&pkt2, &gathered, segments);
+    for(int i = 0; i < numsegments; i++)
+    {
+        if(segments[i].size <= 0)
+        {
+            std::cout << "Gathered packet has an empty segment" << std::endl;
+            return 0;
+        }
+    }
+
+    if((numsegments != 3) || (pkt2.length != 6))
+    {
+        std::cout << "Gathered packet has the wrong segments when empty " << numsegments << std::endl;
+        return 0;
+    }
+
+    return 1;
+
+}// testGatheredPacket
+
+
+int testTrackedPacket(void)
+{
+    testPacket_t pkt;
+    Tracked_t tracked = Tracked_t();
+    Tracked_t state = Tracked_t();
+    Tracked_t retained = Tracked_t();
+    Tracked_t decoded = Tracked_t();
+    const uint8_t* data = getDemolinkPacketData(&pkt);
+
+    // The second sample jumps by more than an 8 bit difference can hold
+    tracked.position = 100000;
+    tracked.samples[0] = 10;
+    tracked.samples[1] = 300;
+    encodeTrackedPacketStructureDiff(&pkt, &tracked, &state);
+
+    // 1 + 3 + 4 bytes, the state follows what the decoder sees
+    if((getDemolinkPacketSize(&pkt) != 8) || (data[0] != 0x03) || !decodeTrackedPacketStructureDiff(&pkt, &retained) ||
+        (retained.position != 100000) || (retained.samples[0] != 10) || (retained.samples[1] != 127) || (retained.samples[2] != 0) ||
+        (state.samples[1] != 127))
+    {
+        std::cout << "Tracked packet with every field failed to encode or decode correctly" << std::endl;
+        return 0;
+    }
+
+    // The limited sample catches up over the next two packets
+    encodeTrackedPacketStructureDiff(&pkt, &tracked, &state);
+    if((getDemolinkPacketSize(&pkt) != 5) || (data[0] != 0x02) || !decodeTrackedPacketStructureDiff(&pkt, &retained) || (retained.samples[1] != 254))
+    {
+        std::cout << "Tracked packet failed to catch up a limited difference" << std::endl;
+        return 0;
+    }
+
+    encodeTrackedPacketStructureDiff(&pkt, &tracked, &state);
+    if(!decodeTrackedPacketStructureDiff(&pkt, &retained) || (retained.samples[1] != 300) || (retained.position != 100000))
+    {
+        std::cout << "Tracked packet failed to catch up a limited difference" << std::endl;
+        return 0;
+    }
+
+    // Nothing changed, only the bitmap is sent
+    encodeTrackedPacketStructureDiff(&pkt, &tracked, &state);
+    if((getDemolinkPacketSize(&pkt) != 1) || (data[0] != 0) || !decodeTrackedPacketStructureDiff(&pkt, &retained))
+    {
+        std::cout << "Tracked packet with no changes failed to encode or decode correctly" << std::endl;
+        return 0;
+    }
+
+    // A small change of position is a single byte difference, going down is limited too
+    tracked.position = 100005;
+    tracked.samples[1] = 0;
+    encodeTrackedPacketStructureDiff(&pkt, &tracked, &state);
+    if((getDemolinkPacketSize(&pkt) != 6) || (data[0] != 0x03) || !decodeTrackedPacketStructureDiff(&pkt, &retained) ||
+        (retained.position != 100005) || (retained.samples[1] != 172) || (state.samples[1] != 172))
+    {
+        std::cout << "Tracked packet with a small change failed to encode or decode correctly" << std::endl;
+        return 0;
+    }
+
+    // The normal encode is the difference from zero
+    encodeTrackedPacketStructure(&pkt, &tracked);
+    if((getDemolinkPacketSize(&pkt) != 7) || !decodeTrackedPacketStructure(&pkt, &decoded) || (decoded.position != 100005) ||
+        (decoded.samples[0] != 10) || (decoded.samples[1] != 0) || (decoded.samples[3] != 0))
+    {
+        std::cout << "Tracked packet failed to encode or decode correctly" << std::endl;
+        return 0;
+    }
+
+    return 1;
+
+}// testTrackedPacket
+
+
 int fcompare(double input1, double input2, double epsilon)
 {
     if(fabs(input1 - input2) > epsilon)
@@ -3,7 +3,15 @@
 
 #include "DemolinkProtocol.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 //! Look for an incoming packet in a sequence of bytes
 int lookForDemolinkPacket(testPacket_t* pkt, uint8_t byte);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // PACKETINTERFACE_H
@@ -17,6 +17,10 @@ DEFINES += QT_DEPRECATED_WARNINGS
 SOURCES += \
         DemolinkProtocol.cpp \
         Engine.cpp \
+        DemolinkBenchmark.cpp \
+        DemolinkPacketStats.cpp \
+        DemolinkBatch.cpp \
+        Encodings.cpp \
         GPS.cpp \
         TelemetryPacket.cpp \
         base_types.cpp \
@@ -38,7 +42,11 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
 
 HEADERS += \
+    DemolinkBenchmark.hpp \
+    DemolinkPacketStats.hpp \
+    DemolinkBatch.hpp \
     DemolinkProtocol.hpp \
+    Encodings.hpp \
     Engine.hpp \
     EngineDefinitions.hpp \
     OtherDefinitions.hpp \
@@ -47,8 +55,10 @@ HEADERS += \
     bitfieldtest.hpp \
     fielddecode.hpp \
     fieldencode.hpp \
+    flatmap.hpp \
     floatspecial.hpp \
     globaldependson.hpp \
+    jsoncbor.hpp \
     linkcode.hpp \
     scaleddecode.hpp \
     scaledencode.hpp \
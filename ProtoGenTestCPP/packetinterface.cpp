@@ -6,6 +6,9 @@ static int validateDemolinkPacket(const testPacket_c* pkt);
 //! Compute the Fletcher 16 checksum on a hunk of bytes
 static uint16_t fletcher16( uint8_t const *data, int bytes );
 
+//! Compute the Fletcher 16 checksum on a list of segments
+static uint16_t fletcher16Segments(const DemolinkSegment_c* segments, int count);
+
 //! \return the packet data pointer from the packet
 uint8_t* getDemolinkPacketData(testPacket_c* pkt)
 {
@@ -35,6 +38,50 @@ void finishDemolinkPacket(testPacket_c* pkt, int size, uint32_t packetID)
 
 }
 
+/*!
+ * Complete a packet whose data are a list of segments. The data segments are
+ * moved up to put the packet header first, and the checksum is appended as the
+ * last segment, so the list can be written without copying the data.
+ * \param pkt holds the packet header and checksum.
+ * \param segments is the list of data segments, with room for two more.
+ * \param count is the number of data segments.
+ * \param packetID is the identifier of the packet.
+ * \return the number of segments, including the header and checksum.
+ */
+int finishDemolinkPacketSegments(testPacket_c* pkt, DemolinkSegment_c* segments, int count, uint32_t packetID)
+{
+    uint16_t check;
+    int size = 0;
+    int i;
+
+    for(i = count; i > 0; i--)
+    {
+        size += segments[i-1].size;
+        segments[i] = segments[i-1];
+    }
+
+    pkt->sync0 = TEST_PKT_SYNC_BYTE0;
+    pkt->sync1 = TEST_PKT_SYNC_BYTE1;
+    pkt->pkttype = (uint8_t)packetID;
+    pkt->length = (uint8_t)size;
+
+    segments[0].data = (const uint8_t*)pkt;
+    segments[0].size = 4;
+    count++;
+
+    // Compute and apply the checksum, which is kept after the largest data
+    check = fletcher16Segments(segments, count);
+    pkt->data[TEST_PKT_MAX_DATA] = (uint8_t)(check>>8);
+    pkt->data[TEST_PKT_MAX_DATA+1] = (uint8_t)(check);
+
+    segments[count].data = &pkt->data[TEST_PKT_MAX_DATA];
+    segments[count].size = 2;
+
+    return count + 1;
+
+}// finishDemolinkPacketSegments
+
+
 //! \return the size of a packet from the packet header
 int getDemolinkPacketSize(const testPacket_c* pkt)
 {
@@ -161,3 +208,45 @@ uint16_t fletcher16( uint8_t const *data, int bytes )
     sum2 = (sum2 & 0xff) + (sum2 >> 8);
     return sum2 << 8 | sum1;
 }
+
+
+/*!
+ * Compute the Fletcher 16 on a list of segments, with the same result as
+ * fletcher16() on the segments laid end to end.
+ * \param segments is the list of segments to compute the checksum for.
+ * \param count is the number of segments.
+ * \return the 16-bit Fletcher's checksum of the segments.
+ */
+uint16_t fletcher16Segments(const DemolinkSegment_c* segments, int count)
+{
+    uint16_t sum1 = 0xff, sum2 = 0xff;
+    int tlen = 0;
+    int i, j;
+
+    for(i = 0; i < count; i++)
+    {
+        for(j = 0; j < segments[i].size; j++)
+        {
+            sum2 += sum1 += segments[i].data[j];
+
+            // 20 is a magic number that guarantees no overflow in the worst case
+            if(++tlen >= 20)
+            {
+                tlen = 0;
+                sum1 = (sum1 & 0xff) + (sum1 >> 8);
+                sum2 = (sum2 & 0xff) + (sum2 >> 8);
+            }
+        }
+    }
+
+    if(tlen > 0)
+    {
+        sum1 = (sum1 & 0xff) + (sum1 >> 8);
+        sum2 = (sum2 & 0xff) + (sum2 >> 8);
+    }
+
+    /* Second reduction step to reduce sums to 8 bits */
+    sum1 = (sum1 & 0xff) + (sum1 >> 8);
+    sum2 = (sum2 & 0xff) + (sum2 >> 8);
+    return sum2 << 8 | sum1;
+}
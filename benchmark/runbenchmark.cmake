@@ -0,0 +1,155 @@
+# Run the generator benchmark. This is invoked by the "benchmark" target as:
+#
+#   cmake -DPROTOGEN=<exe> -DSYNTHESIZE=<exe> -DWORKDIR=<dir>
+#         [-DBASELINE=<dir>] [-DTOLERANCE=<percent>] -P runbenchmark.cmake
+#
+# For each scale a protocol is synthesized, ProtoGen is run on it with
+# -stats-json, and the statistics are saved to <WORKDIR>/<scale>.json. If
+# BASELINE is a directory holding the results of an earlier run then the
+# generation time of each scale is compared against it, and the benchmark
+# fails if any scale is slower by more than TOLERANCE percent (default 25).
+#
+# The generation time is the sum of the parse phases and the helper files.
+# Loading the XML and replacing the output files on disk depend mostly on the
+# file system, and the markdown and doxygen outputs are not generated (doxygen
+# only runs with -yes-doxygen), so none of them are compared.
+cmake_minimum_required(VERSION 3.19)
+
+if(NOT PROTOGEN OR NOT SYNTHESIZE OR NOT WORKDIR)
+    message(FATAL_ERROR "PROTOGEN, SYNTHESIZE and WORKDIR must be defined")
+endif()
+
+if(NOT TOLERANCE)
+    set(TOLERANCE 25)
+endif()
+
+# Each scale is: name packets fields depth structures enums bitfields arrays perfile
+set(SCALES
+    "small     50  10 1   5   5 20 10  10"
+    "medium   200  20 2  20  20 20 10  10"
+    "large    500  20 2  50  50 20 10  25"
+    "wide      20 200 1  10  10 30 20   1"
+    "deep     100  16 8  10  10 20 10  10"
+)
+
+# CMake math is integer only, so times are compared in microseconds. The JSON
+# reader may give small times in exponent form, such as 1e-06
+function(to_microseconds SECONDS RESULT)
+    string(REGEX MATCH "^([0-9]+)(\\.([0-9]*))?([eE]([-+]?[0-9]+))?" MATCHED "${SECONDS}")
+    set(WHOLE ${CMAKE_MATCH_1})
+    set(DIGITS "${CMAKE_MATCH_1}${CMAKE_MATCH_3}")
+    set(EXPONENT 0)
+    if(CMAKE_MATCH_5)
+        string(REGEX REPLACE "^\\+" "" EXPONENT "${CMAKE_MATCH_5}")
+    endif()
+
+    # The number of digits before the decimal point, counted in microseconds
+    string(LENGTH "${WHOLE}" POINT)
+    math(EXPR POINT "${POINT} + ${EXPONENT} + 6")
+    if(POINT LESS_EQUAL 0)
+        set(MICRO 0)
+    else()
+        string(SUBSTRING "${DIGITS}0000000000000000000000" 0 ${POINT} MICRO)
+        string(REGEX REPLACE "^0+([0-9])" "\\1" MICRO "${MICRO}")
+    endif()
+    set(${RESULT} ${MICRO} PARENT_SCOPE)
+endfunction()
+
+# Sum the generation phases of a set of statistics, in microseconds
+function(generation_time STATS RESULT)
+    set(SUM 0)
+    string(JSON COUNT LENGTH "${STATS}" phases)
+    math(EXPR LAST "${COUNT} - 1")
+    foreach(INDEX RANGE ${LAST})
+        string(JSON PHASE GET "${STATS}" phases ${INDEX} name)
+        if(PHASE MATCHES "^Parse " OR PHASE STREQUAL "Helper files")
+            string(JSON SECONDS GET "${STATS}" phases ${INDEX} seconds)
+            to_microseconds(${SECONDS} MICRO)
+            math(EXPR SUM "${SUM} + ${MICRO}")
+        endif()
+    endforeach()
+    set(${RESULT} ${SUM} PARENT_SCOPE)
+endfunction()
+
+file(MAKE_DIRECTORY ${WORKDIR})
+
+set(REGRESSIONS "")
+
+foreach(SCALE ${SCALES})
+    string(REGEX REPLACE " +" ";" SCALE "${SCALE}")
+    list(GET SCALE 0 NAME)
+    list(GET SCALE 1 PACKETS)
+    list(GET SCALE 2 FIELDS)
+    list(GET SCALE 3 DEPTH)
+    list(GET SCALE 4 STRUCTURES)
+    list(GET SCALE 5 ENUMS)
+    list(GET SCALE 6 BITFIELDS)
+    list(GET SCALE 7 ARRAYS)
+    list(GET SCALE 8 PERFILE)
+
+    set(XMLFILE ${WORKDIR}/${NAME}.xml)
+    set(OUTDIR ${WORKDIR}/${NAME})
+
+    execute_process(
+        COMMAND ${SYNTHESIZE} -o ${XMLFILE} -packets ${PACKETS} -fields ${FIELDS} -depth ${DEPTH}
+                -structures ${STRUCTURES} -enums ${ENUMS} -bitfields ${BITFIELDS} -arrays ${ARRAYS} -perfile ${PERFILE}
+        RESULT_VARIABLE RESULT)
+
+    if(NOT RESULT EQUAL 0)
+        message(FATAL_ERROR "Failed to synthesize ${NAME} protocol")
+    endif()
+
+    # Start from an empty output, so every file is written
+    file(REMOVE_RECURSE ${OUTDIR})
+
+    execute_process(
+        COMMAND ${PROTOGEN} ${XMLFILE} ${OUTDIR} -no-markdown -no-unrecognized -stats-json
+        WORKING_DIRECTORY ${WORKDIR}
+        OUTPUT_VARIABLE OUTPUT
+        ERROR_QUIET
+        RESULT_VARIABLE RESULT)
+
+    if(NOT RESULT EQUAL 0)
+        message(FATAL_ERROR "ProtoGen failed on ${NAME} protocol")
+    endif()
+
+    # The statistics are the last thing printed
+    string(FIND "${OUTPUT}" "\n{\n" START REVERSE)
+    if(START LESS 0)
+        message(FATAL_ERROR "No statistics found in ProtoGen output for ${NAME}")
+    endif()
+
+    string(SUBSTRING "${OUTPUT}" ${START} -1 STATS)
+    file(WRITE ${WORKDIR}/${NAME}.json "${STATS}")
+
+    # Report the phases
+    message(STATUS "${NAME}: ${PACKETS} packets, ${FIELDS} fields, depth ${DEPTH}")
+    string(JSON COUNT LENGTH "${STATS}" phases)
+    math(EXPR LAST "${COUNT} - 1")
+    foreach(INDEX RANGE ${LAST})
+        string(JSON PHASE GET "${STATS}" phases ${INDEX} name)
+        string(JSON SECONDS GET "${STATS}" phases ${INDEX} seconds)
+        string(REGEX REPLACE "^([0-9]+\\.[0-9]?[0-9]?[0-9]?[0-9]?[0-9]?[0-9]?).*$" "\\1" SECONDS "${SECONDS}")
+        message(STATUS "    ${PHASE}: ${SECONDS} s")
+    endforeach()
+
+    generation_time("${STATS}" GENERATIONUS)
+    message(STATUS "    Generation: ${GENERATIONUS} us")
+
+    # Compare against the baseline
+    if(BASELINE AND EXISTS ${BASELINE}/${NAME}.json)
+        file(READ ${BASELINE}/${NAME}.json BASESTATS)
+        generation_time("${BASESTATS}" BASEUS)
+        math(EXPR LIMITUS "${BASEUS} * (100 + ${TOLERANCE}) / 100")
+
+        message(STATUS "    Baseline generation: ${BASEUS} us")
+        if(GENERATIONUS GREATER LIMITUS)
+            list(APPEND REGRESSIONS "${NAME} (${GENERATIONUS} us versus ${BASEUS} us)")
+        endif()
+    endif()
+
+endforeach()
+
+if(REGRESSIONS)
+    message(FATAL_ERROR "Generation time regressed by more than ${TOLERANCE}% for: ${REGRESSIONS}")
+endif()
@@ -0,0 +1,247 @@
+/*!
+ * \file
+ * Synthesize a protocol xml file of configurable scale, for benchmarking the
+ * generator. The output is deterministic for a given set of options, so runs
+ * can be compared across ProtoGen versions.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdlib>
+
+//! Options controlling the scale and content of the synthesized protocol
+typedef struct
+{
+    int packets = 100;      //!< Number of packets
+    int structures = 10;    //!< Number of global structures, which packets refer to
+    int fields = 20;        //!< Number of fields in each packet and structure
+    int depth = 1;          //!< Depth of structures nested inside each packet
+    int enums = 10;         //!< Number of global enumerations
+    int bitfields = 20;     //!< Percentage of fields which are bitfields
+    int arrays = 10;        //!< Percentage of fields which are arrays
+    int perfile = 10;       //!< Number of packets that share an output file
+    unsigned seed = 1;      //!< Seed of the random number generator
+    bool cpp = false;       //!< True to generate C++ instead of C
+    std::string output;     //!< Output file name, empty for stdout
+}SynthesizeOptions;
+
+static void printHelp(void);
+static void writeFields(std::ostream& xml, const SynthesizeOptions& options, std::mt19937& rng, int count, int structures, const std::string& indent);
+static void writeNested(std::ostream& xml, const SynthesizeOptions& options, std::mt19937& rng, const std::string& parent, int level, const std::string& indent);
+
+int main(int argc, char *argv[])
+{
+    SynthesizeOptions options;
+
+    for(int i = 1; i < argc; i++)
+    {
+        std::string argument(argv[i]);
+
+        // Every option except -cpp and -help has a numeric or text follower
+        if(argument == "-cpp")
+        {
+            options.cpp = true;
+            continue;
+        }
+        else if((argument == "-help") || (argument == "-?") || (i >= argc - 1))
+        {
+            printHelp();
+            return (argument == "-help") || (argument == "-?") ? 0 : 1;
+        }
+
+        std::string value(argv[++i]);
+
+        if(argument == "-o")
+            options.output = value;
+        else if(argument == "-packets")
+            options.packets = std::atoi(value.c_str());
+        else if(argument == "-structures")
+            options.structures = std::atoi(value.c_str());
+        else if(argument == "-fields")
+            options.fields = std::atoi(value.c_str());
+        else if(argument == "-depth")
+            options.depth = std::atoi(value.c_str());
+        else if(argument == "-enums")
+            options.enums = std::atoi(value.c_str());
+        else if(argument == "-bitfields")
+            options.bitfields = std::atoi(value.c_str());
+        else if(argument == "-arrays")
+            options.arrays = std::atoi(value.c_str());
+        else if(argument == "-perfile")
+            options.perfile = std::atoi(value.c_str());
+        else if(argument == "-seed")
+            options.seed = (unsigned)std::atoi(value.c_str());
+        else
+        {
+            std::cerr << "error: unrecognized option " << argument << std::endl;
+            printHelp();
+            return 1;
+        }
+
+    }// for all arguments
+
+    // Keep the options sane
+    if(options.fields < 1)
+        options.fields = 1;
+
+    if(options.perfile < 1)
+        options.perfile = 1;
+
+    std::mt19937 rng(options.seed);
+    std::stringstream xml;
+
+    xml << "<?xml version=\"1.0\"?>\n";
+    xml << "<Protocol name=\"Synth\" prefix=\"Syn\" api=\"1\" version=\"1.0\" endian=\"big\" supportLongBitfield=\"true\"";
+    if(options.cpp)
+        xml << " cpp=\"true\"";
+    xml << " comment=\"Synthesized protocol with " << options.packets << " packets of " << options.fields << " fields\">\n";
+
+    xml << "    <Enum name=\"SynthPacketIds\" comment=\"Packet identifiers\">\n";
+    for(int p = 0; p < options.packets; p++)
+        xml << "        <Value name=\"SYNTH_PKT_" << p << "\" comment=\"Identifier of packet " << p << "\"/>\n";
+    xml << "    </Enum>\n";
+
+    for(int e = 0; e < options.enums; e++)
+    {
+        xml << "    <Enum name=\"SynthEnum" << e << "\" comment=\"Enumeration " << e << "\">\n";
+        for(int v = 0; v < 8; v++)
+            xml << "        <Value name=\"SYNTH_ENUM" << e << "_" << v << "\" comment=\"Value " << v << "\"/>\n";
+        xml << "    </Enum>\n";
+    }
+
+    // Each structure can refer to the structures before it
+    for(int s = 0; s < options.structures; s++)
+    {
+        xml << "    <Structure name=\"SynthStruct" << s << "\" file=\"SynthStructures\" comment=\"Global structure " << s << "\">\n";
+        writeFields(xml, options, rng, options.fields, s, "        ");
+        xml << "    </Structure>\n";
+    }
+
+    for(int p = 0; p < options.packets; p++)
+    {
+        xml << "    <Packet name=\"SynthPacket" << p << "\" ID=\"SYNTH_PKT_" << p << "\" file=\"SynthPackets" << p/options.perfile << "\" comment=\"Packet " << p << "\">\n";
+        writeFields(xml, options, rng, options.fields, options.structures, "        ");
+        writeNested(xml, options, rng, "SynthPacket" + std::to_string(p), 1, "        ");
+        xml << "    </Packet>\n";
+    }
+
+    xml << "</Protocol>\n";
+
+    if(options.output.empty())
+        std::cout << xml.str();
+    else
+    {
+        std::fstream file(options.output, std::ios_base::out);
+
+        if(!file.is_open())
+        {
+            std::cerr << "error: failed to open " << options.output << std::endl;
+            return 1;
+        }
+
+        file << xml.str();
+    }
+
+    return 0;
+
+}// main
+
+
+/*!
+ * Write a set of randomly chosen fields.
+ * \param xml receives the fields.
+ * \param options are the synthesis options.
+ * \param rng is the random number generator.
+ * \param count is the number of fields to write.
+ * \param structures is the number of global structures that can be referenced.
+ * \param indent is the indentation of the fields.
+ */
+void writeFields(std::ostream& xml, const SynthesizeOptions& options, std::mt19937& rng, int count, int structures, const std::string& indent)
+{
+    const std::vector<std::string> types = {"unsigned8", "unsigned16", "unsigned32", "signed8", "signed16", "signed32", "float32"};
+
+    std::uniform_int_distribution<int> percent(0, 99);
+
+    for(int f = 0; f < count; f++)
+    {
+        int choice = percent(rng);
+        std::string name = "field" + std::to_string(f);
+
+        if(choice < options.bitfields)
+        {
+            // A group of bitfields that fills whole bytes
+            int bits = 0;
+            for(int b = 0; (bits < 8) || (bits % 8); b++)
+            {
+                int width = 1 + (int)(rng() % 7);
+                if((bits % 8) + width > 8)
+                    width = 8 - (bits % 8);
+
+                bits += width;
+                xml << indent << "<Data name=\"" << name << "_" << b << "\" inMemoryType=\"unsigned8\" encodedType=\"bitfield" << width << "\" comment=\"Bitfield\"/>\n";
+            }
+        }
+        else if(choice < options.bitfields + options.arrays)
+            xml << indent << "<Data name=\"" << name << "\" inMemoryType=\"" << types.at(rng() % types.size()) << "\" array=\"" << 2 + (rng() % 15) << "\" comment=\"Array\"/>\n";
+        else if((options.enums > 0) && (choice < options.bitfields + options.arrays + 10))
+            xml << indent << "<Data name=\"" << name << "\" enum=\"SynthEnum" << rng() % options.enums << "\" encodedType=\"unsigned8\" comment=\"Enumeration\"/>\n";
+        else if((structures > 0) && (choice < options.bitfields + options.arrays + 15))
+            xml << indent << "<Data name=\"" << name << "\" struct=\"SynthStruct" << rng() % structures << "\" comment=\"Structure\"/>\n";
+        else if(choice < options.bitfields + options.arrays + 30)
+            xml << indent << "<Data name=\"" << name << "\" inMemoryType=\"float32\" encodedType=\"signed16\" max=\"100\" comment=\"Scaled\"/>\n";
+        else
+            xml << indent << "<Data name=\"" << name << "\" inMemoryType=\"" << types.at(rng() % types.size()) << "\" comment=\"Number\"/>\n";
+
+    }// for all fields
+
+}// writeFields
+
+
+/*!
+ * Write structures nested inside a packet, each containing the next level.
+ * \param xml receives the structures.
+ * \param options are the synthesis options.
+ * \param rng is the random number generator.
+ * \param parent is the name of the packet, used to make the structure type names unique.
+ * \param level is the nesting level, starting at 1.
+ * \param indent is the indentation of the structure.
+ */
+void writeNested(std::ostream& xml, const SynthesizeOptions& options, std::mt19937& rng, const std::string& parent, int level, const std::string& indent)
+{
+    if(level > options.depth)
+        return;
+
+    xml << indent << "<Structure name=\"" << parent << "Nested" << level << "\" comment=\"Nested structure at level " << level << "\">\n";
+    writeFields(xml, options, rng, (options.fields + 1)/2, options.structures, indent + "    ");
+    writeNested(xml, options, rng, parent, level + 1, indent + "    ");
+    xml << indent << "</Structure>\n";
+
+}// writeNested
+
+
+void printHelp(void)
+{
+    std::cout << R"===(Synthesize a protocol xml file for benchmarking ProtoGen
+
+Usage: ProtoGenSynthesize -options
+
+  -o <file>          : Output file (stdout if not given).
+  -packets <n>       : Number of packets (default 100).
+  -structures <n>    : Number of global structures referenced by packets
+                       (default 10).
+  -fields <n>        : Number of fields per packet and structure (default 20).
+  -depth <n>         : Depth of structures nested in each packet (default 1).
+  -enums <n>         : Number of global enumerations (default 10).
+  -bitfields <n>     : Percentage of fields which are bitfield groups
+                       (default 20).
+  -arrays <n>        : Percentage of fields which are arrays (default 10).
+  -perfile <n>       : Number of packets sharing an output file (default 10).
+  -seed <n>          : Random seed (default 1).
+  -cpp               : Generate a C++ protocol instead of C.
+
+)===";
+}
@@ -4,11 +4,14 @@
 #include "protocolcode.h"
 #include "protocoldocumentation.h"
 #include "protocolparser.h"
+#include "shuntingyard.h"
+#include <iomanip>
+#include <sstream>
 
 /*!
  * Constructor for encodable
  */
-Encodable::Encodable(ProtocolParser* parse, const std::string& Parent, ProtocolSupport supported) :
+Encodable::Encodable(ProtocolParser* parse, const std::string& Parent, SharedSupport supported) :
     ProtocolDocumentation(parse, Parent, supported)
 {
 }
@@ -204,14 +207,14 @@ std::string Encodable::getReturnCode(bool positive) const
 {
     if(positive)
     {
-        if(support.language == ProtocolSupport::c_language)
+        if(support->language == ProtocolSupport::c_language)
             return "1";
         else
             return "true";
     }
     else
     {
-        if(support.language == ProtocolSupport::c_language)
+        if(support->language == ProtocolSupport::c_language)
             return "0";
         else
             return "false";
@@ -245,7 +248,7 @@ std::string Encodable::getEncodeFieldAccess(bool isStructureMember, const std::s
     // How we are going to access the field
     if(isStructureMember)
     {
-        if(support.language == ProtocolSupport::c_language)
+        if(support->language == ProtocolSupport::c_language)
             access = "_pg_user->" + variable; // Access via structure pointer
         else
             access = variable;                // Access via implicit class reference
@@ -268,7 +271,7 @@ std::string Encodable::getEncodeFieldAccess(bool isStructureMember, const std::s
         // the structure, even for encoding. Note however that if we are a
         // parameter we are already a pointer (because we never pass structures
         // by value).
-        if(!isPrimitive() && (support.language == ProtocolSupport::c_language) && (isStructureMember || isArray()))
+        if(!isPrimitive() && (support->language == ProtocolSupport::c_language) && (isStructureMember || isArray()))
             access = "&" + access;
     }
 
@@ -300,7 +303,7 @@ std::string Encodable::getDecodeFieldAccess(bool isStructureMember, const std::s
 
     if(isStructureMember)
     {
-        if(support.language == ProtocolSupport::c_language)
+        if(support->language == ProtocolSupport::c_language)
             access = "_pg_user->" + variable; // Access via structure pointer
         else
             access = variable;                // Access via implicit class reference
@@ -317,7 +320,7 @@ std::string Encodable::getDecodeFieldAccess(bool isStructureMember, const std::s
             }
 
             // If we are a structure, and the language is C, we need the address of the structure.
-            if(!isPrimitive() && (support.language == ProtocolSupport::c_language))
+            if(!isPrimitive() && (support->language == ProtocolSupport::c_language))
                 access = "&" + access;
         }
     }
@@ -334,7 +337,7 @@ std::string Encodable::getDecodeFieldAccess(bool isStructureMember, const std::s
                     access += "[_pg_j]";
 
                 // If we are a structure, and the language is C, we need the address of the structure.
-                if(!isPrimitive() && (support.language == ProtocolSupport::c_language))
+                if(!isPrimitive() && (support->language == ProtocolSupport::c_language))
                     access = "&" + access;
             }
             else if(!isPrimitive())
@@ -431,6 +434,253 @@ std::string Encodable::getDecodeArrayIterationCode(const std::string& spacing, b
 }// Encodable::getDecodeArrayIterationCode
 
 
+/*!
+ * Get the code that computes the key of this encodable in a flat map. The key
+ * is formed from the key of the parent (_pg_prekey), the identifier of this
+ * field's name, and the array indices (_pg_i and _pg_j) if this is an array.
+ * \return the code that computes the key
+ */
+std::string Encodable::getFlatMapKey(void) const
+{
+    std::string output = "pgFlatMapKey(_pg_prekey, " + getFlatMapIdString(name);
+
+    // The array dimension of a string is not iterated, its the length of the string
+    if(isArray() && !isString())
+        output += ", _pg_i";
+
+    if(is2dArray() && !isString())
+        output += ", _pg_j";
+
+    return output + ")";
+
+}// Encodable::getFlatMapKey
+
+
+/*!
+ * Get the identifier of a field name in a flat map, which is the 32-bit FNV-1a
+ * hash of the name. This is stable as fields are added or removed.
+ * \param fieldname is the name of the field
+ * \return the identifier of the field
+ */
+uint32_t Encodable::getFlatMapId(const std::string& fieldname)
+{
+    return getFieldNameHash(fieldname, 0);
+
+}// Encodable::getFlatMapId
+
+
+/*!
+ * Get the seeded 32-bit FNV-1a hash of a field name. This must match
+ * pgFieldHash() in the generated jsoncbor.hpp, which is used to find fields
+ * from their keys when reading JSON or CBOR.
+ * \param fieldname is the name of the field
+ * \param seed is mixed into the offset basis of the hash
+ * 
+eturn the hash of the field name
+ */
+uint32_t Encodable::getFieldNameHash(const std::string& fieldname, uint32_t seed)
+{
+    uint32_t hash = 2166136261u ^ seed;
+
+    for(std::size_t i = 0; i < fieldname.size(); i++)
+    {
+        hash ^= (uint8_t)fieldname.at(i);
+        hash *= 16777619u;
+    }
+
+    return hash;
+
+}// Encodable::getFieldNameHash
+
+
+/*!
+ * Get the identifier of a field name in a flat map as a hexadecimal literal
+ * \param fieldname is the name of the field
+ * \return the identifier as code, for example "0x1234ABCDu"
+ */
+std::string Encodable::getFlatMapIdString(const std::string& fieldname)
+{
+    std::stringstream stream;
+    stream << "0x" << std::hex << std::uppercase << std::setw(8) << std::setfill('0') << getFlatMapId(fieldname) << "u";
+    return stream.str();
+
+}// Encodable::getFlatMapIdString
+
+
+/*!
+ * Get the key of this encodable as a string literal for the JSON or CBOR
+ * writer. The key is precomputed so that nothing is escaped or measured at
+ * runtime.
+ * \param cbor should be true for the CBOR key, else the JSON key
+ * \return the key literal as code, for example "\"name\":" or "\x64" "name"
+ */
+std::string Encodable::getJsonKeyLiteral(bool cbor) const
+{
+    if(!cbor)
+        return "\"\\\"" + name + "\\\":\"";
+
+    std::stringstream stream;
+
+    // CBOR text string header, major type 3, followed by the length
+    stream << std::hex << std::uppercase << std::setfill('0') << "\"";
+    if(name.size() < 24)
+        stream << "\\x" << std::setw(2) << (0x60 + name.size());
+    else
+        stream << "\\x78\\x" << std::setw(2) << (name.size() & 0xFF);
+
+    // A separate literal, so the name is not consumed by the hexadecimal escape
+    stream << "\" \"" << name << "\"";
+
+    return stream.str();
+
+}// Encodable::getJsonKeyLiteral
+
+
+/*!
+ * Get the code that writes this encodable as an array to a JSON or CBOR
+ * writer. Two dimensional arrays are written as arrays of arrays.
+ * \param element is the statement that writes one element of the array
+ * \return the code that writes the array, or just the element if this is not an array
+ */
+std::string Encodable::getJsonArrayWriteCode(const std::string& element) const
+{
+    std::string output;
+    std::string spacing = TAB_IN;
+
+    if(!isArray())
+        return spacing + element + "\n";
+
+    output += spacing + "_pg_writer.beginArray();\n";
+
+    if(variableArray.empty())
+        output += spacing + "for(_pg_i = 0; _pg_i < " + array + "; _pg_i++)\n";
+    else
+        output += spacing + "for(_pg_i = 0; _pg_i < (unsigned)" + getEncodeFieldAccess(true, variableArray) + " && _pg_i < " + array + "; _pg_i++)\n";
+
+    if(is2dArray())
+    {
+        output += spacing + "{\n";
+        spacing += TAB_IN;
+        output += spacing + "_pg_writer.beginArray();\n";
+
+        if(variable2dArray.empty())
+            output += spacing + "for(_pg_j = 0; _pg_j < " + array2d + "; _pg_j++)\n";
+        else
+            output += spacing + "for(_pg_j = 0; _pg_j < (unsigned)" + getEncodeFieldAccess(true, variable2dArray) + " && _pg_j < " + array2d + "; _pg_j++)\n";
+
+        output += spacing + TAB_IN + element + "\n";
+        output += spacing + "_pg_writer.endArray();\n";
+        spacing = TAB_IN;
+        output += spacing + "}\n";
+    }
+    else
+        output += spacing + TAB_IN + element + "\n";
+
+    output += spacing + "_pg_writer.endArray();\n";
+
+    return output;
+
+}// Encodable::getJsonArrayWriteCode
+
+
+/*!
+ * Get the code that reads this encodable as an array from a JSON or CBOR
+ * reader. Elements beyond the size of the array are skipped.
+ * \param spacing is the spacing that begins each line
+ * \param element is the statement that reads one element of the array
+ * \return the code that reads the array, or just the element if this is not an array
+ */
+std::string Encodable::getJsonArrayReadCode(const std::string& spacing, const std::string& element) const
+{
+    std::string output;
+
+    if(!isArray())
+        return spacing + element + "\n";
+
+    std::string spacing2 = spacing + TAB_IN + TAB_IN;
+
+    output += spacing + "if(_pg_reader.beginArray())\n";
+    output += spacing + "{\n";
+    output += spacing + TAB_IN + "for(_pg_i = 0; _pg_reader.nextElement(); _pg_i++)\n";
+    output += spacing + TAB_IN + "{\n";
+    output += spacing2 + "if(_pg_i >= " + array + ")\n";
+    output += spacing2 + TAB_IN + "_pg_reader.skipValue();\n";
+
+    if(is2dArray())
+    {
+        std::string spacing3 = spacing2 + TAB_IN + TAB_IN;
+
+        output += spacing2 + "else if(_pg_reader.beginArray())\n";
+        output += spacing2 + "{\n";
+        output += spacing2 + TAB_IN + "for(_pg_j = 0; _pg_reader.nextElement(); _pg_j++)\n";
+        output += spacing2 + TAB_IN + "{\n";
+        output += spacing3 + "if(_pg_j >= " + array2d + ")\n";
+        output += spacing3 + TAB_IN + "_pg_reader.skipValue();\n";
+        output += spacing3 + "else\n";
+        output += spacing3 + TAB_IN + element + "\n";
+        output += spacing2 + TAB_IN + "}\n";
+        output += spacing2 + "}\n";
+    }
+    else
+    {
+        output += spacing2 + "else\n";
+        output += spacing2 + TAB_IN + element + "\n";
+    }
+
+    output += spacing + TAB_IN + "}\n";
+    output += spacing + "}\n";
+
+    return output;
+
+}// Encodable::getJsonArrayReadCode
+
+
+/*!
+ * Replicate the static initializer of one element across the array dimensions
+ * of this encodable. This requires the array sizes to be known numbers at
+ * generation time, possibly by way of enumeration values.
+ * \param element is the initializer of one element of the array
+ * \param ok is set to false if the array sizes cannot be resolved
+ * \return the initializer of the entire array, or just the element if this is not an array
+ */
+std::string Encodable::getArrayStaticInitializer(const std::string& element, bool* ok) const
+{
+    if(!isArray())
+        return element;
+
+    bool good1 = false, good2 = true;
+    double size1 = ShuntingYard::computeInfix(parser->replaceEnumerationNameWithValue(array), &good1);
+    double size2 = 1;
+
+    if(is2dArray())
+        size2 = ShuntingYard::computeInfix(parser->replaceEnumerationNameWithValue(array2d), &good2);
+
+    if(!good1 || !good2 || (size1 < 1) || (size2 < 1))
+    {
+        *ok = false;
+        return std::string();
+    }
+
+    std::string output = element;
+
+    if(is2dArray())
+    {
+        std::string row = "{" + element;
+        for(int j = 1; j < (int)size2; j++)
+            row += ", " + element;
+
+        output = row + "}";
+    }
+
+    std::string initializer = "{" + output;
+    for(int i = 1; i < (int)size1; i++)
+        initializer += ", " + output;
+
+    return initializer + "}";
+
+}// Encodable::getArrayStaticInitializer
+
+
 /*!
  * Get documentation repeat details for array or 2d arrays
  * \return The repeat details
@@ -509,7 +759,7 @@ std::string Encodable::getRepeatsDocumentationDetails(void) const
  * \return a pointer to a newly allocated encodable. The caller is
  *         responsible for deleting this object.
  */
-Encodable* Encodable::generateEncodable(ProtocolParser* parse, const std::string& parent, ProtocolSupport supported, const XMLElement* field)
+Encodable* Encodable::generateEncodable(ProtocolParser* parse, const std::string& parent, SharedSupport supported, const XMLElement* field)
 {
     Encodable* enc = NULL;
 
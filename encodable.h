@@ -10,12 +10,12 @@ class Encodable : public ProtocolDocumentation
 public:
 
     //! Constructor for basic encodable that sets protocol options
-    Encodable(ProtocolParser* parse, const std::string& parent, ProtocolSupport supported);
+    Encodable(ProtocolParser* parse, const std::string& parent, SharedSupport supported);
 
     virtual ~Encodable() {;}
 
     //! Construct a protocol field by parsing a DOM element
-    static Encodable* generateEncodable(ProtocolParser* parse, const std::string& parent, ProtocolSupport supported, const XMLElement* field);
+    static Encodable* generateEncodable(ProtocolParser* parse, const std::string& parent, SharedSupport supported, const XMLElement* field);
 
     //! Provide the pointer to a previous encodable in the list
     virtual void setPreviousEncodable(Encodable* prev) {(void)prev;}
@@ -44,6 +44,9 @@ public:
     //! Return the string that sets this encodable to its initial value in code
     virtual std::string getSetInitialValueString(bool isStructureMember) const {(void)isStructureMember; return std::string();}
 
+    //! Return the value of this encodable in the static initializer of its parent, empty if zero
+    virtual std::string getStaticInitializerString(bool* ok) const {(void)ok; return std::string();}
+
     //! Return the strings that #define initial and variable values
     virtual std::string getInitialAndVerifyDefines(bool includeComment = true) const {(void)includeComment; return std::string();}
 
@@ -71,6 +74,12 @@ public:
     //! Get the string used to decode this field from a map
     virtual std::string getMapDecodeString(void) const {return std::string();}
 
+    //! Get the string used to write this field to a JSON (or CBOR) writer
+    virtual std::string getJsonWriteString(bool cbor) const {(void)cbor; return std::string();}
+
+    //! Get the string used to read this field from a JSON (or CBOR) reader, once its key is found
+    virtual std::string getJsonReadString(const std::string& spacing, bool cbor) const {(void)spacing; (void)cbor; return std::string();}
+
     //! Return the string that sets this encodable to its default value in code
     virtual std::string getSetToDefaultsString(bool isStructureMember) const {(void)isStructureMember; return std::string();}
 
@@ -86,6 +95,9 @@ public:
     //! Return the include directives needed for this encodable's map functions
     virtual void getMapIncludeDirectives(std::vector<std::string>& list) const {(void)list;}
 
+    //! Return the include directives needed for this encodable's JSON and CBOR functions
+    virtual void getJsonIncludeDirectives(std::vector<std::string>& list) const {(void)list;}
+
     //! Return the include directives needed for this encodable's compare functions
     virtual void getCompareIncludeDirectives(std::vector<std::string>& list) const {(void)list;}
 
@@ -125,6 +137,30 @@ public:
     //! Get the array handling code for decoding context
     virtual std::string getDecodeArrayIterationCode(const std::string& spacing, bool isStructureMember) const;
 
+    //! Get the code that computes the key of this encodable in a flat map
+    std::string getFlatMapKey(void) const;
+
+    //! Get the identifier of a field name in a flat map
+    static uint32_t getFlatMapId(const std::string& fieldname);
+
+    //! Get the identifier of a field name in a flat map as a hexadecimal literal
+    static std::string getFlatMapIdString(const std::string& fieldname);
+
+    //! Get the seeded hash of a field name, which matches pgFieldHash() in generated code
+    static uint32_t getFieldNameHash(const std::string& fieldname, uint32_t seed);
+
+    //! Get the key of this encodable as a string literal for the JSON or CBOR writer
+    std::string getJsonKeyLiteral(bool cbor) const;
+
+    //! Get the code that writes this encodable as an array to a JSON or CBOR writer
+    std::string getJsonArrayWriteCode(const std::string& element) const;
+
+    //! Get the code that reads this encodable as an array from a JSON or CBOR reader
+    std::string getJsonArrayReadCode(const std::string& spacing, const std::string& element) const;
+
+    //! Replicate an element initializer across the array dimensions of this encodable
+    std::string getArrayStaticInitializer(const std::string& element, bool* ok) const;
+
     //! Return true if this encodable has documentation for markdown output
     virtual bool hasDocumentation(void) {return true;}
 
@@ -170,6 +206,12 @@ public:
     //! True if this encodable has a default value
     virtual bool isDefault(void) const {return false;}
 
+    //! True if the gather encode references this encodable in place, rather than copying it into the packet
+    virtual bool isGather(void) const {return false;}
+
+    //! Get the string that adds this encodable to the segment list of the gather encode
+    virtual std::string getGatherEncodeString(bool isStructureMember) const {(void)isStructureMember; return std::string();}
+
     //! Get the maximum number of temporary bytes needed for a bitfield group
     virtual void getBitfieldGroupNumBytes(int* num) const {(void)num;}
 
@@ -194,6 +236,9 @@ public:
     //! True if this encodable has a direct child that needs an iterator for decoding
     virtual bool usesDecodeIterator(void) const = 0;
 
+    //! True if the packet encode and decode functions visit the elements of this encodable with the iterator
+    virtual bool usesCodecIterator(void) const {return true;}
+
     //! True if this encodable has a direct child that needs an iterator for verifying
     virtual bool usesVerifyIterator(void) const = 0;
 
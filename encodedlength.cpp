@@ -82,6 +82,36 @@ void EncodedLength::addToLength(const std::string & length, bool isString, bool
 }// EncodedLength::addToLength
 
 
+/*!
+ * Add length strings for a field whose encoded length depends on its value,
+ * such as a variable length integer.
+ * \param minLength is the smallest length the field can have.
+ * \param maxLength is the largest length the field can have.
+ * \param isVariable is true if this length is for a variable length array
+ * \param isDependent is true if this length is for a field whose presence depends on another field
+ * \param isDefault is true if this length is for a default field.
+ */
+void EncodedLength::addRangeToLength(const std::string& minLength, const std::string& maxLength, bool isVariable, bool isDependent, bool isDefault)
+{
+    if(maxLength.empty())
+        return;
+
+    addToLengthString(maxEncodedLength, maxLength);
+
+    // Default fields do not add to the length of anything else
+    if(isDefault)
+        return;
+
+    // The maximum is used here, so that the packet length is checked after decoding
+    addToLengthString(nonDefaultEncodedLength, maxLength);
+
+    // If not variable or dependent, then add to minimum length
+    if(!isVariable && !isDependent)
+        addToLengthString(minEncodedLength, minLength);
+
+}// EncodedLength::addRangeToLength
+
+
 /*!
  * Add a grouping of length strings to this length
  * \param rightLength is the length strings to add.
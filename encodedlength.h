@@ -11,6 +11,9 @@ public:
     //! Add successive length strings
     void addToLength(const std::string & length, bool isString = false, bool isVariable = false, bool  isDependent = false, bool isDefault = false);
 
+    //! Add length strings for a field whose length is between a minimum and a maximum
+    void addRangeToLength(const std::string& minLength, const std::string& maxLength, bool isVariable = false, bool isDependent = false, bool isDefault = false);
+
     //! Add a grouping of length strings
     void addToLength(const EncodedLength& rightLength, const std::string& array = std::string(), bool isVariable = false, bool isDependent = false, const std::string& array2d = std::string());
 
@@ -5,7 +5,7 @@
 #include <math.h>
 #include <algorithm>
 
-EnumElement::EnumElement(ProtocolParser *parse, EnumCreator *creator, const std::string& parent, ProtocolSupport supported) :
+EnumElement::EnumElement(ProtocolParser *parse, EnumCreator *creator, const std::string& parent, SharedSupport supported) :
     ProtocolDocumentation(parse, parent, supported),
     hidden(false),
     ignoresPrefix(false),
@@ -86,7 +86,7 @@ std::string EnumElement::getDeclaration() const
 }
 
 //! Create an empty enumeration list
-EnumCreator::EnumCreator(ProtocolParser* parse, const std::string& parent, ProtocolSupport supported) :
+EnumCreator::EnumCreator(ProtocolParser* parse, const std::string& parent, SharedSupport supported) :
     ProtocolDocumentation(parse, parent, supported),
     minbitwidth(0),
     maxvalue(0),
@@ -194,16 +194,16 @@ void EnumCreator::parse(bool nocode)
     lookupTitle = ProtocolParser::isFieldSet("lookupTitle", map);
     lookupComment = ProtocolParser::isFieldSet("lookupComment", map);
     file = ProtocolParser::getAttribute("file", map);
-    translate = ProtocolParser::getAttribute("translate", map, support.globaltranslate);
+    translate = ProtocolParser::getAttribute("translate", map, support->globaltranslate);
 
     // The file attribute is only supported on global enumerations
     if(isglobal)
     {
-        filepath = support.outputpath;
+        filepath = support->outputpath;
 
         // If no file information is provided we use the global header name
         if(file.empty())
-            file = support.protoName + "Protocol";
+            file = support->protoName + "Protocol";
 
         // This will separate all the path information
         ProtocolFile::separateModuleNameAndPath(file, filepath);
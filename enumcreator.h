@@ -15,7 +15,7 @@ class EnumElement : public ProtocolDocumentation
 public:
 
     //! Cronstruct an enumeration element
-    EnumElement(ProtocolParser* parse, EnumCreator* creator, const std::string& Parent, ProtocolSupport supported);
+    EnumElement(ProtocolParser* parse, EnumCreator* creator, const std::string& Parent, SharedSupport supported);
 
     //! Parse an enumeration element
     void parse(bool nocode = false) override;
@@ -64,7 +64,7 @@ class EnumCreator : public ProtocolDocumentation
 {
 public:
     //! Construct the enumeration object
-    EnumCreator(ProtocolParser* parse, const std::string& parent, ProtocolSupport supported);
+    EnumCreator(ProtocolParser* parse, const std::string& parent, SharedSupport supported);
 
     ~EnumCreator(void);
 
@@ -132,7 +132,12 @@ between them. A protocol is Big Endian if it sends the most significant
 byte first and the least significant last. If the computer and the protocol
 have the same endianness then encoding data from memory into a byte stream
 is a simple copy. However if the endianness is not the same then bytes must
-be re-ordered for the data to be interpreted correctly.)");
+be re-ordered for the data to be interpreted correctly.
+
+Variable length integers have no endianness. They are encoded 7 bits at a
+time, least significant first, with the most significant bit of each byte set
+if more bytes follow, so small numbers use fewer bytes. Signed numbers are
+zigzag encoded, so that small negative numbers are also short.)");
 
     header.makeLineSeparator();
 
@@ -156,7 +161,13 @@ void stringToBytes(const char* string, uint8_t* bytes, int* index, int maxLength
 void bytesToBeBytes(const uint8_t* data, uint8_t* bytes, int* index, int num);
 
 //! Copy an array of bytes to a byte stream while reversing the order.
-void bytesToLeBytes(const uint8_t* data, uint8_t* bytes, int* index, int num);)");
+void bytesToLeBytes(const uint8_t* data, uint8_t* bytes, int* index, int num);
+
+//! Encode a null terminated string on a byte stream as the index of a dictionary entry, or as the string itself
+void stringToDictionaryBytes(const char* string, const char* const* dictionary, int entries, uint8_t* bytes, int* index, int maxLength, int fixedLength);
+
+//! Encode an array of bytes on a byte stream with run length compression
+void bytesToRleBytes(const uint8_t* data, uint8_t* bytes, int* index, int num);)");
 
     if(support.int64)
     {
@@ -194,6 +205,27 @@ void bytesToLeBytes(const uint8_t* data, uint8_t* bytes, int* index, int num);)"
 
     }// for all output byte counts
 
+    // Variable length integers have no endian, their bytes are always least significant first
+    for(int bits = 32; (bits == 32) || ((bits == 64) && support.int64); bits += 32)
+    {
+        if(bits > 32)
+        {
+            header.makeLineSeparator();
+            header.write("#ifdef UINT64_MAX\n");
+        }
+
+        header.makeLineSeparator();
+        header.write("//! " + briefVarintEncodeComment(bits, false) + "\n");
+        header.write(varintEncodeSignature(bits, false) + ";\n");
+
+        header.makeLineSeparator();
+        header.write("//! " + briefVarintEncodeComment(bits, true) + "\n");
+        header.write(varintEncodeSignature(bits, true) + ";\n");
+
+        if(bits > 32)
+            header.write("\n#endif // UINT64_MAX\n");
+    }
+
     header.makeLineSeparator();
 
     return header.flush();
@@ -326,7 +358,112 @@ void bytesToLeBytes(const uint8_t* data, uint8_t* bytes, int* index, int num)
         num--;
     }
 
-}// bytesToLeBytes)");
+}// bytesToLeBytes
+
+
+/*!
+ * Encode a null terminated string on a byte stream using a dictionary of
+ * likely values. If the string matches a dictionary entry only the index of
+ * the entry is encoded, in one byte. Otherwise the byte 255 is encoded,
+ * followed by the string itself, so the encoding is never more than one byte
+ * longer than the string alone.
+ * \param string is the null terminated string to encode
+ * \param dictionary is the list of likely values of the string.
+ * \param entries is the number of entries in the dictionary, which must be
+ *        less than 255.
+ * \param bytes is a pointer to the byte stream which receives the encoded data.
+ * \param index gives the location of the first byte in the byte stream, and
+ *        will be incremented by the number of bytes encoded when this function
+ *        is complete.
+ * \param maxLength is the maximum number of bytes that can be encoded for the
+ *        string. A null terminator is always included in the encoding.
+ * \param fixedLength should be 1 to force the number of bytes encoded for a
+ *        string which is not in the dictionary to be exactly maxLength.
+ */
+void stringToDictionaryBytes(const char* string, const char* const* dictionary, int entries, uint8_t* bytes, int* index, int maxLength, int fixedLength)
+{
+    int i, j;
+
+    for(i = 0; i < entries; i++)
+    {
+        const char* entry = dictionary[i];
+
+        // Compare the characters that would be encoded
+        for(j = 0; (j < maxLength - 1) && (string[j] != 0) && (string[j] == entry[j]); j++);
+
+        if(((j == maxLength - 1) || (string[j] == 0)) && (entry[j] == 0))
+            break;
+    }
+
+    if(i < entries)
+        bytes[(*index)++] = (uint8_t)i;
+    else
+    {
+        bytes[(*index)++] = 255;
+        stringToBytes(string, bytes, index, maxLength, fixedLength);
+    }
+
+}// stringToDictionaryBytes
+
+
+/*!
+ * Encode an array of bytes on a byte stream with run length compression. The
+ * encoding is a sequence of blocks which each start with a control byte. A
+ * control byte less than 128 is followed by that many plus one bytes, which
+ * are copied. A control byte of 128 or more is followed by a single byte which
+ * is repeated the control byte minus 125 times. Runs of 3 to 130 repeated
+ * bytes are compressed, other bytes are copied in blocks of up to 128; so the
+ * encoding of num bytes is never more than num plus (num+127)/128 bytes long.
+ * \param data is the array of bytes to encode.
+ * \param bytes is a pointer to the byte stream which receives the encoded data.
+ * \param index gives the location of the first byte in the byte stream, and
+ *        will be incremented by the number of bytes encoded when this function
+ *        is complete.
+ * \param num is the number of bytes to encode
+ */
+void bytesToRleBytes(const uint8_t* data, uint8_t* bytes, int* index, int num)
+{
+    int i = 0;
+    int run;
+    int literals = 0;
+
+    while(i < num)
+    {
+        // Count the bytes that repeat the byte at i
+        for(run = 1; (i + run < num) && (run < 130) && (data[i + run] == data[i]); run++);
+
+        if((run < 3) && (literals < 128))
+        {
+            // Too short to compress, gather into a block of copied bytes
+            literals++;
+            i++;
+            continue;
+        }
+
+        // Finish the block of copied bytes before this one
+        if(literals > 0)
+        {
+            bytes[(*index)++] = (uint8_t)(literals - 1);
+            bytesToBeBytes(data + i - literals, bytes, index, literals);
+            literals = 0;
+        }
+
+        if(run >= 3)
+        {
+            bytes[(*index)++] = (uint8_t)(run + 125);
+            bytes[(*index)++] = data[i];
+            i += run;
+        }
+
+    }// while bytes to encode
+
+    if(literals > 0)
+    {
+        bytes[(*index)++] = (uint8_t)(literals - 1);
+        bytesToBeBytes(data + i - literals, bytes, index, literals);
+    }
+
+}// bytesToRleBytes)");
 
     source.makeLineSeparator();
 
@@ -359,6 +496,26 @@ void bytesToLeBytes(const uint8_t* data, uint8_t* bytes, int* index, int num)
 
     }
 
+    for(int bits = 32; (bits == 32) || ((bits == 64) && support.int64); bits += 32)
+    {
+        if(bits > 32)
+        {
+            source.makeLineSeparator();
+            source.write("#ifdef UINT64_MAX\n");
+        }
+
+        source.makeLineSeparator();
+        source.write(fullVarintEncodeComment(bits, false) + "\n");
+        source.write(varintEncodeFunction(bits, false) + "\n");
+
+        source.makeLineSeparator();
+        source.write(fullVarintEncodeComment(bits, true) + "\n");
+        source.write(varintEncodeFunction(bits, true) + "\n");
+
+        if(bits > 32)
+            source.write("#endif // UINT64_MAX\n");
+    }
+
     source.makeLineSeparator();
 
     return source.flush();
@@ -608,6 +765,112 @@ std::string FieldCoding::integerEncodeFunction(int type, bool bigendian)
 }// FieldCoding::integerEncodeFunction
 
 
+/*!
+ * Create the brief variable length encode function comment, without doxygen decorations
+ * \param bits is the width of the integer, 32 or 64.
+ * \param issigned should be true for the signed (zigzag) encoding.
+ * \return The string that represents the one line function comment.
+ */
+std::string FieldCoding::briefVarintEncodeComment(int bits, bool issigned)
+{
+    if(issigned)
+        return "Encode a signed " + std::to_string(bits/8) + " byte integer on a byte stream as a zigzag variable length integer.";
+    else
+        return "Encode an unsigned " + std::to_string(bits/8) + " byte integer on a byte stream as a variable length integer.";
+
+}// FieldCoding::briefVarintEncodeComment
+
+
+/*!
+ * Create the full variable length encode function comment, with doxygen decorations
+ * \param bits is the width of the integer, 32 or 64.
+ * \param issigned should be true for the signed (zigzag) encoding.
+ * \return The string that represents the full multi-line function comment.
+ */
+std::string FieldCoding::fullVarintEncodeComment(int bits, bool issigned)
+{
+    std::string comment = "/*!\n";
+
+    comment += ProtocolParser::outputLongComment(" * ", briefVarintEncodeComment(bits, issigned)) + "\n";
+
+    if(issigned)
+        comment += " * Zigzag encoding interleaves the numbers 0, -1, 1, -2, 2... so that numbers\n * near zero, whatever their sign, use few bytes.\n";
+    else
+        comment += " * Each byte holds 7 bits of the number, least significant first, with the\n * most significant bit of the byte set if more bytes follow.\n";
+
+    comment += " * \\param number is the value to encode.\n";
+    comment += " * \\param bytes is a pointer to the byte stream which receives the encoded data.\n";
+    comment += " * \\param index gives the location of the first byte in the byte stream, and\n";
+    comment += " *        will be incremented by the number of bytes used, from 1 to " + std::to_string((bits + 6)/7) + ".\n";
+    comment += " */";
+
+    return comment;
+
+}// FieldCoding::fullVarintEncodeComment
+
+
+/*!
+ * Create the one line variable length encode function signature, without a trailing semicolon
+ * \param bits is the width of the integer, 32 or 64.
+ * \param issigned should be true for the signed (zigzag) encoding.
+ * \return The string that represents the function signature, without a trailing semicolon
+ */
+std::string FieldCoding::varintEncodeSignature(int bits, bool issigned)
+{
+    std::string number = std::to_string(bits);
+
+    if(issigned)
+        return "void int" + number + "ToVarBytes(int" + number + "_t number, uint8_t* bytes, int* index)";
+    else
+        return "void uint" + number + "ToVarBytes(uint" + number + "_t number, uint8_t* bytes, int* index)";
+
+}// FieldCoding::varintEncodeSignature
+
+
+/*!
+ * Generate the full variable length encode function output, excluding the comment
+ * \param bits is the width of the integer, 32 or 64.
+ * \param issigned should be true for the signed (zigzag) encoding.
+ * \return the function as a string
+ */
+std::string FieldCoding::varintEncodeFunction(int bits, bool issigned)
+{
+    std::string number = std::to_string(bits);
+    std::string function = varintEncodeSignature(bits, issigned) + "\n";
+    function += "{\n";
+
+    if(issigned)
+    {
+        function += "    // Move the sign to the least significant bit\n";
+        function += "    if(number < 0)\n";
+        function += "        uint" + number + "ToVarBytes(~((uint" + number + "_t)number << 1), bytes, index);\n";
+        function += "    else\n";
+        function += "        uint" + number + "ToVarBytes((uint" + number + "_t)number << 1, bytes, index);\n";
+    }
+    else
+    {
+        function += "    // increment byte pointer for starting point\n";
+        function += "    bytes += (*index);\n";
+        function += "\n";
+        function += "    // Every byte except the last has its most significant bit set\n";
+        function += "    while(number > 0x7F)\n";
+        function += "    {\n";
+        function += "        *(bytes++) = (uint8_t)(number | 0x80);\n";
+        function += "        number = number >> 7;\n";
+        function += "        (*index)++;\n";
+        function += "    }\n";
+        function += "\n";
+        function += "    *bytes = (uint8_t)(number);\n";
+        function += "    (*index)++;\n";
+    }
+
+    function += "}\n";
+
+    return function;
+
+}// FieldCoding::varintEncodeFunction
+
+
 /*!
  * Generate the header file for protocols caling
  * \return true if the file is generated.
@@ -661,7 +924,13 @@ void stringFromBytes(char* string, const uint8_t* bytes, int* index, int maxLeng
 void bytesFromBeBytes(uint8_t* data, const uint8_t* bytes, int* index, int num);
 
 //! Copy an array of bytes from a byte stream while reversing the order.
-void bytesFromLeBytes(uint8_t* data, const uint8_t* bytes, int* index, int num);)");
+void bytesFromLeBytes(uint8_t* data, const uint8_t* bytes, int* index, int num);
+
+//! Decode a null terminated string from a byte stream which may give the index of a dictionary entry
+int stringFromDictionaryBytes(char* string, const char* const* dictionary, int entries, const uint8_t* bytes, int* index, int maxLength, int fixedLength);
+
+//! Decode an array of bytes from a byte stream with run length compression
+int bytesFromRleBytes(uint8_t* data, const uint8_t* bytes, int* index, int num);)");
 
 
     if(support.int64)
@@ -698,6 +967,39 @@ void bytesFromLeBytes(uint8_t* data, const uint8_t* bytes, int* index, int num);
 
     }// for all input types
 
+    // Variable length integers have no endian, their bytes are always least significant first
+    for(int bits = 32; (bits == 32) || ((bits == 64) && support.int64); bits += 32)
+    {
+        if(bits > 32)
+        {
+            header.makeLineSeparator();
+            header.write("#ifdef UINT64_MAX\n");
+        }
+
+        header.makeLineSeparator();
+        header.write("//! " + briefVarintDecodeComment(bits, false) + "\n");
+        header.write(varintDecodeSignature(bits, false) + ";\n");
+
+        header.makeLineSeparator();
+        header.write("//! " + briefVarintDecodeComment(bits, true) + "\n");
+        header.write(varintDecodeSignature(bits, true) + ";\n");
+
+        if(bits > 32)
+            header.write("\n#endif // UINT64_MAX\n");
+    }
+
+    // Narrow in-memory integers decode the 32 bit number and limit it
+    for(int bits = 8; bits < 32; bits *= 2)
+    {
+        header.makeLineSeparator();
+        header.write("//! " + briefVarintDecodeComment(bits, false) + "\n");
+        header.write(varintDecodeSignature(bits, false) + ";\n");
+
+        header.makeLineSeparator();
+        header.write("//! " + briefVarintDecodeComment(bits, true) + "\n");
+        header.write(varintDecodeSignature(bits, true) + ";\n");
+    }
+
     header.makeLineSeparator();
 
     return header.flush();
@@ -721,7 +1023,7 @@ bool FieldCoding::generateDecodeSource(void)
 // Raw string magic
 source.write(R"(/*!
  * Decode a null terminated string from a byte stream
- * \param string receives the deocded null-terminated string.
+ * \param string receives the decoded null-terminated string.
  * \param bytes is a pointer to the byte stream to be decoded.
  * \param index gives the location of the first byte in the byte stream, and
  *        will be incremented by the number of bytes decoded when this function
@@ -809,7 +1111,109 @@ void bytesFromLeBytes(uint8_t* data, const uint8_t* bytes, int* index, int num)
         num--;
     }
 
-}// bytesFromLeBytes)");
+}// bytesFromLeBytes
+
+
+/*!
+ * Decode a null terminated string from a byte stream that was encoded with
+ * stringToDictionaryBytes(). The first byte is the index of the dictionary
+ * entry, or 255 if the string itself follows.
+ * \param string receives the decoded null-terminated string.
+ * \param dictionary is the list of likely values of the string.
+ * \param entries is the number of entries in the dictionary.
+ * \param bytes is a pointer to the byte stream to be decoded.
+ * \param index gives the location of the first byte in the byte stream, and
+ *        will be incremented by the number of bytes decoded when this function
+ *        is complete.
+ * \param maxLength is the maximum number of bytes that can be decoded.
+ *        maxLength includes the null terminator, which is always applied.
+ * \param fixedLength should be 1 if a string which is not in the dictionary
+ *        was encoded with exactly maxLength bytes.
+ * \return 1 if the string was decoded, 0 if the index is not in the dictionary.
+ */
+int stringFromDictionaryBytes(char* string, const char* const* dictionary, int entries, const uint8_t* bytes, int* index, int maxLength, int fixedLength)
+{
+    int i;
+    int entry = bytes[(*index)++];
+
+    if(entry == 255)
+    {
+        stringFromBytes(string, bytes, index, maxLength, fixedLength);
+        return 1;
+    }
+
+    // Make sure we always include the null terminator
+    string[0] = 0;
+
+    if(entry >= entries)
+        return 0;
+
+    for(i = 0; i < maxLength - 1; i++)
+    {
+        if(dictionary[entry][i] == 0)
+            break;
+        else
+            string[i] = dictionary[entry][i];
+    }
+
+    string[i] = 0;
+
+    return 1;
+
+}// stringFromDictionaryBytes
+
+
+/*!
+ * Decode an array of bytes from a byte stream that was encoded with
+ * bytesToRleBytes(). At most 2 times num bytes are read from the byte stream.
+ * \param data receives the decoded bytes
+ * \param bytes is a pointer to the byte stream to be decoded.
+ * \param index gives the location of the first byte in the byte stream, and
+ *        will be incremented by the number of bytes decoded when this function
+ *        is complete.
+ * \param num is the number of bytes to decode
+ * \return 1 if the bytes were decoded, 0 if the byte stream describes more
+ *         than num bytes.
+ */
+int bytesFromRleBytes(uint8_t* data, const uint8_t* bytes, int* index, int num)
+{
+    int count;
+    int control;
+
+    while(num > 0)
+    {
+        control = bytes[(*index)++];
+
+        if(control < 128)
+        {
+            // Copied bytes
+            count = control + 1;
+            if(count > num)
+                return 0;
+
+            bytesFromBeBytes(data, bytes, index, count);
+        }
+        else
+        {
+            // Repeated byte
+            count = control - 125;
+            if(count > num)
+                return 0;
+
+            for(control = 0; control < count; control++)
+                data[control] = bytes[*index];
+
+            (*index)++;
+        }
+
+        data += count;
+        num -= count;
+
+    }// while bytes to decode
+
+    return 1;
+
+}// bytesFromRleBytes)");
 
     if(support.int64)
     {
@@ -840,6 +1244,37 @@ void bytesFromLeBytes(uint8_t* data, const uint8_t* bytes, int* index, int num)
 
     }// for all input types
 
+    for(int bits = 32; (bits == 32) || ((bits == 64) && support.int64); bits += 32)
+    {
+        if(bits > 32)
+        {
+            source.makeLineSeparator();
+            source.write("#ifdef UINT64_MAX\n");
+        }
+
+        source.makeLineSeparator();
+        source.write(fullVarintDecodeComment(bits, false) + "\n");
+        source.write(varintDecodeFunction(bits, false) + "\n");
+
+        source.makeLineSeparator();
+        source.write(fullVarintDecodeComment(bits, true) + "\n");
+        source.write(varintDecodeFunction(bits, true) + "\n");
+
+        if(bits > 32)
+            source.write("#endif // UINT64_MAX\n");
+    }
+
+    for(int bits = 8; bits < 32; bits *= 2)
+    {
+        source.makeLineSeparator();
+        source.write(fullVarintDecodeComment(bits, false) + "\n");
+        source.write(varintDecodeFunction(bits, false) + "\n");
+
+        source.makeLineSeparator();
+        source.write(fullVarintDecodeComment(bits, true) + "\n");
+        source.write(varintDecodeFunction(bits, true) + "\n");
+    }
+
     source.makeLineSeparator();
 
     return source.flush();
@@ -1118,3 +1553,167 @@ std::string FieldCoding::integerDecodeFunction(int type, bool bigendian)
 
 }// FieldCoding::integerDecodeFunction
 
+
+/*!
+ * Create the brief variable length decode function comment, without doxygen decorations
+ * \param bits is the width of the integer, 8, 16, 32 or 64.
+ * \param issigned should be true for the signed (zigzag) encoding.
+ * \return The string that represents the one line function comment.
+ */
+std::string FieldCoding::briefVarintDecodeComment(int bits, bool issigned)
+{
+    if(issigned)
+        return "Decode a signed " + std::to_string(bits/8) + " byte integer from a zigzag variable length integer on a byte stream.";
+    else
+        return "Decode an unsigned " + std::to_string(bits/8) + " byte integer from a variable length integer on a byte stream.";
+
+}// FieldCoding::briefVarintDecodeComment
+
+
+/*!
+ * Create the full variable length decode function comment, with doxygen decorations
+ * \param bits is the width of the integer, 8, 16, 32 or 64.
+ * \param issigned should be true for the signed (zigzag) encoding.
+ * \return The string that represents the full multi-line function comment.
+ */
+std::string FieldCoding::fullVarintDecodeComment(int bits, bool issigned)
+{
+    std::string comment = "/*!\n";
+
+    comment += ProtocolParser::outputLongComment(" * ", briefVarintDecodeComment(bits, issigned)) + "\n";
+
+    // Narrow integers are encoded with 32 bits
+    if(bits < 32)
+    {
+        comment += " * The 32 bit number on the byte stream is limited to the range of the result.\n";
+        bits = 32;
+    }
+
+    comment += " * \\param bytes is a pointer to the byte stream which contains the encoded data.\n";
+    comment += " * \\param index gives the location of the first byte in the byte stream, and\n";
+    comment += " *        will be incremented by the number of bytes used, from 1 to " + std::to_string((bits + 6)/7) + ".\n";
+    comment += " * \\return the number decoded from the byte stream\n";
+    comment += " */";
+
+    return comment;
+
+}// FieldCoding::fullVarintDecodeComment
+
+
+/*!
+ * Create the one line variable length decode function signature, without a trailing semicolon
+ * \param bits is the width of the integer, 8, 16, 32 or 64.
+ * \param issigned should be true for the signed (zigzag) encoding.
+ * \return The string that represents the function signature, without a trailing semicolon
+ */
+std::string FieldCoding::varintDecodeSignature(int bits, bool issigned)
+{
+    std::string number = std::to_string(bits);
+
+    if(issigned)
+        return "int" + number + "_t int" + number + "FromVarBytes(const uint8_t* bytes, int* index)";
+    else
+        return "uint" + number + "_t uint" + number + "FromVarBytes(const uint8_t* bytes, int* index)";
+
+}// FieldCoding::varintDecodeSignature
+
+
+/*!
+ * Generate the full variable length decode function output, excluding the
+ * comment. The unsigned decode handles one and two byte numbers, which are the
+ * common case, without a loop. No more than the maximum number of bytes for
+ * the width are ever read. The 8 and 16 bit decodes read a 32 bit number and
+ * limit it to their range.
+ * \param bits is the width of the integer, 8, 16, 32 or 64.
+ * \param issigned should be true for the signed (zigzag) encoding.
+ * \return the function as a string
+ */
+std::string FieldCoding::varintDecodeFunction(int bits, bool issigned)
+{
+    std::string type = "uint" + std::to_string(bits) + "_t";
+    int maxbytes = (bits + 6)/7;
+
+    std::string function = varintDecodeSignature(bits, issigned) + "\n";
+    function += "{\n";
+
+    if(bits < 32)
+    {
+        // Narrow integers decode the 32 bit number and limit it, rather than truncate it
+        std::string max = std::to_string(issigned ? (1 << (bits - 1)) - 1 : (1 << bits) - 1);
+
+        if(issigned)
+        {
+            std::string min = std::to_string(-(1 << (bits - 1)));
+
+            function += "    int32_t number = int32FromVarBytes(bytes, index);\n";
+            function += "\n";
+            function += "    if(number > " + max + ")\n";
+            function += "        return " + max + ";\n";
+            function += "    else if(number < " + min + ")\n";
+            function += "        return " + min + ";\n";
+            function += "    else\n";
+            function += "        return (int" + std::to_string(bits) + "_t)number;\n";
+        }
+        else
+        {
+            function += "    uint32_t number = uint32FromVarBytes(bytes, index);\n";
+            function += "\n";
+            function += "    if(number > " + max + "u)\n";
+            function += "        return " + max + "u;\n";
+            function += "    else\n";
+            function += "        return (uint" + std::to_string(bits) + "_t)number;\n";
+        }
+    }
+    else if(issigned)
+    {
+        function += "    " + type + " number = uint" + std::to_string(bits) + "FromVarBytes(bytes, index);\n";
+        function += "\n";
+        function += "    // Move the sign back from the least significant bit\n";
+        function += "    return (int" + std::to_string(bits) + "_t)((number >> 1) ^ ((" + type + ")0 - (number & 1)));\n";
+    }
+    else
+    {
+        function += "    " + type + " number;\n";
+        function += "    int i;\n";
+        function += "\n";
+        function += "    // increment byte pointer for starting point\n";
+        function += "    bytes += *index;\n";
+        function += "\n";
+        function += "    // Most numbers are small, decode one and two bytes without looping\n";
+        function += "    if(bytes[0] < 0x80)\n";
+        function += "    {\n";
+        function += "        (*index) += 1;\n";
+        function += "        return bytes[0];\n";
+        function += "    }\n";
+        function += "\n";
+        function += "    number = bytes[0] & 0x7F;\n";
+        function += "\n";
+        function += "    if(bytes[1] < 0x80)\n";
+        function += "    {\n";
+        function += "        (*index) += 2;\n";
+        function += "        return number | ((" + type + ")bytes[1] << 7);\n";
+        function += "    }\n";
+        function += "\n";
+        function += "    number |= (" + type + ")(bytes[1] & 0x7F) << 7;\n";
+        function += "\n";
+        function += "    for(i = 2; i < " + std::to_string(maxbytes - 1) + "; i++)\n";
+        function += "    {\n";
+        function += "        number |= (" + type + ")(bytes[i] & 0x7F) << (7*i);\n";
+        function += "        if(bytes[i] < 0x80)\n";
+        function += "        {\n";
+        function += "            (*index) += i + 1;\n";
+        function += "            return number;\n";
+        function += "        }\n";
+        function += "    }\n";
+        function += "\n";
+        function += "    // The last byte is not checked for more bytes, any extra bits are discarded\n";
+        function += "    (*index) += " + std::to_string(maxbytes) + ";\n";
+        function += "    return number | ((" + type + ")bytes[" + std::to_string(maxbytes - 1) + "] << " + std::to_string(7*(maxbytes - 1)) + ");\n";
+    }
+
+    function += "}\n";
+
+    return function;
+
+}// FieldCoding::varintDecodeFunction
+
@@ -50,6 +50,18 @@ protected:
     //! Generate the integer encode function
     std::string integerEncodeFunction(int type, bool bigendian);
 
+    //! Generate the one line brief comment for the variable length encode function
+    std::string briefVarintEncodeComment(int bits, bool issigned);
+
+    //! Generate the full comment for the variable length encode function
+    std::string fullVarintEncodeComment(int bits, bool issigned);
+
+    //! Generate the variable length encode function signature
+    std::string varintEncodeSignature(int bits, bool issigned);
+
+    //! Generate the variable length encode function
+    std::string varintEncodeFunction(int bits, bool issigned);
+
     //! Generate the one line brief comment for the decode function
     std::string briefDecodeComment(int type, bool bigendian);
 
@@ -68,6 +80,18 @@ protected:
     //! Generate the integer decode function
     std::string integerDecodeFunction(int type, bool bigendian);
 
+    //! Generate the one line brief comment for the variable length decode function
+    std::string briefVarintDecodeComment(int bits, bool issigned);
+
+    //! Generate the full comment for the variable length decode function
+    std::string fullVarintDecodeComment(int bits, bool issigned);
+
+    //! Generate the variable length decode function signature
+    std::string varintDecodeSignature(int bits, bool issigned);
+
+    //! Generate the variable length decode function
+    std::string varintDecodeFunction(int bits, bool issigned);
+
     //! List of built in type names
     std::vector<std::string> typeNames;
 
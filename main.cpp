@@ -1,33 +1,125 @@
 #include <iostream>
 #include <fstream>
+#include <thread>
+#include <atomic>
+#include <map>
+#include <set>
+#include <cctype>
 #include "shuntingyard.h"
 #include "protocolparser.h"
+#include "protocolstats.h"
+#include "protocolwatcher.h"
 
 static void printHelp(void);
+static std::vector<std::string> groupArguments(const std::vector<std::string>& input);
+static std::vector<std::string> splitManifestLine(const std::string& line);
+static int generateAll(const std::vector<std::string>& arguments, std::vector<std::string>& inputfiles);
+static int generate(const std::vector<std::string>& arguments, std::vector<std::string>& inputfiles);
+static int generateManifest(const std::string& manifest, const std::vector<std::string>& arguments, std::vector<std::string>& inputfiles);
 
 int main(int argc, char *argv[])
 {
-    std::vector<std::string> arguments;
-
     // First argument is the application name - skip that one
-    for(int i = 1; i < argc; i++)
-    {
-        std::string argument = trimm(std::string(argv[i]));
+    std::vector<std::string> arguments = groupArguments(std::vector<std::string>(argv + 1, argv + argc));
 
-        // All leading "--" are converted to "-" here
-        while(startsWith(argument, "--"))
-            argument.erase(0, 1);
-
-        if(startsWith(argument, "-help") || startsWith(argument, "-?"))
+    for(std::size_t i = 0; i < arguments.size(); i++)
+    {
+        if(startsWith(arguments.at(i), "-help") || startsWith(arguments.at(i), "-?"))
         {
             printHelp();
             return 0;
         }
-        else if(startsWith(argument, "-v"))
+        else if(startsWith(arguments.at(i), "-v"))
         {
             std::cout << ProtocolParser::genVersion << std::endl;
             return 0;
         }
+    }
+
+    // Timing and counter instrumentation
+    bool statsjson = contains(arguments, "-stats-json");
+    ProtocolStats::enable(statsjson || contains(arguments, "-stats"));
+
+    ProtocolStats::Timer totaltimer("Total");
+
+    std::vector<std::string> inputfiles;
+    int result = generateAll(arguments, inputfiles);
+
+    totaltimer.stop();
+
+    if(ProtocolStats::isEnabled())
+        std::cout << ProtocolStats::report(statsjson);
+
+    // Stay resident, regenerating whenever an input file changes. Files
+    // whose contents do not change are not rewritten, so builds that depend
+    // on them are not triggered.
+    while(contains(arguments, "-watch") && !inputfiles.empty())
+    {
+        ProtocolWatcher watcher(inputfiles);
+
+        std::cout << "Watching " << watcher.getNumberOfFiles() << " input files for changes" << std::endl;
+
+        std::string changed = watcher.waitForChange();
+
+        std::cout << "Regenerating after change to " << changed << std::endl;
+
+        ProtocolParser::forgetHelperFiles();
+        inputfiles.clear();
+        result = generateAll(arguments, inputfiles);
+    }
+
+    return result;
+
+}// main
+
+
+/*!
+ * Generate the protocol given on the command line, or every protocol in the
+ * manifest given on the command line.
+ * \param arguments are the command line arguments.
+ * \param inputfiles receives the names of all the input files.
+ * \return 0 if generation succeeded, else the error code.
+ */
+int generateAll(const std::vector<std::string>& arguments, std::vector<std::string>& inputfiles)
+{
+    std::string manifest = liststartsWith(arguments, "-manifest");
+
+    if(manifest.empty())
+        return generate(arguments, inputfiles);
+    else if(manifest.find(" ") >= manifest.size())
+    {
+        std::cerr << "error: must provide a manifest file after -manifest." << std::endl;
+        return 2;
+    }
+    else
+    {
+        manifest = manifest.substr(manifest.find(" ") + 1);
+
+        // The manifest is an input too
+        inputfiles.push_back(manifest);
+        return generateManifest(manifest, arguments, inputfiles);
+    }
+
+}// generateAll
+
+
+/*!
+ * Clean up the arguments and group together the arguments that need a
+ * follower, such as "-license afile.txt".
+ * \param input is the list of arguments, not including the application name.
+ * \return the grouped arguments.
+ */
+std::vector<std::string> groupArguments(const std::vector<std::string>& input)
+{
+    std::vector<std::string> arguments;
+
+    for(std::size_t i = 0; i < input.size(); i++)
+    {
+        std::string argument = trimm(input.at(i));
+
+        // All leading "--" are converted to "-" here
+        while(startsWith(argument, "--"))
+            argument.erase(0, 1);
 
         if(argument.empty())
             continue;
@@ -37,25 +129,229 @@ int main(int argc, char *argv[])
         // on following arguments like "-no-helper-files". We group arguments
         // together that need to go together. All such special arguments
         // start with "-".
-        if((argument.front() == '-') && (i < argc - 1))
+        if((argument.front() == '-') && (i < input.size() - 1))
         {
             // These are the arguments that need followers
-            if( startsWith(argument, "-d")            ||
+            if( startsWith(argument, "-cache")        ||
+                startsWith(argument, "-d")            ||
+                startsWith(argument, "-jobs")         ||
                 startsWith(argument, "-li")           ||
                 startsWith(argument, "-latex-header") ||
+                startsWith(argument, "-manifest")     ||
                 isEqual(argument, "-s")               ||
                 startsWith(argument, "-style")        ||
                 startsWith(argument, "-ti")           ||
                 startsWith(argument, "-tr") )
-                arguments.push_back(argument + " " + trimm(argv[++i]));
+                arguments.push_back(argument + " " + trimm(input.at(++i)));
             else
                 arguments.push_back(argument);
         }
         else
             arguments.push_back(argument);
 
-    }// for all arguments except the first one
+    }// for all arguments
+
+    return arguments;
+
+}// groupArguments
+
+
+/*!
+ * Split a line of a manifest into arguments. Arguments are separated by white
+ * space, and double quotes can be used to include white space in an argument.
+ * \param line is the line to split.
+ * \return the arguments of the line.
+ */
+std::vector<std::string> splitManifestLine(const std::string& line)
+{
+    std::vector<std::string> arguments;
+    std::string argument;
+    bool quoted = false;
+    bool started = false;
+
+    for(char c : line)
+    {
+        if(c == '"')
+        {
+            quoted = !quoted;
+            started = true;
+        }
+        else if(!quoted && std::isspace((unsigned char)c))
+        {
+            if(started)
+                arguments.push_back(argument);
+
+            argument.clear();
+            started = false;
+        }
+        else
+        {
+            argument += c;
+            started = true;
+        }
+    }
+
+    if(started)
+        arguments.push_back(argument);
+
+    return arguments;
+
+}// splitManifestLine
+
+
+/*!
+ * Generate several protocols in one run. Each line of the manifest is one
+ * protocol, using the same arguments as the command line. The arguments given
+ * on the command line apply to every protocol, and any xml files given on the
+ * command line are other files of every protocol. Protocols are generated in
+ * parallel, and protocols which share an output path and options share one
+ * copy of the helper files.
+ * \param manifest is the name of the manifest file.
+ * \param arguments are the command line arguments.
+ * \param inputfiles receives the names of the input files of every protocol.
+ * \return 0 if every protocol was generated, else the largest error code.
+ */
+int generateManifest(const std::string& manifest, const std::vector<std::string>& arguments, std::vector<std::string>& inputfiles)
+{
+    std::fstream file(manifest, std::ios_base::in);
+
+    if(!file.is_open())
+    {
+        std::cerr << "error: failed to open manifest file " << manifest << std::endl;
+        return 2;
+    }
+
+    // Arguments which apply to every protocol
+    std::vector<std::string> common;
+
+    for(std::size_t i = 0; i < arguments.size(); i++)
+    {
+        if(startsWith(arguments.at(i), "-manifest") || startsWith(arguments.at(i), "-jobs"))
+            continue;
+
+        // The output path comes from each protocol
+        if(!startsWith(arguments.at(i), "-") && !endsWith(arguments.at(i), ".xml"))
+        {
+            std::cerr << "warning: output path " << arguments.at(i) << " ignored, each line of the manifest gives its own output path" << std::endl;
+            continue;
+        }
+
+        common.push_back(arguments.at(i));
+    }
+
+    // Each line that is not empty or a comment is a protocol
+    std::vector<std::vector<std::string>> jobs;
+    std::string line;
+
+    while(std::getline(file, line))
+    {
+        line = trimm(line);
+
+        if(line.empty() || (line.front() == '#'))
+            continue;
+
+        std::vector<std::string> job = groupArguments(splitManifestLine(line));
+
+        job.insert(job.end(), common.begin(), common.end());
+        jobs.push_back(job);
+    }
+
+    file.close();
+
+    if(jobs.empty())
+    {
+        std::cerr << "error: no protocols in manifest file " << manifest << std::endl;
+        return 2;
+    }
+
+    // The number of protocols generated at the same time
+    std::size_t numthreads = std::thread::hardware_concurrency();
+
+    std::string jobsargument = liststartsWith(arguments, "-jobs");
+    if(jobsargument.find(" ") < jobsargument.size())
+    {
+        bool ok = false;
+        int number = (int)ShuntingYard::toInt(jobsargument.substr(jobsargument.find(" ") + 1), &ok);
+
+        if(ok && (number > 0))
+            numthreads = (std::size_t)number;
+        else
+            std::cerr << "warning: -jobs argument '" << jobsargument.substr(jobsargument.find(" ") + 1) << "' is invalid." << std::endl;
+    }
+
+    if(numthreads < 1)
+        numthreads = 1;
+
+    if(numthreads > jobs.size())
+        numthreads = jobs.size();
+
+    // Xml files used by more than one protocol, such as the support files
+    // given on the command line, are loaded once and shared
+    std::map<std::string, int> xmlusers;
+    std::vector<std::string> sharedfiles;
+
+    for(const std::vector<std::string>& job : jobs)
+    {
+        std::set<std::string> jobfiles;
+
+        for(const std::string& argument : job)
+        {
+            if(startsWith(argument, "-") || !endsWith(argument, ".xml"))
+                continue;
+
+            std::string absolutename = ProtocolParser::getAbsoluteFileName(argument);
+
+            // Count each protocol once, however often it names the file
+            if(jobfiles.insert(absolutename).second && (++xmlusers[absolutename] == 2))
+                sharedfiles.push_back(argument);
+        }
+    }
+
+    ProtocolParser::shareFiles(sharedfiles);
+
+    std::vector<int> results(jobs.size(), 0);
+    std::vector<std::vector<std::string>> jobinputfiles(jobs.size());
+    std::atomic<std::size_t> next(0);
+    std::vector<std::thread> threads;
+
+    // Each thread takes the next protocol until they are all done
+    for(std::size_t t = 0; t < numthreads; t++)
+    {
+        threads.emplace_back([&]()
+        {
+            for(std::size_t i = next++; i < jobs.size(); i = next++)
+                results[i] = generate(jobs.at(i), jobinputfiles[i]);
+        });
+    }
+
+    for(std::thread& thread : threads)
+        thread.join();
+
+    ProtocolParser::forgetSharedFiles();
+
+    int result = 0;
+    for(std::size_t i = 0; i < results.size(); i++)
+    {
+        if(results.at(i) > result)
+            result = results.at(i);
+
+        inputfiles.insert(inputfiles.end(), jobinputfiles.at(i).begin(), jobinputfiles.at(i).end());
+    }
+
+    return result;
+
+}// generateManifest
+
 
+/*!
+ * Generate one protocol.
+ * \param arguments are the grouped arguments of the protocol.
+ * \param inputfiles receives the names of the input files of the protocol.
+ * \return 0 if the protocol was generated, 1 if there was a problem with the
+ *         input file, or 2 if no input file was given.
+ */
+int generate(const std::vector<std::string>& arguments, std::vector<std::string>& inputfiles)
+{
     ProtocolParser parser;
 
     // Process the positional arguments
@@ -115,9 +411,23 @@ int main(int argc, char *argv[])
     if(!docs.empty())
         parser.setDocsPath(ProtocolFile::sanitizePath(docs));
 
+    // Regeneration cache directory
+    std::string cache = liststartsWith(arguments, "-cache");
+    if(!cache.empty())
+    {
+        cache = ProtocolFile::sanitizePath(cache.substr(cache.find(" ") + 1));
+
+        // An empty path after sanitizing is the current working directory
+        if(cache.empty())
+            cache = "./";
+
+        parser.setCacheDirectory(cache);
+    }
+
     // Process the optional arguments
     parser.disableDoxygen(!contains(arguments, "-yes-doxygen"));
     parser.disableMarkdown(contains(arguments, "-no-markdown"));
+    parser.enableRateReport(contains(arguments, "-rate-report"));
     parser.disableCode(contains(arguments, "-no-code"));
     parser.disableHelperFiles(contains(arguments, "-no-helper-files"));
     parser.disableAboutSection(contains(arguments, "-no-about-section"));
@@ -211,7 +521,23 @@ int main(int argc, char *argv[])
 
     parser.setDBCOptions(dbcfile, dbcidtx, dbcidrx, dbctypeshift, dbcbaud);
 
-    if (parser.parse(filename, path, otherfiles))
+    bool success = parser.parse(filename, path, otherfiles);
+
+    // Everything that was read, including files that failed to parse
+    inputfiles.push_back(filename);
+    inputfiles.insert(inputfiles.end(), otherfiles.begin(), otherfiles.end());
+    inputfiles.insert(inputfiles.end(), parser.getFilesParsed().begin(), parser.getFilesParsed().end());
+
+    if(!licenseTemplate.empty())
+        inputfiles.push_back(licenseTemplate);
+
+    if(!css.empty())
+        inputfiles.push_back(css);
+
+    if(!titlePage.empty())
+        inputfiles.push_back(titlePage);
+
+    if(success)
     {
         // Normal exit
         return 0;
@@ -222,7 +548,7 @@ int main(int argc, char *argv[])
         return 1;
     }
 
-}// main
+}// generate
 
 
 void printHelp(void)
@@ -244,6 +570,8 @@ Usage: ProtoGen inputfile.xml <outputpath> <otherinputfiles.xml> -options
 
   -no-markdown       : Skip generation of user-level documentation.
 
+  -rate-report       : Generate a report of the encoded size and bandwidth of
+                       each packet, as markdown, CSV, and JSON.
   -no-about-section  : Skip generation of "About this ICD" section in
                        documentation output.
   -show-hidden       : Output documentation for all items, even if hidden.
@@ -268,6 +596,26 @@ Usage: ProtoGen inputfile.xml <outputpath> <otherinputfiles.xml> -options
                        language specifier in the protocol file.
   -translate <macro> : Set macro as the name of the global translation macro
                        for string lookups in emitted code.
+  -cache <path>      : Directory of a cache of module fingerprints, used to
+                       skip generation of modules that have not changed.
+  -stats             : Print the time spent in each phase of generation, and
+                       counters of modules, fields, files, and lookups.
+  -stats-json        : Like -stats, but the statistics are printed as JSON.
+
+  -manifest <file>   : Generate several protocols in one run. Each line of the
+                       file gives the arguments of one protocol, in the same
+                       form as the command line. Arguments on the command line
+                       apply to every protocol, and xml files on the command
+                       line are other input files of every protocol. Protocols
+                       with the same output path and options share one copy of
+                       the helper files. Each protocol that uses -cache needs
+                       its own cache directory.
+  -jobs <n>          : Number of protocols of a manifest generated at the same
+                       time (default is the number of processors).
+  -watch             : Stay resident after generating, and generate again
+                       whenever an input file changes. Use with -cache to only
+                       generate the modules that changed.
+
   -version           : Prints just the version information.
 
 )===";
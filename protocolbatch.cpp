@@ -0,0 +1,409 @@
+#include "protocolbatch.h"
+#include "protocolpacket.h"
+
+ProtocolBatch::ProtocolBatch(ProtocolSupport protocolsupport) :
+    header(protocolsupport),
+    source(protocolsupport),
+    support(protocolsupport),
+    prefix(toUpper(protocolsupport.protoName)),
+    handler(protocolsupport.protoName + "BatchHandler" + protocolsupport.typeSuffix),
+    decoders(protocolsupport.protoName + "BatchDecoders" + protocolsupport.typeSuffix)
+{}
+
+
+/*!
+ * Perform the generation, writing out the files
+ * \param fileNameList receives the names of the files that were written.
+ * \param filePathList receives the paths of the files that were written.
+ * \param idInclude is the module which defines the batch identifier, which
+ *        can be empty.
+ * \param packets are all the packets, in the order of the protocol.
+ * \return true if the files were written.
+ */
+bool ProtocolBatch::generate(std::vector<std::string>& fileNameList, std::vector<std::string>& filePathList, const std::string& idInclude, const std::vector<ProtocolPacket*>& packets)
+{
+    if(support.batchID.empty())
+        return false;
+
+    collectDecoders(packets);
+
+    if(generateHeader())
+    {
+        fileNameList.push_back(header.fileName());
+        filePathList.push_back(header.filePath());
+
+        if(generateSource(idInclude))
+        {
+            fileNameList.push_back(source.fileName());
+            filePathList.push_back(source.filePath());
+
+            return true;
+        }
+    }
+
+    return false;
+
+}// ProtocolBatch::generate
+
+
+/*!
+ * Collect the handlers and switch cases which decode the packets of a batch.
+ * The decode functions take a packet, so the data of each packet are copied
+ * into a packet declared on the stack, which requires that pointerType points
+ * to a type which can be declared. If it does not there are no decoders.
+ * \param packets are all the packets, in the order of the protocol.
+ */
+void ProtocolBatch::collectDecoders(const std::vector<ProtocolPacket*>& packets)
+{
+    std::vector<std::string> values;
+
+    packettype = trimm(support.pointerType);
+    if(packettype.empty() || (packettype.back() != '*'))
+        packettype.clear();
+    else
+        packettype = trimm(packettype.substr(0, packettype.size() - 1));
+
+    if(packettype == "void")
+        packettype.clear();
+
+    if(packettype.empty())
+        return;
+
+    for(const ProtocolPacket* packet : packets)
+    {
+        std::string packethandler, packetcases;
+
+        if(!packet->getBatchDecoder(values, packethandler, packetcases))
+            continue;
+
+        handlers += packethandler;
+        cases += "\n" + packetcases;
+        includes.push_back(packet->getHeaderFileName());
+        packet->getIdIncludeDirectives(includes);
+    }
+
+}// ProtocolBatch::collectDecoders
+
+
+/*!
+ * Generate the header file, which declares the batch functions
+ * \return true if the file was written.
+ */
+bool ProtocolBatch::generateHeader(void)
+{
+    header.setModuleNameAndPath(support.protoName + "Batch", support.outputpath);
+
+// Raw string magic here
+header.setFileComment(R"(\brief Batches of )" + support.protoName + R"( packets in one frame
+
+A batch is a packet with the identifier )" + support.batchID + R"( whose data are
+other packets, so many small packets share the framing of one. Each packet in
+the batch has a sub header of its identifier followed by its number of data
+bytes, both encoded as variable length integers, and then its data.
+
+To create a batch start with a byte index of zero, call
+add)" + support.protoName + R"(BatchPacket() for each encoded packet, and then
+finish)" + support.protoName + R"(Batch(). To read a batch call
+dispatch)" + support.protoName + R"(Batch(), or call next)" + support.protoName + R"(BatchPacket()
+until it returns 0. The packets are not copied out of the batch, the data
+given for each packet point into the data of the batch.)" + (cases.empty() ? std::string() : R"(
+
+To decode the packets call decode)" + support.protoName + R"(Batch() with a )" + decoders + R"(
+whose handlers receive the decoded packets. This switches on the packet
+identifier and calls the packet structure decode function, which takes a
+packet, so the data of each packet are copied into a packet on the stack.)"));
+
+    header.makeLineSeparator();
+    header.writeIncludeDirective(support.protoName + "Protocol");
+    header.writeIncludeDirective("stdint.h", std::string(), true);
+
+    if(!cases.empty())
+        header.writeIncludeDirectives(includes);
+
+    header.makeLineSeparator();
+
+    header.write("//! Maximum number of bytes of the sub header of one packet in a batch\n");
+    header.write("#define " + prefix + "_BATCH_MAX_OVERHEAD 10\n");
+    header.write("\n");
+    header.write("//! Function which receives each packet of a batch, data points into the batch\n");
+    header.write("typedef void (*" + handler + ")(uint32_t id, const uint8_t* data, int size, void* context);\n");
+    header.write("\n");
+    header.write("//! Add an encoded packet to a batch\n");
+    header.write("int add" + support.protoName + "BatchPacket(" + support.pointerType + " frame, int* byteindex, int maxbytes, const " + support.pointerType + " pkt);\n");
+    header.write("\n");
+    header.write("//! Complete a batch, after all of its packets have been added\n");
+    header.write("void finish" + support.protoName + "Batch(" + support.pointerType + " frame, int byteindex);\n");
+    header.write("\n");
+    header.write("//! Get the next packet of a batch, without copying it\n");
+    header.write("int next" + support.protoName + "BatchPacket(const " + support.pointerType + " frame, int* byteindex, uint32_t* id, const uint8_t** data, int* size);\n");
+    header.write("\n");
+    header.write("//! Give each packet of a batch to a handler function\n");
+    header.write("int dispatch" + support.protoName + "Batch(const " + support.pointerType + " frame, " + handler + " handler, void* context);\n");
+
+    if(!cases.empty())
+    {
+        header.write("\n");
+        header.write("//! Functions which receive the decoded packets of a batch\n");
+        header.write("typedef struct\n");
+        header.write("{\n");
+        header.write(handlers);
+        header.write("    //! Receives the packets which have no handler or which fail to decode, can be NULL\n");
+        header.write("    " + handler + " handleOther;\n");
+        header.write("}" + decoders + ";\n");
+        header.write("\n");
+        header.write("//! Decode each packet of a batch and give it to its handler\n");
+        header.write("int decode" + support.protoName + "Batch(const " + support.pointerType + " frame, const " + decoders + "* decoders, void* context);\n");
+    }
+
+    header.makeLineSeparator();
+
+    return header.flush();
+
+}// ProtocolBatch::generateHeader
+
+
+/*!
+ * Generate the source file, which defines the batch functions
+ * \param idInclude is the module which defines the batch identifier, which
+ *        can be empty.
+ * \return true if the file was written.
+ */
+bool ProtocolBatch::generateSource(const std::string& idInclude)
+{
+    source.setModuleNameAndPath(support.protoName + "Batch", support.outputpath);
+
+    if(!idInclude.empty())
+        source.writeIncludeDirective(idInclude);
+
+    source.writeIncludeDirective("string.h", std::string(), true);
+    source.makeLineSeparator();
+
+    source.write("//! Number of bytes needed to encode a number as a variable length integer\n");
+    source.write("static int batchVarLength(uint32_t number)\n");
+    source.write("{\n");
+    source.write("    int length = 1;\n");
+    source.write("\n");
+    source.write("    while(number >= 0x80)\n");
+    source.write("    {\n");
+    source.write("        number >>= 7;\n");
+    source.write("        length++;\n");
+    source.write("    }\n");
+    source.write("\n");
+    source.write("    return length;\n");
+    source.write("}\n");
+    source.write("\n");
+    source.write("//! Encode a number as a variable length integer, least significant group first\n");
+    source.write("static void batchToVarBytes(uint32_t number, uint8_t* bytes, int* index)\n");
+    source.write("{\n");
+    source.write("    while(number >= 0x80)\n");
+    source.write("    {\n");
+    source.write("        bytes[(*index)++] = (uint8_t)(number | 0x80);\n");
+    source.write("        number >>= 7;\n");
+    source.write("    }\n");
+    source.write("\n");
+    source.write("    bytes[(*index)++] = (uint8_t)number;\n");
+    source.write("}\n");
+    source.write("\n");
+    source.write("//! Decode a variable length integer, without reading beyond size bytes, returning 0 if it does not end\n");
+    source.write("static int batchFromVarBytes(const uint8_t* bytes, int* index, int size, uint32_t* number)\n");
+    source.write("{\n");
+    source.write("    int shift;\n");
+    source.write("\n");
+    source.write("    *number = 0;\n");
+    source.write("\n");
+    source.write("    for(shift = 0; (shift < 35) && (*index < size); shift += 7)\n");
+    source.write("    {\n");
+    source.write("        uint8_t byte = bytes[(*index)++];\n");
+    source.write("\n");
+    source.write("        *number |= ((uint32_t)(byte & 0x7F)) << shift;\n");
+    source.write("\n");
+    source.write("        if((byte & 0x80) == 0)\n");
+    source.write("            return 1;\n");
+    source.write("    }\n");
+    source.write("\n");
+    source.write("    return 0;\n");
+    source.write("}\n");
+
+    source.makeLineSeparator();
+    source.write("/*!\n");
+    source.write(" * Add an encoded packet to a batch. The packet data are copied into the\n");
+    source.write(" * batch after a sub header with the packet identifier and size.\n");
+    source.write(" * \\param frame is the batch packet.\n");
+    source.write(" * \\param byteindex is the index of the next byte in the data of frame, which\n");
+    source.write(" *        should be zero for the first packet. It is updated by this function.\n");
+    source.write(" * \\param maxbytes is the maximum number of data bytes frame can hold.\n");
+    source.write(" * \\param pkt is the encoded packet to add.\n");
+    source.write(" * \\return 1 if the packet was added, 0 if it would not fit in maxbytes.\n");
+    source.write(" */\n");
+    source.write("int add" + support.protoName + "BatchPacket(" + support.pointerType + " frame, int* byteindex, int maxbytes, const " + support.pointerType + " pkt)\n");
+    source.write("{\n");
+    source.write("    uint32_t id = get" + support.protoName + "PacketID(pkt);\n");
+    source.write("    int size = get" + support.protoName + "PacketSize(pkt);\n");
+    source.write("    uint8_t* data = get" + support.protoName + "PacketData(frame);\n");
+    source.write("\n");
+    source.write("    if((size < 0) || (*byteindex + batchVarLength(id) + batchVarLength((uint32_t)size) + size > maxbytes))\n");
+    source.write("        return 0;\n");
+    source.write("\n");
+    source.write("    batchToVarBytes(id, data, byteindex);\n");
+    source.write("    batchToVarBytes((uint32_t)size, data, byteindex);\n");
+    source.write("\n");
+    source.write("    if(size > 0)\n");
+    source.write("        memcpy(data + *byteindex, get" + support.protoName + "PacketDataConst(pkt), (size_t)size);\n");
+    source.write("\n");
+    source.write("    *byteindex += size;\n");
+    source.write("\n");
+    source.write("    return 1;\n");
+    source.write("\n");
+    source.write("}// add" + support.protoName + "BatchPacket\n");
+
+    source.makeLineSeparator();
+    source.write("/*!\n");
+    source.write(" * Complete a batch, after all of its packets have been added\n");
+    source.write(" * \\param frame is the batch packet.\n");
+    source.write(" * \\param byteindex is the number of data bytes in frame.\n");
+    source.write(" */\n");
+    source.write("void finish" + support.protoName + "Batch(" + support.pointerType + " frame, int byteindex)\n");
+    source.write("{\n");
+    source.write("    finish" + support.protoName + "Packet(frame, byteindex, " + support.batchID + ");\n");
+    source.write("\n");
+    source.write("}// finish" + support.protoName + "Batch\n");
+
+    source.makeLineSeparator();
+    source.write("/*!\n");
+    source.write(" * Get the next packet of a batch, without copying it\n");
+    source.write(" * \\param frame is the batch packet.\n");
+    source.write(" * \\param byteindex is the index of the next byte in the data of frame, which\n");
+    source.write(" *        should be zero for the first packet. It is updated by this function.\n");
+    source.write(" * \\param id receives the identifier of the packet.\n");
+    source.write(" * \\param data receives a pointer to the data of the packet, inside the data of frame.\n");
+    source.write(" * \\param size receives the number of data bytes of the packet.\n");
+    source.write(" * \\return 1 if a packet was found, 0 if there are no more packets or the\n");
+    source.write(" *         sub header or size goes beyond the end of the batch.\n");
+    source.write(" */\n");
+    source.write("int next" + support.protoName + "BatchPacket(const " + support.pointerType + " frame, int* byteindex, uint32_t* id, const uint8_t** data, int* size)\n");
+    source.write("{\n");
+    source.write("    const uint8_t* bytes = get" + support.protoName + "PacketDataConst(frame);\n");
+    source.write("    int numbytes = get" + support.protoName + "PacketSize(frame);\n");
+    source.write("    int index = *byteindex;\n");
+    source.write("    uint32_t length;\n");
+    source.write("\n");
+    source.write("    if(index >= numbytes)\n");
+    source.write("        return 0;\n");
+    source.write("\n");
+    source.write("    if(!batchFromVarBytes(bytes, &index, numbytes, id) || !batchFromVarBytes(bytes, &index, numbytes, &length))\n");
+    source.write("        return 0;\n");
+    source.write("\n");
+    source.write("    if(length > (uint32_t)(numbytes - index))\n");
+    source.write("        return 0;\n");
+    source.write("\n");
+    source.write("    *data = bytes + index;\n");
+    source.write("    *size = (int)length;\n");
+    source.write("    *byteindex = index + (int)length;\n");
+    source.write("\n");
+    source.write("    return 1;\n");
+    source.write("\n");
+    source.write("}// next" + support.protoName + "BatchPacket\n");
+
+    source.makeLineSeparator();
+    source.write("/*!\n");
+    source.write(" * Give each packet of a batch to a handler function, in the order they were added\n");
+    source.write(" * \\param frame is the batch packet.\n");
+    source.write(" * \\param handler is called with the identifier, data, and size of each packet.\n");
+    source.write(" * \\param context is passed to handler.\n");
+    source.write(" * \\return the number of packets, or -1 if frame is not a batch or does not\n");
+    source.write(" *         end on a packet boundary. In that case the packets before the\n");
+    source.write(" *         error have already been given to handler.\n");
+    source.write(" */\n");
+    source.write("int dispatch" + support.protoName + "Batch(const " + support.pointerType + " frame, " + handler + " handler, void* context)\n");
+    source.write("{\n");
+    source.write("    int byteindex = 0;\n");
+    source.write("    int count = 0;\n");
+    source.write("    uint32_t id;\n");
+    source.write("    const uint8_t* data;\n");
+    source.write("    int size;\n");
+    source.write("\n");
+    source.write("    if(get" + support.protoName + "PacketID(frame) != " + support.batchID + ")\n");
+    source.write("        return -1;\n");
+    source.write("\n");
+    source.write("    while(next" + support.protoName + "BatchPacket(frame, &byteindex, &id, &data, &size))\n");
+    source.write("    {\n");
+    source.write("        handler(id, data, size, context);\n");
+    source.write("        count++;\n");
+    source.write("    }\n");
+    source.write("\n");
+    source.write("    if(byteindex != get" + support.protoName + "PacketSize(frame))\n");
+    source.write("        return -1;\n");
+    source.write("\n");
+    source.write("    return count;\n");
+    source.write("\n");
+    source.write("}// dispatch" + support.protoName + "Batch\n");
+
+    if(!cases.empty())
+    {
+        source.makeLineSeparator();
+        source.write("//! The handlers and context of a batch which is being decoded\n");
+        source.write("typedef struct\n");
+        source.write("{\n");
+        source.write("    const " + decoders + "* decoders;\n");
+        source.write("    void* context;\n");
+        source.write("}batchDecodeState;\n");
+
+        source.makeLineSeparator();
+        source.write("/*!\n");
+        source.write(" * Decode one packet of a batch and give it to its handler. Packets with no\n");
+        source.write(" * handler, or which fail to decode, are given to the handleOther handler.\n");
+        source.write(" * \\param id is the identifier of the packet.\n");
+        source.write(" * \\param data points to the data of the packet, inside the batch.\n");
+        source.write(" * \\param size is the number of data bytes of the packet.\n");
+        source.write(" * \\param context is the batchDecodeState.\n");
+        source.write(" */\n");
+        source.write("static void batchDecodePacket(uint32_t id, const uint8_t* data, int size, void* context)\n");
+        source.write("{\n");
+        source.write("    const batchDecodeState* batch = (const batchDecodeState*)context;\n");
+        source.write("    " + packettype + " pkt;\n");
+        source.write("\n");
+        source.write("    // The decode functions take a packet, the batch is never larger than one\n");
+        source.write("    if(size > 0)\n");
+        source.write("        memcpy(get" + support.protoName + "PacketData(&pkt), data, (size_t)size);\n");
+        source.write("\n");
+        source.write("    finish" + support.protoName + "Packet(&pkt, size, id);\n");
+        source.write("\n");
+        source.write("    switch(id)\n");
+        source.write("    {\n");
+        source.write("    default:\n");
+        source.write("        break;\n");
+        source.write(cases);
+        source.write("    }\n");
+        source.write("\n");
+        source.write("    if(batch->decoders->handleOther != NULL)\n");
+        source.write("        batch->decoders->handleOther(id, data, size, batch->context);\n");
+        source.write("\n");
+        source.write("}// batchDecodePacket\n");
+
+        source.makeLineSeparator();
+        source.write("/*!\n");
+        source.write(" * Decode each packet of a batch and give it to its handler, in the order\n");
+        source.write(" * they were added. Each packet is copied into a packet on the stack and\n");
+        source.write(" * decoded by its packet structure decode function.\n");
+        source.write(" * \\param frame is the batch packet.\n");
+        source.write(" * \\param decoders are the handlers of the decoded packets, any of which can be NULL.\n");
+        source.write(" * \\param context is passed to the handlers.\n");
+        source.write(" * \\return the number of packets, or -1 if frame is not a batch or does not\n");
+        source.write(" *         end on a packet boundary. In that case the packets before the\n");
+        source.write(" *         error have already been given to their handlers.\n");
+        source.write(" */\n");
+        source.write("int decode" + support.protoName + "Batch(const " + support.pointerType + " frame, const " + decoders + "* decoders, void* context)\n");
+        source.write("{\n");
+        source.write("    batchDecodeState batch;\n");
+        source.write("\n");
+        source.write("    batch.decoders = decoders;\n");
+        source.write("    batch.context = context;\n");
+        source.write("\n");
+        source.write("    return dispatch" + support.protoName + "Batch(frame, batchDecodePacket, &batch);\n");
+        source.write("\n");
+        source.write("}// decode" + support.protoName + "Batch\n");
+    }
+
+    return source.flush();
+
+}// ProtocolBatch::generateSource
@@ -0,0 +1,48 @@
+#ifndef PROTOCOLBATCH_H
+#define PROTOCOLBATCH_H
+
+/*!
+ * \file
+ * Auto magically generate the functions that pack many packets into one frame
+ */
+
+
+#include "protocolfile.h"
+#include "protocolsupport.h"
+#include <string>
+#include <vector>
+
+class ProtocolPacket;
+
+class ProtocolBatch
+{
+public:
+    ProtocolBatch(ProtocolSupport protocolsupport);
+
+    //! Perform the generation, writing out the files
+    bool generate(std::vector<std::string>& fileNameList, std::vector<std::string>& filePathList, const std::string& idInclude, const std::vector<ProtocolPacket*>& packets);
+
+protected:
+
+    //! Collect the handlers and cases which decode the packets of a batch
+    void collectDecoders(const std::vector<ProtocolPacket*>& packets);
+
+    //! Generate the header file
+    bool generateHeader(void);
+
+    //! Generate the source file
+    bool generateSource(const std::string& idInclude);
+
+    ProtocolHeaderFile header;
+    ProtocolSourceFile source;
+    ProtocolSupport support;
+    std::string prefix;     //!< Prefix of the macros, which is the upper case protocol name
+    std::string handler;    //!< Type name of the function that receives each packet of a batch
+    std::string decoders;   //!< Type name of the structure of handlers of the decoded packets
+    std::string packettype; //!< Type of the packet that pointerType points to, empty if it cannot be declared
+    std::string handlers;   //!< Declarations of the handlers of the decoded packets
+    std::string cases;      //!< Switch cases which decode the packets of a batch
+    std::vector<std::string> includes; //!< Headers which declare the packet structures and decode functions
+};
+
+#endif // PROTOCOLBATCH_H
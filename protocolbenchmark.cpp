@@ -0,0 +1,347 @@
+#include "protocolbenchmark.h"
+#include "protocolstructuremodule.h"
+
+//! Indentation of the generated code
+static const std::string& TAB_IN = ProtocolDocumentation::TAB_IN;
+
+ProtocolBenchmark::ProtocolBenchmark(ProtocolSupport protocolsupport) :
+    header(protocolsupport),
+    source(protocolsupport),
+    support(protocolsupport)
+{}
+
+
+/*!
+ * Perform the generation, writing out the files
+ * \param fileNameList receives the names of the files that were written.
+ * \param filePathList receives the paths of the files that were written.
+ * \param modules are all the structures and packets, which have been parsed.
+ * \return true if the files were written.
+ */
+bool ProtocolBenchmark::generate(std::vector<std::string>& fileNameList, std::vector<std::string>& filePathList, const std::vector<ProtocolStructureModule*>& modules)
+{
+    if(support.benchmark && generateHeader())
+    {
+        fileNameList.push_back(header.fileName());
+        filePathList.push_back(header.filePath());
+
+        if(generateSource(modules))
+        {
+            fileNameList.push_back(source.fileName());
+            filePathList.push_back(source.filePath());
+
+            return true;
+        }
+    }
+
+    return false;
+
+}// ProtocolBenchmark::generate
+
+
+//! Generate the header file
+bool ProtocolBenchmark::generateHeader(void)
+{
+    header.setModuleNameAndPath(support.protoName + "Benchmark", support.outputpath);
+
+// Raw string magic here
+header.setFileComment(R"(\brief Encode and decode benchmark of the )" + support.protoName + R"( protocol
+
+Every structure and packet that can be encoded and decoded is filled with
+random data, which is then encoded and decoded in tight loops. The time per
+encode and decode, the throughput, and the number of instructions per byte
+(where the Linux perf_event interface is available) are printed.
+
+Link this module with the generated code and the packet interface, and call
+)" + "run" + support.protoName + R"(Benchmark(), or compile it with
+PROTOGEN_BENCHMARK_MAIN defined to get a stand alone program. Each loop
+starts with the requested number of iterations, which is doubled until the
+loop runs for at least the requested number of seconds, so that short loops
+are not dominated by the resolution of the clock.)");
+
+    header.makeLineSeparator();
+    header.writeIncludeDirective("stdint.h", std::string(), true);
+    header.makeLineSeparator();
+    header.write("//! Benchmark the encode and decode of every structure and packet\n");
+    header.write("int run" + support.protoName + "Benchmark(int iterations, double seconds);\n");
+
+    return header.flush();
+
+}// ProtocolBenchmark::generateHeader
+
+
+/*!
+ * Generate the source file
+ * \param modules are all the structures and packets, which have been parsed.
+ * \return true if the file was written.
+ */
+bool ProtocolBenchmark::generateSource(const std::vector<ProtocolStructureModule*>& modules)
+{
+    std::vector<std::string> functions;
+    std::vector<std::string> names;
+    std::vector<std::string> includes;
+
+    for(const ProtocolStructureModule* module : modules)
+    {
+        std::string function = module->getBenchmarkFunction();
+
+        if(function.empty())
+            continue;
+
+        functions.push_back(function);
+        names.push_back("benchmark" + module->typeName);
+        includes.push_back(module->getHeaderFileName());
+
+        // In C the init function may be in the verify file
+        if((support.language == ProtocolSupport::c_language) && module->hasInit())
+            includes.push_back(module->getVerifyHeaderFileName());
+    }
+
+    source.setModuleNameAndPath(support.protoName + "Benchmark", support.outputpath);
+    source.writeIncludeDirectives(includes);
+    source.writeIncludeDirective("string.h", std::string(), true);
+    source.writeIncludeDirective("stdlib.h", std::string(), true);
+    source.writeIncludeDirective("stdio.h", std::string(), true);
+    source.writeIncludeDirective("limits.h", std::string(), true);
+
+    if(support.language == ProtocolSupport::c_language)
+        source.writeIncludeDirective("time.h", std::string(), true);
+    else
+    {
+        source.writeIncludeDirective("chrono", std::string(), true, false);
+        source.writeIncludeDirective("vector", std::string(), true, false);
+    }
+
+    source.makeLineSeparator();
+    source.write(getHelperFunctions());
+
+    for(const std::string& function : functions)
+    {
+        source.makeLineSeparator();
+        source.write(function);
+    }
+
+    source.makeLineSeparator();
+    source.write("/*!\n");
+    source.write(" * Benchmark the encode and decode of every structure and packet, printing\n");
+    source.write(" * one line of results for each.\n");
+    source.write(" * \\param iterations is the minimum number of times to encode and decode each.\n");
+    source.write(" * \\param seconds is the minimum time of each loop, the number of iterations\n");
+    source.write(" *        is doubled until the loop takes at least this long.\n");
+    source.write(" * \\return the number of decodes that failed, which should be zero.\n");
+    source.write(" */\n");
+    source.write("int run" + support.protoName + "Benchmark(int iterations, double seconds)\n");
+    source.write("{\n");
+    source.write(TAB_IN + "uint32_t seed = 0x12345678;\n");
+    source.write(TAB_IN + "int failures = 0;\n");
+    source.write("\n");
+    source.write(TAB_IN + "if(iterations < 1)\n");
+    source.write(TAB_IN + TAB_IN + "iterations = 1;\n");
+    source.write("\n");
+    source.write(TAB_IN + "printf(\"%-40s %6s %10s %10s %8s %10s %10s %8s\\n\", \"Name\", \"Bytes\", \"Enc ns\", \"Enc MB/s\", \"Enc I/B\", \"Dec ns\", \"Dec MB/s\", \"Dec I/B\");\n");
+    source.write("\n");
+
+    for(const std::string& name : names)
+        source.write(TAB_IN + "failures += " + name + "(iterations, seconds, &seed);\n");
+
+    source.write("\n");
+    source.write(TAB_IN + "return failures;\n");
+    source.write("\n");
+    source.write("}// run" + support.protoName + "Benchmark\n");
+
+    source.makeLineSeparator();
+    source.write("#ifdef PROTOGEN_BENCHMARK_MAIN\n");
+    source.write("\n");
+    source.write("int main(int argc, char* argv[])\n");
+    source.write("{\n");
+    source.write(TAB_IN + "int iterations = 1000;\n");
+    source.write(TAB_IN + "double seconds = 0.1;\n");
+    source.write("\n");
+    source.write(TAB_IN + "if(argc > 1)\n");
+    source.write(TAB_IN + TAB_IN + "iterations = atoi(argv[1]);\n");
+    source.write("\n");
+    source.write(TAB_IN + "if(argc > 2)\n");
+    source.write(TAB_IN + TAB_IN + "seconds = atof(argv[2]);\n");
+    source.write("\n");
+    source.write(TAB_IN + "return (run" + support.protoName + "Benchmark(iterations, seconds) == 0) ? 0 : 1;\n");
+    source.write("}\n");
+    source.write("\n");
+    source.write("#endif // PROTOGEN_BENCHMARK_MAIN\n");
+
+    return source.flush();
+
+}// ProtocolBenchmark::generateSource
+
+
+/*!
+ * Get the helper functions that time the loops and report the results. The
+ * instruction counter uses the Linux perf_event interface, which is not
+ * available in strict ANSI C. If the counter cannot be opened (for example
+ * due to permissions) instructions per byte are reported as "n/a". In C the
+ * time comes from the POSIX monotonic clock where it is declared, otherwise
+ * from the processor time returned by clock().
+ * \return the source code of the helper functions
+ */
+std::string ProtocolBenchmark::getHelperFunctions(void) const
+{
+    std::string output;
+    bool c = (support.language == ProtocolSupport::c_language);
+
+    output += "#if defined(__linux__) && (defined(__cplusplus) || !defined(__STRICT_ANSI__))\n";
+    output += "#include <linux/perf_event.h>\n";
+    output += "#include <sys/syscall.h>\n";
+    output += "#include <sys/ioctl.h>\n";
+    output += "#include <unistd.h>\n";
+    output += "#define _PG_PERF_EVENT\n";
+    output += "#endif\n";
+    output += "\n";
+
+    output += "//! Timing of one benchmark loop\n";
+    output += "typedef struct\n";
+    output += "{\n";
+    if(c)
+        output += TAB_IN + "double start;            //!< Time in seconds when the loop started\n";
+    else
+        output += TAB_IN + "std::chrono::steady_clock::time_point start; //!< Time when the loop started\n";
+    output += TAB_IN + "int iterations;          //!< Number of times around the loop\n";
+    output += TAB_IN + "double seconds;          //!< Seconds spent in the loop\n";
+    output += TAB_IN + "long long instructions;  //!< Instructions retired in the loop, -1 if not available\n";
+    output += TAB_IN + "int counter;             //!< File descriptor of the instruction counter, -1 if not available\n";
+    output += "}_pg_timing_t;\n";
+    output += "\n";
+
+    output += "//! Generate a pseudo random number using xorshift\n";
+    output += "static uint32_t _pg_random(uint32_t* seed)\n";
+    output += "{\n";
+    output += TAB_IN + "uint32_t x = *seed;\n";
+    output += TAB_IN + "x ^= x << 13;\n";
+    output += TAB_IN + "x ^= x >> 17;\n";
+    output += TAB_IN + "x ^= x << 5;\n";
+    output += TAB_IN + "*seed = x;\n";
+    output += TAB_IN + "return x;\n";
+    output += "}\n";
+    output += "\n";
+
+    output += "//! Fill a buffer with random bytes\n";
+    output += "static void _pg_fillRandom(uint8_t* data, int size, uint32_t* seed)\n";
+    output += "{\n";
+    output += TAB_IN + "int i;\n";
+    output += TAB_IN + "for(i = 0; i < size; i++)\n";
+    output += TAB_IN + TAB_IN + "data[i] = (uint8_t)(_pg_random(seed) >> 24);\n";
+    output += "}\n";
+    output += "\n";
+
+    if(c)
+    {
+        output += "//! Get the current time in seconds from the most steady clock available\n";
+        output += "static double _pg_now(void)\n";
+        output += "{\n";
+        output += "#ifdef CLOCK_MONOTONIC\n";
+        output += TAB_IN + "struct timespec now;\n";
+        output += TAB_IN + "clock_gettime(CLOCK_MONOTONIC, &now);\n";
+        output += TAB_IN + "return (double)now.tv_sec + now.tv_nsec*1.0e-9;\n";
+        output += "#else\n";
+        output += TAB_IN + "return (double)clock()/CLOCKS_PER_SEC;\n";
+        output += "#endif\n";
+        output += "}\n";
+        output += "\n";
+    }
+
+    output += "//! Start timing a benchmark loop\n";
+    output += "static void _pg_startTiming(_pg_timing_t* timing)\n";
+    output += "{\n";
+    output += TAB_IN + "timing->seconds = 0;\n";
+    output += TAB_IN + "timing->instructions = -1;\n";
+    output += TAB_IN + "timing->counter = -1;\n";
+    output += "\n";
+    output += "#ifdef _PG_PERF_EVENT\n";
+    output += TAB_IN + "{\n";
+    output += TAB_IN + TAB_IN + "struct perf_event_attr attr;\n";
+    output += TAB_IN + TAB_IN + "memset(&attr, 0, sizeof(attr));\n";
+    output += TAB_IN + TAB_IN + "attr.type = PERF_TYPE_HARDWARE;\n";
+    output += TAB_IN + TAB_IN + "attr.size = sizeof(attr);\n";
+    output += TAB_IN + TAB_IN + "attr.config = PERF_COUNT_HW_INSTRUCTIONS;\n";
+    output += TAB_IN + TAB_IN + "attr.disabled = 1;\n";
+    output += TAB_IN + TAB_IN + "attr.exclude_kernel = 1;\n";
+    output += TAB_IN + TAB_IN + "attr.exclude_hv = 1;\n";
+    output += "\n";
+    output += TAB_IN + TAB_IN + "timing->counter = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);\n";
+    output += TAB_IN + TAB_IN + "if(timing->counter >= 0)\n";
+    output += TAB_IN + TAB_IN + "{\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "ioctl(timing->counter, PERF_EVENT_IOC_RESET, 0);\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "ioctl(timing->counter, PERF_EVENT_IOC_ENABLE, 0);\n";
+    output += TAB_IN + TAB_IN + "}\n";
+    output += TAB_IN + "}\n";
+    output += "#endif\n";
+    output += "\n";
+    if(c)
+        output += TAB_IN + "timing->start = _pg_now();\n";
+    else
+        output += TAB_IN + "timing->start = std::chrono::steady_clock::now();\n";
+    output += "}\n";
+    output += "\n";
+
+    output += "//! Stop timing a benchmark loop\n";
+    output += "static void _pg_stopTiming(_pg_timing_t* timing)\n";
+    output += "{\n";
+    if(c)
+        output += TAB_IN + "timing->seconds = _pg_now() - timing->start;\n";
+    else
+        output += TAB_IN + "timing->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - timing->start).count();\n";
+    output += "\n";
+    output += "#ifdef _PG_PERF_EVENT\n";
+    output += TAB_IN + "if(timing->counter >= 0)\n";
+    output += TAB_IN + "{\n";
+    output += TAB_IN + TAB_IN + "long long count = 0;\n";
+    output += TAB_IN + TAB_IN + "ioctl(timing->counter, PERF_EVENT_IOC_DISABLE, 0);\n";
+    output += TAB_IN + TAB_IN + "if(read(timing->counter, &count, sizeof(count)) == (ssize_t)sizeof(count))\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "timing->instructions = count;\n";
+    output += TAB_IN + TAB_IN + "close(timing->counter);\n";
+    output += TAB_IN + "}\n";
+    output += "#endif\n";
+    output += "}\n";
+    output += "\n";
+
+    output += "//! Double the iterations of a loop that was shorter than seconds, return 1 if the loop should be run again\n";
+    output += "static int _pg_repeatTiming(_pg_timing_t* timing, double seconds)\n";
+    output += "{\n";
+    output += TAB_IN + "if((timing->seconds >= seconds) || (timing->iterations > INT_MAX/2))\n";
+    output += TAB_IN + TAB_IN + "return 0;\n";
+    output += "\n";
+    output += TAB_IN + "timing->iterations *= 2;\n";
+    output += TAB_IN + "return 1;\n";
+    output += "}\n";
+    output += "\n";
+
+    output += "//! Print the results of one benchmark\n";
+    output += "static void _pg_report(const char* name, int bytes, const _pg_timing_t* encodetiming, const _pg_timing_t* decodetiming)\n";
+    output += "{\n";
+    output += TAB_IN + "const _pg_timing_t* timings[2] = {encodetiming, decodetiming};\n";
+    output += TAB_IN + "int i;\n";
+    output += "\n";
+    output += TAB_IN + "printf(\"%-40s %6d\", name, bytes);\n";
+    output += "\n";
+    output += TAB_IN + "for(i = 0; i < 2; i++)\n";
+    output += TAB_IN + "{\n";
+    output += TAB_IN + TAB_IN + "double seconds = timings[i]->seconds;\n";
+    output += TAB_IN + TAB_IN + "double total = (double)bytes*timings[i]->iterations;\n";
+    output += "\n";
+    output += TAB_IN + TAB_IN + "printf(\" %10.1f\", seconds*1.0e9/timings[i]->iterations);\n";
+    output += "\n";
+    output += TAB_IN + TAB_IN + "if(seconds > 0)\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "printf(\" %10.1f\", total/seconds/1.0e6);\n";
+    output += TAB_IN + TAB_IN + "else\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "printf(\" %10s\", \"n/a\");\n";
+    output += "\n";
+    output += TAB_IN + TAB_IN + "if((timings[i]->instructions >= 0) && (total > 0))\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "printf(\" %8.2f\", timings[i]->instructions/total);\n";
+    output += TAB_IN + TAB_IN + "else\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "printf(\" %8s\", \"n/a\");\n";
+    output += TAB_IN + "}\n";
+    output += "\n";
+    output += TAB_IN + "printf(\"\\n\");\n";
+    output += "}\n";
+
+    return output;
+
+}// ProtocolBenchmark::getHelperFunctions
@@ -0,0 +1,41 @@
+#ifndef PROTOCOLBENCHMARK_H
+#define PROTOCOLBENCHMARK_H
+
+/*!
+ * \file
+ * Auto magically generate the encode and decode benchmark of a protocol
+ */
+
+
+#include "protocolfile.h"
+#include "protocolsupport.h"
+#include <string>
+#include <vector>
+
+class ProtocolStructureModule;
+
+class ProtocolBenchmark
+{
+public:
+    ProtocolBenchmark(ProtocolSupport protocolsupport);
+
+    //! Perform the generation, writing out the files
+    bool generate(std::vector<std::string>& fileNameList, std::vector<std::string>& filePathList, const std::vector<ProtocolStructureModule*>& modules);
+
+protected:
+
+    //! Generate the header file
+    bool generateHeader(void);
+
+    //! Generate the source file
+    bool generateSource(const std::vector<ProtocolStructureModule*>& modules);
+
+    //! Get the helper functions that time the loops and report the results
+    std::string getHelperFunctions(void) const;
+
+    ProtocolHeaderFile header;
+    ProtocolSourceFile source;
+    ProtocolSupport support;
+};
+
+#endif // PROTOCOLBENCHMARK_H
@@ -153,7 +153,7 @@ void ProtocolBitfield::generatetest(ProtocolSupport support)
         source.write("    test.encode(data, &index);\n");
         source.write("\n");
         source.write("    // Clear the in-memory data so we can be sure the decoder sets all bits correctly\n");
-        source.write("    memset(&test, 0, sizeof(test));\n");
+        source.write("    memset((void*)&test, 0, sizeof(test));\n");
         source.write("\n");
         source.write("    index = 0;\n");
         source.write("    if(!test.decode(data, &index))\n");
@@ -183,7 +183,7 @@ void ProtocolBitfield::generatetest(ProtocolSupport support)
         source.write("    test2.encode(data, &index);\n");
         source.write("\n");
         source.write("    // Clear the in-memory data so we can be sure the decoder sets all bits correctly\n");
-        source.write("    memset(&test2, 0, sizeof(test2));\n");
+        source.write("    memset((void*)&test2, 0, sizeof(test2));\n");
         source.write("\n");
         source.write("    index = 0;\n");
         source.write("    if(!test2.decode(data, &index))\n");
@@ -213,7 +213,7 @@ void ProtocolBitfield::generatetest(ProtocolSupport support)
         source.write("    test3.encode(data, &index);\n");
         source.write("\n");
         source.write("    // Clear the in-memory data so we can be sure the decoder sets all bits correctly\n");
-        source.write("    memset(&test3, 0, sizeof(test3));\n");
+        source.write("    memset((void*)&test3, 0, sizeof(test3));\n");
         source.write("\n");
         source.write("    index = 0;\n");
         source.write("    if(!test3.decode(data, &index))\n");
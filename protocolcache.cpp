@@ -0,0 +1,214 @@
+#include "protocolcache.h"
+#include "protocolsupport.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+
+/*!
+ * Load the cache from disk. If the layout of the modules has changed (because
+ * a module was added, removed, or moved to a different file) then the cache
+ * contents are discarded, and every module will be generated.
+ * \param layoutFingerprint is the fingerprint of the module layout of this run
+ */
+void ProtocolCache::load(const std::string& layoutFingerprint)
+{
+    entries.clear();
+    owners.clear();
+    layout = layoutFingerprint;
+
+    if(!isEnabled())
+        return;
+
+    std::fstream file(cacheFileName(), std::ios_base::in);
+
+    // No cache yet is not an error, everything will be generated
+    if(!file.is_open())
+        return;
+
+    std::string line;
+    CacheEntry* entry = nullptr;
+
+    // The first line is the layout the cache was made with
+    if(!std::getline(file, line) || (line != "layout " + layout))
+    {
+        std::cout << "Module layout changed, regenerating all modules" << std::endl;
+        return;
+    }
+
+    while(std::getline(file, line))
+    {
+        std::size_t first = line.find(' ');
+        std::size_t second = line.find(' ', first + 1);
+
+        if((first >= line.size()) || (second >= line.size()))
+            continue;
+
+        std::string tag = line.substr(0, first);
+        std::string value = line.substr(first + 1, second - first - 1);
+        std::string name = line.substr(second + 1);
+
+        if(tag == "module")
+        {
+            entry = &entries[name];
+            entry->fingerprint = value;
+        }
+        else if((tag == "file") && (entry != nullptr))
+        {
+            entry->files[name] = value;
+            owners[name]++;
+        }
+    }
+
+}// ProtocolCache::load
+
+
+/*!
+ * Save the cache to disk
+ * \return true if the cache was written
+ */
+bool ProtocolCache::save(void) const
+{
+    if(!isEnabled())
+        return false;
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+
+    std::fstream file(cacheFileName(), std::ios_base::out);
+
+    if(!file.is_open())
+    {
+        std::cerr << "warning: failed to write cache file " << cacheFileName() << std::endl;
+        return false;
+    }
+
+    file << "layout " << layout << "\n";
+
+    for(const auto& entry : entries)
+    {
+        file << "module " << entry.second.fingerprint << " " << entry.first << "\n";
+
+        for(const auto& output : entry.second.files)
+            file << "file " << output.second << " " << output.first << "\n";
+    }
+
+    return true;
+
+}// ProtocolCache::save
+
+
+/*!
+ * Determine if a module can be skipped. This is true if the module has the
+ * same fingerprint as the last run, and all of its output files are as they
+ * were left by the last run. Modules which share an output file with any other
+ * module, or with the files given by the caller, cannot be skipped, because
+ * that file will be rebuilt from scratch.
+ * \param module is the unique name of the module.
+ * \param fingerprint is the fingerprint of the module inputs for this run.
+ * \param reservedFiles are files which are always generated.
+ * \return true if the module does not need to be generated
+ */
+bool ProtocolCache::isCurrent(const std::string& module, const std::string& fingerprint, const std::vector<std::string>& reservedFiles) const
+{
+    auto it = entries.find(module);
+
+    if((it == entries.end()) || (it->second.fingerprint != fingerprint))
+        return false;
+
+    for(const auto& output : it->second.files)
+    {
+        if(owners.at(output.first) > 1)
+            return false;
+
+        if(contains(reservedFiles, output.first, true))
+            return false;
+
+        if(hashFile(output.first) != output.second)
+            return false;
+    }
+
+    return true;
+
+}// ProtocolCache::isCurrent
+
+
+/*!
+ * Record the fingerprint and output files of a module which was generated.
+ * \param module is the unique name of the module.
+ * \param fingerprint is the fingerprint of the module inputs for this run.
+ * \param files is the list of files the module wrote, which must be current on disk.
+ */
+void ProtocolCache::update(const std::string& module, const std::string& fingerprint, const std::vector<std::string>& files)
+{
+    CacheEntry& entry = entries[module];
+
+    for(const auto& output : entry.files)
+        owners[output.first]--;
+
+    entry.fingerprint = fingerprint;
+    entry.files.clear();
+
+    for(const std::string& name : files)
+    {
+        std::error_code ec;
+
+        // Not every potential output is written
+        if(name.empty() || !std::filesystem::is_regular_file(name, ec))
+            continue;
+
+        if(entry.files.count(name) == 0)
+        {
+            entry.files[name] = hashFile(name);
+            owners[name]++;
+        }
+    }
+
+}// ProtocolCache::update
+
+
+/*!
+ * Compute the 64-bit FNV-1a hash of some data
+ * \param data is the data to hash
+ * \return the hash as a 16 character hexadecimal string
+ */
+std::string ProtocolCache::hash(const std::string& data)
+{
+    uint64_t hash = 14695981039346656037ull;
+
+    for(unsigned char c : data)
+    {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+
+    std::stringstream stream;
+    stream << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return stream.str();
+
+}// ProtocolCache::hash
+
+
+/*!
+ * Compute the hash of the contents of a file
+ * \param fileName is the name of the file, including its path
+ * \return the hash as a hexadecimal string, or an empty string if the file cannot be read
+ */
+std::string ProtocolCache::hashFile(const std::string& fileName)
+{
+    std::fstream file(fileName, std::ios_base::in);
+
+    if(!file.is_open())
+        return std::string();
+
+    return hash(std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>()));
+
+}// ProtocolCache::hashFile
+
+
+//! \return the name of the cache file, including the cache directory
+std::string ProtocolCache::cacheFileName(void) const
+{
+    return directory + "protogen.cache";
+}
@@ -0,0 +1,60 @@
+#ifndef PROTOCOLCACHE_H
+#define PROTOCOLCACHE_H
+
+/*!
+ * \file
+ * Persistent per-module fingerprints used to skip regeneration of modules
+ * whose inputs and outputs have not changed since the last run
+ */
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+class ProtocolCache
+{
+public:
+    //! Set the directory of the cache, an empty directory disables the cache
+    void setDirectory(const std::string& path) {directory = path;}
+
+    //! Determine if the cache is in use
+    bool isEnabled(void) const {return !directory.empty();}
+
+    //! Load the cache from disk, discarding it if the layout has changed
+    void load(const std::string& layoutFingerprint);
+
+    //! Save the cache to disk
+    bool save(void) const;
+
+    //! Determine if a module can be skipped because nothing it depends on has changed
+    bool isCurrent(const std::string& module, const std::string& fingerprint, const std::vector<std::string>& reservedFiles) const;
+
+    //! Record the fingerprint and output files of a module which was generated
+    void update(const std::string& module, const std::string& fingerprint, const std::vector<std::string>& files);
+
+    //! Compute the hash of some data as a hexadecimal string
+    static std::string hash(const std::string& data);
+
+    //! Compute the hash of the contents of a file as a hexadecimal string
+    static std::string hashFile(const std::string& fileName);
+
+protected:
+
+    //! A module fingerprint and the hashes of its output files
+    typedef struct
+    {
+        std::string fingerprint;                    //!< Fingerprint of the module inputs
+        std::map<std::string, std::string> files;   //!< Hashes of the module outputs by file name
+    }CacheEntry;
+
+    //! Name of the cache file within the cache directory
+    std::string cacheFileName(void) const;
+
+    std::string directory;                          //!< Directory of the cache file
+    std::string layout;                             //!< Fingerprint of the module layout
+    std::map<std::string, CacheEntry> entries;      //!< Cache entries by module name
+    std::map<std::string, int> owners;              //!< Number of modules which write each file
+};
+
+#endif // PROTOCOLCACHE_H
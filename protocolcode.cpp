@@ -7,7 +7,7 @@
  * \param parent is the hierarchical name of the owning object
  * \param supported indicates what the protocol can support
  */
-ProtocolCode::ProtocolCode(ProtocolParser* parse, std::string parent, ProtocolSupport supported):
+ProtocolCode::ProtocolCode(ProtocolParser* parse, std::string parent, SharedSupport supported):
     Encodable(parse, parent, supported)
 {
     attriblist = {"name", "encode", "decode", "encode_c", "decode_c", "encode_cpp", "decode_cpp", "encode_python", "decode_python", "comment", "include"};
@@ -81,14 +81,14 @@ std::string ProtocolCode::getEncodeString(int* bitcount, bool isStructureMember)
 
     std::string output;
 
-    if((support.language == ProtocolSupport::c_language) && !encode.empty())
+    if((support->language == ProtocolSupport::c_language) && !encode.empty())
     {
         if(!comment.empty())
             output += TAB_IN + "// " + comment + "\n";
 
         output += TAB_IN + encode + "\n";
     }
-    else if((support.language == ProtocolSupport::cpp_language) && !encodecpp.empty())
+    else if((support->language == ProtocolSupport::cpp_language) && !encodecpp.empty())
     {
         if(!comment.empty())
             output += TAB_IN + "// " + comment + "\n";
@@ -119,14 +119,14 @@ std::string ProtocolCode::getDecodeString(int* bitcount, bool isStructureMember,
 
     std::string output;
 
-    if((support.language == ProtocolSupport::c_language) && !decode.empty())
+    if((support->language == ProtocolSupport::c_language) && !decode.empty())
     {
         if(!comment.empty())
             output += TAB_IN + "// " + comment + "\n";
 
         output += TAB_IN + decode + "\n";
     }
-    else if((support.language == ProtocolSupport::cpp_language) && !decodecpp.empty())
+    else if((support->language == ProtocolSupport::cpp_language) && !decodecpp.empty())
     {
         if(!comment.empty())
             output += TAB_IN + "// " + comment + "\n";
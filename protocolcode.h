@@ -9,7 +9,7 @@ class ProtocolCode : public Encodable
     public:
 
     //! Construct a field, setting the protocol name and name prefix
-    ProtocolCode(ProtocolParser* parse, std::string parent, ProtocolSupport supported);
+    ProtocolCode(ProtocolParser* parse, std::string parent, SharedSupport supported);
 
     //! Reset all data to defaults
     void clear(void) override;
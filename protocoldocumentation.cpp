@@ -13,11 +13,12 @@ std::vector<std::string> ProtocolDocumentation::keywords = {"auto", "double", "i
 std::vector<std::string> ProtocolDocumentation::variablenames = {"_pg_user", "_pg_user1", "_pg_user2", "_pg_data", "_pg_i", "_pg_j", "_pg_byteindex", "_pg_bytecount", "_pg_numBytes", "_pg_bitfieldbytes", "_pg_tempbitfield", "_pg_templongbitfield", "_pg_bitfieldindex", "_pg_good", "_pg_struct1", "_pg_struct2", "_pg_prename", "_pg_report"};
 
 //! Construct the document object, with details about the overall protocol
-ProtocolDocumentation::ProtocolDocumentation(ProtocolParser* parse, std::string Parent, ProtocolSupport supported) :
+ProtocolDocumentation::ProtocolDocumentation(ProtocolParser* parse, std::string Parent, SharedSupport supported) :
     support(supported),
     parser(parse),
     parent(Parent),
     e(nullptr),
+    line(0),
     attriblist({"name", "title", "comment", "file", "paragraph"}),
     outlineLevel(0)
 {
@@ -105,6 +106,23 @@ std::string ProtocolDocumentation::getTopLevelMarkdown(bool global, const std::v
 }// ProtocolDocumentation::getTopLevelMarkdown
 
 
+/*!
+ * Get the protocol support of this object in order to change it. The support
+ * is shared with other objects, so this object first gets its own copy, which
+ * is then shared with the children created after the change.
+ * \return a reference to the support of this object
+ */
+ProtocolSupport& ProtocolDocumentation::changeSupport(void)
+{
+    std::shared_ptr<ProtocolSupport> copy = std::make_shared<ProtocolSupport>(*support);
+
+    support = copy;
+
+    return *copy;
+
+}// ProtocolDocumentation::changeSupport
+
+
 /*!
  * Output a warning to stderr. The warning will include the hierarchical name.
  * used to describe this objects location in the xml.
@@ -119,9 +137,7 @@ void ProtocolDocumentation::emitWarning(const std::string& warning, const std::s
     if(!subname.empty())
         name += ":" + subname;
 
-    int line = e->GetLineNum();
-
-    std::cerr << support.sourcefile << "(" << line << "): warning: " << name << ": " << warning << std::endl;
+    std::cerr << support->sourcefile << "(" << line << "): warning: " << name << ": " << warning << std::endl;
 }
 
 
@@ -134,7 +150,7 @@ void ProtocolDocumentation::emitWarning(const std::string& warning, const std::s
  */
 void ProtocolDocumentation::emitWarning(const std::string& warning, const XMLAttribute* a) const
 {
-    emitWarning(support.sourcefile, getHierarchicalName(), warning, a);
+    emitWarning(support->sourcefile, getHierarchicalName(), warning, a);
 }
 
 
@@ -168,7 +184,7 @@ void ProtocolDocumentation::emitWarning(const std::string& sourcefile, const std
 void ProtocolDocumentation::testAndWarnAttributes(const XMLAttribute* map) const
 {
     // The only thing we check for is unrecognized attributes
-    if(support.disableunrecognized)
+    if(support->disableunrecognized)
         return;
 
     /// TODO: test for repeated attributes
@@ -191,7 +207,7 @@ void ProtocolDocumentation::testAndWarnAttributes(const XMLAttribute* map) const
  * \param e is the DOM element which may have documentation children
  * \param list receives the list of allocated objects.
  */
-void ProtocolDocumentation::getChildDocuments(ProtocolParser* parse, const std::string& Parent, ProtocolSupport support, const XMLElement* e, std::vector<ProtocolDocumentation*>& list)
+void ProtocolDocumentation::getChildDocuments(ProtocolParser* parse, const std::string& Parent, SharedSupport support, const XMLElement* e, std::vector<ProtocolDocumentation*>& list)
 {
     // The list of documentation that goes inside this packet
     std::vector<const XMLElement*> documents = ProtocolParser::childElementsByTagName(e, "Document");
@@ -12,15 +12,15 @@ class ProtocolDocumentation
 public:
 
     //! Construct the document object
-    ProtocolDocumentation(ProtocolParser* parse, std::string Parent, ProtocolSupport supported);
+    ProtocolDocumentation(ProtocolParser* parse, std::string Parent, SharedSupport supported);
 
     //! Virtual destructor
     virtual ~ProtocolDocumentation(void) {;}
 
     //! Set the element from the DOM
-    virtual void setElement(const XMLElement* element) {e = element;}
+    virtual void setElement(const XMLElement* element) {e = element; line = (element != nullptr) ? element->GetLineNum() : 0;}
 
-    //! Get the element
+    //! Get the element, which is only valid until the parser releases the DOM
     const XMLElement* getElement(void) {return e;}
 
     //! Parse the document from the DOM
@@ -51,7 +51,7 @@ public:
     void testAndWarnAttributes(const XMLAttribute* map) const;
 
     //! Helper function to create a list of ProtocolDocumentation objects
-    static void getChildDocuments(ProtocolParser* parse, const std::string& parent, ProtocolSupport support, const XMLElement* e, std::vector<ProtocolDocumentation*>& list);
+    static void getChildDocuments(ProtocolParser* parse, const std::string& parent, SharedSupport support, const XMLElement* e, std::vector<ProtocolDocumentation*>& list);
 
 public:
 
@@ -64,10 +64,14 @@ public:
 
 protected:
 
-    ProtocolSupport support;    //!< Information about what is supported
+    //! Get our own copy of the protocol support, in order to change it
+    ProtocolSupport& changeSupport(void);
+
+    SharedSupport support;      //!< Information about what is supported, shared with other objects
     ProtocolParser* parser;     //!< The parser object
     std::string parent;         //!< The parent name of this encodable
     const XMLElement* e;        //!< The DOM element which is the source of this object's data
+    int line;                   //!< The line number of the element, kept for warnings after the DOM is released
 
     std::vector<std::string> attriblist;//!< List of all attributes that we understand
 
@@ -4,6 +4,7 @@
 #include "enumcreator.h"
 #include "protocolstructuremodule.h"
 #include "protocolbitfield.h"
+#include "protocolstats.h"
 #include "prebuiltSources/floatspecial.h"
 #include <cmath>
 #include <iomanip>
@@ -12,7 +13,7 @@
 #include <limits>
 #include <iostream>
 
-TypeData::TypeData(ProtocolSupport sup) :
+TypeData::TypeData(SharedSupport sup) :
     isBool(false),
     isStruct(false),
     isSigned(false),
@@ -22,6 +23,7 @@ TypeData::TypeData(ProtocolSupport sup) :
     isString(false),
     isFixedString(false),
     isNull(false),
+    isVarint(false),
     bits(8),
     sigbits(0),
     enummax(0),
@@ -44,6 +46,7 @@ void TypeData::clear(void)
     isString = false;
     isFixedString = false;
     isNull = false;
+    isVarint = false;
     bits = 8;
     sigbits = 0;
     enummax = 0;
@@ -64,7 +67,7 @@ std::string TypeData::toTypeString(const std::string& structName) const
         typeName = "char";
     else if(isBitfield)
     {
-        if((bits > 32) && (support.longbitfield))
+        if((bits > 32) && (support->longbitfield))
             typeName = "uint64_t";
         else
             typeName = "unsigned";
@@ -78,9 +81,9 @@ std::string TypeData::toTypeString(const std::string& structName) const
         typeName = trimm(structName);
 
         // Make sure it ends with the suffix;
-        if(!endsWith(typeName, support.typeSuffix))
+        if(!endsWith(typeName, support->typeSuffix))
         {
-            typeName += support.typeSuffix;
+            typeName += support->typeSuffix;
         }
     }
     else
@@ -240,6 +243,11 @@ uint64_t TypeData::getMaximumIntegerValue(void) const
         uint64_t max = (0x1ull << (bits-1)) - 1;
         return max;
     }
+    else if(bits >= 64)
+    {
+        // Shifting by the full width is undefined
+        return 0xFFFFFFFFFFFFFFFFull;
+    }
     else
     {
         uint64_t max = (0x1ull << bits) - 1;
@@ -470,11 +478,12 @@ double TypeData::extractDouble(const std::string& string, bool* ok)
  * \param parent is the hierarchical name of the parent object
  * \param supported indicates what the protocol can support
  */
-ProtocolField::ProtocolField(ProtocolParser* parse, std::string parent, ProtocolSupport supported):
+ProtocolField::ProtocolField(ProtocolParser* parse, std::string parent, SharedSupport supported):
     Encodable(parse, parent, supported),
     encodedMin(0),
     encodedMax(0),
     scaler(1),
+    resolution(0),
     hasVerifyMinValue(false),
     verifyMinValue(0),
     limitMinValue(0),
@@ -483,6 +492,10 @@ ProtocolField::ProtocolField(ProtocolParser* parse, std::string parent, Protocol
     limitMaxValue(0),
     checkConstant(false),
     overridesPrevious(false),
+    deltaElement(false),
+    deltaPacket(false),
+    rle(false),
+    gather(false),
     isOverriden(false),
     inMemoryType(supported),
     encodedType(supported),
@@ -522,7 +535,12 @@ ProtocolField::ProtocolField(ProtocolParser* parse, std::string parent, Protocol
                   "verifyMinValue",
                   "verifyMaxValue",
                   "map",
-                  "limitOnEncode"};
+                  "limitOnEncode",
+                  "delta",
+                  "resolution",
+                  "rle",
+                  "dictionary",
+                  "gather"};
 }
 
 
@@ -535,12 +553,19 @@ void ProtocolField::clear(void)
 
     encodedMin = encodedMax = 0;
     scaler = 1;
+    resolution = 0;
+    resolutionString.clear();
     defaultString.clear();
     defaultStringForDisplay.clear();
     constantString.clear();
     constantStringForDisplay.clear();
     checkConstant = false;
     overridesPrevious = false;
+    deltaElement = false;
+    deltaPacket = false;
+    rle = false;
+    gather = false;
+    dictionary.clear();
     isOverriden = false;
     encodedType = inMemoryType = TypeData(support);
     bitfieldData.clear();
@@ -801,7 +826,7 @@ void ProtocolField::extractType(TypeData& data, const std::string& typeString, b
         // default to unsigned 8
         data.bits = 8;
 
-        if(support.supportbool == false)
+        if(support->supportbool == false)
         {
             emitWarning("bool support is disabled in this protocol");
         }
@@ -819,7 +844,7 @@ void ProtocolField::extractType(TypeData& data, const std::string& typeString, b
         // Get the number of bits, between 1 and 32 inclusive
         data.bits = data.extractPositiveInt(type);
 
-        if(support.bitfield == false)
+        if(support->bitfield == false)
         {
             emitWarning("bitfield support is disabled in this protocol");
 
@@ -838,7 +863,7 @@ void ProtocolField::extractType(TypeData& data, const std::string& typeString, b
                 data.bits = 1;
                 emitWarning("bitfields must have a bit width of at least one");
             }
-            else if((data.bits > 32) && (support.longbitfield == false))
+            else if((data.bits > 32) && (support->longbitfield == false))
             {
                 emitWarning("bitfields must have a bit width of 32 or less");
                 data.bits = 32;
@@ -865,6 +890,18 @@ void ProtocolField::extractType(TypeData& data, const std::string& typeString, b
 
         data.bits = 8;
     }
+    else if(startsWith(type, "var"))
+    {
+        // "varuint" or "varsint". The width follows the in memory type, which
+        // is worked out once both types are known
+        data.isSigned = startsWith(type, "vars");
+        data.bits = 32;
+
+        if(inMemory)
+            emitWarning("variable length integers are only for encoded types, in memory type changed to 32 bit integer");
+        else
+            data.isVarint = true;
+    }
     else
     {
         // Get the number of bits, between 1 and 32 inclusive
@@ -948,7 +985,7 @@ void ProtocolField::extractType(TypeData& data, const std::string& typeString, b
                     else
                         data.bits = 64;
 
-                    if((data.bits < 32) && (support.specialFloat == false))
+                    if((data.bits < 32) && (support->specialFloat == false))
                     {
                         emitWarning("non-standard float bit widths are disabled in this protocol");
                         data.bits = 32;
@@ -992,7 +1029,7 @@ void ProtocolField::extractType(TypeData& data, const std::string& typeString, b
 
             }// else if not in memory float
 
-            if((data.bits > 32) && (support.float64 == false))
+            if((data.bits > 32) && (support->float64 == false))
             {
                 emitWarning("64 bit float support is disabled in this protocol");
                 data.bits = 32;
@@ -1017,7 +1054,7 @@ void ProtocolField::extractType(TypeData& data, const std::string& typeString, b
                         data.bits = 8;
                 }
             }
-            else if(((data.bits % 8) != 0) || (data.bits > 64))
+            else if((((data.bits % 8) != 0) && !canBitPack(data)) || (data.bits > 64))
             {
                 emitWarning("encoded integer types must be 8, 16, 24, 32, 40, 48, 56, or 64 bits");
 
@@ -1039,7 +1076,7 @@ void ProtocolField::extractType(TypeData& data, const std::string& typeString, b
                     data.bits = 8;
             }
 
-            if((data.bits > 32) && (support.int64 == false))
+            if((data.bits > 32) && (support->int64 == false))
             {
                 emitWarning("Integers greater than 32 bits are disabled in this protocol");
                 data.bits = 32;
@@ -1052,6 +1089,162 @@ void ProtocolField::extractType(TypeData& data, const std::string& typeString, b
 }// ProtocolField::extractType
 
 
+/*!
+ * Get the encoded type string that achieves the resolution over the range
+ * from min to max. The encoded type is only chosen if it is not given, or is
+ * "auto" or "bitfield"; otherwise the resolution is checked once the scaling
+ * is known. The width is the fewest bits whose unsigned range divides max -
+ * min into steps no larger than the resolution. Unless a bitfield is asked
+ * for, or the field is bitpacked, the width is rounded up to whole bytes.
+ * If the resolution cannot be used it is cleared.
+ * \param encodedTypeString is the encoded type string from the user.
+ * \return the encoded type string to use.
+ */
+std::string ProtocolField::getEncodedTypeForResolution(const std::string& encodedTypeString)
+{
+    bool ok;
+
+    if(inMemoryType.isNull || inMemoryType.isStruct || inMemoryType.isString || inMemoryType.isBool || inMemoryType.isEnum)
+    {
+        emitWarning("resolution does not apply to this type data");
+        resolutionString.clear();
+        return encodedTypeString;
+    }
+
+    if(maxString.empty())
+    {
+        emitWarning("resolution requires max");
+        resolutionString.clear();
+        return encodedTypeString;
+    }
+
+    double res = ShuntingYard::computeInfix(parser->replaceEnumerationNameWithValue(resolutionString), &ok);
+    if(!ok || (res <= 0.0))
+    {
+        emitWarning("resolution must be a number greater than zero");
+        resolutionString.clear();
+        return encodedTypeString;
+    }
+
+    double max = ShuntingYard::computeInfix(parser->replaceEnumerationNameWithValue(maxString), &ok);
+    double min = 0.0;
+
+    if(ok && !minString.empty())
+        min = ShuntingYard::computeInfix(parser->replaceEnumerationNameWithValue(minString), &ok);
+
+    if(!ok || (max <= min))
+    {
+        emitWarning("resolution requires numeric min and max, with max more than min");
+        resolutionString.clear();
+        return encodedTypeString;
+    }
+
+    std::string type = toLower(encodedTypeString);
+    if(!type.empty() && (type != "auto") && (type != "bitfield"))
+        return encodedTypeString;
+
+    int maxbits = support->int64 ? 64 : 32;
+    int bits = 1;
+
+    // A small tolerance, so a range that is an exact multiple of the resolution does not need an extra bit
+    double steps = ceil((max - min)/res - 1e-9);
+
+    while((bits < maxbits) && ((pow(2.0, bits) - 1.0) < steps))
+        bits++;
+
+    if((pow(2.0, bits) - 1.0) < steps)
+        emitWarning("resolution needs more than " + std::to_string(maxbits) + " bits, " + std::to_string(maxbits) + " bits used");
+
+    TypeData data(support);
+    data.bits = bits;
+
+    if(type == "bitfield")
+        return "bitfield" + std::to_string(bits);
+    else if(canBitPack(data))
+        return "unsigned" + std::to_string(bits);
+    else
+        return "unsigned" + std::to_string(8*((bits + 7)/8));
+
+}// ProtocolField::getEncodedTypeForResolution
+
+
+/*!
+ * Determine if an encoded type can be packed into the bit stream of a
+ * bitpacked packet or structure. Only single integers are packed; arrays,
+ * dependent fields, floats, strings, structures, and variable length integers
+ * remain on byte boundaries.
+ * \param data is the encoded type to test.
+ * \return true if the encoded type can be a bitfield.
+ */
+bool ProtocolField::canBitPack(const TypeData& data) const
+{
+    if(!support->bitpacked || !support->bitfield || !array.empty() || !dependsOn.empty())
+        return false;
+
+    if(data.isNull || data.isFloat || data.isString || data.isStruct || data.isVarint)
+        return false;
+
+    // Signed bitfields are offset by their minimum, which needs an in-memory
+    // value, and the offset of a full width signed value does not fit in the
+    // scaling functions, so those stay as two's complement bytes
+    if(data.isSigned && (inMemoryType.isNull || (data.bits >= 32)))
+        return false;
+
+    if(data.bits < 1)
+        return false;
+
+    if(support->longbitfield)
+        return (data.bits <= 64);
+    else
+        return (data.bits <= 32);
+
+}// ProtocolField::canBitPack
+
+
+/*!
+ * Change the encoded type to a bitfield if the packet or structure is
+ * bitpacked. Bitfields are unsigned, so a signed encoding becomes an unsigned
+ * one whose minimum is the negative of its maximum, which keeps the range and
+ * resolution of the signed encoding.
+ * \param encodedFromInMemory should be true if the encoded type was not given,
+ *        and was copied from the in memory type.
+ */
+void ProtocolField::applyBitPacking(bool encodedFromInMemory)
+{
+    if(encodedType.isBitfield || !canBitPack(encodedType))
+        return;
+
+    encodedType.isBitfield = true;
+
+    // An unspecified encoding of a boolean only needs one bit
+    if(inMemoryType.isBool && encodedFromInMemory)
+        encodedType.bits = 1;
+
+    if(encodedType.isSigned)
+    {
+        encodedType.isSigned = false;
+
+        if(!maxString.empty())
+        {
+            if(ShuntingYard::isNumber(maxString))
+                minString = "-" + maxString;
+            else
+                minString = "-(" + maxString + ")";
+        }
+        else
+        {
+            std::string half = std::to_string(1ull << (encodedType.bits - 1));
+
+            if(scalerString.empty())
+                minString = "-" + half;
+            else
+                minString = "-" + half + "/(" + scalerString + ")";
+        }
+    }
+
+}// ProtocolField::applyBitPacking
+
+
 /*!
  * Parse the DOM to determine the details of this ProtocolField
  * \param nocode should be true to not output any code
@@ -1059,6 +1252,7 @@ void ProtocolField::extractType(TypeData& data, const std::string& typeString, b
 void ProtocolField::parse(bool nocode)
 {
     (void)nocode;
+    ProtocolStats::count("Fields");
     std::string memoryTypeString;
     std::string encodedTypeString;
     std::string structName;
@@ -1079,9 +1273,9 @@ void ProtocolField::parse(bool nocode)
 
     // This will propagate to any of the children we create
     if(ProtocolParser::isFieldSet("limitOnEncode", map))
-        support.limitonencode = true;
+        changeSupport().limitonencode = true;
     else if(ProtocolParser::isFieldClear("limitOnEncode", map))
-        support.limitonencode = false;
+        changeSupport().limitonencode = false;
 
     title = ProtocolParser::getAttribute("title", map);
     memoryTypeString = ProtocolParser::getAttribute("inMemoryType", map);
@@ -1090,6 +1284,7 @@ void ProtocolField::parse(bool nocode)
     maxString = ProtocolParser::getAttribute("max", map);
     minString = ProtocolParser::getAttribute("min", map);
     scalerString = ProtocolParser::getAttribute("scaler", map);
+    resolutionString = ProtocolParser::getAttribute("resolution", map);
     printScalerString = ProtocolParser::getAttribute("printscaler", map);
     array = ProtocolParser::getAttribute("array", map);
     variableArray = ProtocolParser::getAttribute("variableArray", map);
@@ -1144,6 +1339,39 @@ void ProtocolField::parse(bool nocode)
 
     }
 
+    temp = ProtocolParser::getAttribute("delta", map);
+    if(!temp.empty())
+    {
+        if(contains(temp, "element") || ProtocolParser::isFieldSet(temp))
+            deltaElement = true;
+        else if(contains(temp, "packet"))
+            deltaPacket = true;
+        else if(!ProtocolParser::isFieldClear(temp))
+            emitWarning("Value for 'delta' field is incorrect: '" + temp + "'");
+    }
+
+    temp = ProtocolParser::getAttribute("rle", map);
+    if(ProtocolParser::isFieldSet(temp))
+        rle = true;
+    else if(!temp.empty() && !ProtocolParser::isFieldClear(temp))
+        emitWarning("Value for 'rle' field is incorrect: '" + temp + "'");
+
+    temp = ProtocolParser::getAttribute("gather", map);
+    if(ProtocolParser::isFieldSet(temp))
+        gather = true;
+    else if(!temp.empty() && !ProtocolParser::isFieldClear(temp))
+        emitWarning("Value for 'gather' field is incorrect: '" + temp + "'");
+
+    // Dictionary entries are separated by '|', so they can contain spaces and commas
+    temp = ProtocolParser::getAttribute("dictionary", map);
+    if(!temp.empty())
+    {
+        dictionary = split(temp, "|");
+
+        for(std::size_t i = 0; i < dictionary.size(); i++)
+            dictionary[i] = trimm(dictionary.at(i));
+    }
+
     if(name.empty() && (memoryTypeString != "null"))
     {
         emitWarning("Data tag without a name");
@@ -1170,6 +1398,10 @@ void ProtocolField::parse(bool nocode)
     // Extract the in memory type
     extractType(inMemoryType, memoryTypeString, true, enumName);
 
+    // The resolution can choose the encoded type
+    if(!resolutionString.empty())
+        encodedTypeString = getEncodedTypeForResolution(encodedTypeString);
+
     // The encoded type string, this can be empty which implies encoded is same as memory
     if(encodedTypeString.empty())
     {
@@ -1192,11 +1424,13 @@ void ProtocolField::parse(bool nocode)
             inMemoryType = encodedType;
     }
 
+    applyBitPacking(encodedTypeString.empty());
+
     // If we have a hidden field, and we are not supposed to omit code for that
     // field, we treat it as null. This is because we *must* omit the code in
     // order to adhere to the encoding packet rules. This may break some code
     // if other fields depend on the hidden field.
-    if(hidden && !neverOmit && support.omitIfHidden)
+    if(hidden && !neverOmit && support->omitIfHidden)
     {
         comment = "Hidden field skipped";
         inMemoryType.clear();
@@ -1258,8 +1492,8 @@ void ProtocolField::parse(bool nocode)
             {
                 // Make it a multiple of 8 bits. The only way to have something
                 // different is to encode as a bitfield, which means the
-                // encoded string won't be empty
-                if(minbits % 8)
+                // encoded string won't be empty, or the field is bitpacked
+                if((minbits % 8) && !encodedType.isBitfield)
                     minbits = ((minbits/8)+1)*8;
 
                 encodedType.bits = minbits;
@@ -1387,6 +1621,40 @@ void ProtocolField::parse(bool nocode)
         inMemoryType.bits = encodedType.bits = 8;
     }
 
+    if(encodedType.isVarint)
+    {
+        if(inMemoryType.isStruct || encodedType.isString || encodedType.isBitfield)
+        {
+            emitWarning("variable length integer encoding does not apply to this type data");
+            encodedType.isVarint = false;
+        }
+        else
+        {
+            // Variable length integers are 32 bits wide, unless the in memory type needs 64
+            if((inMemoryType.bits > 32) && support->int64)
+                encodedType.bits = 64;
+            else
+                encodedType.bits = 32;
+
+            // A maximum would scale the value to use the full width, which defeats the purpose
+            if(!maxString.empty())
+            {
+                emitWarning("max is ignored for variable length integers, use scaler instead");
+                maxString.clear();
+            }
+
+            // Reserved space is skipped by decoding it, which we only do once
+            if(inMemoryType.isNull && !array.empty())
+            {
+                emitWarning("reserved variable length integers cannot be arrays");
+                array.clear();
+                variableArray.clear();
+                array2d.clear();
+                variable2dArray.clear();
+            }
+        }
+    }
+
     if(array.empty() && !variableArray.empty())
     {
         emitWarning("Must specify array length to specify variable array length");
@@ -1704,6 +1972,20 @@ void ProtocolField::parse(bool nocode)
         emitWarning("max is not more than min, encoding not scaled");
     }
 
+    // Check the resolution the scaling actually achieves
+    if(!resolutionString.empty())
+    {
+        resolution = ShuntingYard::computeInfix(parser->replaceEnumerationNameWithValue(resolutionString), &ok);
+
+        if(encodedType.isFloat)
+        {
+            emitWarning("resolution does not apply to floating point encodings");
+            resolution = 0.0;
+        }
+        else if((1.0/scaler) > resolution*(1.0 + 1e-9))
+            emitWarning("encoded resolution is " + getDisplayNumberString(1.0/scaler) + ", which is coarser than the requested " + getDisplayNumberString(resolution));
+    }
+
     if(inMemoryType.isFloat && !encodedType.isFloat && !inMemoryType.isNull && !encodedType.isNull)
     {
         // If the user wants to convert a float to an integer they should be
@@ -1717,7 +1999,7 @@ void ProtocolField::parse(bool nocode)
     }
 
     // Just the type data
-    typeName = inMemoryType.toTypeString(support.prefix + structName);
+    typeName = inMemoryType.toTypeString(support->prefix + structName);
 
     if(!constantString.empty())
     {
@@ -1731,6 +2013,85 @@ void ProtocolField::parse(bool nocode)
     // Make sure no keyword conflicts
     checkAgainstKeywords();
 
+    if(deltaElement || deltaPacket)
+    {
+        if(deltaElement && array.empty())
+        {
+            emitWarning("delta encoding between elements only applies to arrays, ignored");
+            deltaElement = false;
+        }
+        else if(inMemoryType.isNull || inMemoryType.isStruct || inMemoryType.isString || inMemoryType.isFloat || inMemoryType.isBool || inMemoryType.isEnum || encodedType.isNull || encodedType.isBitfield)
+        {
+            emitWarning("delta encoding only applies to integers, ignored");
+            deltaElement = deltaPacket = false;
+        }
+        else if(encodedType.isFloat || !encodedType.isSigned)
+        {
+            emitWarning("delta encoding requires a signed integer encoding, ignored");
+            deltaElement = deltaPacket = false;
+        }
+        else if(isFloatScaling() || isIntegerScaling() || !constantString.empty())
+        {
+            emitWarning("delta encoding cannot be combined with scaling or a constant, ignored");
+            deltaElement = deltaPacket = false;
+        }
+        else if((encodedType.bits < inMemoryType.bits) && ((inMemoryType.bits > 32) || ((inMemoryType.bits > 16) && !support->int64)))
+        {
+            // Narrow encodings limit the difference, which needs a wider type to compute
+            emitWarning("delta encoding of this in-memory type requires an encoding at least as wide, ignored");
+            deltaElement = deltaPacket = false;
+        }
+        else if(encodedType.bits < inMemoryType.bits)
+        {
+            // The encoded differences are limited, which loses data until later values catch up
+            emitWarning("delta encoding is narrower than the in-memory type, larger differences are limited");
+        }
+    }
+
+    if(rle)
+    {
+        if(!isArray() || is2dArray() || inMemoryType.isNull || inMemoryType.isStruct || inMemoryType.isString || inMemoryType.isFloat || inMemoryType.isBool || inMemoryType.isEnum || (inMemoryType.bits != 8) ||
+           (encodedType.bits != 8) || encodedType.isFloat || encodedType.isBitfield || encodedType.isVarint)
+        {
+            emitWarning("rle only applies to one dimensional arrays of bytes, ignored");
+            rle = false;
+        }
+        else if(isFloatScaling() || isIntegerScaling() || !constantString.empty() || !defaultString.empty() || deltaElement || deltaPacket)
+        {
+            emitWarning("rle cannot be combined with scaling, a constant, a default, or delta encoding, ignored");
+            rle = false;
+        }
+    }
+
+    if(!dictionary.empty())
+    {
+        bool ok = false;
+        int maxLength = (int)ShuntingYard::computeInfix(parser->replaceEnumerationNameWithValue(array), &ok);
+
+        if(!inMemoryType.isString)
+        {
+            emitWarning("dictionary only applies to strings, ignored");
+            dictionary.clear();
+        }
+        else if(!constantString.empty())
+        {
+            emitWarning("dictionary cannot be combined with a constant, ignored");
+            dictionary.clear();
+        }
+        else if(dictionary.size() > 255)
+        {
+            // The index 255 means the string itself follows
+            emitWarning("dictionary is limited to 255 entries");
+            dictionary.resize(255);
+        }
+
+        for(std::size_t i = 0; ok && (i < dictionary.size()); i++)
+        {
+            if((int)dictionary.at(i).size() >= maxLength)
+                emitWarning("dictionary entry \"" + dictionary.at(i) + "\" is too long for the string");
+        }
+    }
+
     // Work out the limits that come from the encoding rules
     if(isFloatScaling() || isIntegerScaling())
     {
@@ -1773,18 +2134,16 @@ void ProtocolField::parse(bool nocode)
     }
     else
     {
-        limitMinValue = (double)encodedType.getMinimumIntegerValue();
-        limitMaxValue = (double)encodedType.getMaximumIntegerValue();
+        // Delta encoding limits the differences, not the values, and a narrow
+        // variable length integer is limited to the in-memory range
+        const TypeData& limitType = (deltaElement || deltaPacket || isNarrowVarint()) ? inMemoryType : encodedType;
 
-        if(limitMaxValue >= 0)
-            limitMaxStringForComment = limitMaxString = std::to_string((uint64_t)round(limitMaxValue));
-        else
-            limitMaxStringForComment = limitMaxString = std::to_string((int64_t)round(limitMaxValue));
+        limitMinValue = (double)limitType.getMinimumIntegerValue();
+        limitMaxValue = (double)limitType.getMaximumIntegerValue();
 
-        if(limitMinValue >= 0)
-            limitMinStringForComment = limitMinString = std::to_string((uint64_t)round(limitMinValue));
-        else
-            limitMinStringForComment = limitMinString = std::to_string((int64_t)round(limitMinValue));
+        // The strings come from the integers, since a double cannot hold the 64-bit limits exactly
+        limitMaxStringForComment = limitMaxString = std::to_string(limitType.getMaximumIntegerValue());
+        limitMinStringForComment = limitMinString = std::to_string(limitType.getMinimumIntegerValue());
     }
 
     // Now handle the verify maximum value
@@ -1811,6 +2170,10 @@ void ProtocolField::parse(bool nocode)
         verifyMinValue = ShuntingYard::computeInfix(parser->replaceEnumerationNameWithValue(verifyMinString), &hasVerifyMinValue);
     }
 
+    // The encode limits are known now, which gather has to check
+    if(gather && !canGather())
+        gather = false;
+
     // Support the case where a numeric string uses "pi" or "e".
     defaultStringForDisplay = handleNumericConstants(defaultString);
     constantStringForDisplay = handleNumericConstants(constantString);
@@ -1867,10 +2230,10 @@ std::string ProtocolField::handleNumericConstants(std::string& input) const
     else
     {
         // There are two non-numeric cases we can handle: the get API string and the get version string
-        if(!support.api.empty() && (display == "get" + support.protoName + "Api()"))
-            display = support.api;
-        else if(!support.version.empty() && (display == "get" + support.protoName + "Version()"))
-            display = support.version;
+        if(!support->api.empty() && (display == "get" + support->protoName + "Api()"))
+            display = support->api;
+        else if(!support->version.empty() && (display == "get" + support->protoName + "Version()"))
+            display = support->version;
     }
 
     return display;
@@ -1961,7 +2324,13 @@ void ProtocolField::computeEncodedLength(void)
         }
     }
     else if(inMemoryType.isString)
-        encodedLength.addToLength(array, !inMemoryType.isFixedString, false, !dependsOn.empty(), !defaultString.empty());
+    {
+        // A dictionary index is one byte, which is followed by the string only if it is not in the dictionary
+        if(dictionary.empty())
+            encodedLength.addToLength(array, !inMemoryType.isFixedString, false, !dependsOn.empty(), !defaultString.empty());
+        else
+            encodedLength.addRangeToLength("1", "1+" + array, false, !dependsOn.empty(), !defaultString.empty());
+    }
     else if(inMemoryType.isStruct)
     {
         encodedLength.clear();
@@ -1981,6 +2350,45 @@ void ProtocolField::computeEncodedLength(void)
                 encodedLength.addToLength("getMinLengthOf" + typeName + "()"         , false, false,                    !dependsOn.empty(), (!defaultString.empty()) || overridesPrevious);
         }
     }
+    else if(encodedType.isVarint)
+    {
+        // At least one byte, and at most one byte for every 7 bits
+        std::string minLengthString = "1";
+        std::string maxLengthString = std::to_string((encodedType.bits + 6) / 7);
+
+        // Remember that we could be encoding an array
+        if(isArray())
+        {
+            minLengthString += "*" + array;
+            maxLengthString += "*" + array;
+        }
+
+        if(is2dArray())
+        {
+            minLengthString += "*" + array2d;
+            maxLengthString += "*" + array2d;
+        }
+
+        encodedLength.addRangeToLength(minLengthString, maxLengthString, !variableArray.empty() || !variable2dArray.empty(), !dependsOn.empty(), (!defaultString.empty()) || overridesPrevious);
+    }
+    else if(rle)
+    {
+        // Run length compression adds at most one byte for every 128 bytes.
+        // Every 130 bytes need at least two bytes.
+        std::string minLengthString = "2";
+        std::string maxLengthString = "2*" + array;
+
+        bool ok = false;
+        int number = (int)(ShuntingYard::computeInfix(parser->replaceEnumerationNameWithValue(array), &ok) + 0.5);
+
+        if(ok && (number > 0))
+        {
+            minLengthString = std::to_string(2*((number + 129)/130));
+            maxLengthString = std::to_string(number + (number + 127)/128);
+        }
+
+        encodedLength.addRangeToLength(minLengthString, maxLengthString, !variableArray.empty(), !dependsOn.empty(), overridesPrevious);
+    }
     else
     {
         std::string lengthString = std::to_string(encodedType.bits / 8);
@@ -2072,6 +2480,48 @@ std::string ProtocolField::getDeclaration(void) const
     else if(isArray())
         output += "[" + array + "]";
 
+    // C++ members are initialized where they are declared
+    if(isDefaultMemberInitialized())
+    {
+        std::string initial = getCppInitialValue();
+
+        // Array elements after the first are zeroed by the brace initializer,
+        // so a non-zero initial value is replicated to every element. If the
+        // array size cannot be resolved only the first element is set.
+        bool ok = false;
+        std::string replicated;
+        if(isArray() && !inMemoryType.isString)
+        {
+            std::string value = initial;
+            if(inMemoryType.isFloat && endsWith(value, "f"))
+                value.pop_back();
+            else if(inMemoryType.isBool)
+            {
+                replaceinplace(value, "(bool)", "");
+                replaceinplace(value, "false", "0");
+                replaceinplace(value, "true", "1");
+            }
+
+            bool zero = false;
+            if((ShuntingYard::computeInfix(parser->replaceEnumerationNameWithValue(value), &zero) != 0) || !zero)
+            {
+                ok = true;
+                replicated = getArrayStaticInitializer(initial, &ok);
+            }
+        }
+
+        if(inMemoryType.isString)
+            output += " = " + initial;
+        else if(isArray() && ok)
+            output += " = " + replicated;
+        else if(is2dArray())
+            output += " = {{" + initial + "}}";
+        else if(isArray())
+            output += " = {" + initial + "}";
+        else
+            output += " = " + initial;
+    }
+
     output += ";";
 
     if(comment.empty())
@@ -2196,6 +2646,24 @@ void ProtocolField::getMapIncludeDirectives(std::vector<std::string>& list) cons
 }// ProtocolField::getMapIncludeDirectives
 
 
+/*!
+ * Return the include directives needed for this encodable's JSON and CBOR functions
+ * \param list is push_backed with any directives this encodable requires.
+ */
+void ProtocolField::getJsonIncludeDirectives(std::vector<std::string>& list) const
+{
+    if(inMemoryType.isStruct)
+    {
+        const ProtocolStructureModule* struc = parser->lookUpStructure(typeName);
+
+        if(struc != NULL)
+            struc->getJsonIncludeDirectives(list);
+
+    }// if struct
+
+}// ProtocolField::getJsonIncludeDirectives
+
+
 /*!
  * Return the include directives needed for this encodable's compare functions
  * \param list is push_backed with any directives this encodable requires.
@@ -2447,6 +2915,13 @@ void ProtocolField::getDocumentationDetails(std::vector<int>& outline, std::stri
                 else
                     encodings.push_back("F" + std::to_string(encodedType.bits));
             }
+            else if(encodedType.isVarint)
+            {
+                if(encodedType.isSigned)
+                    encodings.push_back("VI" + std::to_string(encodedType.bits));
+                else
+                    encodings.push_back("VU" + std::to_string(encodedType.bits));
+            }
             else if(encodedType.isSigned)
                 encodings.push_back("I" + std::to_string(encodedType.bits));
             else
@@ -2475,7 +2950,7 @@ void ProtocolField::getDocumentationDetails(std::vector<int>& outline, std::stri
         if(!description.empty() && !endsWith(description, "."))
             description += ".";
 
-        if(support.limitonencode && (!verifyMinStringForDisplay.empty() || !verifyMaxStringForDisplay.empty()))
+        if(support->limitonencode && (!verifyMinStringForDisplay.empty() || !verifyMaxStringForDisplay.empty()))
         {
             if(!verifyMinStringForDisplay.empty() && !verifyMaxStringForDisplay.empty())
                 description += "<br>Value is limited on encode from " + verifyMinStringForDisplay + " to " + verifyMaxStringForDisplay + ".";
@@ -2493,6 +2968,21 @@ void ProtocolField::getDocumentationDetails(std::vector<int>& outline, std::stri
         if(!constantString.empty())
             description += "<br>Data are given constant value on encode " + constantStringForDisplay + ".";
 
+        if(resolution > 0.0)
+            description += "<br>Resolution is " + getDisplayNumberString(1.0/scaler) + ", quantization error is up to " + getDisplayNumberString(0.5/scaler) + ".";
+
+        if(deltaElement)
+            description += "<br>Each element is encoded as the difference from the previous element, the first from zero.";
+
+        if(deltaPacket)
+            description += "<br>Encoded as the difference from the previous packet by the diff functions, otherwise from zero.";
+
+        if(rle)
+            description += "<br>Bytes are run length compressed, which adds at most one byte for every 128 bytes.";
+
+        if(!dictionary.empty())
+            description += "<br>Encoded as a one byte index if the string is one of \"" + join(dictionary, "\", \"") + "\" (index 0 to " + std::to_string(dictionary.size() - 1) + "), otherwise as 255 followed by the string.";
+
         if(!dependsOn.empty())
         {
             if(dependsOnValue.empty())
@@ -2564,6 +3054,47 @@ std::string ProtocolField::getEncodeString(int* bitcount, bool isStructureMember
 }
 
 
+/*!
+ * Get the next lines(s) of source coded needed to encode this field in the
+ * diff encode. A delta="packet" field is encoded as the difference from
+ * _pg_state, which is updated to what the decoder will see; any other field is
+ * encoded as it is by getEncodeString().
+ * \param bitcount points to the running count of bits in a bitfields and should persist between calls
+ * \param isStructureMember should be true if the left hand side is a
+ *        member of a user structure, else the left hand side is a pointer
+ *        to the inMemoryType
+ * \return The string to add to the source file that encodes this field.
+ */
+std::string ProtocolField::getDiffEncodeString(int* bitcount, bool isStructureMember) const
+{
+    if(deltaPacket)
+        return getEncodeStringForField(isStructureMember, true);
+    else
+        return getEncodeString(bitcount, isStructureMember);
+
+}// ProtocolField::getDiffEncodeString
+
+
+/*!
+ * Get the next lines(s) of source coded needed to decode this field in the
+ * diff decode. The difference of a delta="packet" field is added to the
+ * retained value; any other field is decoded as it is by getDecodeString().
+ * \param bitcount points to the running count of bits in a bitfields and should persist between calls
+ * \param isStructureMember should be true if the left hand side is a
+ *        member of a user structure, else the left hand side is a pointer
+ *        to the inMemoryType
+ * \return The string to add to the source file that decodes this field.
+ */
+std::string ProtocolField::getDiffDecodeString(int* bitcount, bool isStructureMember) const
+{
+    if(deltaPacket)
+        return getDecodeStringForField(isStructureMember, false, true);
+    else
+        return getDecodeString(bitcount, isStructureMember, false);
+
+}// ProtocolField::getDiffDecodeString
+
+
 /*!
  * Get the next lines(s) of source coded needed to decode this field
  * \param bitcount points to the running count of bits in a bitfields and should persist between calls
@@ -2655,11 +3186,15 @@ std::string ProtocolField::getVerifyString(void) const
     if(!comment.empty())
         output += spacing + "// " + comment + "\n";
 
+    // Arrays of numbers are clamped in a single pass without branches
+    if(usesVerifyClampLoop())
+        return output + getVerifyClampLoopString();
+
     output += getEncodeArrayIterationCode(spacing, true);
 
     if(inMemoryType.isStruct)
     {
-        if(support.language == ProtocolSupport::c_language)
+        if(support->language == ProtocolSupport::c_language)
             access = "&_pg_user->" + name;
         else
             access = name;  // in this case, name is already pointer, so we don't need "&"
@@ -2668,7 +3203,7 @@ std::string ProtocolField::getVerifyString(void) const
         {
             arrayspacing += TAB_IN;
 
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
                 access = "&_pg_user->" + name + "[_pg_i]";
             else
                 access = name + "[_pg_i]";
@@ -2682,7 +3217,7 @@ std::string ProtocolField::getVerifyString(void) const
         }
 
         // This calls the verify function
-        if(support.language == ProtocolSupport::c_language)
+        if(support->language == ProtocolSupport::c_language)
         {
             output += spacing + arrayspacing + "if(!verify" + typeName + "(" + access + "))\n";
             output += spacing + arrayspacing + TAB_IN + "_pg_good = 0;\n";
@@ -2697,10 +3232,10 @@ std::string ProtocolField::getVerifyString(void) const
     else
     {
         std::string failedvalue = "false";
-        if(support.language == ProtocolSupport::c_language)
+        if(support->language == ProtocolSupport::c_language)
             failedvalue = "0";
 
-        if(support.language == ProtocolSupport::c_language)
+        if(support->language == ProtocolSupport::c_language)
             access = "_pg_user->" + name;
         else
             access = name;
@@ -2709,7 +3244,7 @@ std::string ProtocolField::getVerifyString(void) const
         {
             arrayspacing += TAB_IN;
 
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
                 access = "_pg_user->" + name + "[_pg_i]";
             else
                 access = name + "[_pg_i]";
@@ -2752,21 +3287,164 @@ std::string ProtocolField::getVerifyString(void) const
 
 
 /*!
-* Get the string used for comparing this field.
-* \return the string used to compare this field, which may be empty
-*/
-std::string ProtocolField::getComparisonString(void) const
+ * Determine if this field is verified with a branch free clamp loop. This is
+ * true for arrays of numbers.
+ * \return true if getVerifyClampLoopString() is used to verify this field
+ */
+bool ProtocolField::usesVerifyClampLoop(void) const
+{
+    if(!isArray() || !hasVerify())
+        return false;
+
+    if(inMemoryType.isNull || inMemoryType.isString || inMemoryType.isStruct || inMemoryType.isEnum || inMemoryType.isBitfield)
+        return false;
+
+    return true;
+
+}// ProtocolField::usesVerifyClampLoop
+
+
+/*!
+ * Get the code that verifies an array of numbers. Each row of the array is
+ * one contiguous run of elements and each element is clamped with conditional
+ * moves rather than branches, so the loop can be vectorized. Whether any
+ * element was clamped is tracked in the same pass.
+ * \return the code that verifies this array
+ */
+std::string ProtocolField::getVerifyClampLoopString(void) const
 {
     std::string output;
+    std::string spacing = TAB_IN + TAB_IN;
+    std::string access;
+    std::string index = "_pg_i";
 
-    // No comparison if nothing is in memory or if not encoded
-    if(inMemoryType.isNull || encodedType.isNull)
-        return output;
+    if(support->language == ProtocolSupport::c_language)
+        access = "_pg_user->" + name;
+    else
+        access = name;
 
-    if(inMemoryType.isString)
+    output += TAB_IN + "{\n";
+
+    // C99 lets us promise the compiler there is no aliasing, C++ has no standard equivalent
+    std::string pointer = typeName + "* _pg_data = ";
+    if(support->language == ProtocolSupport::c_language)
+        pointer = typeName + "* restrict _pg_data = ";
+
+    // Compare once, then select, so that the compiler can if-convert the loop
+    std::string flag = "int ";
+    std::string none = "0";
+    std::string failedvalue = "0";
+    if(support->language == ProtocolSupport::cpp_language)
     {
-        if(support.language == ProtocolSupport::c_language)
-            output += TAB_IN + "if(std::string(_pg_user1->" + name + ").compare(_pg_user2->" + name + ") != 0)\n";
+        flag = "bool ";
+        none = failedvalue = "false";
+    }
+
+    if(!is2dArray())
+        output += spacing + pointer + "&" + access + "[0];\n";
+
+    if(variableArray.empty())
+        output += spacing + "unsigned _pg_count = " + array + ";\n";
+    else
+    {
+        output += spacing + "unsigned _pg_count = (unsigned)" + getEncodeFieldAccess(true, variableArray) + ";\n";
+        output += spacing + "if(_pg_count > " + array + ")\n";
+        output += spacing + TAB_IN + "_pg_count = " + array + ";\n";
+    }
+
+    // The second dimension is the contiguous run of each row
+    if(is2dArray())
+    {
+        if(variable2dArray.empty())
+            output += spacing + "unsigned _pg_count2d = " + array2d + ";\n";
+        else
+        {
+            output += spacing + "unsigned _pg_count2d = (unsigned)" + getEncodeFieldAccess(true, variable2dArray) + ";\n";
+            output += spacing + "if(_pg_count2d > " + array2d + ")\n";
+            output += spacing + TAB_IN + "_pg_count2d = " + array2d + ";\n";
+        }
+    }
+
+    output += spacing + flag + "_pg_clamped = " + none + ";\n";
+    output += "\n";
+    output += spacing + "for(_pg_i = 0; _pg_i < _pg_count; _pg_i++)\n";
+    output += spacing + "{\n";
+
+    if(is2dArray())
+    {
+        output += spacing + TAB_IN + pointer + "&" + access + "[_pg_i][0];\n";
+        output += "\n";
+        output += spacing + TAB_IN + "for(_pg_j = 0; _pg_j < _pg_count2d; _pg_j++)\n";
+        output += spacing + TAB_IN + "{\n";
+        spacing += TAB_IN;
+        index = "_pg_j";
+    }
+
+    std::string min = inMemoryType.applyTypeToConstant(verifyMinString);
+    std::string max = inMemoryType.applyTypeToConstant(verifyMaxString);
+    std::string select = "_pg_value";
+
+    output += spacing + TAB_IN + typeName + " _pg_value = _pg_data[" + index + "];\n";
+
+    if(!verifyMinString.empty())
+        output += spacing + TAB_IN + flag + "_pg_low = (_pg_value < " + min + ");\n";
+
+    if(!verifyMaxString.empty())
+    {
+        output += spacing + TAB_IN + flag + "_pg_high = (_pg_value > " + max + ");\n";
+        select = "_pg_high ? " + max + " : " + select;
+    }
+
+    if(!verifyMinString.empty())
+    {
+        if(verifyMaxString.empty())
+            select = "_pg_low ? " + min + " : " + select;
+        else
+            select = "_pg_low ? " + min + " : (" + select + ")";
+    }
+
+    if(verifyMinString.empty())
+        output += spacing + TAB_IN + "_pg_clamped |= _pg_high;\n";
+    else if(verifyMaxString.empty())
+        output += spacing + TAB_IN + "_pg_clamped |= _pg_low;\n";
+    else
+        output += spacing + TAB_IN + "_pg_clamped |= _pg_low | _pg_high;\n";
+
+    output += spacing + TAB_IN + "_pg_data[" + index + "] = " + select + ";\n";
+    output += spacing + "}\n";
+
+    if(is2dArray())
+    {
+        spacing = TAB_IN + TAB_IN;
+        output += spacing + "}\n";
+    }
+
+    output += "\n";
+    output += spacing + "if(_pg_clamped)\n";
+    output += spacing + TAB_IN + "_pg_good = " + failedvalue + ";\n";
+    output += TAB_IN + "}\n";
+
+    return output;
+
+}// ProtocolField::getVerifyClampLoopString
+
+
+/*!
+* Get the string used for comparing this field.
+* \return the string used to compare this field, which may be empty
+*/
+std::string ProtocolField::getComparisonString(void) const
+{
+    std::string output;
+
+    // No comparison if nothing is in memory or if not encoded
+    if(inMemoryType.isNull || encodedType.isNull)
+        return output;
+
+    if(inMemoryType.isString)
+    {
+        if(support->language == ProtocolSupport::c_language)
+            output += TAB_IN + "if(std::string(_pg_user1->" + name + ").compare(_pg_user2->" + name + ") != 0)\n";
         else
             output += TAB_IN + "if(std::string(" + name + ").compare(_pg_user->" + name + ") != 0)\n";
 
@@ -2781,7 +3459,7 @@ std::string ProtocolField::getComparisonString(void) const
         bool closeforloop2 = false;
 
         std::string access1, access2;
-        if(support.language == ProtocolSupport::c_language)
+        if(support->language == ProtocolSupport::c_language)
         {
             access1 = "_pg_user1->" + name;
             access2 = "_pg_user2->" + name;
@@ -2797,7 +3475,7 @@ std::string ProtocolField::getComparisonString(void) const
         {
             if(!variableArray.empty())
             {
-                if(support.language == ProtocolSupport::c_language)
+                if(support->language == ProtocolSupport::c_language)
                     output += spacing + "if(_pg_user1->" + variableArray + " == _pg_user2->" + variableArray + ")\n";
                 else
                     output += spacing + "if(" + variableArray + " == _pg_user->" + variableArray + ")\n";
@@ -2806,7 +3484,7 @@ std::string ProtocolField::getComparisonString(void) const
                 spacing += TAB_IN;
                 closearraytest = true;
 
-                if(support.language == ProtocolSupport::c_language)
+                if(support->language == ProtocolSupport::c_language)
                     output += spacing + "for(_pg_i = 0; (_pg_i < " + array + ") && (_pg_i < (unsigned)_pg_user1->" + variableArray + "); _pg_i++)\n";
                 else
                     output += spacing + "for(_pg_i = 0; (_pg_i < " + array + ") && (_pg_i < (unsigned)" + variableArray + "); _pg_i++)\n";
@@ -2829,7 +3507,7 @@ std::string ProtocolField::getComparisonString(void) const
         {
             if(!variable2dArray.empty())
             {
-                if(support.language == ProtocolSupport::c_language)
+                if(support->language == ProtocolSupport::c_language)
                     output += spacing + "if(_pg_user1->" + variable2dArray + " == _pg_user2->" + variable2dArray + ")\n";
                 else
                     output += spacing + "if(" + variable2dArray + " == _pg_user->" + variable2dArray + ")\n";
@@ -2838,7 +3516,7 @@ std::string ProtocolField::getComparisonString(void) const
                 spacing += TAB_IN;
                 closearraytest2 = true;
 
-                if(support.language == ProtocolSupport::c_language)
+                if(support->language == ProtocolSupport::c_language)
                     output += spacing + "for(_pg_j = 0; (_pg_j < " + array2d + ") && (_pg_j < (unsigned)_pg_user1->" + variable2dArray + "); _pg_j++)\n";
                 else
                     output += spacing + "for(_pg_j = 0; (_pg_j < " + array2d + ") && (_pg_j < (unsigned)" + variable2dArray + "); _pg_j++)\n";
@@ -2859,7 +3537,7 @@ std::string ProtocolField::getComparisonString(void) const
 
         if(inMemoryType.isStruct)
         {
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
                 output += spacing + "_pg_report += compare" + typeName + "(_pg_prename + \":" + name + "\"";
             else
                 output += spacing + "_pg_report += " + access1 + ".compare(_pg_prename + \":" + name + "\"";
@@ -2871,7 +3549,7 @@ std::string ProtocolField::getComparisonString(void) const
                 output += " + \"[\" + std::to_string(_pg_j) + \"]\"";
 
             // Structure compare we need to pass the address of the structure, not the object
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
                 output += ", &" + access1 + ", &" + access2 + ");\n";
             else
                 output += ", &" + access2 + ");\n";
@@ -2968,7 +3646,7 @@ std::string ProtocolField::getTextPrintString(void) const
 
         if(inMemoryType.isStruct)
         {
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
             {
                 // In case of a structure redefines
                 std::string signame = typeName;
@@ -2987,7 +3665,7 @@ std::string ProtocolField::getTextPrintString(void) const
             if(is2dArray())
                 output += " + \"[\" + std::to_string(_pg_j) + \"]\"";
 
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
                 output += ", " + getEncodeFieldAccess(true);
 
             output += ");\n";
@@ -3038,7 +3716,7 @@ std::string ProtocolField::getTextReadString(void) const
     if(inMemoryType.isString)
     {
         // Notice the use of the "pg" copy function, which is just like strncpy but without the security vulnerabilities
-        output += TAB_IN + "pgstrncpy(" + getDecodeFieldAccess(true) + ", extractText(_pg_prename + \":" + name + "\", _pg_source, &_pg_fieldcount).c_str(), " + array + ");\n";
+        output += TAB_IN + "pgstrncpy(" + getDecodeFieldAccess(true) + ", std::string(extractText(_pg_prename + \":" + name + "\", _pg_source, &_pg_fieldcount, _pg_cursor)).c_str(), " + array + ");\n";
     }
     else
     {
@@ -3060,7 +3738,7 @@ std::string ProtocolField::getTextReadString(void) const
 
         if(inMemoryType.isStruct)
         {
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
             {
                 // In case of a structure redefines
                 std::string signame = typeName;
@@ -3080,10 +3758,10 @@ std::string ProtocolField::getTextReadString(void) const
                 output += " + \"[\" + std::to_string(_pg_j) + \"]\"";
 
             // Structure read, we need to pass the address of the structure, not the object
-            if(support.language == ProtocolSupport::c_language)
-                output += ", _pg_source, " + getDecodeFieldAccess(true) + ");\n";
+            if(support->language == ProtocolSupport::c_language)
+                output += ", _pg_source, " + getDecodeFieldAccess(true) + ", _pg_cursor);\n";
             else
-                output += ", _pg_source);\n";
+                output += ", _pg_source, _pg_cursor);\n";
         }
         else
         {
@@ -3099,32 +3777,22 @@ std::string ProtocolField::getTextReadString(void) const
                     output += " + \"[\" + std::to_string(_pg_j) + \"]\"";
             }
 
-            output += ", _pg_source, &_pg_fieldcount);\n";
+            output += ", _pg_source, &_pg_fieldcount, _pg_cursor);\n";
 
             // Check the text and get a result if it is not empty
             output += spacing + "if(!_pg_text.empty())\n";
 
-            // Prefer std::strtox instead of std::stox because the former does not throw and exception and we can tell it to automatically interpret the base
+            // textToNumber uses std::from_chars, which does not throw or allocate, and falls back to std::strtox to interpret other bases
             if(!readScalerString.empty())
-                output += spacing + TAB_IN + getDecodeFieldAccess(true) + " = (" + typeName + ")(std::strtod(_pg_text.c_str(), 0)" + readScalerString + ");\n";
+                output += spacing + TAB_IN + getDecodeFieldAccess(true) + " = (" + typeName + ")(textToNumber<double>(_pg_text)" + readScalerString + ");\n";
             else if(inMemoryType.isFloat && (inMemoryType.bits > 32))
-                output += spacing + TAB_IN + getDecodeFieldAccess(true) + " = std::strtod(_pg_text.c_str(), 0);\n";
+                output += spacing + TAB_IN + getDecodeFieldAccess(true) + " = textToNumber<double>(_pg_text);\n";
             else if(inMemoryType.isFloat)
-                output += spacing + TAB_IN + getDecodeFieldAccess(true) + " = std::strtof(_pg_text.c_str(), 0);\n";
+                output += spacing + TAB_IN + getDecodeFieldAccess(true) + " = textToNumber<float>(_pg_text);\n";
             else if(inMemoryType.isSigned)
-            {
-                if(inMemoryType.bits > 32)
-                    output += spacing + TAB_IN + getDecodeFieldAccess(true) + " = (" + typeName + ")(std::strtoll(_pg_text.c_str(), 0, 0));\n";
-                else
-                    output += spacing + TAB_IN + getDecodeFieldAccess(true) + " = (" + typeName + ")(std::strtol(_pg_text.c_str(), 0, 0));\n";
-            }
+                output += spacing + TAB_IN + getDecodeFieldAccess(true) + " = (" + typeName + ")(textToNumber<long long>(_pg_text));\n";
             else
-            {
-                if(inMemoryType.bits > 32)
-                    output += spacing + TAB_IN + getDecodeFieldAccess(true) + " = (" + typeName + ")(std::strtoull(_pg_text.c_str(), 0, 0));\n";
-                else
-                    output += spacing + TAB_IN + getDecodeFieldAccess(true) + " = (" + typeName + ")(std::strtoul(_pg_text.c_str(), 0, 0));\n";
-            }
+                output += spacing + TAB_IN + getDecodeFieldAccess(true) + " = (" + typeName + ")(textToNumber<unsigned long long>(_pg_text));\n";
 
         }// else not a struct
 
@@ -3164,6 +3832,9 @@ std::string ProtocolField::getMapEncodeString(void) const
     if(!comment.empty())
         output += TAB_IN + "// " + comment + "\n";
 
+    if(support->flatmap)
+        return output + getFlatMapEncodeString();
+
     if(inMemoryType.isString)
     {
         output += TAB_IN + "_pg_map[_pg_prename + \":" + name + "\"] = QString(" + getEncodeFieldAccess(true) + ");\n";
@@ -3182,7 +3853,7 @@ std::string ProtocolField::getMapEncodeString(void) const
 
         if(inMemoryType.isStruct)
         {
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
             {
                 // In case of a structure redefines
                 std::string signame = typeName;
@@ -3200,7 +3871,7 @@ std::string ProtocolField::getMapEncodeString(void) const
             if(is2dArray())
                 output += " + \"[\" + QString::number(_pg_j) + \"]\"";
 
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
                 output += ", _pg_map, " + getEncodeFieldAccess(true) + ");\n";
             else
                 output += ", _pg_map);\n";
@@ -3220,7 +3891,7 @@ std::string ProtocolField::getMapEncodeString(void) const
             // Numeric values are automatically converted to correct QVariant types
             if(inMemoryType.isFloat || !printScalerString.empty())
                 output += getEncodeFieldAccess(true) + printScalerString;
-            else if (inMemoryType.isBool && (support.language == ProtocolSupport::c_language || support.language == ProtocolSupport::cpp_language))
+            else if (inMemoryType.isBool && (support->language == ProtocolSupport::c_language || support->language == ProtocolSupport::cpp_language))
             {
                 // Ensure that boolean types are encoded as unsigned chars
                 output += "(unsigned char) " + getEncodeFieldAccess(true);
@@ -3260,6 +3931,9 @@ std::string ProtocolField::getMapDecodeString(void) const
     if(!comment.empty())
         output += TAB_IN + "// " + comment + "\n";
 
+    if(support->flatmap)
+        return output + getFlatMapDecodeString();
+
     if(inMemoryType.isString)
     {
         key = "_pg_prename + \":" + name + "\"";
@@ -3289,7 +3963,7 @@ std::string ProtocolField::getMapDecodeString(void) const
 
         if(inMemoryType.isStruct)
         {
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
             {
                 // In case of a structure redefines
                 std::string signame = typeName;
@@ -3307,7 +3981,7 @@ std::string ProtocolField::getMapDecodeString(void) const
             if(is2dArray())
                 output += " + \"[\" + QString::number(_pg_j) + \"]\"";
 
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
                 output += ", _pg_map, " + getDecodeFieldAccess(true) + ");\n";
             else
                 output += ", _pg_map);\n";
@@ -3375,6 +4049,267 @@ std::string ProtocolField::getMapDecodeString(void) const
 }// ProtocolField::getMapDecodeString
 
 
+/*!
+ * Get the string used for storing this field in a flat map. Unlike the Qt
+ * map the key is an integer computed from the parent key, the identifier of
+ * this field, and the array indices; so no strings are built at runtime.
+ * \return the string used to store this field in the map, which may be empty
+ */
+std::string ProtocolField::getFlatMapEncodeString(void) const
+{
+    std::string output;
+
+    if(inMemoryType.isString)
+    {
+        output += TAB_IN + "_pg_map.insert(" + getFlatMapKey() + ", (const char*)" + getEncodeFieldAccess(true) + ");\n";
+        return output;
+    }
+
+    std::string spacing = TAB_IN;
+
+    output += getEncodeArrayIterationCode(spacing, true);
+    if(isArray())
+    {
+        spacing += TAB_IN;
+        if(is2dArray())
+            spacing += TAB_IN;
+    }
+
+    if(inMemoryType.isStruct)
+    {
+        if(support->language == ProtocolSupport::c_language)
+        {
+            // In case of a structure redefines
+            std::string signame = typeName;
+            const ProtocolStructure* mystruct = parser->lookUpStructure(typeName);
+            if(mystruct != nullptr)
+                signame = mystruct->getStructName();
+
+            output += spacing + "mapEncode" + signame + "(" + getFlatMapKey() + ", _pg_map, " + getEncodeFieldAccess(true) + ");\n";
+        }
+        else
+            output += spacing + getEncodeFieldAccess(true) + ".mapEncode(" + getFlatMapKey() + ", _pg_map);\n";
+    }
+    else
+    {
+        output += spacing + "_pg_map.insert(" + getFlatMapKey() + ", ";
+
+        // The type of the value selects the storage in the map
+        if(inMemoryType.isFloat || !printScalerString.empty())
+            output += "(double)(" + getEncodeFieldAccess(true) + printScalerString + ")";
+        else if(inMemoryType.isSigned)
+            output += "(long long)" + getEncodeFieldAccess(true);
+        else
+            output += "(unsigned long long)" + getEncodeFieldAccess(true);
+
+        output += ");\n";
+    }
+
+    return output;
+
+}// ProtocolField::getFlatMapEncodeString
+
+
+/*!
+ * Get the string used for extracting this field from a flat map.
+ * \return the string used to read this field from the map, which may be empty
+ */
+std::string ProtocolField::getFlatMapDecodeString(void) const
+{
+    std::string output;
+
+    if(inMemoryType.isString)
+    {
+        output += TAB_IN + "_pg_value = _pg_map.find(" + getFlatMapKey() + ");\n";
+        output += TAB_IN + "if(_pg_value != nullptr)\n";
+        output += TAB_IN + TAB_IN + "pgstrncpy(" + getDecodeFieldAccess(true) + ", _pg_value->toString().c_str(), " + array + ");\n";
+        return output;
+    }
+
+    std::string spacing = TAB_IN;
+
+    output += getEncodeArrayIterationCode(spacing, true);
+
+    if(is2dArray())
+    {
+        spacing += TAB_IN;
+        output += spacing + "{\n";
+        spacing += TAB_IN;
+    }
+    else if(isArray())
+    {
+        output += spacing + "{\n";
+        spacing += TAB_IN;
+    }
+
+    if(inMemoryType.isStruct)
+    {
+        if(support->language == ProtocolSupport::c_language)
+        {
+            // In case of a structure redefines
+            std::string signame = typeName;
+            const ProtocolStructure* mystruct = parser->lookUpStructure(typeName);
+            if(mystruct != nullptr)
+                signame = mystruct->getStructName();
+
+            output += spacing + "mapDecode" + signame + "(" + getFlatMapKey() + ", _pg_map, " + getDecodeFieldAccess(true) + ");\n";
+        }
+        else
+            output += spacing + getDecodeFieldAccess(true) + ".mapDecode(" + getFlatMapKey() + ", _pg_map);\n";
+    }
+    else
+    {
+        output += spacing + "_pg_value = _pg_map.find(" + getFlatMapKey() + ");\n";
+        output += spacing + "if(_pg_value != nullptr)\n";
+        output += spacing + TAB_IN + getDecodeFieldAccess(true) + " = (" + typeName + ")";
+
+        if(!readScalerString.empty())
+            output += "(_pg_value->toDouble()" + readScalerString + ")";
+        else if(inMemoryType.isFloat || !printScalerString.empty())
+            output += "_pg_value->toDouble()";
+        else if(inMemoryType.isSigned)
+            output += "_pg_value->toLongLong()";
+        else
+            output += "_pg_value->toULongLong()";
+
+        output += ";\n";
+    }
+
+    // Close the block under the for loop(s)
+    if(isArray())
+    {
+        spacing = spacing.substr(0, spacing.length() - TAB_IN.length());
+        output += spacing + "}\n";
+    }
+
+    return output;
+
+}// ProtocolField::getFlatMapDecodeString
+
+
+/*!
+ * Get the string used for writing this field to a JSON or CBOR writer
+ * \param cbor should be true to write CBOR, else JSON
+ * \return the string used to write this field, which may be empty
+ */
+std::string ProtocolField::getJsonWriteString(bool cbor) const
+{
+    std::string output;
+    std::string element;
+
+    // No output if nothing is in memory or if not encoded
+    if(inMemoryType.isNull || encodedType.isNull)
+        return output;
+
+    if(!comment.empty())
+        output += TAB_IN + "// " + comment + "\n";
+
+    output += TAB_IN + "_pg_writer.key(" + getJsonKeyLiteral(cbor) + ");\n";
+
+    if(inMemoryType.isString)
+    {
+        output += TAB_IN + "_pg_writer.value((const char*)" + getEncodeFieldAccess(true) + ");\n";
+        return output;
+    }
+
+    if(inMemoryType.isStruct)
+    {
+        std::string function = cbor ? "toCbor" : "toJson";
+
+        if(support->language == ProtocolSupport::c_language)
+        {
+            // In case of a structure redefines
+            std::string signame = typeName;
+            const ProtocolStructure* mystruct = parser->lookUpStructure(typeName);
+            if(mystruct != nullptr)
+                signame = mystruct->getStructName();
+
+            element = function + signame + "(_pg_writer, " + getEncodeFieldAccess(true) + ");";
+        }
+        else
+            element = getEncodeFieldAccess(true) + "." + function + "(_pg_writer);";
+    }
+    else if(!printScalerString.empty())
+        element = "_pg_writer.value((double)(" + getEncodeFieldAccess(true) + printScalerString + "));";
+    else if(inMemoryType.isFloat && (inMemoryType.bits > 32))
+        element = "_pg_writer.value((double)" + getEncodeFieldAccess(true) + ");";
+    else if(inMemoryType.isFloat)
+        element = "_pg_writer.value((float)" + getEncodeFieldAccess(true) + ");";
+    else if(inMemoryType.isSigned)
+        element = "_pg_writer.value((long long)" + getEncodeFieldAccess(true) + ");";
+    else
+        element = "_pg_writer.value((unsigned long long)" + getEncodeFieldAccess(true) + ");";
+
+    output += getJsonArrayWriteCode(element);
+
+    return output;
+
+}// ProtocolField::getJsonWriteString
+
+
+/*!
+ * Get the string used for reading this field from a JSON or CBOR reader. The
+ * key of this field has already been read.
+ * \param spacing is the spacing that begins each line
+ * \param cbor should be true to read CBOR, else JSON
+ * \return the string used to read this field, which may be empty
+ */
+std::string ProtocolField::getJsonReadString(const std::string& spacing, bool cbor) const
+{
+    std::string output;
+    std::string element;
+
+    // No input if nothing is in memory or if not encoded
+    if(inMemoryType.isNull || encodedType.isNull)
+        return output;
+
+    if(inMemoryType.isString)
+    {
+        output += spacing + "_pg_reader.readString(" + getDecodeFieldAccess(true) + ", " + array + ");\n";
+        output += spacing + "_pg_fieldcount++;\n";
+        return output;
+    }
+
+    if(inMemoryType.isStruct)
+    {
+        std::string function = cbor ? "fromCbor" : "fromJson";
+
+        if(support->language == ProtocolSupport::c_language)
+        {
+            // In case of a structure redefines
+            std::string signame = typeName;
+            const ProtocolStructure* mystruct = parser->lookUpStructure(typeName);
+            if(mystruct != nullptr)
+                signame = mystruct->getStructName();
+
+            element = "_pg_fieldcount += " + function + signame + "(_pg_reader, " + getDecodeFieldAccess(true) + ");";
+        }
+        else
+            element = "_pg_fieldcount += " + getDecodeFieldAccess(true) + "." + function + "(_pg_reader);";
+
+        output += getJsonArrayReadCode(spacing, element);
+        return output;
+    }
+
+    if(!readScalerString.empty())
+        element = getDecodeFieldAccess(true) + " = (" + typeName + ")(_pg_reader.readNumber<double>()" + readScalerString + ");";
+    else if(inMemoryType.isFloat && (inMemoryType.bits > 32))
+        element = getDecodeFieldAccess(true) + " = _pg_reader.readNumber<double>();";
+    else if(inMemoryType.isFloat)
+        element = getDecodeFieldAccess(true) + " = _pg_reader.readNumber<float>();";
+    else if(inMemoryType.isSigned)
+        element = getDecodeFieldAccess(true) + " = (" + typeName + ")_pg_reader.readNumber<long long>();";
+    else
+        element = getDecodeFieldAccess(true) + " = (" + typeName + ")_pg_reader.readNumber<unsigned long long>();";
+
+    output += getJsonArrayReadCode(spacing, element);
+    output += spacing + "_pg_fieldcount++;\n";
+
+    return output;
+
+}// ProtocolField::getJsonReadString
+
+
 /*!
  * Return the string that sets this encodable to its default value in code
  * \param isStructureMember should be true if this field is accessed through a "user" structure pointer
@@ -3404,7 +4339,7 @@ std::string ProtocolField::getSetInitialValueString(bool isStructureMember) cons
     if(inMemoryType.isStruct)
     {
         // In C++ the constructor is the initializer
-        if(support.language == ProtocolSupport::c_language)
+        if(support->language == ProtocolSupport::c_language)
         {
             if(!hasInit())
                 return output;
@@ -3430,7 +4365,7 @@ std::string ProtocolField::getSetInitialValueString(bool isStructureMember) cons
     }// if struct
     else if(!isNotInMemory())
     {
-        if(support.language == ProtocolSupport::c_language)
+        if(support->language == ProtocolSupport::c_language)
         {
             if(!initialValueString.empty())
             {
@@ -3441,68 +4376,14 @@ std::string ProtocolField::getSetInitialValueString(bool isStructureMember) cons
                 output += getSetToValueString(isStructureMember, initialValueString);
             }
         }
-        else
+        else if(!isDefaultMemberInitialized())
         {
-            // Try the user's value first
-            std::string initial = initialValueString;
-
-            // If there isn't one, use the default value
-            if(initial.empty())
-                initial = defaultString;
-
-            // If there isn't one, use the constant value
-            if(initial.empty())
-                initial = constantString;
+            // Members which cannot be initialized in the class declaration
+            // (bitfields and function calls) go in the initializer list
+            std::string initial = getCppInitialValue();
 
-            // If there isn't one, use the verify min value
-            if(initial.empty())
-                initial = verifyMinString;
-
-            // In C++ we explicitly initialize all members.
-            if(initial.empty())
-            {
-                if(!inMemoryType.isString)
-                {
-                    if(inMemoryType.isEnum)
-                    {
-                        const EnumCreator* creator = parser->lookUpEnumeration(inMemoryType.enumName);
-                        if(creator == nullptr)
-                            initial = "(" + inMemoryType.enumName + ")0";
-                        else
-                            initial = creator->getFirstEnumerationName();
-                    }
-                    else
-                    {
-                        // Zero seems like the best choice, but we can do a
-                        // little better, if for example we have a minimum
-                        // encoded value we should initialize to
-                        // respect those values
-                        if(limitMaxValue < 0)
-                            initial = limitMaxString;
-                        else if(limitMinValue > 0)
-                            initial = limitMinString;
-                        else
-                            initial = "0";
-
-                    }// else if we are not an enumeration
-
-                }// If we are not a string
-
-            }// If we have no user provided initial value
-
-            initial = inMemoryType.applyTypeToConstant(initial);
-
-            // C++ initializer list
             if(inMemoryType.isString)
-            {
-                // initial is a string literal, so include the quotes. Except for
-                // a special case. If initial ends in "()" then we assume its a
-                // function or macro call
-                if(!endsWith(trimm(initial), "()"))
-                    initial = "\"" + initial + "\"";
-
                 output += TAB_IN + name + "(" + initial + "),\n";
-            }
             else if(is2dArray())
                 output += TAB_IN + name + "{{" + initial + "}},\n";
             else if(isArray())
@@ -3586,22 +4467,173 @@ std::string ProtocolField::getSetToValueString(bool isStructureMember, std::stri
 }// ProtocolField::getSetToValueString
 
 
-//! Return the strings that #define initial and variable values
-std::string ProtocolField::getInitialAndVerifyDefines(bool includeComment) const
+/*!
+ * Get the value this field is initialized to in C++. In C++ we explicitly
+ * initialize all members, so this falls back through the default, constant,
+ * verify and limit values before settling on zero.
+ * \return the initial value, string literals include their quotes
+ */
+std::string ProtocolField::getCppInitialValue(void) const
 {
-    (void)includeComment;
-
-    std::string output;
+    // Try the user's value first
+    std::string initial = initialValueString;
 
-    if(inMemoryType.isNull || inMemoryType.isStruct)
-        return output;
+    // If there isn't one, use the default value
+    if(initial.empty())
+        initial = defaultString;
 
-    // No colons in preprocessor definitions
-    std::string start = getHierarchicalName();
-    replaceinplace(start, ":", "_");
+    // If there isn't one, use the constant value
+    if(initial.empty())
+        initial = constantString;
 
-    if(!initialValueString.empty())
-        output += "#define " + start + "_InitValue " + initialValueString + "\n";
+    // If there isn't one, use the verify min value
+    if(initial.empty())
+        initial = verifyMinString;
+
+    // In C++ we explicitly initialize all members.
+    if(initial.empty())
+    {
+        if(!inMemoryType.isString)
+        {
+            if(inMemoryType.isEnum)
+            {
+                const EnumCreator* creator = parser->lookUpEnumeration(inMemoryType.enumName);
+                if(creator == nullptr)
+                    initial = "(" + inMemoryType.enumName + ")0";
+                else
+                    initial = creator->getFirstEnumerationName();
+            }
+            else
+            {
+                // Zero seems like the best choice, but we can do a
+                // little better, if for example we have a minimum
+                // encoded value we should initialize to
+                // respect those values
+                if(limitMaxValue < 0)
+                    initial = limitMaxString;
+                else if(limitMinValue > 0)
+                    initial = limitMinString;
+                else
+                    initial = "0";
+
+            }// else if we are not an enumeration
+
+        }// If we are not a string
+
+    }// If we have no user provided initial value
+
+    initial = inMemoryType.applyTypeToConstant(initial);
+
+    // initial is a string literal, so include the quotes. Except for a special
+    // case. If initial ends in "()" then we assume its a function or macro call
+    if(inMemoryType.isString && !endsWith(trimm(initial), "()"))
+        initial = "\"" + initial + "\"";
+
+    return initial;
+
+}// ProtocolField::getCppInitialValue
+
+
+/*!
+ * Determine if this field is initialized in the C++ class declaration with a
+ * default member initializer, rather than in the constructor initializer list.
+ * Bitfields cannot have default member initializers, and neither can strings
+ * that are initialized by a function call.
+ * \return true if the declaration of this field includes its initial value
+ */
+bool ProtocolField::isDefaultMemberInitialized(void) const
+{
+    if((support->language != ProtocolSupport::cpp_language) || inMemoryType.isNull || inMemoryType.isStruct || isNotInMemory() || inMemoryType.isBitfield)
+        return false;
+
+    if(inMemoryType.isString && endsWith(getCppInitialValue(), "()"))
+        return false;
+
+    return true;
+
+}// ProtocolField::isDefaultMemberInitialized
+
+
+/*!
+ * Return the value of this field in the C static initializer of its parent
+ * structure. Fields without an initial value are left to be zero.
+ * \param ok is set to false if the value cannot be expressed statically
+ * \return the initializer, which is empty if the field is zero
+ */
+std::string ProtocolField::getStaticInitializerString(bool* ok) const
+{
+    if(inMemoryType.isNull || isNotInMemory())
+        return std::string();
+
+    if(inMemoryType.isStruct)
+    {
+        if(!hasInit())
+            return std::string();
+
+        const ProtocolStructure* mystruct = parser->lookUpStructure(typeName);
+        if(mystruct == nullptr)
+        {
+            *ok = false;
+            return std::string();
+        }
+
+        std::string initializer = mystruct->getStaticInitializerString(ok);
+        if(initializer.empty())
+            return initializer;
+
+        return getArrayStaticInitializer(initializer, ok);
+    }
+
+    std::string value = initialValueString;
+
+    if(value.empty())
+        return value;
+
+    if(inMemoryType.isString)
+    {
+        if(toLower(value) == "null")
+            return std::string();
+
+        // The literal, including its terminator, must fit in the array
+        bool good = false;
+        double size = ShuntingYard::computeInfix(parser->replaceEnumerationNameWithValue(array), &good);
+        if(!good || (value.size() >= size))
+        {
+            *ok = false;
+            return std::string();
+        }
+
+        return "\"" + value + "\"";
+    }
+
+    // Deal with casting doubles to floats, just like getSetToValueString()
+    if(inMemoryType.isFloat && (inMemoryType.bits < 64))
+    {
+        if((value.find('.') != std::string::npos) && (value.back() != 'f'))
+            value = "(float)" + value;
+    }
+
+    return getArrayStaticInitializer(value, ok);
+
+}// ProtocolField::getStaticInitializerString
+
+
+//! Return the strings that #define initial and variable values
+std::string ProtocolField::getInitialAndVerifyDefines(bool includeComment) const
+{
+    (void)includeComment;
+
+    std::string output;
+
+    if(inMemoryType.isNull || inMemoryType.isStruct)
+        return output;
+
+    // No colons in preprocessor definitions
+    std::string start = getHierarchicalName();
+    replaceinplace(start, ":", "_");
+
+    if(!initialValueString.empty())
+        output += "#define " + start + "_InitValue " + initialValueString + "\n";
 
     if(!verifyMinString.empty())
         output += "#define " + start + "_VerifyMin " + verifyMinString + "\n";
@@ -3703,13 +4735,13 @@ std::string ProtocolField::getDBCSignalString(std::string prename, int* bitcount
                 {
                     if(isString())
                     {
-                        output += " SG_ " + localname + " : " + getDBCBitWidthString(numbits, start, false, support.bigendian) + " (1,0) [0|0] \"\" Vector__XXX\n";
+                        output += " SG_ " + localname + " : " + getDBCBitWidthString(numbits, start, false, support->bigendian) + " (1,0) [0|0] \"\" Vector__XXX\n";
                     }
-                    else if(encodedType.isFloat && support.bigendian)
+                    else if(encodedType.isFloat && support->bigendian)
                     {
                         // For big endian float encodings we break the encoding apart into three sections:
                         // a) first bit is sign
-                        output += " SG_ " + localname + "_sign : " + getDBCBitWidthString(1, start, true, support.bigendian) + " (1,0) [0|0] \"\" Vector__XXX\n";
+                        output += " SG_ " + localname + "_sign : " + getDBCBitWidthString(1, start, true, support->bigendian) + " (1,0) [0|0] \"\" Vector__XXX\n";
                         start++;
 
                         uint32_t exponentbits = 0;
@@ -3726,11 +4758,11 @@ std::string ProtocolField::getDBCSignalString(std::string prename, int* bitcount
                         // b) next bits are exponent - notice the offset, which is the "bias" in float world
 
                         int bias = (0x1<<(exponentbits-1)) - 1;
-                        output += " SG_ " + localname + "_exp2 : " + getDBCBitWidthString(exponentbits, start, false, support.bigendian) + " (1," + std::to_string(-1*bias) + ") [" + std::to_string(-1*bias) + "|" + std::to_string(1+bias) + "] \"\" Vector__XXX\n";
+                        output += " SG_ " + localname + "_exp2 : " + getDBCBitWidthString(exponentbits, start, false, support->bigendian) + " (1," + std::to_string(-1*bias) + ") [" + std::to_string(-1*bias) + "|" + std::to_string(1+bias) + "] \"\" Vector__XXX\n";
                         start += exponentbits;
 
                         // c) lasts bits are significand - with implied leading one, range is from 1.0 to 2.0, so offset is 1, and scaler is 1.0/2^sigbits
-                        output += " SG_ " + localname + " : " + getDBCBitWidthString(sigbits, start, false, support.bigendian) + " (" + std::to_string(1.0/(0x1<<sigbits)) + ",1) [" + std::to_string(1.0) + "|" + std::to_string(2.0) + "]";
+                        output += " SG_ " + localname + " : " + getDBCBitWidthString(sigbits, start, false, support->bigendian) + " (" + std::to_string(1.0/(0x1<<sigbits)) + ",1) [" + std::to_string(1.0) + "|" + std::to_string(2.0) + "]";
 
                         // Units data appears on the significand line
                         if((extraInfoNames.size() > 0) && (extraInfoValues.size() > 0) && (extraInfoNames.at(0) == "Units"))
@@ -3743,7 +4775,7 @@ std::string ProtocolField::getDBCSignalString(std::string prename, int* bitcount
                     }
                     else
                     {
-                        output += " SG_ " + localname + " : " + getDBCBitWidthString(numbits, start, encodedType.isSigned, support.bigendian);
+                        output += " SG_ " + localname + " : " + getDBCBitWidthString(numbits, start, encodedType.isSigned, support->bigendian);
 
                         // Scale and offset
                         if(isFloatScaling() || isIntegerScaling())
@@ -3775,14 +4807,14 @@ std::string ProtocolField::getDBCSignalString(std::string prename, int* bitcount
                             // Min and max values
                             output += " [";
 
-                            if((support.limitonencode == false) || verifyMinString.empty() || (hasVerifyMinValue && (verifyMinValue <= limitMinValue)))
+                            if((support->limitonencode == false) || verifyMinString.empty() || (hasVerifyMinValue && (verifyMinValue <= limitMinValue)))
                                 output += limitMinStringForComment;
                             else
                                 output += verifyMinString;
 
                             output += "|";
 
-                            if((support.limitonencode == false) || verifyMaxString.empty() || (hasVerifyMaxValue && (verifyMaxValue >= limitMaxValue)))
+                            if((support->limitonencode == false) || verifyMaxString.empty() || (hasVerifyMaxValue && (verifyMaxValue >= limitMaxValue)))
                                 output += limitMaxStringForComment;
                             else
                                 output += verifyMaxString;
@@ -3926,7 +4958,7 @@ std::string ProtocolField::getDBCSignalComment(std::string prename, uint32_t ID)
             }
             else if(!inMemoryType.isNull && !encodedType.isNull && !comment.empty() && !isHidden())
             {
-                if(encodedType.isFloat && support.bigendian)
+                if(encodedType.isFloat && support->bigendian)
                 {
                     output += "CM_ SG_ " + std::to_string(ID) + " " + localname + "_sign \"Sign bit, negative if set\";\n";
                     output += "CM_ SG_ " + std::to_string(ID) + " " + localname + "_exp2 \"Multiply significand by 2 raised to this power\";\n";
@@ -4195,7 +5227,7 @@ std::string ProtocolField::getLimitedArgument(std::string argument) const
     if(isFloatScaling() || isIntegerScaling() || (encodedType.isFloat && (encodedType.bits < 32)))
     {
         // However the user may want tighter limits
-        if(support.limitonencode && (!verifyMinString.empty() || !verifyMaxString.empty()))
+        if(support->limitonencode && (!verifyMinString.empty() || !verifyMaxString.empty()))
         {
             bool skipmin = verifyMinString.empty();
             bool skipmax = verifyMaxString.empty();
@@ -4229,7 +5261,7 @@ std::string ProtocolField::getLimitedArgument(std::string argument) const
         bool skipmax = true;
 
         // In this case we don't have the scaling functions, so we may need to apply a limit, even if the user didn't ask for it
-        if(!hasVerifyMaxValue && !verifyMaxString.empty() && support.limitonencode)
+        if(!hasVerifyMaxValue && !verifyMaxString.empty() && support->limitonencode)
         {
             // In this case we cannot vet the user's verify string, we just have to use it
             maxstring = verifyMaxString;
@@ -4238,7 +5270,7 @@ std::string ProtocolField::getLimitedArgument(std::string argument) const
         }// if we cannot evaluate the verify value
         else
         {
-            if(hasVerifyMaxValue && support.limitonencode && (verifyMaxValue < limitMaxValue))
+            if(hasVerifyMaxValue && support->limitonencode && (verifyMaxValue < limitMaxValue))
             {
                 maxvalue = verifyMaxValue;
                 maxstring = verifyMaxString;
@@ -4251,7 +5283,7 @@ std::string ProtocolField::getLimitedArgument(std::string argument) const
         }// else if we can evaluate the verify value
 
         // In this case we don't have the scaling functions, so we may need to apply a limit, even if the user didn't ask for it
-        if(!hasVerifyMinValue && !verifyMinString.empty() && support.limitonencode)
+        if(!hasVerifyMinValue && !verifyMinString.empty() && support->limitonencode)
         {
             // In this case we cannot vet the user's verify string, we just have to use it
             minstring = verifyMinString;
@@ -4260,7 +5292,7 @@ std::string ProtocolField::getLimitedArgument(std::string argument) const
         }// if we cannot evaluate the verify value
         else
         {
-            if(hasVerifyMinValue && support.limitonencode && (verifyMinValue > limitMinValue))
+            if(hasVerifyMinValue && support->limitonencode && (verifyMinValue > limitMinValue))
             {
                 minvalue = verifyMinValue;
                 minstring = verifyMinString;
@@ -4312,7 +5344,7 @@ std::string ProtocolField::getEncodeStringForBitfield(int* bitcount, bool isStru
 
     // Commenting indicating the range of the field
     if(!inMemoryType.isNull && !inMemoryType.isBool && constantstring.empty() && (encodedType.bits > 1) && !inMemoryType.isEnum)
-        output += TAB_IN + getRangeComment(support.limitonencode);
+        output += TAB_IN + getRangeComment(support->limitonencode);
 
     if(constantstring.empty())
         argument = getLimitedArgument(getEncodeFieldAccess(isStructureMember));
@@ -4325,34 +5357,42 @@ std::string ProtocolField::getEncodeStringForBitfield(int* bitcount, bool isStru
     }
     else if(isFloatScaling())
     {
+        int numberbits = encodedType.bits;
+
         if(encodedType.bits > 32)
         {
-            if(support.longbitfield)
+            if(support->longbitfield)
             {
-                if(support.float64)
+                if(support->float64)
                     argument = "float64ScaledToLongBitfield((double)" + argument;
                 else
                     argument = "float32ScaledToLongBitfield((float)" + argument;
             }
             else
             {
-                if(support.float64)
+                if(support->float64)
                    argument = "float64ScaledToBitfield((double)" + argument;
                 else
                    argument = "float32ScaledToBitfield((float)" + argument;
             }
         }
+        else if((encodedType.bits > 24) && support->float64)
+        {
+            // float32 only has 24 bits of precision
+            argument = "float64ScaledToBitfield((double)" + argument;
+            numberbits = 64;
+        }
         else
             argument = "float32ScaledToBitfield((float)" + argument;
 
-        argument += ", " + getNumberString(encodedMin, encodedType.bits);
-        argument += ", " + getNumberString(scaler, encodedType.bits);
+        argument += ", " + getNumberString(encodedMin, numberbits);
+        argument += ", " + getNumberString(scaler, numberbits);
         argument += ", " + std::to_string(encodedType.bits);
         argument += ")";
     }
     else if(isIntegerScaling())
     {
-        if((encodedType.bits > 32) && support.longbitfield)
+        if((encodedType.bits > 32) && support->longbitfield)
             argument = inMemoryType.toSigString() + "ScaledToLongBitfield(" + argument;
         else
             argument = inMemoryType.toSigString() + "ScaledToBitfield(" + argument;
@@ -4393,7 +5433,7 @@ std::string ProtocolField::getEncodeStringForBitfield(int* bitcount, bool isStru
 
             output += TAB_IN + "// Encode the entire group of bits in one shot\n";
 
-            if(support.bigendian)
+            if(support->bigendian)
                 output += TAB_IN + "bytesToBeBytes(_pg_bitfieldbytes, _pg_data, &_pg_byteindex, " + std::to_string(num) + ");\n";
             else
                 output += TAB_IN + "bytesToLeBytes(_pg_bitfieldbytes, _pg_data, &_pg_byteindex, " + std::to_string(num) + ");\n";
@@ -4461,7 +5501,7 @@ std::string ProtocolField::getDecodeStringForBitfield(int* bitcount, bool isStru
     {
         int num = (bitfieldData.groupBits+7)/8;
         output += TAB_IN + "// Decode the entire group of bits in one shot\n";
-        if(support.bigendian)
+        if(support->bigendian)
             output += TAB_IN + "bytesFromBeBytes(_pg_bitfieldbytes, _pg_data, &_pg_byteindex, " + std::to_string(num) + ");\n";
         else
             output += TAB_IN + "bytesFromLeBytes(_pg_bitfieldbytes, _pg_data, &_pg_byteindex, " + std::to_string(num) + ");\n";
@@ -4554,35 +5594,45 @@ std::string ProtocolField::getDecodeStringForBitfield(int* bitcount, bool isStru
                 if(isFloatScaling())
                 {
                     std::string cast;
+                    int numberbits = encodedType.bits;
 
                     if(!inMemoryType.isFloat)
                         cast = "(" + typeName +")";
 
                     if(encodedType.bits > 32)
                     {
-                        if((inMemoryType.bits != 64) && support.float64)
+                        if((inMemoryType.bits != 64) && support->float64)
                             cast = "(" + typeName +")";
 
-                        if(support.longbitfield)
+                        if(support->longbitfield)
                         {
-                            if(support.float64)
+                            if(support->float64)
                                 output += cast + "float64ScaledFromLongBitfield(" + argument;
                             else
                                 output += cast + "float32ScaledFromLongBitfield(" + argument;
                         }
                         else
                         {
-                            if(support.float64)
+                            if(support->float64)
                                 output += cast + "float64ScaledFromBitfield(" + argument;
                             else
                                 output += cast + "float32ScaledFromBitfield(" + argument;
                         }
                     }
+                    else if((encodedType.bits > 24) && support->float64)
+                    {
+                        // float32 only has 24 bits of precision
+                        if(inMemoryType.bits != 64)
+                            cast = "(" + typeName +")";
+
+                        output += cast + "float64ScaledFromBitfield(" + argument;
+                        numberbits = 64;
+                    }
                     else
                         output += cast + "float32ScaledFromBitfield(" + argument;
 
-                    output += ", " + getNumberString(encodedMin, encodedType.bits);
-                    output += ", " + getNumberString(1.0, encodedType.bits) + "/" + getNumberString(scaler, encodedType.bits);
+                    output += ", " + getNumberString(encodedMin, numberbits);
+                    output += ", " + getNumberString(1.0, numberbits) + "/" + getNumberString(scaler, numberbits);
                     output += ");\n";
 
                 }// if float scaled bitfield
@@ -4590,7 +5640,7 @@ std::string ProtocolField::getDecodeStringForBitfield(int* bitcount, bool isStru
                 {
                     if(scaler != 1.0)
                     {
-                        if((encodedType.bits > 32) && support.longbitfield)
+                        if((encodedType.bits > 32) && support->longbitfield)
                             output += inMemoryType.toSigString() + "ScaledFromLongBitfield(" + argument;
                         else
                             output += inMemoryType.toSigString() + "ScaledFromBitfield(" + argument;
@@ -4716,7 +5766,13 @@ std::string ProtocolField::getEncodeStringForString(bool isStructureMember) cons
     if(!comment.empty())
         output += "    // " + comment + "\n";
 
-    if(constantstring.empty())
+    if(!dictionary.empty())
+    {
+        output += "    {\n";
+        output += getDictionaryDeclaration(TAB_IN + TAB_IN);
+        output += "        stringToDictionaryBytes(" + getEncodeFieldAccess(isStructureMember) + ", _pg_dictionary, " + std::to_string(dictionary.size()) + ", _pg_data, &_pg_byteindex, " + array;
+    }
+    else if(constantstring.empty())
         output += "    stringToBytes(" + getEncodeFieldAccess(isStructureMember) + ", _pg_data, &_pg_byteindex, " + array;
     else
         output += "    stringToBytes(" + constantstring + ", _pg_data, &_pg_byteindex, " + array;
@@ -4726,6 +5782,9 @@ std::string ProtocolField::getEncodeStringForString(bool isStructureMember) cons
     else
         output += ", 0);\n";
 
+    if(!dictionary.empty())
+        output += "    }\n";
+
     return output;
 
 }// ProtocolField::getEncodeStringForString
@@ -4750,6 +5809,25 @@ std::string ProtocolField::getDecodeStringForString(bool isStructureMember, bool
     if(!comment.empty())
         output += spacing + "// " + comment + "\n";
 
+    if(!dictionary.empty())
+    {
+        // The dictionary index is always present, the string may follow
+        if(defaultEnabled && (!defaultString.empty() || overridesPrevious))
+        {
+            output += spacing + "if(_pg_byteindex + 1 > _pg_numbytes)\n";
+            output += spacing + TAB_IN + "return 1;\n";
+            output += "\n";
+        }
+
+        output += spacing + "{\n";
+        output += getDictionaryDeclaration(spacing + TAB_IN);
+        output += spacing + TAB_IN + "if(!stringFromDictionaryBytes(" + getDecodeFieldAccess(isStructureMember) + ", _pg_dictionary, " + std::to_string(dictionary.size()) + ", _pg_data, &_pg_byteindex, " + array + (inMemoryType.isFixedString ? ", 1))\n" : ", 0))\n");
+        output += spacing + TAB_IN + TAB_IN + "return " + getReturnCode(false) + ";\n";
+        output += spacing + "}\n";
+
+        return output;
+    }
+
     // If this field has a default value, or overrides a previous value
     if(defaultEnabled && (!defaultString.empty() || overridesPrevious))
     {
@@ -4839,7 +5917,7 @@ std::string ProtocolField::getEncodeStringForStructure(bool isStructureMember) c
 
     access = getEncodeFieldAccess(isStructureMember);
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += spacing + "encode" + typeName + "(_pg_data, &_pg_byteindex, " + access + ");\n";
     else
     {
@@ -4915,7 +5993,7 @@ std::string ProtocolField::getDecodeStringForStructure(bool isStructureMember) c
 
     access = getDecodeFieldAccess(isStructureMember);
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
         output += spacing + "if(decode" + typeName + "(_pg_data, &_pg_byteindex, " + access + ") == 0)\n";
         output += spacing + TAB_IN + "return 0;\n";
@@ -4998,9 +6076,11 @@ std::string ProtocolField::getConstantString(void) const
  * \param isStructureMember should be true if the left hand side is a
  *        member of a user structure, else the left hand side is a pointer
  *        to the inMemoryType
+ * \param againstState should be true to encode a delta="packet" field as the
+ *        difference from _pg_state, which is updated, as the diff encode does.
  * \return The string to add to the source file that encodes this field.
  */
-std::string ProtocolField::getEncodeStringForField(bool isStructureMember) const
+std::string ProtocolField::getEncodeStringForField(bool isStructureMember, bool againstState) const
 {
     std::string output;
     std::string endian;
@@ -5018,7 +6098,7 @@ std::string ProtocolField::getEncodeStringForField(bool isStructureMember) const
 
     // Additional commenting to describe the scaling
     if(!inMemoryType.isNull && !inMemoryType.isBool && constantstring.empty())
-        output += spacing + getRangeComment(support.limitonencode);
+        output += spacing + getRangeComment(support->limitonencode);
 
     int length = encodedType.bits / 8;
     lengthString = std::to_string(length);
@@ -5032,9 +6112,11 @@ std::string ProtocolField::getEncodeStringForField(bool isStructureMember) const
 
     // The endian string, which is empty for 1 byte, since
     // endian only applies to multi-byte fields
-    if(length > 1)
+    if(encodedType.isVarint)
+        endian = "Var";
+    else if(length > 1)
     {
-        if(support.bigendian)
+        if(support->bigendian)
             endian += "Be";
         else
             endian += "Le";
@@ -5053,6 +6135,26 @@ std::string ProtocolField::getEncodeStringForField(bool isStructureMember) const
         spacing += TAB_IN;
     }
 
+    if(deltaElement || deltaPacket)
+    {
+        output += getEncodeStringForDelta(spacing, endian, isStructureMember, againstState);
+
+        if(!dependsOn.empty())
+            output += TAB_IN + "}\n";
+
+        return output;
+    }
+
+    if(rle)
+    {
+        output += getEncodeStringForRle(spacing, isStructureMember);
+
+        if(!dependsOn.empty())
+            output += TAB_IN + "}\n";
+
+        return output;
+    }
+
     std::string arrayspacing;
     std::string argument = getEncodeFieldAccess(isStructureMember);
 
@@ -5073,6 +6175,47 @@ std::string ProtocolField::getEncodeStringForField(bool isStructureMember) const
     else
         argument = constantstring;
 
+    output += spacing + arrayspacing + getEncodeStringForElement(argument);
+
+    if(!dependsOn.empty())
+        output += TAB_IN + "}\n";
+
+    return output;
+
+}// ProtocolField::getEncodeStringForField
+
+
+/*!
+ * Get the statement that encodes one element of this field, which is a single
+ * value, or one element of an array.
+ * \param argument is the value to encode, which has already been limited, or
+ *        is the constant.
+ * \return the encode statement, including the semicolon and line feed but not
+ *         the leading spacing.
+ */
+std::string ProtocolField::getEncodeStringForElement(const std::string& argument) const
+{
+    std::string output;
+    std::string endian;
+
+    std::string constantstring = getConstantString();
+
+    int length = encodedType.bits / 8;
+
+    // The endian string, which is empty for 1 byte, since
+    // endian only applies to multi-byte fields
+    if(encodedType.isVarint)
+        endian = "Var";
+    else if(length > 1)
+    {
+        if(support->bigendian)
+            endian += "Be";
+        else
+            endian += "Le";
+    }
+    else
+        endian = "";
+
     if(encodedType.isFloat)
     {
         // In this case we are encoding as a floating point. Typically we
@@ -5090,7 +6233,7 @@ std::string ProtocolField::getEncodeStringForField(bool isStructureMember) const
         // the in-memory type as a double, but the encoded as a float
         std::string cast = "(" + encodedType.toTypeString() + ")";
 
-        output += spacing + arrayspacing + "float" + std::to_string(encodedType.bits) + "To" + endian + "Bytes(" + cast + argument + scalestring + ", _pg_data, &_pg_byteindex";
+        output += "float" + std::to_string(encodedType.bits) + "To" + endian + "Bytes(" + cast + argument + scalestring + ", _pg_data, &_pg_byteindex";
 
         if((encodedType.bits == 16) || (encodedType.bits == 24))
             output += ", " + std::to_string(encodedType.sigbits);
@@ -5102,15 +6245,13 @@ std::string ProtocolField::getEncodeStringForField(bool isStructureMember) const
     {
         std::string cast;
 
-        output += spacing + arrayspacing;
-
         // The in-memory part of the scaling
         if(isFloatScaling())
         {
             // If we are floating scaling, we are going to use a float-encoding
             // function, since even an integer encoding function would still
             // have to cast to float to apply the scaler.
-            if((inMemoryType.bits > 32) && support.float64)
+            if((inMemoryType.bits > 32) && support->float64)
             {
                 output += "float64";
 
@@ -5206,130 +6347,849 @@ std::string ProtocolField::getEncodeStringForField(bool isStructureMember) const
         // This is the termination of the function and the line
         function += ", _pg_data, &_pg_byteindex);\n";
 
-        output += spacing + arrayspacing + function;
+        output += function;
 
     }// else if not float scaled
 
-    if(!dependsOn.empty())
-        output += TAB_IN + "}\n";
-
     return output;
 
-}// ProtocolField::getEncodeStringForField
+}// ProtocolField::getEncodeStringForElement
 
 
 /*!
- * Check to see if we should be doing floating point scaling on this field.
- * This means the encode operation is going to call a function like
- * `float32To...()`; and the decode function is going to call a function like
- * `float32From...()`.
- * \return true if scaling should be based on floating point operations
+ * Get the next lines of source needed to encode a field whose elements are
+ * encoded as a difference. With delta="element" each element is the difference
+ * from the previous element, and the first element is predicted to be zero.
+ * With delta="packet" each element is the difference from the same element of
+ * the last packet, which is _pg_state in the diff encode, or zero otherwise. If
+ * the encoding is at least as wide as the in-memory type the differences use
+ * modulo arithmetic and are exact. Otherwise large differences are limited,
+ * and the prediction follows the limited value so the encoder and decoder
+ * agree, catching up over later elements or packets.
+ * \param spacing is the spacing that begins each line.
+ * \param endian is the endian string of the encode function.
+ * \param isStructureMember should be true if the left hand side is a
+ *        member of a user structure, else the left hand side is a pointer
+ *        to the inMemoryType
+ * \param againstState should be true to encode a delta="packet" field as the
+ *        difference from _pg_state, which is updated with what the decoder will see.
+ * \return The string to add to the source file that encodes this field.
  */
-bool ProtocolField::isFloatScaling(void) const
+std::string ProtocolField::getEncodeStringForDelta(const std::string& spacing, const std::string& endian, bool isStructureMember, bool againstState) const
 {
-    // If the encoding is floating point then we are not scaling
-    if(encodedType.isFloat)
-        return false;
+    std::string output;
+    std::string argument = getLimitedArgument(getEncodeFieldAccess(isStructureMember));
+    std::string function = encodedType.toSigString() + "To" + endian + "Bytes(";
+    std::string unsignedType = "uint" + std::to_string(inMemoryType.bits) + "_t";
+    std::string loopspacing = spacing;
+    std::string prediction = "_pg_prediction";
+    std::string from = "previous element";
 
-    if(inMemoryType.isFloat)
+    if(isArray())
+        loopspacing += TAB_IN;
+
+    if(is2dArray())
+        loopspacing += TAB_IN;
+
+    // Differences between packets are from the state, which has the same layout as the user data
+    if(deltaPacket)
     {
-        // If the user input a scaler string, then they want float scaling
-        if(!scalerString.empty() || (scaler != 1.0))
-           return true;
+        from = "last packet";
 
-        // The min value only matters if we are signed
-        if(!encodedType.isSigned && (encodedMin != 0.0))
-            return true;
+        if(againstState)
+        {
+            prediction = "_pg_state->" + name;
+            if(isArray())
+                prediction += "[_pg_i]";
+            if(is2dArray())
+                prediction += "[_pg_j]";
+        }
+        else
+            prediction = "0";
     }
-    else
+
+    output += spacing + "{\n";
+
+    if(encodedType.bits >= inMemoryType.bits)
     {
-        // In this case the inMemoryType is not a float, but we might still
-        // want float scaling if the scaling terms are not integer
-        if((scaler != 1.0) && (ceil(scaler) != floor(scaler)))
-            return true;
+        std::string signedType = "int" + std::to_string(inMemoryType.bits) + "_t";
 
-        // The min value only matters if we are signed
-        if(!encodedType.isSigned && (encodedMin != 0.0) && (ceil(encodedMin) != floor(encodedMin)))
-            return true;
-    }
+        if(deltaElement)
+        {
+            output += spacing + TAB_IN + unsignedType + " _pg_prediction = 0;\n";
+            output += "\n";
+        }
 
-    return false;
+        output += getEncodeArrayIterationCode(spacing + TAB_IN, isStructureMember);
+        if(isArray())
+            output += loopspacing + "{\n";
 
-}// ProtocolField::isFloatScaling
+        output += loopspacing + TAB_IN + "// Difference from the " + from + ", wrapped to the in-memory width\n";
+        output += loopspacing + TAB_IN + function + "(" + signedType + ")(" + unsignedType + ")((" + unsignedType + ")" + argument + " - (" + unsignedType + ")" + prediction + "), _pg_data, &_pg_byteindex);\n";
 
+        if(deltaElement)
+            output += loopspacing + TAB_IN + "_pg_prediction = (" + unsignedType + ")" + argument + ";\n";
+        else if(againstState)
+            output += loopspacing + TAB_IN + prediction + " = " + argument + ";\n";
 
-/*!
- * Check to see if we should be doing integer scaling on this field. This
- * means encode and decode functions will inline scaling operations using integers.
- * \return true if scaling should be based on integer operations
- */
-bool ProtocolField::isIntegerScaling(void) const
-{
-    // If the encoding is floating point then we are not scaling
-    if(encodedType.isFloat)
-        return false;
 
-    if(!inMemoryType.isFloat)
+        if(isArray())
+            output += loopspacing + "}\n";
+    }
+    else
     {
-        if((scaler != 1.0) && (ceil(scaler) == floor(scaler)))
-            return true;
+        // The difference of two 16-bit numbers fits in 32 bits, 32-bit numbers need 64
+        std::string deltaType = (inMemoryType.bits > 16) ? "int64_t" : "int32_t";
+        std::string max = std::to_string(encodedType.getMaximumIntegerValue());
+        std::string min = std::to_string(encodedType.getMinimumIntegerValue());
 
-        // The min value only matters if we are signed
-        if(!encodedType.isSigned && (encodedMin != 0.0) && (ceil(encodedMin) == floor(encodedMin)))
-            return true;
+        if(deltaElement)
+            output += spacing + TAB_IN + typeName + " _pg_prediction = 0;\n";
+
+        output += spacing + TAB_IN + deltaType + " _pg_delta;\n";
+        output += "\n";
+        output += getEncodeArrayIterationCode(spacing + TAB_IN, isStructureMember);
+        if(isArray())
+            output += loopspacing + "{\n";
+
+        output += loopspacing + TAB_IN + "// Difference from the " + from + ", limited to the encoded range\n";
+        output += loopspacing + TAB_IN + "_pg_delta = (" + deltaType + ")" + argument + " - (" + deltaType + ")" + prediction + ";\n";
+        output += loopspacing + TAB_IN + "if(_pg_delta > " + max + ")\n";
+        output += loopspacing + TAB_IN + TAB_IN + "_pg_delta = " + max + ";\n";
+        output += loopspacing + TAB_IN + "else if(_pg_delta < " + min + ")\n";
+        output += loopspacing + TAB_IN + TAB_IN + "_pg_delta = " + min + ";\n";
+        output += loopspacing + TAB_IN + function + "(" + encodedType.toTypeString() + ")_pg_delta, _pg_data, &_pg_byteindex);\n";
+
+        if(deltaElement || againstState)
+        {
+            output += "\n";
+            output += loopspacing + TAB_IN + "// Predict the next " + (deltaElement ? "element" : "packet") + " from what the decoder will see\n";
+            output += loopspacing + TAB_IN + prediction + " = (" + typeName + ")(" + prediction + " + _pg_delta);\n";
+        }
+
+
+        if(isArray())
+            output += loopspacing + "}\n";
     }
 
-    return false;
+    output += spacing + "}\n";
 
-}// ProtocolField::isIntegerScaling
+    return output;
+
+}// ProtocolField::getEncodeStringForDelta
 
 
 /*!
- * Get the next lines(s) of source coded needed to decode this field, which
- * is not a bitfield or a string
+ * Get the next lines of source needed to decode a field whose elements are
+ * encoded as a difference. With delta="element" each element is the running
+ * sum of the differences. With delta="packet" the difference is added to the
+ * retained value in the diff decode, or to zero otherwise. The sums are
+ * computed with modulo arithmetic.
+ * \param spacing is the spacing that begins each line.
+ * \param endian is the endian string of the decode function.
  * \param isStructureMember should be true if the left hand side is a
  *        member of a user structure, else the left hand side is a pointer
  *        to the inMemoryType
- * \param defaultEnabled should be true to enable default handling
+ * \param againstState should be true to add the difference of a delta="packet"
+ *        field to the retained value.
  * \return The string to add to the source file that decodes this field.
  */
-std::string ProtocolField::getDecodeStringForField(bool isStructureMember, bool defaultEnabled) const
+std::string ProtocolField::getDecodeStringForDelta(const std::string& spacing, const std::string& endian, bool isStructureMember, bool againstState) const
 {
     std::string output;
-    std::string endian;
-    std::string spacing = TAB_IN;
-    std::string arrayspacing;
-    std::string argument;
+    std::string unsignedType = "uint" + std::to_string(inMemoryType.bits) + "_t";
+    std::string access = getDecodeFieldAccess(isStructureMember);
+    std::string difference = "(" + unsignedType + ")" + encodedType.toSigString() + "From" + endian + "Bytes(_pg_data, &_pg_byteindex)";
+    std::string loopspacing = spacing;
 
-    std::string constantstring = getConstantString();
+    // Wrap to the in-memory width, signed types need a second cast
+    std::string cast = "(" + unsignedType + ")";
+    if(typeName != unsignedType)
+        cast = "(" + typeName + ")" + cast;
 
-    if(encodedType.isNull)
-        return output;
+    if(isArray())
+        loopspacing += TAB_IN;
 
-    argument = getDecodeFieldAccess(isStructureMember);
+    if(is2dArray())
+        loopspacing += TAB_IN;
 
-    int length = encodedType.bits / 8;
+    output += spacing + "{\n";
 
-    // The endian string, which is empty for 1 byte, since
-    // endian only applies to multi-byte fields
-    if(length > 1)
+    if(deltaElement)
     {
-        if(support.bigendian)
-            endian += "Be";
-        else
-            endian += "Le";
+        output += spacing + TAB_IN + unsignedType + " _pg_prediction = 0;\n";
+        output += "\n";
     }
-    else
-        endian = "";
-
-    // What is the length in bytes of this field, remember that we could be encoding an array
-    std::string lengthString = std::to_string(length);
 
+    output += getDecodeArrayIterationCode(spacing + TAB_IN, isStructureMember);
     if(isArray())
+        output += loopspacing + "{\n";
+
+    if(deltaElement)
     {
-        if(variableArray.empty())
-            lengthString += "*" + array;
-        else
+        output += loopspacing + TAB_IN + "// Add the difference to the previous element\n";
+        output += loopspacing + TAB_IN + "_pg_prediction = (" + unsignedType + ")(_pg_prediction + " + difference + ");\n";
+        output += loopspacing + TAB_IN + access + " = (" + typeName + ")_pg_prediction;\n";
+    }
+    else if(againstState)
+    {
+        output += loopspacing + TAB_IN + "// Add the difference to the value of the last packet\n";
+        output += loopspacing + TAB_IN + access + " = " + cast + "((" + unsignedType + ")" + access + " + " + difference + ");\n";
+    }
+    else
+    {
+        output += loopspacing + TAB_IN + "// The difference from zero\n";
+        if(typeName == unsignedType)
+            output += loopspacing + TAB_IN + access + " = " + difference + ";\n";
+        else
+            output += loopspacing + TAB_IN + access + " = (" + typeName + ")" + difference + ";\n";
+    }
+
+    if(isArray())
+        output += loopspacing + "}\n";
+
+    output += spacing + "}\n";
+
+    return output;
+
+}// ProtocolField::getDecodeStringForDelta
+
+
+/*!
+ * Get the next lines of source needed to encode an array of bytes with run
+ * length compression.
+ * \param spacing is the spacing that begins each line.
+ * \param isStructureMember should be true if the left hand side is a
+ *        member of a user structure, else the left hand side is a pointer
+ *        to the inMemoryType
+ * \return The string to add to the source file that encodes this field.
+ */
+std::string ProtocolField::getEncodeStringForRle(const std::string& spacing, bool isStructureMember) const
+{
+    std::string access = name;
+
+    if(isStructureMember && (support->language == ProtocolSupport::c_language))
+        access = "_pg_user->" + name;
+
+    if(inMemoryType.isSigned)
+        access = "(const uint8_t*)" + access;
+
+    return spacing + "bytesToRleBytes(" + access + ", _pg_data, &_pg_byteindex, " + getRleByteCount(isStructureMember, true) + ");\n";
+
+}// ProtocolField::getEncodeStringForRle
+
+
+/*!
+ * Get the next lines of source needed to decode an array of bytes with run
+ * length compression. The decode fails if the compressed data describe more
+ * bytes than the array.
+ * \param spacing is the spacing that begins each line.
+ * \param isStructureMember should be true if the left hand side is a
+ *        member of a user structure, else the left hand side is a pointer
+ *        to the inMemoryType
+ * \return The string to add to the source file that decodes this field.
+ */
+std::string ProtocolField::getDecodeStringForRle(const std::string& spacing, bool isStructureMember) const
+{
+    std::string output;
+    std::string access = name;
+
+    if(isStructureMember && (support->language == ProtocolSupport::c_language))
+        access = "_pg_user->" + name;
+
+    if(inMemoryType.isSigned)
+        access = "(uint8_t*)" + access;
+
+    output += spacing + "if(!bytesFromRleBytes(" + access + ", _pg_data, &_pg_byteindex, " + getRleByteCount(isStructureMember, false) + "))\n";
+    output += spacing + TAB_IN + "return " + getReturnCode(false) + ";\n";
+
+    return output;
+
+}// ProtocolField::getDecodeStringForRle
+
+
+/*!
+ * Get the number of bytes of a run length compressed array, which is limited
+ * by the variable array length if there is one.
+ * \param isStructureMember should be true if the variable array length is a
+ *        member of a user structure.
+ * \param encode should be true for the encode context, else decode.
+ * \return the number of bytes as a code expression.
+ */
+std::string ProtocolField::getRleByteCount(bool isStructureMember, bool encode) const
+{
+    if(variableArray.empty())
+        return array;
+
+    std::string count;
+
+    if(encode)
+        count = getEncodeFieldAccess(isStructureMember, variableArray);
+    else
+        count = getDecodeFieldAccess(isStructureMember, variableArray);
+
+    return "((unsigned)" + count + " < " + array + ") ? (int)" + count + " : " + array;
+
+}// ProtocolField::getRleByteCount
+
+
+/*!
+ * Determine if this field can be referenced in place by the gather encode,
+ * which requires the encoded bytes to be the same as the bytes in memory.
+ * This emits a warning if it cannot.
+ * \return true if this field can be referenced in place.
+ */
+bool ProtocolField::canGather(void) const
+{
+    if(inMemoryType.isString)
+    {
+        if(encodedType.isNull || !constantString.empty() || !dictionary.empty())
+        {
+            emitWarning("gather cannot be combined with a constant or a dictionary, ignored");
+            return false;
+        }
+    }
+    else if(!isArray() || is2dArray() || inMemoryType.isNull || inMemoryType.isStruct || inMemoryType.isFloat || inMemoryType.isBool || inMemoryType.isEnum || (inMemoryType.bits != 8) ||
+            (encodedType.bits != 8) || encodedType.isFloat || encodedType.isBitfield || encodedType.isVarint || (encodedType.isSigned != inMemoryType.isSigned))
+    {
+        emitWarning("gather only applies to strings, and one dimensional arrays of bytes encoded as they are in memory, ignored");
+        return false;
+    }
+    else if(isFloatScaling() || isIntegerScaling() || !constantString.empty() || deltaElement || deltaPacket || rle || (getLimitedArgument(name) != name))
+    {
+        emitWarning("gather cannot be combined with scaling, a constant, delta or rle encoding, or encode limits, ignored");
+        return false;
+    }
+
+    return true;
+
+}// ProtocolField::canGather
+
+
+/*!
+ * Get the next lines of source needed to add this field to the segment list
+ * of the gather encode. The packet data before this field become one segment,
+ * and this field becomes the next segment, referenced in place. The bytes
+ * are the same as the normal encode would produce.
+ * \param isStructureMember should be true if the left hand side is a
+ *        member of a user structure, else the left hand side is a pointer
+ *        to the inMemoryType
+ * \return The string to add to the source file that references this field.
+ */
+std::string ProtocolField::getGatherEncodeString(bool isStructureMember) const
+{
+    std::string output;
+    std::string spacing = TAB_IN;
+    std::string access = name;
+
+    if(isStructureMember && (support->language == ProtocolSupport::c_language))
+        access = "_pg_user->" + name;
+
+    if(!comment.empty())
+        output += spacing + "// " + comment + "\n";
+
+    if(!dependsOn.empty())
+    {
+        output += spacing + "if(" + getEncodeFieldAccess(isStructureMember, dependsOn);
+
+        if(!dependsOnValue.empty())
+            output += " " + dependsOnCompare + " " + dependsOnValue;
+
+        output += ")\n" + spacing + "{\n";
+        spacing += TAB_IN;
+    }
+
+    // The number of bytes referenced in place, a string stops at its terminator
+    if(inMemoryType.isString)
+    {
+        output += spacing + "_pg_length = 0;\n";
+        output += spacing + "while((_pg_length < " + array + " - 1) && (" + access + "[_pg_length] != 0))\n";
+        output += spacing + TAB_IN + "_pg_length++;\n";
+    }
+    else
+        output += spacing + "_pg_length = " + getRleByteCount(isStructureMember, true) + ";\n";
+
+    output += "\n";
+    output += spacing + "// " + name + " is referenced in place, if it is not empty, the packet data before it are one segment\n";
+    output += spacing + "if(_pg_length > 0)\n";
+    output += spacing + "{\n";
+    output += spacing + TAB_IN + "if(_pg_byteindex > _pg_start)\n";
+    output += spacing + TAB_IN + "{\n";
+    output += spacing + TAB_IN + TAB_IN + "_pg_segments[_pg_numsegments].data = _pg_data + _pg_start;\n";
+    output += spacing + TAB_IN + TAB_IN + "_pg_segments[_pg_numsegments++].size = _pg_byteindex - _pg_start;\n";
+    output += spacing + TAB_IN + "}\n";
+    output += "\n";
+    output += spacing + TAB_IN + "_pg_segments[_pg_numsegments].data = (const uint8_t*)" + access + ";\n";
+    output += spacing + TAB_IN + "_pg_segments[_pg_numsegments++].size = _pg_length;\n";
+    output += spacing + TAB_IN + "_pg_gathered += _pg_length;\n";
+    output += spacing + TAB_IN + "_pg_start = _pg_byteindex;\n";
+    output += spacing + "}\n";
+
+    // The null termination, or padding, of a string is in the packet data
+    if(inMemoryType.isFixedString)
+    {
+        output += "\n";
+        output += spacing + "while(_pg_length++ < " + array + ")\n";
+        output += spacing + TAB_IN + "_pg_data[_pg_byteindex++] = 0;\n";
+    }
+    else if(inMemoryType.isString)
+    {
+        output += "\n";
+        output += spacing + "_pg_data[_pg_byteindex++] = 0;\n";
+    }
+
+    if(!dependsOn.empty())
+        output += TAB_IN + "}\n";
+
+    return output;
+
+}// ProtocolField::getGatherEncodeString
+
+
+/*!
+ * Determine if this field can be encoded and decoded one element at a time by
+ * the stream functions. Each element must have a fixed encoded length of whole
+ * bytes, which excludes bitfields, strings, structures, variable length
+ * integers, and delta or run length encoded arrays.
+ * \return true if this field can be part of the stream functions.
+ */
+bool ProtocolField::isStreamable(void) const
+{
+    // A field which is not encoded is not part of the stream
+    if(encodedType.isNull)
+        return true;
+
+    if(encodedType.isBitfield || encodedType.isString || encodedType.isVarint || inMemoryType.isString || inMemoryType.isStruct)
+        return false;
+
+    return !deltaElement && !deltaPacket && !rle;
+
+}// ProtocolField::isStreamable
+
+
+/*!
+ * Get the condition under which the stream functions process the next element
+ * of this field, which includes the depends on test and the array limits.
+ * \param isStructureMember should be true if the left hand side is a
+ *        member of a user structure.
+ * \param encode should be true for the encode context, false for decode.
+ * \return the condition, which is empty if the field is always processed.
+ */
+std::string ProtocolField::getStreamCondition(bool isStructureMember, bool encode) const
+{
+    std::vector<std::string> terms;
+
+    if(!dependsOn.empty())
+    {
+        std::string term;
+
+        if(encode)
+            term = getEncodeFieldAccess(isStructureMember, dependsOn);
+        else
+            term = getDecodeFieldAccess(isStructureMember, dependsOn);
+
+        if(!dependsOnValue.empty())
+            term += " " + dependsOnCompare + " " + dependsOnValue;
+
+        terms.push_back(term);
+    }
+
+    if(isArray())
+        terms.push_back("_pg_i < " + getStreamArrayLimit(variableArray, array, isStructureMember, encode));
+
+    if(is2dArray())
+        terms.push_back("_pg_j < " + getStreamArrayLimit(variable2dArray, array2d, isStructureMember, encode));
+
+    // Multiple terms are each in parentheses
+    if(terms.size() == 1)
+        return terms.front();
+
+    std::string condition;
+    for(std::size_t i = 0; i < terms.size(); i++)
+    {
+        if(i > 0)
+            condition += " && ";
+
+        condition += "(" + terms.at(i) + ")";
+    }
+
+    return condition;
+
+}// ProtocolField::getStreamCondition
+
+
+/*!
+ * Get the number of elements of an array dimension for the stream functions,
+ * limited by the variable array length if there is one.
+ * \param variable is the name of the variable length, which can be empty.
+ * \param size is the size of the array dimension.
+ * \param isStructureMember should be true if the left hand side is a
+ *        member of a user structure.
+ * \param encode should be true for the encode context, false for decode.
+ * \return the number of elements.
+ */
+std::string ProtocolField::getStreamArrayLimit(const std::string& variable, const std::string& size, bool isStructureMember, bool encode) const
+{
+    if(variable.empty())
+        return size;
+
+    std::string access;
+    if(encode)
+        access = getEncodeFieldAccess(isStructureMember, variable);
+    else
+        access = getDecodeFieldAccess(isStructureMember, variable);
+
+    return "(((unsigned)" + access + " < " + size + ") ? (unsigned)" + access + " : " + size + ")";
+
+}// ProtocolField::getStreamArrayLimit
+
+
+/*!
+ * Get the string that moves the stream functions to the next element of this
+ * field, the second array index moves fastest.
+ * \param spacing is the spacing that begins each line.
+ * \param isStructureMember should be true if the left hand side is a
+ *        member of a user structure.
+ * \param encode should be true for the encode context, false for decode.
+ * \return the string that moves to the next element.
+ */
+std::string ProtocolField::getStreamNextElementString(const std::string& spacing, bool isStructureMember, bool encode) const
+{
+    std::string output;
+
+    if(!isArray())
+        output += spacing + "_pg_state->field++;\n";
+    else if(!is2dArray())
+        output += spacing + "_pg_state->i++;\n";
+    else
+    {
+        output += spacing + "if(++_pg_state->j >= " + getStreamArrayLimit(variable2dArray, array2d, isStructureMember, encode) + ")\n";
+        output += spacing + "{\n";
+        output += spacing + TAB_IN + "_pg_state->j = 0;\n";
+        output += spacing + TAB_IN + "_pg_state->i++;\n";
+        output += spacing + "}\n";
+    }
+
+    return output;
+
+}// ProtocolField::getStreamNextElementString
+
+
+/*!
+ * Get the string that moves the stream functions to the next field, once all
+ * the elements of this field are done.
+ * \param spacing is the spacing that begins each line.
+ * \return the string that moves to the next field.
+ */
+std::string ProtocolField::getStreamNextFieldString(const std::string& spacing) const
+{
+    std::string output;
+
+    if(!isArray())
+        output += spacing + "_pg_state->field++;\n";
+    else
+    {
+        output += spacing + "{\n";
+        output += spacing + TAB_IN + "_pg_state->field++;\n";
+        output += spacing + TAB_IN + "_pg_state->i = 0;\n";
+        if(is2dArray())
+            output += spacing + TAB_IN + "_pg_state->j = 0;\n";
+        output += spacing + "}\n";
+    }
+
+    return output;
+
+}// ProtocolField::getStreamNextFieldString
+
+
+/*!
+ * Get the string that encodes the next element of this field in the stream
+ * encode. The element is encoded in the state, from where the stream encode
+ * copies it into the chunks.
+ * \param spacing is the spacing that begins each line.
+ * \param isStructureMember should be true if the left hand side is a
+ *        member of a user structure.
+ * \return the string that encodes the next element.
+ */
+std::string ProtocolField::getStreamEncodeString(const std::string& spacing, bool isStructureMember) const
+{
+    std::string output;
+    std::string condition = getStreamCondition(isStructureMember, true);
+
+    // Constant encode overrides the argument
+    std::string argument = getConstantString();
+    if(argument.empty())
+        argument = getLimitedArgument(getEncodeFieldAccess(isStructureMember));
+
+    if(!comment.empty())
+        output += spacing + "// " + comment + "\n";
+
+    if(condition.empty())
+    {
+        output += spacing + getEncodeStringForElement(argument);
+        output += getStreamNextElementString(spacing, isStructureMember, true);
+    }
+    else if(!isArray())
+    {
+        output += spacing + "if(" + condition + ")\n";
+        output += spacing + TAB_IN + getEncodeStringForElement(argument);
+        output += getStreamNextElementString(spacing, isStructureMember, true);
+    }
+    else
+    {
+        output += spacing + "if(" + condition + ")\n";
+        output += spacing + "{\n";
+        output += spacing + TAB_IN + getEncodeStringForElement(argument);
+        output += getStreamNextElementString(spacing + TAB_IN, isStructureMember, true);
+        output += spacing + "}\n";
+        output += spacing + "else\n";
+        output += getStreamNextFieldString(spacing);
+    }
+
+    return output;
+
+}// ProtocolField::getStreamEncodeString
+
+
+/*!
+ * Get the string that finds the length of the next element of this field in
+ * the stream decode, or moves to the next field if there are no more elements.
+ * \param spacing is the spacing that begins each line.
+ * \param isStructureMember should be true if the left hand side is a
+ *        member of a user structure.
+ * \return the string that finds the length of the next element.
+ */
+std::string ProtocolField::getStreamLengthString(const std::string& spacing, bool isStructureMember) const
+{
+    std::string output;
+    std::string condition = getStreamCondition(isStructureMember, false);
+    std::string length = std::to_string(encodedType.bits / 8);
+
+    if(condition.empty())
+        output += spacing + "_pg_state->length = " + length + ";\n";
+    else
+    {
+        output += spacing + "if(" + condition + ")\n";
+        output += spacing + TAB_IN + "_pg_state->length = " + length + ";\n";
+        output += spacing + "else\n";
+
+        if(isArray())
+            output += getStreamNextFieldString(spacing);
+        else
+            output += getStreamNextFieldString(spacing + TAB_IN);
+    }
+
+    return output;
+
+}// ProtocolField::getStreamLengthString
+
+
+/*!
+ * Get the string that decodes the next element of this field in the stream
+ * decode, once all the bytes of the element have been collected in the state.
+ * \param spacing is the spacing that begins each line.
+ * \param isStructureMember should be true if the left hand side is a
+ *        member of a user structure.
+ * \return the string that decodes the next element.
+ */
+std::string ProtocolField::getStreamDecodeString(const std::string& spacing, bool isStructureMember) const
+{
+    std::string output;
+    std::string argument = getDecodeFieldAccess(isStructureMember);
+
+    if(!comment.empty())
+        output += spacing + "// " + comment + "\n";
+
+    if(inMemoryType.isNull)
+    {
+        if(checkConstant)
+            output += getDecodeConstantCheck(spacing, "-1");
+        else if(comment.empty())
+        {
+            // Skip over reserved space
+            output += spacing + "// Skip over reserved space\n";
+        }
+    }
+    else
+    {
+        output += spacing + getDecodeStringForElement(argument);
+
+        if(checkConstant)
+        {
+            output += spacing + "if(" + argument + " != " + getConstantString() + ")\n";
+            output += spacing + TAB_IN + "return -1;\n";
+        }
+    }
+
+    output += getStreamNextElementString(spacing, isStructureMember, false);
+
+    return output;
+
+}// ProtocolField::getStreamDecodeString
+
+
+/*!
+ * Get the declaration of the dictionary of a string field, which is a static
+ * table of the likely values of the string named `_pg_dictionary`.
+ * \param spacing is the spacing that begins each line.
+ * \return the declaration.
+ */
+std::string ProtocolField::getDictionaryDeclaration(const std::string& spacing) const
+{
+    std::string output = spacing + "static const char* const _pg_dictionary[" + std::to_string(dictionary.size()) + "] = {";
+
+    for(std::size_t i = 0; i < dictionary.size(); i++)
+    {
+        if(i > 0)
+            output += ", ";
+
+        // Escape the characters that are special in a string literal
+        output += "\"" + replace(replace(dictionary.at(i), "\\", "\\\\"), "\"", "\\\"") + "\"";
+    }
+
+    output += "};\n";
+
+    return output;
+
+}// ProtocolField::getDictionaryDeclaration
+
+
+/*!
+ * Check to see if we should be doing floating point scaling on this field.
+ * This means the encode operation is going to call a function like
+ * `float32To...()`; and the decode function is going to call a function like
+ * `float32From...()`.
+ * \return true if scaling should be based on floating point operations
+ */
+bool ProtocolField::isFloatScaling(void) const
+{
+    // If the encoding is floating point then we are not scaling
+    if(encodedType.isFloat)
+        return false;
+
+    if(inMemoryType.isFloat)
+    {
+        // If the user input a scaler string, then they want float scaling
+        if(!scalerString.empty() || (scaler != 1.0))
+           return true;
+
+        // The min value only matters if we are signed
+        if(!encodedType.isSigned && (encodedMin != 0.0))
+            return true;
+    }
+    else
+    {
+        // In this case the inMemoryType is not a float, but we might still
+        // want float scaling if the scaling terms are not integer
+        if((scaler != 1.0) && (ceil(scaler) != floor(scaler)))
+            return true;
+
+        // The min value only matters if we are signed
+        if(!encodedType.isSigned && (encodedMin != 0.0) && (ceil(encodedMin) != floor(encodedMin)))
+            return true;
+    }
+
+    return false;
+
+}// ProtocolField::isFloatScaling
+
+
+/*!
+ * Check to see if we should be doing integer scaling on this field. This
+ * means encode and decode functions will inline scaling operations using integers.
+ * \return true if scaling should be based on integer operations
+ */
+bool ProtocolField::isIntegerScaling(void) const
+{
+    // If the encoding is floating point then we are not scaling
+    if(encodedType.isFloat)
+        return false;
+
+    if(!inMemoryType.isFloat)
+    {
+        if((scaler != 1.0) && (ceil(scaler) == floor(scaler)))
+            return true;
+
+        // The min value only matters if we are signed
+        if(!encodedType.isSigned && (encodedMin != 0.0) && (ceil(encodedMin) == floor(encodedMin)))
+            return true;
+    }
+
+    return false;
+
+}// ProtocolField::isIntegerScaling
+
+
+/*!
+ * Check to see if this field is a variable length integer decoded into an
+ * in-memory integer narrower than 32 bits, without scaling. The decode limits
+ * the number to the range of the in-memory type, rather than truncate it.
+ * \return true if the variable length integer is limited to a narrow in-memory type
+ */
+bool ProtocolField::isNarrowVarint(void) const
+{
+    if(!encodedType.isVarint || deltaElement || deltaPacket || isFloatScaling() || isIntegerScaling())
+        return false;
+
+    if(inMemoryType.isFloat || inMemoryType.isBool || inMemoryType.isEnum || inMemoryType.isNull || inMemoryType.isStruct)
+        return false;
+
+    return (inMemoryType.bits < 32) && (inMemoryType.isSigned == encodedType.isSigned);
+
+}// ProtocolField::isNarrowVarint
+
+
+/*!
+ * Get the next lines(s) of source coded needed to decode this field, which
+ * is not a bitfield or a string
+ * \param isStructureMember should be true if the left hand side is a
+ *        member of a user structure, else the left hand side is a pointer
+ *        to the inMemoryType
+ * \param defaultEnabled should be true to enable default handling
+ * \param againstState should be true to add the difference of a delta="packet"
+ *        field to the retained value, as the diff decode does.
+ * \return The string to add to the source file that decodes this field.
+ */
+std::string ProtocolField::getDecodeStringForField(bool isStructureMember, bool defaultEnabled, bool againstState) const
+{
+    std::string output;
+    std::string endian;
+    std::string spacing = TAB_IN;
+    std::string arrayspacing;
+    std::string argument;
+
+    std::string constantstring = getConstantString();
+
+    if(encodedType.isNull)
+        return output;
+
+    argument = getDecodeFieldAccess(isStructureMember);
+
+    int length = encodedType.bits / 8;
+
+    // The endian string, which is empty for 1 byte, since
+    // endian only applies to multi-byte fields
+    if(encodedType.isVarint)
+        endian = "Var";
+    else if(length > 1)
+    {
+        if(support->bigendian)
+            endian += "Be";
+        else
+            endian += "Le";
+    }
+    else
+        endian = "";
+
+    // What is the length in bytes of this field, remember that we could be encoding an array.
+    // Variable length integers are only known to have at least one byte each
+    std::string lengthString = std::to_string(encodedType.isVarint ? 1 : length);
+
+    if(isArray())
+    {
+        if(variableArray.empty())
+            lengthString += "*" + array;
+        else
             lengthString += "*" + getDecodeFieldAccess(isStructureMember, variableArray);
 
         if(is2dArray())
@@ -5374,31 +7234,7 @@ std::string ProtocolField::getDecodeStringForField(bool isStructureMember, bool
     {
         if(checkConstant && array.empty())
         {
-            output += spacing + "if (";
-
-            if(encodedType.isFloat)
-            {
-                if(encodedType.bits == 16)
-                    output += "float16From" + endian + "Bytes(_pg_data, &_pg_byteindex, " + std::to_string(encodedType.sigbits) + ")";
-                else if(encodedType.bits == 24)
-                    output += "float24From" + endian + "Bytes(_pg_data, &_pg_byteindex, " + std::to_string(encodedType.sigbits) + ")";
-                else if((inMemoryType.bits > 32) && support.float64)
-                    output += "float64From" + endian + "Bytes(_pg_data, &_pg_byteindex)";
-                else
-                    output += "float32From" + endian + "Bytes(_pg_data, &_pg_byteindex)";
-            }
-            else
-            {
-                if(encodedType.isSigned)
-                    output += "int";
-                else
-                    output += "uint";
-
-                output += std::to_string(encodedType.bits) + "From" + endian + "Bytes(_pg_data, &_pg_byteindex)";
-            }
-
-            output += " != (" + encodedType.toTypeString() + ") " + constantstring + ")\n";
-            output += spacing + TAB_IN + "return " + getReturnCode(false) + ";\n";
+            output += getDecodeConstantCheck(spacing, getReturnCode(false));
 
         }// If constant value must be checked
         else
@@ -5407,11 +7243,25 @@ std::string ProtocolField::getDecodeStringForField(bool isStructureMember, bool
             if(comment.empty())
                 output += spacing + "// Skip over reserved space\n";
 
-            output += spacing + "_pg_byteindex += " + lengthString + ";\n";
+            // The length of a variable length integer is only known by decoding it
+            if(encodedType.isVarint)
+                output += spacing + "(void)" + encodedType.toSigString() + "FromVarBytes(_pg_data, &_pg_byteindex);\n";
+            else
+                output += spacing + "_pg_byteindex += " + lengthString + ";\n";
 
         }// else constant value is not checked
 
     }// If nothing in-memory
+    else if(deltaElement || deltaPacket)
+    {
+        output += getDecodeStringForDelta(spacing, endian, isStructureMember, againstState);
+
+    }// else if delta encoded array
+    else if(rle)
+    {
+        output += getDecodeStringForRle(spacing, isStructureMember);
+
+    }// else if run length compressed array
     else
     {
         output += getDecodeArrayIterationCode(spacing, isStructureMember);
@@ -5424,144 +7274,247 @@ std::string ProtocolField::getDecodeStringForField(bool isStructureMember, bool
                 arrayspacing += TAB_IN;
          }
 
-        if(encodedType.isFloat)
-        {
-            // In this case we are encoding as a floating point. Typically we
-            // would not scale here, but there are cases where scaling is
-            // interesting.
-            std::string scalestring;
+        output += spacing + arrayspacing + getDecodeStringForElement(argument);
 
-            // Notice that encodedMax and encodedMin do not make sense since
-            // the encoded type is float
-            if(scaler != 1.0)
-                scalestring = "(" + getNumberString(1.0, inMemoryType.bits) + "/" + getNumberString(scaler, inMemoryType.bits) + ")*" ;
+    }// else not null in-memory
 
-            output += spacing + arrayspacing + argument + " = " + scalestring + "float" + std::to_string(encodedType.bits) + "From" + endian + "Bytes(_pg_data, &_pg_byteindex";
+    // Handle the check constant case, the null case was handled above
+    if(!inMemoryType.isNull && checkConstant)
+    {
+        output += spacing + arrayspacing + "if (" + argument + " != " + constantstring + ")\n";
+        output += spacing + arrayspacing + TAB_IN + "return " + getReturnCode(false) + ";\n";
+    }
 
-            if((encodedType.bits == 16) || (encodedType.bits == 24))
-                output += ", " + std::to_string(encodedType.sigbits);
+    // The length check before a default field only guaranteed one byte of a
+    // variable length integer, check again now that its length is known
+    if(defaultEnabled && (!defaultString.empty() || overridesPrevious) && encodedType.isVarint)
+    {
+        output += spacing + "if(_pg_byteindex > _pg_numbytes)\n";
+        output += spacing + TAB_IN + "return " + getReturnCode(false) + ";\n";
+    }
 
-            output += ");\n";
+    // Close the depends on block
+    if(!dependsOn.empty())
+        output += TAB_IN + "}\n";
 
-        }// if float
-        else if(isFloatScaling())
-        {
-            output += spacing + arrayspacing + argument + " = ";
+    return output;
 
-            // The cast if the in memory type is not floating
-            if(!inMemoryType.isFloat)
-                output += "(" + inMemoryType.toTypeString() + ")";
+}// ProtocolField::getDecodeStringForField
 
-            if((inMemoryType.bits > 32) && support.float64)
-                output += "float64";
-            else
-                output += "float32";
 
-            // The scaling decode function
-            output += "ScaledFrom" + std::to_string(length);
+/*!
+ * Get the statement that decodes a field which is not in memory and fails the
+ * decode if the value is not the constant.
+ * \param spacing is the spacing that begins each line.
+ * \param failure is the value to return if the decoded value is not the constant.
+ * \return the constant check, including the line feeds.
+ */
+std::string ProtocolField::getDecodeConstantCheck(const std::string& spacing, const std::string& failure) const
+{
+    std::string output;
+    std::string endian;
 
-            // Signed or unsigned
-            if(encodedType.isSigned)
-                output += "Signed";
-            else
-                output += "Unsigned";
+    // The endian string, which is empty for 1 byte
+    if(encodedType.isVarint)
+        endian = "Var";
+    else if(encodedType.bits > 8)
+    {
+        if(support->bigendian)
+            endian = "Be";
+        else
+            endian = "Le";
+    }
 
-            output += endian + "Bytes(_pg_data, &_pg_byteindex";
+    output += spacing + "if (";
 
-            // Signature changes for signed versus unsigned
-            if(!encodedType.isSigned)
-                output += ", " + getNumberString(encodedMin, inMemoryType.bits);
+    if(encodedType.isFloat)
+    {
+        if(encodedType.bits == 16)
+            output += "float16From" + endian + "Bytes(_pg_data, &_pg_byteindex, " + std::to_string(encodedType.sigbits) + ")";
+        else if(encodedType.bits == 24)
+            output += "float24From" + endian + "Bytes(_pg_data, &_pg_byteindex, " + std::to_string(encodedType.sigbits) + ")";
+        else if((inMemoryType.bits > 32) && support->float64)
+            output += "float64From" + endian + "Bytes(_pg_data, &_pg_byteindex)";
+        else
+            output += "float32From" + endian + "Bytes(_pg_data, &_pg_byteindex)";
+    }
+    else
+    {
+        if(encodedType.isSigned)
+            output += "int";
+        else
+            output += "uint";
 
-            // Notice how the scaling value is the inverse for the decode function
-            output += ", " + getNumberString(1.0, inMemoryType.bits) + "/" + getNumberString(scaler, inMemoryType.bits);
+        output += std::to_string(encodedType.bits) + "From" + endian + "Bytes(_pg_data, &_pg_byteindex)";
+    }
 
-            output += ");\n";
+    output += " != (" + encodedType.toTypeString() + ") " + getConstantString() + ")\n";
+    output += spacing + TAB_IN + "return " + failure + ";\n";
 
-        }// if float scaling to integer
-        else if(isIntegerScaling())
-        {
-            output += spacing + arrayspacing + argument + " = ";
+    return output;
 
-            // If the scaler is 1, add the minimum value in directly - save the cost of division
-            if(scaler == 1.0)
-            {
-                // Might need a cast
-                if((inMemoryType.isSigned != encodedType.isSigned) || (inMemoryType.bits < encodedType.bits))
-                    output += "(" + inMemoryType.toTypeString() + ")";
+}// ProtocolField::getDecodeConstantCheck
 
-                // "int32FromBeBytes(data, &_pg_byteindex)" for example
-                output += "(" + encodedType.toSigString() + "From" + endian + "Bytes(_pg_data, &_pg_byteindex) + " + std::to_string((int64_t)round(encodedMin)) + ");\n";
-            }
-            else
-            {
-                // "uint32" or "int16" for example
-                output += inMemoryType.toSigString();
 
-                // Scaled from a number of bytes
-                output += "ScaledFrom" + std::to_string(length);
+/*!
+ * Get the statement that decodes one element of this field, which is a single
+ * value, or one element of an array.
+ * \param argument is the value which receives the decoded element.
+ * \return the decode statement, including the semicolon and line feed but not
+ *         the leading spacing.
+ */
+std::string ProtocolField::getDecodeStringForElement(const std::string& argument) const
+{
+    std::string output;
+    std::string endian;
+
+    int length = encodedType.bits / 8;
 
-                // Signed or unsigned
-                if(encodedType.isSigned)
-                    output += "Signed";
-                else
-                    output += "Unsigned";
+    // The endian string, which is empty for 1 byte, since
+    // endian only applies to multi-byte fields
+    if(encodedType.isVarint)
+        endian = "Var";
+    else if(length > 1)
+    {
+        if(support->bigendian)
+            endian += "Be";
+        else
+            endian += "Le";
+    }
+    else
+        endian = "";
+
+    if(encodedType.isFloat)
+    {
+        // In this case we are encoding as a floating point. Typically we
+        // would not scale here, but there are cases where scaling is
+        // interesting.
+        std::string scalestring;
+
+        // Notice that encodedMax and encodedMin do not make sense since
+        // the encoded type is float
+        if(scaler != 1.0)
+            scalestring = "(" + getNumberString(1.0, inMemoryType.bits) + "/" + getNumberString(scaler, inMemoryType.bits) + ")*" ;
 
-                // In an endian order
-                output += endian + "Bytes(_pg_data, &_pg_byteindex";
+        output += argument + " = " + scalestring + "float" + std::to_string(encodedType.bits) + "From" + endian + "Bytes(_pg_data, &_pg_byteindex";
 
-                // Signature changes for signed versus unsigned
-                if(!encodedType.isSigned)
-                    output += ", " + std::to_string((int64_t)round(encodedMin));
+        if((encodedType.bits == 16) || (encodedType.bits == 24))
+            output += ", " + std::to_string(encodedType.sigbits);
 
-                output += ", " + std::to_string((int64_t)round(scaler));
+        output += ");\n";
 
-                output += ");\n";
-            }
+    }// if float
+    else if(isFloatScaling())
+    {
+        output += argument + " = ";
+
+        // The cast if the in memory type is not floating
+        if(!inMemoryType.isFloat)
+            output += "(" + inMemoryType.toTypeString() + ")";
+
+        if((inMemoryType.bits > 32) && support->float64)
+            output += "float64";
+        else
+            output += "float32";
+
+        // The scaling decode function
+        output += "ScaledFrom" + std::to_string(length);
+
+        // Signed or unsigned
+        if(encodedType.isSigned)
+            output += "Signed";
+        else
+            output += "Unsigned";
+
+        output += endian + "Bytes(_pg_data, &_pg_byteindex";
+
+        // Signature changes for signed versus unsigned
+        if(!encodedType.isSigned)
+            output += ", " + getNumberString(encodedMin, inMemoryType.bits);
+
+        // Notice how the scaling value is the inverse for the decode function
+        output += ", " + getNumberString(1.0, inMemoryType.bits) + "/" + getNumberString(scaler, inMemoryType.bits);
+
+        output += ");\n";
 
-        }// else if integer scaling to integer
+    }// if float scaling to integer
+    else if(isIntegerScaling())
+    {
+        output += argument + " = ";
+
+        // If the scaler is 1, add the minimum value in directly - save the cost of division
+        if(scaler == 1.0)
+        {
+            // Might need a cast
+            if((inMemoryType.isSigned != encodedType.isSigned) || (inMemoryType.bits < encodedType.bits))
+                output += "(" + inMemoryType.toTypeString() + ")";
+
+            // "int32FromBeBytes(data, &_pg_byteindex)" for example
+            output += "(" + encodedType.toSigString() + "From" + endian + "Bytes(_pg_data, &_pg_byteindex) + " + std::to_string((int64_t)round(encodedMin)) + ");\n";
+        }
         else
         {
-            std::string function;
+            // "uint32" or "int16" for example
+            output += inMemoryType.toSigString();
 
+            // Scaled from a number of bytes
+            output += "ScaledFrom" + std::to_string(length);
+
+            // Signed or unsigned
             if(encodedType.isSigned)
-                function = "int";
+                output += "Signed";
             else
-                function = "uint";
-
-            // "int32FromBeBytes(data, &_pg_byteindex)" for example
-            function += std::to_string(encodedType.bits) + "From" + endian + "Bytes(_pg_data, &_pg_byteindex)";
+                output += "Unsigned";
 
-            if(inMemoryType.isBool)
-            {
-                function = "(" + function + ") ? true : false";
-            }
-            else if(inMemoryType.isFloat || (inMemoryType.bits != encodedType.bits) || inMemoryType.isEnum)
-            {
-                // Add a cast in case the encoded type is different from the in memory type
-                // "int32ToBeBytes((int32_t)((_pg_user->value - min)*scale)" for example
-                function = "(" + typeName + ")" + function;
-            }
+            // In an endian order
+            output += endian + "Bytes(_pg_data, &_pg_byteindex";
 
-            output += spacing + arrayspacing + argument + " = " + function + ";\n";
+            // Signature changes for signed versus unsigned
+            if(!encodedType.isSigned)
+                output += ", " + std::to_string((int64_t)round(encodedMin));
 
-        }// else not floating point scaled
+            output += ", " + std::to_string((int64_t)round(scaler));
 
-    }// else not null in-memory
+            output += ");\n";
+        }
 
-    // Handle the check constant case, the null case was handled above
-    if(!inMemoryType.isNull && checkConstant)
+    }// else if integer scaling to integer
+    else
     {
-        output += spacing + arrayspacing + "if (" + argument + " != " + constantstring + ")\n";
-        output += spacing + arrayspacing + TAB_IN + "return " + getReturnCode(false) + ";\n";
-    }
+        std::string function;
 
-    // Close the depends on block
-    if(!dependsOn.empty())
-        output += TAB_IN + "}\n";
+        if(encodedType.isSigned)
+            function = "int";
+        else
+            function = "uint";
+
+        // A narrow in-memory integer decodes a variable length integer limited to its range
+        if(isNarrowVarint())
+            function += std::to_string(inMemoryType.bits) + "FromVarBytes(_pg_data, &_pg_byteindex)";
+        else
+        {
+            // "int32FromBeBytes(data, &_pg_byteindex)" for example
+            function += std::to_string(encodedType.bits) + "From" + endian + "Bytes(_pg_data, &_pg_byteindex)";
+        }
+
+        if(inMemoryType.isBool)
+        {
+            function = "(" + function + ") ? true : false";
+        }
+        else if(inMemoryType.isFloat || ((inMemoryType.bits != encodedType.bits) && !isNarrowVarint()) || inMemoryType.isEnum)
+        {
+            // Add a cast in case the encoded type is different from the in memory type
+            // "int32ToBeBytes((int32_t)((_pg_user->value - min)*scale)" for example
+            function = "(" + typeName + ")" + function;
+        }
+
+        output += argument + " = " + function + ";\n";
+
+    }// else not floating point scaled
 
     return output;
 
-}// ProtocolField::getDecodeStringForField
+}// ProtocolField::getDecodeStringForElement
 
 
 /*!
@@ -5583,7 +7536,7 @@ std::string ProtocolField::getNumberString(double number, int bits) const
     // Note DBL_DECIMAL_DIG is 17 in IEE-754. This results in unsightly
     // rounding, for example 65.534999999999997 instead of 65.535. Hence
     // use one less (which is what we used to have).
-    if((bits <= 32) || !support.float64)
+    if((bits <= 32) || !support->float64)
         stream << std::setprecision(std::numeric_limits<float>::max_digits10);
     else
         stream << std::setprecision(std::numeric_limits<double>::max_digits10 - 1);
@@ -5599,7 +7552,7 @@ std::string ProtocolField::getNumberString(double number, int bits) const
         string += ".0";
 
     // Floating point constant
-    if((bits <= 32) || !support.float64)
+    if((bits <= 32) || !support->float64)
         string += "f";
 
     return string;
@@ -10,7 +10,7 @@ class TypeData
 public:
 
     //! Construct empty type data
-    TypeData(ProtocolSupport sup);
+    TypeData(SharedSupport sup);
 
     //! Reset all members to default except the protocol support
     void clear(void);
@@ -25,6 +25,7 @@ public:
     bool isString;      //!< true if type is a variable length string
     bool isFixedString; //!< true if type is a fixed length string
     bool isNull;        //!< true if type is null, i.e not in memory OR not encoded
+    bool isVarint;      //!< true if type is encoded as a variable length integer
     int bits;           //!< number of bits used by type
     int sigbits;        //!< number of bits for the significand of a float16 or float24
     int enummax;        //!< maximum value of the enumeration if isEnum is true
@@ -59,7 +60,7 @@ public:
 
 private:
 
-    ProtocolSupport support;
+    SharedSupport support;
 };
 
 
@@ -112,7 +113,7 @@ public:
     };
 
     //! Construct a field, setting the protocol name and name prefix
-    ProtocolField(ProtocolParser* parse, std::string parent, ProtocolSupport supported);
+    ProtocolField(ProtocolParser* parse, std::string parent, SharedSupport supported);
 
     //! Provide the pointer to a previous encodable in the list
     void setPreviousEncodable(Encodable* prev) override;
@@ -177,6 +178,9 @@ public:
     //! Return the include directives needed for this encodable's map functions
     void getMapIncludeDirectives(std::vector<std::string>& list) const override;
 
+    //! Return the include directives needed for this encodable's JSON and CBOR functions
+    void getJsonIncludeDirectives(std::vector<std::string>& list) const override;
+
     //! Return the include directives needed for this encodable's compare functions
     void getCompareIncludeDirectives(std::vector<std::string>& list) const override;
 
@@ -207,12 +211,45 @@ public:
     //! Return the string that is used to decode this encoable
     std::string getDecodeString(int* bitcount, bool isStructureMember, bool defaultEnabled = false) const override;
 
+    //! Return the string that encodes this field in the diff encode, which may be the difference from the state
+    std::string getDiffEncodeString(int* bitcount, bool isStructureMember) const;
+
+    //! Return the string that decodes this field in the diff decode, which may add a difference to the retained value
+    std::string getDiffDecodeString(int* bitcount, bool isStructureMember) const;
+
+    //! True if the diff functions encode this field as the difference from the last packet
+    bool isDeltaPacket(void) const {return deltaPacket;}
+
     //! Return the string that sets this encodable to its default value in code
     std::string getSetToDefaultsString(bool isStructureMember) const override;
 
+    //! True if the gather encode references this field in place
+    bool isGather(void) const override {return gather;}
+
+    //! Return the string that adds this field to the segment list of the gather encode
+    std::string getGatherEncodeString(bool isStructureMember) const override;
+
+    //! True if this field can be encoded and decoded one element at a time by the stream functions
+    bool isStreamable(void) const;
+
+    //! Return the string that encodes the next element of this field in the stream encode
+    std::string getStreamEncodeString(const std::string& spacing, bool isStructureMember) const;
+
+    //! Return the string that finds the length of the next element of this field in the stream decode
+    std::string getStreamLengthString(const std::string& spacing, bool isStructureMember) const;
+
+    //! Return the string that decodes the next element of this field in the stream decode
+    std::string getStreamDecodeString(const std::string& spacing, bool isStructureMember) const;
+
     //! Get the string used for verifying this field.
     std::string getVerifyString(void) const override;
 
+    //! True if this field is an array of numbers verified by a branch free clamp loop
+    bool usesVerifyClampLoop(void) const;
+
+    //! Get the branch free clamp loop that verifies an array of numbers
+    std::string getVerifyClampLoopString(void) const;
+
     //! Get the string used for comparing this field.
     std::string getComparisonString(void) const override;
 
@@ -228,12 +265,21 @@ public:
     //! Get the string used for map decoding this field
     std::string getMapDecodeString(void) const override;
 
+    //! Get the string used for writing this field to JSON or CBOR
+    std::string getJsonWriteString(bool cbor) const override;
+
+    //! Get the string used for reading this field from JSON or CBOR
+    std::string getJsonReadString(const std::string& spacing, bool cbor) const override;
+
     //! Return the string that sets this encodable to its initial value in code
     std::string getSetInitialValueString(bool isStructureMember) const override;
 
     //! Return the string that sets this encodable to specific value in code
     std::string getSetToValueString(bool isStructureMember, std::string value) const;
 
+    //! Return the value of this field in the static initializer of its parent, empty if zero
+    std::string getStaticInitializerString(bool* ok) const override;
+
     //! Return the strings that #define initial and variable values
     std::string getInitialAndVerifyDefines(bool includeComment = true) const override;
 
@@ -277,16 +323,22 @@ public:
     bool usesDecodeTempLongBitfield(void) const override;
 
     //! True if this encodable has a direct child that needs an iterator on encode
-    bool usesEncodeIterator(void) const override {return (isArray() && !isNotEncoded() && !inMemoryType.isString);}
+    bool usesEncodeIterator(void) const override {return usesIterator();}
 
     //! True if this encodable has a direct child that needs an iterator on decode
-    bool usesDecodeIterator(void) const override {return (isArray() && !inMemoryType.isNull && !isNotEncoded() && !inMemoryType.isString);}
+    bool usesDecodeIterator(void) const override {return (usesIterator() && !inMemoryType.isNull);}
+
+    //! Run length compressed arrays are encoded and decoded with their own loop
+    bool usesCodecIterator(void) const override {return !rle;}
 
     //! True if this encodable has a direct child that needs an iterator for verifying
-    bool usesVerifyIterator(void) const override {return hasVerify() && usesEncodeIterator();}
+    bool usesVerifyIterator(void) const override {return hasVerify() && usesIterator();}
 
     //! True if this encodable has a direct child that needs an iterator for initializing
-    bool usesInitIterator(void) const override {return hasInit() && usesEncodeIterator();}
+    bool usesInitIterator(void) const override {return hasInit() && usesIterator();}
+
+    //! True if this encodable is an array whose elements are visited one at a time
+    bool usesIterator(void) const {return (isArray() && !isNotEncoded() && !inMemoryType.isString);}
 
     //! True if this encodable has a direct child that needs an iterator on encode
     bool uses2ndEncodeIterator(void) const override {return (is2dArray() && !isNotEncoded() && !inMemoryType.isString);}
@@ -323,6 +375,12 @@ protected:
     //! String providing the scaler from in-Memory to encoded
     std::string scalerString;
 
+    //! String providing the resolution the encoding must achieve
+    std::string resolutionString;
+
+    //! The resolution the encoding must achieve, or 0 if not specified
+    double resolution;
+
     //! The string used to multiply the in-memory type to compare and print to text
     std::string printScalerString;
 
@@ -395,6 +453,21 @@ protected:
     //! Flag indicating this field overrides a previous field
     bool overridesPrevious;
 
+    //! Flag indicating array elements are encoded as the difference from the previous element
+    bool deltaElement;
+
+    //! Flag indicating the diff functions encode this field as the difference from the last packet
+    bool deltaPacket;
+
+    //! Flag indicating the bytes of an array are run length compressed
+    bool rle;
+
+    //! Flag indicating the gather encode references this field in place
+    bool gather;
+
+    //! Likely values of a string, which are encoded as an index into this list
+    std::vector<std::string> dictionary;
+
     //! Flag indicating this field is being overriden by a later one
     bool isOverriden;
 
@@ -426,6 +499,15 @@ protected:
     //! Extract the type information from the type string
     void extractType(TypeData& data, const std::string& typeString, bool inMemory, const std::string& enumName = std::string());
 
+    //! Get the encoded type string that achieves the resolution over the range from min to max
+    std::string getEncodedTypeForResolution(const std::string& encodedTypeString);
+
+    //! Determine if an encoded type can be packed into the bit stream of a bitpacked packet or structure
+    bool canBitPack(const TypeData& data) const;
+
+    //! Change the encoded type to a bitfield if the packet or structure is bitpacked
+    void applyBitPacking(bool encodedFromInMemory);
+
     //! Return the constant value string, sourced from either constantValue, encodeConstantValue, decodeConstantValue
     std::string getConstantString() const;
 
@@ -460,7 +542,16 @@ protected:
     std::string getEncodeStringForStructure(bool isStructureMember) const;
 
     //! Get the next lines(s, bool isStructureMember) of source coded needed to encode a field, which is not a bitfield or a string
-    std::string getEncodeStringForField(bool isStructureMember) const;
+    std::string getEncodeStringForField(bool isStructureMember, bool againstState = false) const;
+
+    //! Get the statement that encodes one element of a field, which is not a bitfield or a string
+    std::string getEncodeStringForElement(const std::string& argument) const;
+
+    //! Get the next lines of source needed to encode an array field as differences between elements
+    std::string getEncodeStringForDelta(const std::string& spacing, const std::string& endian, bool isStructureMember, bool againstState) const;
+
+    //! Get the next lines of source needed to encode an array of bytes with run length compression
+    std::string getEncodeStringForRle(const std::string& spacing, bool isStructureMember) const;
 
     //! Get the next lines(s, bool isStructureMember) of source coded needed to decode a bitfield field
     std::string getDecodeStringForBitfield(int* bitcount, bool isStructureMember, bool defaultEnabled) const;
@@ -472,7 +563,52 @@ protected:
     std::string getDecodeStringForStructure(bool isStructureMember) const;
 
     //! Get the next lines(s, bool isStructureMember) of source coded needed to decode a field, which is not a bitfield or a string
-    std::string getDecodeStringForField(bool isStructureMember, bool defaultEnabled) const;
+    std::string getDecodeStringForField(bool isStructureMember, bool defaultEnabled, bool againstState = false) const;
+
+    //! Get the statement that decodes a field which is not in memory and checks its constant value
+    std::string getDecodeConstantCheck(const std::string& spacing, const std::string& failure) const;
+
+    //! Get the statement that decodes one element of a field, which is not a bitfield or a string
+    std::string getDecodeStringForElement(const std::string& argument) const;
+
+    //! Get the next lines of source needed to decode an array field from differences between elements
+    std::string getDecodeStringForDelta(const std::string& spacing, const std::string& endian, bool isStructureMember, bool againstState) const;
+
+    //! Get the next lines of source needed to decode an array of bytes with run length compression
+    std::string getDecodeStringForRle(const std::string& spacing, bool isStructureMember) const;
+
+    //! Get the declaration of the dictionary of a string field
+    std::string getDictionaryDeclaration(const std::string& spacing) const;
+
+    //! Get the number of bytes of the array, limited by the variable array length if there is one
+    std::string getRleByteCount(bool isStructureMember, bool encode) const;
+
+    //! Determine if this field can be referenced in place by the gather encode
+    bool canGather(void) const;
+
+    //! Get the condition under which the stream functions process the next element of this field
+    std::string getStreamCondition(bool isStructureMember, bool encode) const;
+
+    //! Get the number of elements of an array dimension for the stream functions
+    std::string getStreamArrayLimit(const std::string& variable, const std::string& size, bool isStructureMember, bool encode) const;
+
+    //! Get the string that moves the stream functions to the next element of this field
+    std::string getStreamNextElementString(const std::string& spacing, bool isStructureMember, bool encode) const;
+
+    //! Get the string that moves the stream functions to the next field
+    std::string getStreamNextFieldString(const std::string& spacing) const;
+
+    //! Get the string used for encoding this field to a flat map
+    std::string getFlatMapEncodeString(void) const;
+
+    //! Get the string used for decoding this field from a flat map
+    std::string getFlatMapDecodeString(void) const;
+
+    //! Get the value this field is initialized to in C++
+    std::string getCppInitialValue(void) const;
+
+    //! True if this field is initialized in the C++ class declaration rather than the constructor
+    bool isDefaultMemberInitialized(void) const;
 
     //! Get the source needed to close out a string of bitfields in the encode function.
     std::string getCloseBitfieldString(int* bitcount) const;
@@ -483,6 +619,9 @@ protected:
     //! Check to see if we should be doing integer scaling on this field
     bool isIntegerScaling(void) const;
 
+    //! Check to see if a variable length integer is decoded into a narrower in-memory integer
+    bool isNarrowVarint(void) const;
+
     //! Get the string that describes the bit start position and width
     static std::string getDBCBitWidthString(uint32_t numbits, uint32_t start, bool isSigned, bool isBigEndian);
 
@@ -1,5 +1,6 @@
 #include "protocolfile.h"
 #include "protocolparser.h"
+#include "protocolstats.h"
 #include <fstream>
 #include <filesystem>
 #include <iostream>
@@ -12,8 +13,10 @@ std::string ProtocolFile::tempprefix = "temporarydeleteme_";
  * \param supported are the Protocol-wide options.
  * \param temp should be true for this file to be a temp file
  */
-ProtocolFile::ProtocolFile(const std::string& moduleName, ProtocolSupport supported, bool temp) :
-    support(supported),
+ProtocolFile::ProtocolFile(const std::string& moduleName, const ProtocolSupport& supported, bool temp) :
+    language(supported.language),
+    supportbool(supported.supportbool),
+    licenseText(supported.licenseText),
     module(moduleName),
     dirty(false),
     appending(false),
@@ -27,8 +30,10 @@ ProtocolFile::ProtocolFile(const std::string& moduleName, ProtocolSupport suppor
  * or a file will not be created
  * \param supported are the Protocol-wide options.
  */
-ProtocolFile::ProtocolFile(ProtocolSupport supported) :
-    support(supported),
+ProtocolFile::ProtocolFile(const ProtocolSupport& supported) :
+    language(supported.language),
+    supportbool(supported.supportbool),
+    licenseText(supported.licenseText),
     dirty(false),
     appending(false),
     temporary(true),
@@ -39,7 +44,7 @@ ProtocolFile::ProtocolFile(ProtocolSupport supported) :
 
 void ProtocolFile::setModuleNameAndPath(std::string name, std::string filepath)
 {
-    setModuleNameAndPath(std::string(), name, filepath, support.language);
+    setModuleNameAndPath(std::string(), name, filepath, language);
 }
 
 void ProtocolFile::setModuleNameAndPath(std::string name, std::string filepath, ProtocolSupport::LanguageType languageoverride)
@@ -49,7 +54,7 @@ void ProtocolFile::setModuleNameAndPath(std::string name, std::string filepath,
 
 void ProtocolFile::setModuleNameAndPath(std::string prefix, std::string name, std::string filepath)
 {
-    setModuleNameAndPath(prefix, name, filepath, support.language);
+    setModuleNameAndPath(prefix, name, filepath, language);
 }
 
 void ProtocolFile::setModuleNameAndPath(std::string prefix, std::string name, std::string filepath, ProtocolSupport::LanguageType languageoverride)
@@ -57,7 +62,7 @@ void ProtocolFile::setModuleNameAndPath(std::string prefix, std::string name, st
     // Remove any contents we currently have
     clear();
 
-    support.language = languageoverride;
+    language = languageoverride;
 
     // Clean it all up
     separateModuleNameAndPath(name, filepath);
@@ -148,11 +153,13 @@ void ProtocolFile::separateModuleNameAndPath(std::string& name, std::string& fil
 
 
 /*!
- * Clear the contents of the file. This will also mark the file as clean
+ * Clear the contents of the file. This will also mark the file as clean. The
+ * memory of the contents is released, rather than kept for reuse, as every
+ * module holds its files until the end of the run.
  */
 void ProtocolFile::clear()
 {
-    contents.clear();
+    std::string().swap(contents);
     dirty = false;
     appending = false;
 }
@@ -232,7 +239,7 @@ void ProtocolFile::writeIncludeDirective(const std::string& include, const std::
     // Technically things other than .h* could be included, but not by ProtoGen
     if(!contains(directive, ".h") && autoextension)
     {
-        if(support.language == ProtocolSupport::cpp_language)
+        if(language == ProtocolSupport::cpp_language)
             directive += ".hpp";
         else
             directive += ".h";
@@ -459,12 +466,16 @@ void ProtocolFile::copyTemporaryFile(const std::string& path, const std::string&
 
     if(equal)
     {
+        ProtocolStats::count("Files unchanged");
+
         // If the two file contents are the same, delete the temporary
         // file, leave the original file unchanged
         deleteFile(tempFileName);
     }
     else
     {
+        ProtocolStats::count("Files written");
+
         // else if the file contents are different, delete the original
         // file and rename the temp file to be the original file
         renameFile(tempFileName, permFileName);
@@ -525,6 +536,8 @@ bool ProtocolFile::flush(void)
         return false;
     }
 
+    ProtocolStats::Timer timer("Flush files");
+
     std::error_code ec;
 
     // Make sure the path exists
@@ -543,6 +556,8 @@ bool ProtocolFile::flush(void)
     // The actual interesting contents
     file << contents;
 
+    ProtocolStats::count("Bytes emitted", contents.size());
+
     // And the file
     file.close();
 
@@ -620,7 +635,7 @@ void ProtocolHeaderFile::extractExtension(std::string& name)
     // A header file extension must start with ".h" (.h, .hpp, .hxx, etc.)
     if(!contains(extension, ".h"))
     {
-        if(support.language == ProtocolSupport::cpp_language)
+        if(language == ProtocolSupport::cpp_language)
             extension = ".hpp";
         else
             extension = ".h";
@@ -653,6 +668,8 @@ bool ProtocolHeaderFile::flush(void)
         return false;
     }
 
+    ProtocolStats::Timer timer("Flush files");
+
     std::error_code ec;
 
     // Make sure the path exists
@@ -674,6 +691,8 @@ bool ProtocolHeaderFile::flush(void)
     // close the file out
     file << getClosingStatement();
 
+    ProtocolStats::count("Bytes emitted", contents.size() + getClosingStatement().size());
+
     // And the file
     file.close();
 
@@ -692,7 +711,7 @@ std::string ProtocolHeaderFile::getClosingStatement(void)
 {
     std::string close;
 
-    if(support.language == ProtocolSupport::c_language)
+    if(language == ProtocolSupport::c_language)
     {
         // close the __cplusplus
         close += "#ifdef __cplusplus\n";
@@ -748,9 +767,9 @@ void ProtocolHeaderFile::prepareToAppend(void)
         // Tag for what generated the file
         write("// " + fileName(true) + " was generated by ProtoGen version " + ProtocolParser::genVersion + "\n\n");
 
-        if (!support.licenseText.empty())
+        if (!licenseText.empty())
         {
-            write(support.licenseText);
+            write(licenseText);
             makeLineSeparator();
         }
 
@@ -759,14 +778,14 @@ void ProtocolHeaderFile::prepareToAppend(void)
         write("#ifndef " + define + "\n");
         write("#define " + define + "\n");
 
-        if(support.language == ProtocolSupport::c_language)
+        if(language == ProtocolSupport::c_language)
         {
             write("\n// Language target is C, C++ compilers: don't mangle us\n");
             write("#ifdef __cplusplus\n");
             write("extern \"C\" {\n");
             write("#endif\n\n");
         }
-        else if(support.language == ProtocolSupport::cpp_language)
+        else if(language == ProtocolSupport::cpp_language)
         {
             write("\n// Language target is C++\n\n");
         }
@@ -777,10 +796,10 @@ void ProtocolHeaderFile::prepareToAppend(void)
         write(" */\n");
         write("\n");
 
-        if((support.language == ProtocolSupport::c_language) || (support.language == ProtocolSupport::cpp_language))
+        if((language == ProtocolSupport::c_language) || (language == ProtocolSupport::cpp_language))
             writeIncludeDirective("stdint.h", "", true);
 
-        if(support.supportbool && (support.language == ProtocolSupport::c_language))
+        if(supportbool && (language == ProtocolSupport::c_language))
             writeIncludeDirective("stdbool.h", "", true);
 
         makeLineSeparator();
@@ -797,7 +816,7 @@ void ProtocolSourceFile::extractExtension(std::string& name)
 {
     ProtocolFile::extractExtension(name);
 
-    if(support.language == ProtocolSupport::cpp_language)
+    if(language == ProtocolSupport::cpp_language)
     {
         // We cannot allow the .c extension for c++
         if(extension.empty() || endsWith(extension, ".c"))
@@ -863,6 +882,8 @@ bool ProtocolSourceFile::flush(void)
         return false;
     }
 
+    ProtocolStats::Timer timer("Flush files");
+
     if(hasNontrivialContent)
     {
         std::error_code ec;
@@ -886,6 +907,8 @@ bool ProtocolSourceFile::flush(void)
         // close the file out
         file << getClosingStatement();
 
+        ProtocolStats::count("Bytes emitted", contents.size() + getClosingStatement().size());
+
         // And the file
         file.close();
     }
@@ -961,9 +984,9 @@ void ProtocolSourceFile::prepareToAppend(void)
         // Tag for what generated the file
         writeInternal("// " + fileName(true) + " was generated by ProtoGen version " + ProtocolParser::genVersion + "\n\n");
 
-        if (!support.licenseText.empty())
+        if (!licenseText.empty())
         {
-            writeInternal(support.licenseText);
+            writeInternal(licenseText);
             makeLineSeparator();
         }
 
@@ -9,10 +9,10 @@ class ProtocolFile
 {
 public:
     //! Construct the protocol file
-    ProtocolFile(const std::string& moduleName, ProtocolSupport supported, bool temporary = true);
+    ProtocolFile(const std::string& moduleName, const ProtocolSupport& supported, bool temporary = true);
 
     //! Construct the protocol file
-    ProtocolFile(ProtocolSupport supported);
+    ProtocolFile(const ProtocolSupport& supported);
 
     //! Destructor that performs the actual file write
     virtual ~ProtocolFile();
@@ -106,8 +106,14 @@ protected:
     //! Return the correct on disk name
     std::string fileNameAndPathOnDisk(void) const;
 
-    //! Protocol wide support details
-    ProtocolSupport support;
+    //! The language of the file
+    ProtocolSupport::LanguageType language;
+
+    //! True if the C language file includes stdbool.h
+    bool supportbool;
+
+    //! License text to be added to the file
+    std::string licenseText;
 
     //! The file extension
     std::string extension;
@@ -141,7 +147,7 @@ class ProtocolHeaderFile : public ProtocolFile
 public:
 
     //! Construct the protocol header file
-    ProtocolHeaderFile(ProtocolSupport supported) : ProtocolFile(supported){}
+    ProtocolHeaderFile(const ProtocolSupport& supported) : ProtocolFile(supported){}
 
     //! Destructor that performs the actual file write
     ~ProtocolHeaderFile() override;
@@ -173,7 +179,7 @@ class ProtocolSourceFile : public ProtocolFile
 public:
 
     //! Construct the protocol header file
-    ProtocolSourceFile(ProtocolSupport supported) : ProtocolFile(supported){}
+    ProtocolSourceFile(const ProtocolSupport& supported) : ProtocolFile(supported){}
 
     //! Destructor that performs the actual file write
     ~ProtocolSourceFile() override;
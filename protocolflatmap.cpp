@@ -0,0 +1,292 @@
+#include "protocolflatmap.h"
+
+ProtocolFlatMap::ProtocolFlatMap(ProtocolSupport protocolsupport) :
+    header(protocolsupport),
+    support(protocolsupport)
+{}
+
+//! Perform the generation, writing out the files
+bool ProtocolFlatMap::generate(std::vector<std::string>& fileNameList, std::vector<std::string>& filePathList)
+{
+    if(support.flatmap && generateHeader())
+    {
+        fileNameList.push_back(header.fileName());
+        filePathList.push_back(header.filePath());
+        return true;
+    }
+
+    return false;
+}
+
+
+//! Generate the header file
+bool ProtocolFlatMap::generateHeader(void)
+{
+    // This is always C++, regardless of the protocol language
+    header.setModuleNameAndPath("flatmap", support.outputpath, ProtocolSupport::cpp_language);
+
+// Raw string magic here
+header.setFileComment(R"(\brief Flat map used by the map encode and decode functions
+
+The map encode and decode functions store each field in a map from a 64-bit
+key to a value. The key of a field is formed from the key of its parent and
+an identifier which is a hash of the field name. Array indices are mixed
+into the key as integers. Hence no strings are built at runtime to form
+keys, and no Qt types are needed.
+
+Each structure has a key table that gives the identifier and name of each
+of its fields, which can be used to recover field names from identifiers.
+The key of a top level structure is provided by the caller, and should be
+unique for each packet stored in the same map (the packet identifier is a
+good choice).)");
+
+header.makeLineSeparator();
+header.writeIncludeDirective("stdint.h", std::string(), true);
+header.writeIncludeDirective("cstddef", std::string(), true, false);
+header.writeIncludeDirective("cstdlib", std::string(), true, false);
+header.writeIncludeDirective("string", std::string(), true, false);
+header.writeIncludeDirective("vector", std::string(), true, false);
+header.makeLineSeparator();
+
+// Raw string magic here
+header.write(R"(//! Entry in a table that associates field identifiers with field names
+typedef struct
+{
+    uint32_t id;        //!< The field identifier, a hash of the field name
+    const char* name;   //!< The field name, null for the last entry of a table
+}pgFlatMapKeyEntry;
+
+//! Mix the bits of a 64-bit number, used to form flat map keys
+inline uint64_t pgFlatMapMix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+//! Form the key of a field from the key of its parent and the field identifier
+inline uint64_t pgFlatMapKey(uint64_t parent, uint32_t id)
+{
+    return pgFlatMapMix((parent * 0x9E3779B97F4A7C15ULL) ^ id);
+}
+
+//! Form the key of an array element, the index is a sub-key of the field
+inline uint64_t pgFlatMapKey(uint64_t parent, uint32_t id, unsigned index)
+{
+    return pgFlatMapMix(pgFlatMapKey(parent, id) + index + 1);
+}
+
+//! Form the key of a 2D array element, the indices are sub-keys of the field
+inline uint64_t pgFlatMapKey(uint64_t parent, uint32_t id, unsigned index, unsigned index2)
+{
+    return pgFlatMapMix(pgFlatMapKey(parent, id, index) + index2 + 1);
+}
+
+//! Find the name of a field identifier in a key table, null if not found
+inline const char* pgFlatMapKeyName(const pgFlatMapKeyEntry* table, uint32_t id)
+{
+    for(; table->name != nullptr; table++)
+    {
+        if(table->id == id)
+            return table->name;
+    }
+
+    return nullptr;
+}
+
+//! A single value stored in a flat map
+class pgFlatMapValue
+{
+public:
+    //! The type of data held in the value
+    enum Type
+    {
+        invalid,
+        floating,
+        signedint,
+        unsignedint,
+        text
+    };
+
+    pgFlatMapValue() : type(invalid), u(0) {}
+
+    //! \return the value as a double
+    double toDouble(void) const
+    {
+        switch(type)
+        {
+        default:            return 0;
+        case floating:      return d;
+        case signedint:     return (double)s;
+        case unsignedint:   return (double)u;
+        case text:          return std::strtod(str.c_str(), 0);
+        }
+    }
+
+    //! \return the value as a signed integer
+    long long toLongLong(void) const
+    {
+        switch(type)
+        {
+        default:            return 0;
+        case floating:      return (long long)d;
+        case signedint:     return s;
+        case unsignedint:   return (long long)u;
+        case text:          return std::strtoll(str.c_str(), 0, 0);
+        }
+    }
+
+    //! \return the value as an unsigned integer
+    unsigned long long toULongLong(void) const
+    {
+        switch(type)
+        {
+        default:            return 0;
+        case floating:      return (unsigned long long)d;
+        case signedint:     return (unsigned long long)s;
+        case unsignedint:   return u;
+        case text:          return std::strtoull(str.c_str(), 0, 0);
+        }
+    }
+
+    //! \return the value as a string, which is empty if the value is not text
+    const std::string& toString(void) const {return str;}
+
+    Type type;          //!< The type of data held in the value
+    union
+    {
+        double d;               //!< The floating point value
+        long long s;            //!< The signed integer value
+        unsigned long long u;   //!< The unsigned integer value
+    };
+    std::string str;    //!< The text value
+};
+
+//! Open addressing hash map from flat map keys to values
+class pgFlatMap
+{
+public:
+    pgFlatMap() : count(0) {}
+
+    //! Reserve space for a number of values, to prevent rehashing as values are inserted
+    void reserve(std::size_t size)
+    {
+        std::size_t capacity = 16;
+        while(capacity < 2*size)
+            capacity *= 2;
+
+        if(capacity > slots.size())
+            rehash(capacity);
+    }
+
+    //! Remove all values from the map, the capacity is not changed
+    void clear(void)
+    {
+        for(std::size_t i = 0; i < slots.size(); i++)
+            slots[i] = Slot();
+        count = 0;
+    }
+
+    //! \return the number of values in the map
+    std::size_t size(void) const {return count;}
+
+    //! \return true if the map contains key
+    bool contains(uint64_t key) const {return find(key) != nullptr;}
+
+    //! Insert a floating point value, replacing any value with the same key
+    void insert(uint64_t key, double value) {pgFlatMapValue& v = findOrInsert(key); v.type = pgFlatMapValue::floating; v.d = value;}
+
+    //! Insert a signed value, replacing any value with the same key
+    void insert(uint64_t key, long long value) {pgFlatMapValue& v = findOrInsert(key); v.type = pgFlatMapValue::signedint; v.s = value;}
+
+    //! Insert an unsigned value, replacing any value with the same key
+    void insert(uint64_t key, unsigned long long value) {pgFlatMapValue& v = findOrInsert(key); v.type = pgFlatMapValue::unsignedint; v.u = value;}
+
+    //! Insert a text value, replacing any value with the same key
+    void insert(uint64_t key, const char* value) {pgFlatMapValue& v = findOrInsert(key); v.type = pgFlatMapValue::text; v.str = value;}
+
+    //! Find the value associated with a key, null if the key is not in the map
+    const pgFlatMapValue* find(uint64_t key) const
+    {
+        if(slots.empty())
+            return nullptr;
+
+        std::size_t mask = slots.size() - 1;
+        for(std::size_t i = key & mask; slots[i].used; i = (i + 1) & mask)
+        {
+            if(slots[i].key == key)
+                return &slots[i].value;
+        }
+
+        return nullptr;
+    }
+
+    //! Call function(key, value) for every value in the map, in no particular order
+    template <typename F>
+    void forEach(F function) const
+    {
+        for(std::size_t i = 0; i < slots.size(); i++)
+        {
+            if(slots[i].used)
+                function(slots[i].key, slots[i].value);
+        }
+    }
+
+private:
+
+    //! One slot in the open addressing table
+    struct Slot
+    {
+        Slot() : key(0), used(false) {}
+        uint64_t key;
+        bool used;
+        pgFlatMapValue value;
+    };
+
+    //! Find the value for a key, inserting a new value if needed
+    pgFlatMapValue& findOrInsert(uint64_t key)
+    {
+        // Keep the load factor at or below one half
+        if(2*(count + 1) > slots.size())
+            rehash(slots.empty() ? 16 : 2*slots.size());
+
+        std::size_t mask = slots.size() - 1;
+        std::size_t i = key & mask;
+        for(; slots[i].used; i = (i + 1) & mask)
+        {
+            if(slots[i].key == key)
+                return slots[i].value;
+        }
+
+        slots[i].used = true;
+        slots[i].key = key;
+        count++;
+        return slots[i].value;
+    }
+
+    //! Change the number of slots, which must be a power of 2
+    void rehash(std::size_t capacity)
+    {
+        std::vector<Slot> old(capacity);
+        old.swap(slots);
+        count = 0;
+
+        for(std::size_t i = 0; i < old.size(); i++)
+        {
+            if(old[i].used)
+                findOrInsert(old[i].key) = old[i].value;
+        }
+    }
+
+    std::vector<Slot> slots;    //!< The open addressing table, size is a power of 2
+    std::size_t count;          //!< The number of slots that are used
+};)");
+
+header.makeLineSeparator();
+
+return header.flush();
+
+}// ProtocolFlatMap::generateHeader
@@ -0,0 +1,31 @@
+#ifndef PROTOCOLFLATMAP_H
+#define PROTOCOLFLATMAP_H
+
+/*!
+ * \file
+ * Auto magically generate the flat map helper used by the Qt-free map functions
+ */
+
+
+#include "protocolfile.h"
+#include "protocolsupport.h"
+#include <string>
+
+class ProtocolFlatMap
+{
+public:
+    ProtocolFlatMap(ProtocolSupport protocolsupport);
+
+    //! Perform the generation, writing out the files
+    bool generate(std::vector<std::string>& fileNameList, std::vector<std::string>& filePathList);
+
+protected:
+
+    //! Generate the header file, all the functions are inline
+    bool generateHeader(void);
+
+    ProtocolHeaderFile header;
+    ProtocolSupport support;
+};
+
+#endif // PROTOCOLFLATMAP_H
@@ -0,0 +1,759 @@
+#include "protocoljsoncbor.h"
+
+ProtocolJsonCbor::ProtocolJsonCbor(ProtocolSupport protocolsupport) :
+    header(protocolsupport),
+    support(protocolsupport)
+{}
+
+//! Perform the generation, writing out the files
+bool ProtocolJsonCbor::generate(std::vector<std::string>& fileNameList, std::vector<std::string>& filePathList)
+{
+    if(generateHeader())
+    {
+        fileNameList.push_back(header.fileName());
+        filePathList.push_back(header.filePath());
+        return true;
+    }
+
+    return false;
+}
+
+
+//! Generate the header file
+bool ProtocolJsonCbor::generateHeader(void)
+{
+    // This is always C++, regardless of the protocol language
+    header.setModuleNameAndPath("jsoncbor", support.outputpath, ProtocolSupport::cpp_language);
+
+// Raw string magic here
+header.setFileComment(R"(\brief Streaming JSON and CBOR writers and readers
+
+The toJson and toCbor functions write each field of a structure directly to
+a pgJsonWriter or pgCborWriter. There is no intermediate document: the keys
+are precomputed literals. Integers are formatted with std::to_chars, floating
+point with snprintf and read with strtod, since std::to_chars and
+std::from_chars for floating point are not available everywhere.
+
+The fromJson and fromCbor functions read fields from a pgJsonReader or
+pgCborReader. Each structure finds the field for a key using a perfect hash
+of its field names, which ProtoGen computes using pgFieldHash(). Keys that do
+not match a field are skipped, as are array elements beyond the array size.)");
+
+header.makeLineSeparator();
+header.writeIncludeDirective("stdint.h", std::string(), true);
+header.writeIncludeDirective("cstddef", std::string(), true, false);
+header.writeIncludeDirective("cstdio", std::string(), true, false);
+header.writeIncludeDirective("cstdlib", std::string(), true, false);
+header.writeIncludeDirective("cstring", std::string(), true, false);
+header.writeIncludeDirective("cmath", std::string(), true, false);
+header.writeIncludeDirective("charconv", std::string(), true, false);
+header.writeIncludeDirective("string", std::string(), true, false);
+header.writeIncludeDirective("string_view", std::string(), true, false);
+header.writeIncludeDirective("type_traits", std::string(), true, false);
+header.writeIncludeDirective("vector", std::string(), true, false);
+header.makeLineSeparator();
+
+// Raw string magic here
+header.write(R"(//! Hash a field name, this must match the hash ProtoGen uses to build the perfect hash of the field names
+inline uint32_t pgFieldHash(std::string_view name, uint32_t seed)
+{
+    uint32_t hash = 2166136261u ^ seed;
+
+    for(std::size_t i = 0; i < name.size(); i++)
+    {
+        hash ^= (uint8_t)name[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+//! Streaming JSON writer, which appends to a string
+class pgJsonWriter
+{
+public:
+    pgJsonWriter() : comma(false) {}
+
+    //! Clear the output so the writer can be reused
+    void clear(void) {output.clear(); comma = false;}
+
+    //! Begin an object, which must be closed with endObject()
+    void beginObject(void) {separate(); output += '{'; comma = false;}
+
+    //! End an object
+    void endObject(void) {output += '}'; comma = true;}
+
+    //! Begin an array, which must be closed with endArray()
+    void beginArray(void) {separate(); output += '['; comma = false;}
+
+    //! End an array
+    void endArray(void) {output += ']'; comma = true;}
+
+    //! Write a key, the literal is already quoted, escaped, and followed by ':'
+    template <std::size_t N>
+    void key(const char (&literal)[N]) {separate(); output.append(literal, N - 1); comma = false;}
+
+    //! Write a number, JSON has no representation of infinity or NaN so these are null
+    void value(double number) {separate(); if(std::isfinite(number)) appendNumber(number); else output += "null"; comma = true;}
+
+    //! Write a number, JSON has no representation of infinity or NaN so these are null
+    void value(float number) {separate(); if(std::isfinite(number)) appendNumber(number); else output += "null"; comma = true;}
+
+    //! Write a number
+    void value(long long number) {separate(); appendNumber(number); comma = true;}
+
+    //! Write a number
+    void value(unsigned long long number) {separate(); appendNumber(number); comma = true;}
+
+    //! Write a string, escaping characters as needed
+    void value(const char* text)
+    {
+        static const char hex[] = "0123456789abcdef";
+
+        separate();
+        output += '"';
+        for(; *text != 0; text++)
+        {
+            uint8_t c = (uint8_t)(*text);
+
+            if((c == '"') || (c == '\\'))
+            {
+                output += '\\';
+                output += (char)c;
+            }
+            else if(c == '\n')
+                output += "\\n";
+            else if(c == '\r')
+                output += "\\r";
+            else if(c == '\t')
+                output += "\\t";
+            else if(c < 0x20)
+            {
+                output += "\\u00";
+                output += hex[c >> 4];
+                output += hex[c & 0x0F];
+            }
+            else
+                output += (char)c;
+        }
+        output += '"';
+        comma = true;
+    }
+
+    std::string output; //!< The JSON text
+
+private:
+
+    //! Output a comma if a value preceded this one
+    void separate(void) {if(comma) output += ',';}
+
+    //! Append a number using a representation that round trips
+    template <typename T>
+    void appendNumber(T number)
+    {
+        char buffer[32];
+
+        if constexpr (std::is_floating_point<T>::value)
+        {
+            // 9 digits round trip a float, and 17 a double
+            std::snprintf(buffer, sizeof(buffer), (sizeof(T) > sizeof(float)) ? "%.17g" : "%.9g", (double)number);
+            output += buffer;
+        }
+        else
+        {
+            std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+            output.append(buffer, result.ptr - buffer);
+        }
+    }
+
+    bool comma; //!< true if the next value needs a comma before it
+};
+
+//! Streaming CBOR (RFC 8949) writer, which appends to a string of bytes
+class pgCborWriter
+{
+public:
+    //! Clear the output so the writer can be reused
+    void clear(void) {output.clear();}
+
+    //! Begin an indefinite length map, which must be closed with endObject()
+    void beginObject(void) {output += (char)0xBF;}
+
+    //! End a map
+    void endObject(void) {output += (char)0xFF;}
+
+    //! Begin an indefinite length array, which must be closed with endArray()
+    void beginArray(void) {output += (char)0x9F;}
+
+    //! End an array
+    void endArray(void) {output += (char)0xFF;}
+
+    //! Write a key, the literal is already encoded as a CBOR text string
+    template <std::size_t N>
+    void key(const char (&literal)[N]) {output.append(literal, N - 1);}
+
+    //! Write a double precision number
+    void value(double number) {uint64_t bits; std::memcpy(&bits, &number, sizeof(bits)); output += (char)0xFB; appendBigEndian(bits, 8);}
+
+    //! Write a single precision number
+    void value(float number) {uint32_t bits; std::memcpy(&bits, &number, sizeof(bits)); output += (char)0xFA; appendBigEndian(bits, 4);}
+
+    //! Write a signed number
+    void value(long long number)
+    {
+        if(number < 0)
+            appendHead(1, (uint64_t)(-1 - number));
+        else
+            appendHead(0, (uint64_t)number);
+    }
+
+    //! Write an unsigned number
+    void value(unsigned long long number) {appendHead(0, number);}
+
+    //! Write a text string
+    void value(const char* text)
+    {
+        std::size_t length = std::strlen(text);
+        appendHead(3, length);
+        output.append(text, length);
+    }
+
+    std::string output; //!< The CBOR bytes
+
+private:
+
+    //! Append the most significant bytes of value in big endian order
+    void appendBigEndian(uint64_t value, int bytes)
+    {
+        for(int i = bytes - 1; i >= 0; i--)
+            output += (char)(value >> (8*i));
+    }
+
+    //! Append a major type and argument using the shortest encoding
+    void appendHead(uint8_t major, uint64_t value)
+    {
+        major <<= 5;
+
+        if(value < 24)
+            output += (char)(major | value);
+        else if(value <= 0xFF)
+        {
+            output += (char)(major | 24);
+            appendBigEndian(value, 1);
+        }
+        else if(value <= 0xFFFF)
+        {
+            output += (char)(major | 25);
+            appendBigEndian(value, 2);
+        }
+        else if(value <= 0xFFFFFFFF)
+        {
+            output += (char)(major | 26);
+            appendBigEndian(value, 4);
+        }
+        else
+        {
+            output += (char)(major | 27);
+            appendBigEndian(value, 8);
+        }
+    }
+};
+
+//! Streaming JSON reader
+class pgJsonReader
+{
+public:
+    //! Construct the reader, the text must remain valid while it is being read
+    pgJsonReader(std::string_view text) : source(text), index(0) {}
+
+    //! Begin reading an object, if the next value is not an object it is skipped and false is returned
+    bool beginObject(void) {return beginContainer('{');}
+
+    //! Read the next key of an object, returns false at the end of the object
+    bool nextKey(std::string_view& key)
+    {
+        if(!nextItem('}'))
+            return false;
+
+        skipSpace();
+        if(!readRawString(key))
+            return false;
+
+        skipSpace();
+        if((index >= source.size()) || (source[index] != ':'))
+            return false;
+
+        index++;
+        return true;
+    }
+
+    //! Begin reading an array, if the next value is not an array it is skipped and false is returned
+    bool beginArray(void) {return beginContainer('[');}
+
+    //! Move to the next element of an array, returns false at the end of the array
+    bool nextElement(void) {return nextItem(']');}
+
+    //! Read a number, which may also be a quoted string or a boolean
+    template <typename T>
+    T readNumber(void)
+    {
+        T number = 0;
+        std::string_view token;
+
+        skipSpace();
+        if(index >= source.size())
+            return number;
+
+        if(source[index] == '"')
+            readRawString(token);
+        else if((source[index] == 't') || (source[index] == 'f') || (source[index] == 'n'))
+        {
+            number = (source[index] == 't') ? 1 : 0;
+            skipValue();
+            return number;
+        }
+        else
+        {
+            std::size_t first = index;
+            while((index < source.size()) && (std::strchr("+-.0123456789eE", source[index]) != nullptr))
+                index++;
+            token = source.substr(first, index - first);
+        }
+
+        // Numbers such as "+1" are not valid JSON, but we tolerate them
+        if(!token.empty() && (token[0] == '+'))
+            token.remove_prefix(1);
+
+        if(token.empty())
+            return number;
+
+        if constexpr (std::is_floating_point<T>::value)
+        {
+            // strtod needs a terminated copy of the token
+            std::string copy(token);
+            number = (T)std::strtod(copy.c_str(), nullptr);
+        }
+        else
+            std::from_chars(token.data(), token.data() + token.size(), number);
+
+        return number;
+    }
+
+    //! Read a string into a buffer of size bytes, which is always terminated
+    void readString(char* text, int size)
+    {
+        int length = 0;
+
+        skipSpace();
+        if((index >= source.size()) || (source[index] != '"'))
+        {
+            skipValue();
+            return;
+        }
+
+        for(index++; (index < source.size()) && (source[index] != '"'); index++)
+        {
+            char c = source[index];
+
+            if((c == '\\') && (index + 1 < source.size()))
+            {
+                c = source[++index];
+                if(c == 'n')
+                    c = '\n';
+                else if(c == 'r')
+                    c = '\r';
+                else if(c == 't')
+                    c = '\t';
+                else if(c == 'b')
+                    c = '\b';
+                else if(c == 'f')
+                    c = '\f';
+                else if((c == 'u') && (index + 4 < source.size()))
+                {
+                    // Only code points that fit in one byte are kept
+                    unsigned long code = std::strtoul(std::string(source.substr(index + 1, 4)).c_str(), 0, 16);
+                    c = (code < 0x100) ? (char)code : '?';
+                    index += 4;
+                }
+            }
+
+            if(length < size - 1)
+                text[length++] = c;
+        }
+
+        if(size > 0)
+            text[length] = 0;
+
+        if(index < source.size())
+            index++;
+    }
+
+    //! Skip the next value, including any values it contains
+    void skipValue(void)
+    {
+        int depth = 0;
+
+        skipSpace();
+        while(index < source.size())
+        {
+            char c = source[index];
+
+            if(c == '"')
+            {
+                std::string_view ignored;
+                readRawString(ignored);
+            }
+            else if((c == '{') || (c == '['))
+            {
+                depth++;
+                index++;
+            }
+            else if((c == '}') || (c == ']'))
+            {
+                // The end of the container that holds this value
+                if(depth == 0)
+                    return;
+
+                depth--;
+                index++;
+            }
+            else if(c == ',')
+            {
+                if(depth == 0)
+                    return;
+
+                index++;
+            }
+            else
+                index++;
+
+            if(depth == 0)
+            {
+                // The end of a string or container, or more of a literal
+                if((c == '"') || (c == '}') || (c == ']'))
+                    return;
+            }
+        }
+    }
+
+private:
+
+    //! Skip white space
+    void skipSpace(void)
+    {
+        while((index < source.size()) && ((source[index] == ' ') || (source[index] == '\n') || (source[index] == '\r') || (source[index] == '\t')))
+            index++;
+    }
+
+    //! Read a string without decoding escapes, returning the text between the quotes
+    bool readRawString(std::string_view& text)
+    {
+        if((index >= source.size()) || (source[index] != '"'))
+            return false;
+
+        std::size_t first = ++index;
+        while((index < source.size()) && (source[index] != '"'))
+        {
+            if(source[index] == '\\')
+                index++;
+            index++;
+        }
+
+        text = source.substr(first, std::min(index, source.size()) - first);
+
+        if(index < source.size())
+            index++;
+
+        return true;
+    }
+
+    //! Begin an object or array
+    bool beginContainer(char open)
+    {
+        skipSpace();
+        if((index < source.size()) && (source[index] == open))
+        {
+            index++;
+            return true;
+        }
+
+        skipValue();
+        return false;
+    }
+
+    //! Move to the next item in an object or array
+    bool nextItem(char close)
+    {
+        skipSpace();
+        if(index >= source.size())
+            return false;
+
+        if(source[index] == close)
+        {
+            index++;
+            return false;
+        }
+
+        if(source[index] == ',')
+        {
+            index++;
+            skipSpace();
+        }
+
+        return index < source.size();
+    }
+
+    std::string_view source;    //!< The text being read
+    std::size_t index;          //!< The location of the next character to read
+};
+
+//! Streaming CBOR (RFC 8949) reader
+class pgCborReader
+{
+public:
+    //! Construct the reader, the data must remain valid while it is being read
+    pgCborReader(std::string_view data) : source(data), index(0) {}
+
+    //! Begin reading a map, if the next value is not a map it is skipped and false is returned
+    bool beginObject(void) {return beginContainer(5);}
+
+    //! Read the next key of a map, returns false at the end of the map
+    bool nextKey(std::string_view& key)
+    {
+        if(!nextItem())
+            return false;
+
+        // Keys which are not text are skipped, and returned as empty
+        key = std::string_view();
+        if(peekMajor() != 3)
+        {
+            skipValue();
+            return true;
+        }
+
+        uint64_t length = readHead();
+        if(length > source.size() - index)
+            length = source.size() - index;
+
+        key = source.substr(index, length);
+        index += length;
+        return true;
+    }
+
+    //! Begin reading an array, if the next value is not an array it is skipped and false is returned
+    bool beginArray(void) {return beginContainer(4);}
+
+    //! Move to the next element of an array, returns false at the end of the array
+    bool nextElement(void) {return nextItem();}
+
+    //! Read a number, which may be an integer, floating point, or simple value
+    template <typename T>
+    T readNumber(void)
+    {
+        if(index >= source.size())
+            return 0;
+
+        uint8_t major = peekMajor();
+        uint8_t info = source[index] & 0x1F;
+
+        if(major == 0)
+            return (T)readHead();
+        else if(major == 1)
+            return (T)(-1 - (long long)readHead());
+        else if(major == 7)
+        {
+            uint64_t bits = readHead();
+
+            if(info == 25)
+                return (T)halfToFloat((uint16_t)bits);
+            else if(info == 26)
+            {
+                float number;
+                uint32_t bits32 = (uint32_t)bits;
+                std::memcpy(&number, &bits32, sizeof(number));
+                return (T)number;
+            }
+            else if(info == 27)
+            {
+                double number;
+                std::memcpy(&number, &bits, sizeof(number));
+                return (T)number;
+            }
+            else if(bits == 21)
+                return 1;   // true
+
+            return 0;
+        }
+
+        skipValue();
+        return 0;
+    }
+
+    //! Read a text string into a buffer of size bytes, which is always terminated
+    void readString(char* text, int size)
+    {
+        if((index >= source.size()) || (peekMajor() != 3) || ((source[index] & 0x1F) == 31))
+        {
+            skipValue();
+            return;
+        }
+
+        uint64_t length = readHead();
+        if(length > source.size() - index)
+            length = source.size() - index;
+
+        if(size > 0)
+        {
+            std::size_t copy = (length < (uint64_t)(size - 1)) ? (std::size_t)length : (std::size_t)(size - 1);
+            std::memcpy(text, source.data() + index, copy);
+            text[copy] = 0;
+        }
+
+        index += length;
+    }
+
+    //! Skip the next value, including any values it contains
+    void skipValue(void)
+    {
+        if(index >= source.size())
+            return;
+
+        uint8_t major = peekMajor();
+        bool indefinite = ((source[index] & 0x1F) == 31);
+        uint64_t value = readHead();
+
+        if((major == 2) || (major == 3))
+        {
+            if(indefinite)
+            {
+                // Chunks until the break
+                while((index < source.size()) && ((uint8_t)source[index] != 0xFF))
+                    skipValue();
+                index++;
+            }
+            else
+                index += (value < source.size() - index) ? value : source.size() - index;
+        }
+        else if((major == 4) || (major == 5))
+        {
+            if(indefinite)
+            {
+                while((index < source.size()) && ((uint8_t)source[index] != 0xFF))
+                    skipValue();
+                index++;
+            }
+            else
+            {
+                if(major == 5)
+                    value *= 2;
+
+                for(uint64_t i = 0; (i < value) && (index < source.size()); i++)
+                    skipValue();
+            }
+        }
+        else if(major == 6)
+            skipValue();    // the tagged value
+    }
+
+private:
+
+    //! \return the major type of the next value
+    uint8_t peekMajor(void) const {return (uint8_t)source[index] >> 5;}
+
+    //! Read the initial byte and argument of a value, the argument of an indefinite length is zero
+    uint64_t readHead(void)
+    {
+        uint8_t info = source[index++] & 0x1F;
+        uint64_t value = 0;
+        int bytes = 0;
+
+        if(info < 24)
+            return info;
+        else if(info == 24)
+            bytes = 1;
+        else if(info == 25)
+            bytes = 2;
+        else if(info == 26)
+            bytes = 4;
+        else if(info == 27)
+            bytes = 8;
+
+        for(int i = 0; (i < bytes) && (index < source.size()); i++)
+            value = (value << 8) | (uint8_t)source[index++];
+
+        return value;
+    }
+
+    //! Begin a map or array
+    bool beginContainer(uint8_t major)
+    {
+        if(index >= source.size())
+            return false;
+
+        if(peekMajor() != major)
+        {
+            skipValue();
+            return false;
+        }
+
+        bool indefinite = ((source[index] & 0x1F) == 31);
+        uint64_t count = readHead();
+        remaining.push_back(indefinite ? UINT64_MAX : count);
+        return true;
+    }
+
+    //! Move to the next item in a map or array
+    bool nextItem(void)
+    {
+        if(remaining.empty() || (index >= source.size()))
+            return false;
+
+        if(remaining.back() == UINT64_MAX)
+        {
+            if((uint8_t)source[index] == 0xFF)
+            {
+                index++;
+                remaining.pop_back();
+                return false;
+            }
+
+            return true;
+        }
+
+        if(remaining.back() == 0)
+        {
+            remaining.pop_back();
+            return false;
+        }
+
+        remaining.back()--;
+        return true;
+    }
+
+    //! Convert IEEE-754 half precision to single precision
+    static float halfToFloat(uint16_t half)
+    {
+        int exponent = (half >> 10) & 0x1F;
+        int significand = half & 0x3FF;
+        float number;
+
+        if(exponent == 0)
+            number = std::ldexp((float)significand, -24);
+        else if(exponent == 31)
+            number = (significand == 0) ? INFINITY : NAN;
+        else
+            number = std::ldexp((float)(significand + 1024), exponent - 25);
+
+        return (half & 0x8000) ? -number : number;
+    }
+
+    std::string_view source;        //!< The data being read
+    std::size_t index;              //!< The location of the next byte to read
+    std::vector<uint64_t> remaining;//!< Items remaining in each open container, UINT64_MAX if indefinite
+};)");
+
+header.makeLineSeparator();
+
+return header.flush();
+
+}// ProtocolJsonCbor::generateHeader
@@ -0,0 +1,31 @@
+#ifndef PROTOCOLJSONCBOR_H
+#define PROTOCOLJSONCBOR_H
+
+/*!
+ * \file
+ * Auto magically generate the JSON and CBOR streaming writers and readers
+ */
+
+
+#include "protocolfile.h"
+#include "protocolsupport.h"
+#include <string>
+
+class ProtocolJsonCbor
+{
+public:
+    ProtocolJsonCbor(ProtocolSupport protocolsupport);
+
+    //! Perform the generation, writing out the files
+    bool generate(std::vector<std::string>& fileNameList, std::vector<std::string>& filePathList);
+
+protected:
+
+    //! Generate the header file, all the functions are inline
+    bool generateHeader(void);
+
+    ProtocolHeaderFile header;
+    ProtocolSupport support;
+};
+
+#endif // PROTOCOLJSONCBOR_H
@@ -1,10 +1,12 @@
 #include "protocolpacket.h"
 #include "enumcreator.h"
 #include "protocolstructure.h"
+#include "protocolfield.h"
 #include "protocolparser.h"
 #include "protocoldocumentation.h"
 #include "shuntingyard.h"
 #include <iostream>
+#include <algorithm>
 
 
 /*!
@@ -15,16 +17,19 @@
  * \param bigendian should be true to encode multi-byte fields with the most
  *        significant byte first.
  */
-ProtocolPacket::ProtocolPacket(ProtocolParser* parse, ProtocolSupport supported) :
+ProtocolPacket::ProtocolPacket(ProtocolParser* parse, SharedSupport supported) :
     ProtocolStructureModule(parse, supported),
     useInOtherPackets(false),
     parameterFunctions(false),
     structureFunctions(true),
     dbctxon(false),
-    dbcrxon(false)
+    dbcrxon(false),
+    diff(false),
+    gather(false),
+    stream(false)
 {
     // These are attributes on top of the normal structureModule that we support
-    std::vector<std::string> newattribs({"structureInterface", "parameterInterface", "ID", "useInOtherPackets"});
+    std::vector<std::string> newattribs({"structureInterface", "parameterInterface", "ID", "useInOtherPackets", "rate", "diff", "stream"});
 
     // Now append the new attributes onto our old list
     // Now append the new attributes onto our old list
@@ -44,11 +49,16 @@ void ProtocolPacket::clear(void)
 {
     ProtocolStructureModule::clear();
     ids.clear();
+    rate.clear();
     useInOtherPackets = false;
     parameterFunctions = false;
     structureFunctions = true;
     dbctxon = false;
     dbcrxon = false;
+    diff = false;
+    gather = false;
+    stream = false;
+    statsIndex = 0;
 
     // Delete all the objects in the list
     for(std::size_t i = 0; i < documentList.size(); i++)
@@ -88,6 +98,10 @@ void ProtocolPacket::parse(bool nocode)
     // re-implementation of ProtocolStructureModule with different rules.
     ProtocolStructure::parse(nocode);
 
+    // Our entry in the table of runtime counters
+    if(support->packetStats)
+        statsIndex = parser->getPacketIndex(this);
+
     const XMLAttribute* map = e->FirstAttribute();
 
     std::string moduleName = ProtocolParser::getAttribute("file", map);
@@ -96,6 +110,7 @@ void ProtocolPacket::parse(bool nocode)
     std::string comparemodulename = ProtocolParser::getAttribute("comparefile", map);
     std::string printmodulename = ProtocolParser::getAttribute("printfile", map);
     std::string mapmodulename = ProtocolParser::getAttribute("mapfile", map);
+    std::string jsonmodulename = ProtocolParser::getAttribute("jsonfile", map);
 
     encode = !ProtocolParser::isFieldClear(ProtocolParser::getAttribute("encode", map));
     decode = !ProtocolParser::isFieldClear(ProtocolParser::getAttribute("decode", map));
@@ -109,9 +124,10 @@ void ProtocolPacket::parse(bool nocode)
     // It is possible to suppress the globally specified compare output
     if(ProtocolParser::isFieldClear(ProtocolParser::getAttribute("compare", map)))
     {
-        support.compare = compare = false;
+        ProtocolSupport& changed = changeSupport();
+        changed.compare = compare = false;
+        changed.globalCompareName.clear();
         comparemodulename.clear();
-        support.globalCompareName.clear();
     }
     else if(ProtocolParser::isFieldSet(ProtocolParser::getAttribute("compare", map)))
         compare = true;
@@ -119,9 +135,10 @@ void ProtocolPacket::parse(bool nocode)
     // It is possible to suppress the globally specified print output
     if(ProtocolParser::isFieldClear(ProtocolParser::getAttribute("print", map)))
     {
-        support.print = print = false;
+        ProtocolSupport& changed = changeSupport();
+        changed.print = print = false;
+        changed.globalPrintName.clear();
         printmodulename.clear();
-        support.globalPrintName.clear();
     }
     else if(ProtocolParser::isFieldSet(ProtocolParser::getAttribute("print", map)))
         print = true;
@@ -129,13 +146,25 @@ void ProtocolPacket::parse(bool nocode)
     // It is possible to suppress the globally specified map output
     if(ProtocolParser::isFieldClear(ProtocolParser::getAttribute("map", map)))
     {
-        support.mapEncode = mapEncode = false;
+        ProtocolSupport& changed = changeSupport();
+        changed.mapEncode = mapEncode = false;
+        changed.globalMapName.clear();
         mapmodulename.clear();
-        support.globalMapName.clear();
     }
     else if(ProtocolParser::isFieldSet(ProtocolParser::getAttribute("map", map)))
         mapEncode = true;
 
+    // It is possible to suppress the globally specified json output
+    if(ProtocolParser::isFieldClear(ProtocolParser::getAttribute("json", map)))
+    {
+        ProtocolSupport& changed = changeSupport();
+        changed.json = json = false;
+        changed.globalJsonName.clear();
+        jsonmodulename.clear();
+    }
+    else if(ProtocolParser::isFieldSet(ProtocolParser::getAttribute("json", map)))
+        json = true;
+
     useInOtherPackets = ProtocolParser::isFieldSet("useInOtherPackets", map);
     std::string redefinename = ProtocolParser::getAttribute("redefine", map);
 
@@ -159,6 +188,15 @@ void ProtocolPacket::parse(bool nocode)
     // Its possible to have multiple ID attributes which are separated by white space or commas, etc.
     ids = splitanyof(ProtocolParser::getAttribute("ID", map), " ,;:\t\n\r");
 
+    // The expected rate of the packet, which only matters for the rate report
+    rate = ProtocolParser::getAttribute("rate", map);
+
+    // Change-only encoding against the last sent state
+    diff = ProtocolParser::isFieldSet("diff", map);
+
+    // Resumable encode and decode one element at a time
+    stream = ProtocolParser::isFieldSet("stream", map);
+
     // In case the user didn't provide a comment, see if we use the comment for the ID
     if(comment.empty() && (ids.size() > 0))
         comment = parser->getEnumerationValueComment(ids.at(0));
@@ -166,15 +204,16 @@ void ProtocolPacket::parse(bool nocode)
     // Warnings common to structures and packets
     issueWarnings(map);
 
-    // Warning about maximum data size, only applies to packets
-    if(support.maxdatasize > 0)
+    // Warning about maximum data size, only applies to packets, unless the
+    // packet is streamed in which case it need not fit in a buffer
+    if((support->maxdatasize > 0) && !stream)
     {
         // maxdatasize will be zero if the length string cannot be computed
         int maxdatasize = (int)(ShuntingYard::computeInfix(parser->replaceEnumerationNameWithValue(encodedLength.maxEncodedLength)) + 0.5);
 
         // Warn the user if the packet might be too big
-        if(maxdatasize > support.maxdatasize)
-            emitWarning("Maximum packet size of " + std::to_string(maxdatasize) + " bytes exceeds limit of " + std::to_string(support.maxdatasize) + " bytes");
+        if(maxdatasize > support->maxdatasize)
+            emitWarning("Maximum packet size of " + std::to_string(maxdatasize) + " bytes exceeds limit of " + std::to_string(support->maxdatasize) + " bytes");
     }
 
     // Warnings about C keywords
@@ -195,19 +234,73 @@ void ProtocolPacket::parse(bool nocode)
         // wrapping it in a structure, if we are the C language
         if((getNumberOfEncodeParameters() > 1) && (getNumberOfDecodeParameters() > 1))
             structureFunctions = true;
-        else if((support.language != ProtocolSupport::c_language) && ((getNumberOfEncodeParameters() > 1) || (getNumberOfDecodeParameters() > 1)))
+        else if((support->language != ProtocolSupport::c_language) && ((getNumberOfEncodeParameters() > 1) || (getNumberOfDecodeParameters() > 1)))
             structureFunctions = true;
         else
             parameterFunctions = true;
     }
 
+    if(diff)
+    {
+        if(!structureFunctions)
+        {
+            emitWarning("diff requires the structure interface");
+            diff = false;
+        }
+        else if(getNumberOfDiffFields() <= 0)
+        {
+            emitWarning("diff requires fields in memory which are not constant or bitfields");
+            diff = false;
+        }
+    }
+
+    // Only the diff functions keep the last packet, which delta="packet" needs
+    if(!diff)
+    {
+        for(std::size_t i = 0; i < encodables.size(); i++)
+        {
+            const ProtocolField* field = dynamic_cast<const ProtocolField*>(encodables.at(i));
+            if((field != nullptr) && field->isDeltaPacket())
+                emitWarning(field->name + ": delta between packets requires diff, the field is encoded as the difference from zero");
+        }
+    }
+
+    // The gather encode is output if any field is referenced in place
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        if(encodables.at(i)->isGather())
+            gather = true;
+    }
+
+    if(gather && !structureFunctions)
+    {
+        emitWarning("gather requires the structure interface");
+        gather = false;
+    }
+
+    if(stream)
+    {
+        if(!structureFunctions)
+        {
+            emitWarning("stream requires the structure interface");
+            stream = false;
+        }
+        else if((getNumberOfEncodeParameters() <= 0) || (getNumberOfDecodeParameters() <= 0))
+        {
+            emitWarning("stream requires fields in memory");
+            stream = false;
+        }
+        else if(!isStreamable())
+            stream = false;
+    }
+
     if(!redefinename.empty())
     {
         if(redefinename == name)
             emitWarning("Redefine must be different from name");
         else
         {
-            redefines = parser->lookUpStructure(support.prefix + redefinename + support.typeSuffix);
+            redefines = parser->lookUpStructure(support->prefix + redefinename + support->typeSuffix);
             if(redefines == nullptr)
             {
                 redefinename.clear();
@@ -216,7 +309,7 @@ void ProtocolPacket::parse(bool nocode)
         }
 
         if(redefines != nullptr)
-            structName = support.prefix + redefinename + support.typeSuffix;
+            structName = support->prefix + redefinename + support->typeSuffix;
     }
 
     // If no ID is supplied use the packet name in upper case,
@@ -229,7 +322,7 @@ void ProtocolPacket::parse(bool nocode)
         return;
 
     // Don't output if hidden and we are omitting hidden items
-    if(isHidden() && !neverOmit && support.omitIfHidden)
+    if(isHidden() && !neverOmit && support->omitIfHidden)
     {
         std::cout << "Skipping code output for hidden packet " << getHierarchicalName() << std::endl;
         return;
@@ -238,7 +331,22 @@ void ProtocolPacket::parse(bool nocode)
     // Most of the file setup work. This will also declare the structure if
     // warranted (note the details of the structure declaration will reflect
     // back to this class via virtual functions).
-    setupFiles(moduleName, defheadermodulename, verifymodulename, comparemodulename, printmodulename, mapmodulename, structureFunctions, false);
+    setupFiles(moduleName, defheadermodulename, verifymodulename, comparemodulename, printmodulename, mapmodulename, jsonmodulename, structureFunctions, false);
+
+    // Nothing to write if the files are current from a previous run
+    if(cached)
+    {
+        discardCachedOutput();
+        return;
+    }
+
+    // The runtime counters are updated by the packet and verify functions
+    if(support->packetStats)
+    {
+        source.writeIncludeDirective(support->protoName + "PacketStats");
+        if(hasVerify())
+            verifySource->writeIncludeDirective(support->protoName + "PacketStats");
+    }
 
     // The functions that include structures which are children of this
     // packet. These need to be declared before the main functions
@@ -267,7 +375,7 @@ void ProtocolPacket::parse(bool nocode)
     createTopLevelStructureFunctions();
 
     // In the C language the utility functions are macros, defined just below the functions.
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
         // White space is good
         header.makeLineSeparator();
@@ -327,6 +435,15 @@ void ProtocolPacket::parse(bool nocode)
             mapSource->flush();
     }
 
+    if(json)
+    {
+        if(jsonHeader != nullptr)
+            jsonHeader->flush();
+
+        if(jsonSource != nullptr)
+            jsonSource->flush();
+    }
+
 }// ProtocolPacket::parse
 
 
@@ -419,14 +536,35 @@ std::string ProtocolPacket::getClassDeclaration_CPP(void) const
             ProtocolFile::makeLineSeparator(output);
         }
 
+        if(diff)
+        {
+            ProtocolFile::makeLineSeparator(output);
+            output += getDiffPrototypes(TAB_IN);
+            ProtocolFile::makeLineSeparator(output);
+        }
+
+        if(gather)
+        {
+            ProtocolFile::makeLineSeparator(output);
+            output += getGatherEncodePrototype(TAB_IN);
+            ProtocolFile::makeLineSeparator(output);
+        }
+
+        if(stream)
+        {
+            ProtocolFile::makeLineSeparator(output);
+            output += getStreamPrototypes(TAB_IN);
+            ProtocolFile::makeLineSeparator(output);
+        }
+
     }// if structure packet functions
 
     // Packet version of compare function
     if(compare)
     {
         ProtocolFile::makeLineSeparator(output);
-        output += TAB_IN + "//! Compare two " + support.prefix + name + " packets and generate a report\n";
-        output += TAB_IN + "static std::string compare(std::string prename, const " + support.pointerType + " pkt1, const " + support.pointerType + " pkt2);\n";
+        output += TAB_IN + "//! Compare two " + support->prefix + name + " packets and generate a report\n";
+        output += TAB_IN + "static std::string compare(std::string prename, const " + support->pointerType + " pkt1, const " + support->pointerType + " pkt2);\n";
         ProtocolFile::makeLineSeparator(output);
     }
 
@@ -435,7 +573,7 @@ std::string ProtocolPacket::getClassDeclaration_CPP(void) const
     {
         ProtocolFile::makeLineSeparator(output);
         output += TAB_IN + "//! Generate a string that describes the contents of a " + name + " packet\n";
-        output += TAB_IN + "static std::string textPrint(std::string prename, const " + support.pointerType + " pkt);\n";
+        output += TAB_IN + "static std::string textPrint(std::string prename, const " + support->pointerType + " pkt);\n";
         ProtocolFile::makeLineSeparator(output);
     }
 
@@ -499,6 +637,13 @@ std::string ProtocolPacket::getClassDeclaration_CPP(void) const
             ProtocolFile::makeLineSeparator(output);
         }
 
+        if(json)
+        {
+            ProtocolFile::makeLineSeparator(output);
+            output += ProtocolStructure::getJsonFunctionPrototype(TAB_IN, false);
+            ProtocolFile::makeLineSeparator(output);
+        }
+
         ProtocolFile::makeLineSeparator(output);
 
         // Finally the local members of this class. Notice that if we only have
@@ -538,19 +683,19 @@ std::string ProtocolPacket::createUtilityFunctions(const std::string& spacing) c
 {
     std::string output;
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
         // The macro for the packet ID, we only emit this if the packet has a single ID, which is the normal case
         if(ids.size() == 1)
         {
-            output += spacing + "//! return the packet ID for the " + support.prefix + name + " packet\n";
-            output += spacing + "#define get" + support.prefix + name + support.packetParameterSuffix + "ID() (" + ids.at(0) + ")\n";
+            output += spacing + "//! return the packet ID for the " + support->prefix + name + " packet\n";
+            output += spacing + "#define get" + support->prefix + name + support->packetParameterSuffix + "ID() (" + ids.at(0) + ")\n";
             output += "\n";
         }
 
         // The macro for the minimum packet length
-        output += spacing + "//! return the minimum encoded length for the " + support.prefix + name + " packet\n";
-        output += spacing + "#define get" + support.prefix + name + "MinDataLength() ";
+        output += spacing + "//! return the minimum encoded length for the " + support->prefix + name + " packet\n";
+        output += spacing + "#define get" + support->prefix + name + "MinDataLength() ";
         if(encodedLength.minEncodedLength.empty())
             output += "0\n";
         else
@@ -558,12 +703,20 @@ std::string ProtocolPacket::createUtilityFunctions(const std::string& spacing) c
 
         // The macro for the maximum packet length
         output += "\n";
-        output += spacing + "//! return the maximum encoded length for the " + support.prefix + name + " packet\n";
-        output += spacing + "#define get" + support.prefix + name + "MaxDataLength() ";
+        output += spacing + "//! return the maximum encoded length for the " + support->prefix + name + " packet\n";
+        output += spacing + "#define get" + support->prefix + name + "MaxDataLength() ";
         if(encodedLength.maxEncodedLength.empty())
             output += "0\n";
         else
             output += "("+encodedLength.maxEncodedLength + ")\n";
+
+        // The macro for the size of the segment list of the gather encode
+        if(gather)
+        {
+            output += "\n";
+            output += spacing + "//! return the maximum number of segments of the gather encode for the " + support->prefix + name + " packet\n";
+            output += spacing + "#define get" + support->prefix + name + "MaxSegments() (" + std::to_string(getNumberOfGatherSegments()) + ")\n";
+        }
     }
     else
     {
@@ -590,6 +743,14 @@ std::string ProtocolPacket::createUtilityFunctions(const std::string& spacing) c
             output += "0;}\n";
         else
             output += "("+encodedLength.maxEncodedLength + ");}\n";
+
+        // The size of the segment list of the gather encode
+        if(gather)
+        {
+            output += "\n";
+            output += spacing + "//! \\return the maximum number of segments of the gather encode\n";
+            output += spacing + "static int maxSegments(void) { return " + std::to_string(getNumberOfGatherSegments()) + ";}\n";
+        }
     }
 
     return output;
@@ -605,7 +766,7 @@ void ProtocolPacket::createTopLevelInitializeFunction(void)
     if(hasInit() && (verifySource != nullptr))
     {
         // In C++ this is part of the class declaration
-        if((support.language == ProtocolSupport::c_language) && (verifyHeader != nullptr))
+        if((support->language == ProtocolSupport::c_language) && (verifyHeader != nullptr))
         {
             verifyHeader->makeLineSeparator();
             verifyHeader->write(getSetToInitialValueFunctionPrototype(std::string(), false));
@@ -618,8 +779,12 @@ void ProtocolPacket::createTopLevelInitializeFunction(void)
         // Notice that if we are not outputting structure functions, and this
         // class won't be used by others, we will not have any data members and
         // do not need a constructor.
-        if((support.language == ProtocolSupport::c_language) || ((getNumberInMemory() > 0) && (useInOtherPackets || structureFunctions)))
+        if((support->language == ProtocolSupport::c_language) || ((getNumberInMemory() > 0) && (useInOtherPackets || structureFunctions)))
         {
+            // memset() for the structures without static initial values
+            if(support->language == ProtocolSupport::c_language)
+                verifySource->writeIncludeDirective("string.h", std::string(), true);
+
             verifySource->makeLineSeparator();
             verifySource->write(getSetToInitialValueFunctionBody(false));
             verifySource->makeLineSeparator();
@@ -644,7 +809,7 @@ void ProtocolPacket::createTopLevelStructureFunctions(void)
         if(encode)
         {
             // In C++ this is part of the class declaration
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
             {
                 header.makeLineSeparator();
                 header.write(getEncodeFunctionPrototype(std::string(), false));
@@ -657,7 +822,7 @@ void ProtocolPacket::createTopLevelStructureFunctions(void)
         if(decode)
         {
             // In C++ this is part of the class declaration
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
             {
                 header.makeLineSeparator();
                 header.write(getDecodeFunctionPrototype(std::string(), false));
@@ -686,7 +851,7 @@ void ProtocolPacket::createStructurePacketFunctions(void)
 
     // The prototypes in the header file are only needed for C,
     // in C++ these prototypes are part of the class declaration.
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
         // In the event that there are no parameters, the parameter function
         // is the same as the structure function - so don't output both
@@ -706,11 +871,32 @@ void ProtocolPacket::createStructurePacketFunctions(void)
             header.write(getStructurePacketDecodePrototype(std::string()));
         }
 
+        if(diff)
+        {
+            // The prototypes for the change-only encode and decode functions
+            header.makeLineSeparator();
+            header.write(getDiffPrototypes(std::string()));
+        }
+
+        if(gather)
+        {
+            // The prototype for the scatter/gather encode function
+            header.makeLineSeparator();
+            header.write(getGatherEncodePrototype(std::string()));
+        }
+
+        if(stream)
+        {
+            // The prototypes for the resumable encode and decode functions
+            header.makeLineSeparator();
+            header.write(getStreamPrototypes(std::string()));
+        }
+
         if(compare && compareHeader != nullptr)
         {
             compareHeader->makeLineSeparator();
-            compareHeader->write("//! Compare two " + support.prefix + name + " packets and generate a report\n");
-            compareHeader->write("std::string compare" + support.prefix + name + support.packetParameterSuffix + "(std::string prename, const " + support.pointerType + " pkt1, const " + support.pointerType + " pkt2);\n");
+            compareHeader->write("//! Compare two " + support->prefix + name + " packets and generate a report\n");
+            compareHeader->write("std::string compare" + support->prefix + name + support->packetParameterSuffix + "(std::string prename, const " + support->pointerType + " pkt1, const " + support->pointerType + " pkt2);\n");
             compareHeader->makeLineSeparator();
         }
 
@@ -718,7 +904,7 @@ void ProtocolPacket::createStructurePacketFunctions(void)
         {
             printHeader->makeLineSeparator();
             printHeader->write("//! Generate a string that describes the contents of a " + name + " packet\n");
-            printHeader->write("std::string textPrint" + (support.prefix + name + support.packetParameterSuffix) + "(std::string prename, const " + support.pointerType + " pkt);\n");
+            printHeader->write("std::string textPrint" + (support->prefix + name + support->packetParameterSuffix) + "(std::string prename, const " + support->pointerType + " pkt);\n");
             printHeader->makeLineSeparator();
         }
 
@@ -742,6 +928,32 @@ void ProtocolPacket::createStructurePacketFunctions(void)
         source.write(getStructurePacketDecodeBody());
     }
 
+    if(diff)
+    {
+        // memcmp(), strncmp(), and memcpy() for the change detection
+        if(encode)
+            source.writeIncludeDirective("string.h", std::string(), true);
+
+        source.makeLineSeparator();
+        source.write(getDiffEncodeBody());
+        source.makeLineSeparator();
+        source.write(getDiffDecodeBody());
+    }
+
+    if(gather)
+    {
+        source.makeLineSeparator();
+        source.write(getGatherEncodeBody());
+    }
+
+    if(stream)
+    {
+        source.makeLineSeparator();
+        source.write(getStreamEncodeBody());
+        source.makeLineSeparator();
+        source.write(getStreamDecodeBody());
+    }
+
     if(compare && (compareSource != nullptr))
     {
         compareSource->makeLineSeparator();
@@ -753,10 +965,10 @@ void ProtocolPacket::createStructurePacketFunctions(void)
         compareSource->write(" * \\return a string describing any differences between pk1 and pkt2. The string will be empty if there are no differences\n");
         compareSource->write(" */\n");
 
-        if(support.language == ProtocolSupport::c_language)
-            compareSource->write("std::string compare" + (support.prefix + name + support.packetParameterSuffix) + "(std::string _pg_prename, const " + support.pointerType + " _pg_pkt1, const " + support.pointerType + " _pg_pkt2)\n");
+        if(support->language == ProtocolSupport::c_language)
+            compareSource->write("std::string compare" + (support->prefix + name + support->packetParameterSuffix) + "(std::string _pg_prename, const " + support->pointerType + " _pg_pkt1, const " + support->pointerType + " _pg_pkt2)\n");
         else
-            compareSource->write("std::string " + typeName + "::compare(std::string _pg_prename, const " + support.pointerType + " _pg_pkt1, const " + support.pointerType + " _pg_pkt2)\n");
+            compareSource->write("std::string " + typeName + "::compare(std::string _pg_prename, const " + support->pointerType + " _pg_pkt1, const " + support->pointerType + " _pg_pkt2)\n");
 
         compareSource->write("{\n");
         compareSource->write(TAB_IN + "std::string _pg_report;\n");
@@ -771,7 +983,7 @@ void ProtocolPacket::createStructurePacketFunctions(void)
             compareSource->write(TAB_IN + "if(_pg_prename.empty())\n");
             compareSource->write(TAB_IN + TAB_IN + "_pg_prename = \"" + name + "\";\n");
 
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
             {
                 // In C we need explicity initializers
                 compareSource->makeLineSeparator();
@@ -803,7 +1015,7 @@ void ProtocolPacket::createStructurePacketFunctions(void)
 
             compareSource->makeLineSeparator();
             compareSource->write(TAB_IN + "// Check packet types\n");
-            compareSource->write(TAB_IN + "if((get" + support.protoName + "PacketID(_pg_pkt1) != get" + support.protoName + "PacketID(_pg_pkt1)) || (get"+ support.protoName + "PacketID(_pg_pkt2) != get" + (support.prefix + name + support.packetParameterSuffix) + "ID()))\n");
+            compareSource->write(TAB_IN + "if((get" + support->protoName + "PacketID(_pg_pkt1) != get" + support->protoName + "PacketID(_pg_pkt1)) || (get"+ support->protoName + "PacketID(_pg_pkt2) != get" + (support->prefix + name + support->packetParameterSuffix) + "ID()))\n");
             compareSource->write(TAB_IN + "{\n");
             compareSource->write(TAB_IN + TAB_IN + "_pg_report += _pg_prename + \" packet IDs are different\\n\";\n");
             compareSource->write(TAB_IN + TAB_IN + "return _pg_report;\n");
@@ -812,14 +1024,14 @@ void ProtocolPacket::createStructurePacketFunctions(void)
 
         compareSource->makeLineSeparator();
         compareSource->write(TAB_IN + "// Check packet sizes. Even if sizes are different the packets may contain the same result\n");
-        compareSource->write(TAB_IN + "if(get" + support.protoName + "PacketSize(_pg_pkt1) != get" + support.protoName + "PacketSize(_pg_pkt2))\n");
+        compareSource->write(TAB_IN + "if(get" + support->protoName + "PacketSize(_pg_pkt1) != get" + support->protoName + "PacketSize(_pg_pkt2))\n");
         compareSource->write(TAB_IN + TAB_IN + "_pg_report += _pg_prename + \" packet sizes are different\\n\";\n");
 
         if(numDecodes > 0)
         {
             compareSource->makeLineSeparator();
 
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
                 compareSource->write(TAB_IN + "_pg_report += compare" + structName + "(_pg_prename, &_pg_struct1, &_pg_struct2);\n");
             else
                 compareSource->write(TAB_IN + "_pg_report += _pg_struct1.compare(_pg_prename, &_pg_struct2);\n");
@@ -829,8 +1041,8 @@ void ProtocolPacket::createStructurePacketFunctions(void)
         compareSource->write(TAB_IN + "return _pg_report;\n");
         compareSource->write("\n");
 
-        if(support.language == ProtocolSupport::c_language)
-            compareSource->write("}// compare" + support.prefix + name + support.packetParameterSuffix + "\n");
+        if(support->language == ProtocolSupport::c_language)
+            compareSource->write("}// compare" + support->prefix + name + support->packetParameterSuffix + "\n");
         else
             compareSource->write("}// " + typeName + "::compare\n");
 
@@ -845,10 +1057,10 @@ void ProtocolPacket::createStructurePacketFunctions(void)
         printSource->write(" * \\param _pg_pkt is the data to print\n");
         printSource->write(" * \\return a string describing the contents of _pg_pkt\n");
         printSource->write(" */\n");
-        if(support.language == ProtocolSupport::c_language)
-            printSource->write("std::string textPrint" + (support.prefix + name + support.packetParameterSuffix) + "(std::string _pg_prename, const " + support.pointerType + " _pg_pkt)\n");
+        if(support->language == ProtocolSupport::c_language)
+            printSource->write("std::string textPrint" + (support->prefix + name + support->packetParameterSuffix) + "(std::string _pg_prename, const " + support->pointerType + " _pg_pkt)\n");
         else
-            printSource->write("std::string " + typeName + "::textPrint(std::string _pg_prename, const " + support.pointerType + " _pg_pkt)\n");
+            printSource->write("std::string " + typeName + "::textPrint(std::string _pg_prename, const " + support->pointerType + " _pg_pkt)\n");
         printSource->write("{\n");
         printSource->write(TAB_IN + "std::string _pg_report;\n");
 
@@ -862,7 +1074,7 @@ void ProtocolPacket::createStructurePacketFunctions(void)
             printSource->write(TAB_IN + "if(_pg_prename.empty())\n");
             printSource->write(TAB_IN + TAB_IN + "_pg_prename = \"" + name + "\";\n");
 
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
             {
                 // In C we need explicity initializers
                 printSource->makeLineSeparator();
@@ -894,7 +1106,7 @@ void ProtocolPacket::createStructurePacketFunctions(void)
 
             printSource->makeLineSeparator();
             printSource->write(TAB_IN + "// Check packet type\n");
-            printSource->write(TAB_IN + "if(get"+ support.protoName + "PacketID(_pg_pkt) != get" + (support.prefix + name + support.packetParameterSuffix) + "ID())\n");
+            printSource->write(TAB_IN + "if(get"+ support->protoName + "PacketID(_pg_pkt) != get" + (support->prefix + name + support->packetParameterSuffix) + "ID())\n");
             printSource->write(TAB_IN + "{\n");
             printSource->write(TAB_IN + TAB_IN + "_pg_report += _pg_prename + \" packet ID is incorrect\\n\";\n");
             printSource->write(TAB_IN + TAB_IN + "return _pg_report;\n");
@@ -903,13 +1115,13 @@ void ProtocolPacket::createStructurePacketFunctions(void)
 
         printSource->makeLineSeparator();
         printSource->write(TAB_IN + "// Print the packet size\n");
-        printSource->write(TAB_IN + "_pg_report += _pg_prename + \" packet size is \" + std::to_string(get" + support.protoName + "PacketSize(_pg_pkt)) + \"\\n\";\n");
+        printSource->write(TAB_IN + "_pg_report += _pg_prename + \" packet size is \" + std::to_string(get" + support->protoName + "PacketSize(_pg_pkt)) + \"\\n\";\n");
 
         if(numDecodes > 0)
         {
             printSource->makeLineSeparator();
 
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
                 printSource->write(TAB_IN + "_pg_report += textPrint" + structName + "(_pg_prename, &_pg_user);\n");
             else
                 printSource->write(TAB_IN + "_pg_report += _pg_user.textPrint(_pg_prename);\n");
@@ -918,8 +1130,8 @@ void ProtocolPacket::createStructurePacketFunctions(void)
         printSource->makeLineSeparator();
         printSource->write(TAB_IN + "return _pg_report;\n");
         printSource->write("\n");
-        if(support.language == ProtocolSupport::c_language)
-            printSource->write("}// textPrint" + (support.prefix + name + support.packetParameterSuffix) + "\n");
+        if(support->language == ProtocolSupport::c_language)
+            printSource->write("}// textPrint" + (support->prefix + name + support->packetParameterSuffix) + "\n");
         else
             printSource->write("}// " + typeName + "::textPrint\n");
 
@@ -945,9 +1157,9 @@ std::string ProtocolPacket::getStructurePacketEncodeSignature(bool insource) con
     if(insource)
         pg = "_pg_";
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
-        output = "void encode" + support.prefix + name + support.packetStructureSuffix + "(" + support.pointerType + " " + pg + "pkt";
+        output = "void encode" + support->prefix + name + support->packetStructureSuffix + "(" + support->pointerType + " " + pg + "pkt";
 
         if(numEncodes > 0)
             output += ", const " + structName + "* " + pg + "user";
@@ -966,7 +1178,7 @@ std::string ProtocolPacket::getStructurePacketEncodeSignature(bool insource) con
         if(insource)
             output += typeName + "::";
 
-        output += "encode(" + support.pointerType + " " + pg + "pkt";
+        output += "encode(" + support->pointerType + " " + pg + "pkt";
     }
 
     if(ids.size() <= 1)
@@ -974,7 +1186,7 @@ std::string ProtocolPacket::getStructurePacketEncodeSignature(bool insource) con
     else
         output += ", uint32_t " + pg + "id)";
 
-    if((support.language == ProtocolSupport::cpp_language) && (numEncodes > 0))
+    if((support->language == ProtocolSupport::cpp_language) && (numEncodes > 0))
         output += " const";
 
     return output;
@@ -1020,7 +1232,7 @@ std::string ProtocolPacket::getStructurePacketEncodeBody(void) const
     output += " *\n";
     output += ProtocolParser::outputLongComment(" * ", comment) + "\n";
     output += " * \\param _pg_pkt points to the packet which will be created by this function\n";
-    if((numEncodes > 0) && (support.language == ProtocolSupport::c_language))
+    if((numEncodes > 0) && (support->language == ProtocolSupport::c_language))
         output += " * \\param _pg_user points to the user data that will be encoded in _pg_pkt\n";
     if(ids.size() > 1)
         output += " * \\param _pg_id is the packet identifier for _pg_pkt\n";
@@ -1029,7 +1241,7 @@ std::string ProtocolPacket::getStructurePacketEncodeBody(void) const
     output += "{\n";
 
     if(getNumberOfEncodes() > 0)
-        output += TAB_IN + "uint8_t* _pg_data = get" + support.protoName + "PacketData(_pg_pkt);\n";
+        output += TAB_IN + "uint8_t* _pg_data = get" + support->protoName + "PacketData(_pg_pkt);\n";
 
     output += TAB_IN + "int _pg_byteindex = 0;\n";
 
@@ -1045,7 +1257,7 @@ std::string ProtocolPacket::getStructurePacketEncodeBody(void) const
         output += TAB_IN + "uint8_t _pg_bitfieldbytes[" + std::to_string(numbitfieldgroupbytes) + "];\n";
     }
 
-    if(needsEncodeIterator)
+    if(needsCodecEncodeIterator)
         output += TAB_IN + "unsigned _pg_i = 0;\n";
 
     if(needs2ndEncodeIterator)
@@ -1061,18 +1273,19 @@ std::string ProtocolPacket::getStructurePacketEncodeBody(void) const
     std::string id;
     if(ids.size() > 1)
         id = "_pg_id";
-    else if(support.language == ProtocolSupport::c_language)
-        id = "get" + support.prefix + name + support.packetParameterSuffix + "ID()";
+    else if(support->language == ProtocolSupport::c_language)
+        id = "get" + support->prefix + name + support->packetParameterSuffix + "ID()";
     else
         id = "id()";
 
     ProtocolFile::makeLineSeparator(output);
     output += TAB_IN + "// complete the process of creating the packet\n";
-    output += TAB_IN + "finish" + support.protoName + "Packet(_pg_pkt, _pg_byteindex, " + id + ");\n";
+    output += TAB_IN + "finish" + support->protoName + "Packet(_pg_pkt, _pg_byteindex, " + id + ");\n";
+    output += getStatsHook("ENCODED", "_pg_byteindex");
 
     ProtocolFile::makeLineSeparator(output);
-    if(support.language == ProtocolSupport::c_language)
-        output += "}// encode" + support.prefix + name + support.packetStructureSuffix + "\n";
+    if(support->language == ProtocolSupport::c_language)
+        output += "}// encode" + support->prefix + name + support->packetStructureSuffix + "\n";
     else
         output += "}// " + typeName + "::encode\n";
 
@@ -1099,9 +1312,9 @@ std::string ProtocolPacket::getStructurePacketDecodeSignature(bool insource) con
     if(insource)
         pg = "_pg_";
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
-        output = "int decode" + support.prefix + name + support.packetStructureSuffix + "(const " + support.pointerType + " " + pg + "pkt";
+        output = "int decode" + support->prefix + name + support->packetStructureSuffix + "(const " + support->pointerType + " " + pg + "pkt";
 
         if(numDecodes > 0)
             output += ", " + structName + "* " + pg + "user";
@@ -1119,7 +1332,7 @@ std::string ProtocolPacket::getStructurePacketDecodeSignature(bool insource) con
         if(insource)
             output += typeName + "::";
 
-        output += "decode(const " + support.pointerType + " " + pg + "pkt";
+        output += "decode(const " + support->pointerType + " " + pg + "pkt";
     }
 
     output += + ")";
@@ -1163,8 +1376,8 @@ std::string ProtocolPacket::getStructurePacketDecodeBody(void) const
     std::string id;
     if(ids.size() <= 1)
     {
-        if(support.language == ProtocolSupport::c_language)
-            id = "get" + support.prefix + name + support.packetParameterSuffix + "ID()";
+        if(support->language == ProtocolSupport::c_language)
+            id = "get" + support->prefix + name + support->packetParameterSuffix + "ID()";
         else
             id = "id()";
     }
@@ -1177,7 +1390,7 @@ std::string ProtocolPacket::getStructurePacketDecodeBody(void) const
         output += " *\n";
         output += ProtocolParser::outputLongComment(" * ", comment) + "\n";
         output += " * \\param _pg_pkt points to the packet being decoded by this function\n";
-        if((getNumberOfDecodeParameters() > 0) && (support.language == ProtocolSupport::c_language))
+        if((getNumberOfDecodeParameters() > 0) && (support->language == ProtocolSupport::c_language))
             output += " * \\param _pg_user receives the data decoded from the packet\n";
         output += " * \\return " + getReturnCode(false) + " is returned if the packet ID or size is wrong, else " + getReturnCode(true) + "\n";
         output += " */\n";
@@ -1199,7 +1412,7 @@ std::string ProtocolPacket::getStructurePacketDecodeBody(void) const
             output += TAB_IN + "uint8_t _pg_bitfieldbytes[" + std::to_string(numbitfieldgroupbytes) + "];\n";
         }
 
-        if(needsDecodeIterator)
+        if(needsCodecDecodeIterator)
             output += TAB_IN + "unsigned _pg_i = 0;\n";
         if(needs2ndDecodeIterator)
             output += TAB_IN + "unsigned _pg_j = 0;\n";
@@ -1208,12 +1421,12 @@ std::string ProtocolPacket::getStructurePacketDecodeBody(void) const
         if(ids.size() <= 1)
         {
             output += TAB_IN + "// Verify the packet identifier\n";
-            output += TAB_IN + "if(get"+ support.protoName + "PacketID(_pg_pkt) != " + id + ")\n";
+            output += TAB_IN + "if(get"+ support->protoName + "PacketID(_pg_pkt) != " + id + ")\n";
         }
         else
         {
             output += TAB_IN + "// Verify the packet identifier, multiple options exist\n";
-            output += TAB_IN + "uint32_t _pg_packetid = get"+ support.protoName + "PacketID(_pg_pkt);\n";
+            output += TAB_IN + "uint32_t _pg_packetid = get"+ support->protoName + "PacketID(_pg_pkt);\n";
             output += TAB_IN + "if( _pg_packetid != " + ids.at(0);
             for(std::size_t i = 1; i < ids.size(); i++)
                 output += " &&\n" + TAB_IN + TAB_IN + "_pg_packetid != " + ids.at(i);
@@ -1221,16 +1434,17 @@ std::string ProtocolPacket::getStructurePacketDecodeBody(void) const
         }
         output += TAB_IN + TAB_IN + "return " + getReturnCode(false) + ";\n";
         output += "\n";
+        output += getStatsHook("DECODE_BEGIN", std::string());
         output += TAB_IN + "// Verify the packet size\n";
-        output += TAB_IN + "_pg_numbytes = get" + support.protoName + "PacketSize(_pg_pkt);\n";
-        if(support.language == ProtocolSupport::c_language)
-            output += TAB_IN + "if(_pg_numbytes < get" + support.prefix + name + "MinDataLength())\n";
+        output += TAB_IN + "_pg_numbytes = get" + support->protoName + "PacketSize(_pg_pkt);\n";
+        if(support->language == ProtocolSupport::c_language)
+            output += TAB_IN + "if(_pg_numbytes < get" + support->prefix + name + "MinDataLength())\n";
         else
             output += TAB_IN + "if(_pg_numbytes < minLength())\n";
-        output += TAB_IN + TAB_IN + "return " + getReturnCode(false) + ";\n";
+        output += TAB_IN + TAB_IN + "return " + getDecodeFailedReturn("tooShort", getReturnCode(false)) + ";\n";
         output += "\n";
         output += TAB_IN + "// The raw data from the packet\n";
-        output += TAB_IN + "_pg_data = get" + support.protoName + "PacketDataConst(_pg_pkt);\n";
+        output += TAB_IN + "_pg_data = get" + support->protoName + "PacketDataConst(_pg_pkt);\n";
         output += "\n";
         if(defaults)
         {
@@ -1254,7 +1468,7 @@ std::string ProtocolPacket::getStructurePacketDecodeBody(void) const
             if(encodables[i]->isDefault())
                 break;
 
-            output += encodables[i]->getDecodeString(&bitcount, true, true);
+            output += countDecodeReturns(encodables[i]->getDecodeString(&bitcount, true, true));
         }
 
         // Before we write out the decodes for default fields we need to check
@@ -1265,18 +1479,18 @@ std::string ProtocolPacket::getStructurePacketDecodeBody(void) const
             ProtocolFile::makeLineSeparator(output);
             output += TAB_IN + "// Used variable length arrays or dependent fields, check actual length\n";
             output += TAB_IN + "if(_pg_numbytes < _pg_byteindex)\n";
-            output += TAB_IN + TAB_IN + "return " + getReturnCode(false) + ";\n";
+            output += TAB_IN + TAB_IN + "return " + getDecodeFailedReturn("tooShort", getReturnCode(false)) + ";\n";
         }
 
         // Now finish the fields (if any defaults)
         for(; i < encodables.size(); i++)
         {
             ProtocolFile::makeLineSeparator(output);
-            output += encodables[i]->getDecodeString(&bitcount, true, true);
+            output += countDecodeReturns(encodables[i]->getDecodeString(&bitcount, true, true));
         }
 
         ProtocolFile::makeLineSeparator(output);
-        output += TAB_IN + "return " + getReturnCode(true) + ";\n";
+        output += TAB_IN + "return " + getDecodePassedReturn("_pg_numbytes", getReturnCode(true)) + ";\n";
 
     }// if fields to decode
     else
@@ -1293,12 +1507,12 @@ std::string ProtocolPacket::getStructurePacketDecodeBody(void) const
         if(ids.size() <= 1)
         {
             output += TAB_IN + "// Verify the packet identifier\n";
-            output += TAB_IN + "if(get"+ support.protoName + "PacketID(_pg_pkt) != " + id + ")\n";
+            output += TAB_IN + "if(get"+ support->protoName + "PacketID(_pg_pkt) != " + id + ")\n";
         }
         else
         {
             output += TAB_IN + "// Verify the packet identifier, multiple options exist\n";
-            output += TAB_IN + "uint32_t _pg_packetid = get"+ support.protoName + "PacketID(_pg_pkt);\n";
+            output += TAB_IN + "uint32_t _pg_packetid = get"+ support->protoName + "PacketID(_pg_pkt);\n";
             output += TAB_IN + "if( _pg_packetid != " + ids.at(0);
             for(std::size_t i = 1; i < ids.size(); i++)
                 output += " &&\n" + TAB_IN + TAB_IN + "_pg_packetid != " + ids.at(i);
@@ -1311,8 +1525,8 @@ std::string ProtocolPacket::getStructurePacketDecodeBody(void) const
     }// else if no fields to decode
 
     ProtocolFile::makeLineSeparator(output);
-    if(support.language == ProtocolSupport::c_language)
-        output += "}// decode" + support.prefix + name + support.packetStructureSuffix + "\n";
+    if(support->language == ProtocolSupport::c_language)
+        output += "}// decode" + support->prefix + name + support->packetStructureSuffix + "\n";
     else
         output += "}// " + typeName + "::decode\n";
 
@@ -1322,54 +1536,57 @@ std::string ProtocolPacket::getStructurePacketDecodeBody(void) const
 
 
 /*!
- * Create the functions for encoding and decoding the packet to/from parameters
+ * Determine if an encodable has a presence bit in the diff encoding. Only
+ * fields which are encoded, in memory, and not constant can change. Bitfields
+ * are excluded because they are packed together with their neighbors.
+ * \param encodable is the encodable to test.
+ * \return true if the encodable has a presence bit.
  */
-void ProtocolPacket::createPacketFunctions(void)
+bool ProtocolPacket::isDiffField(const Encodable* encodable) const
 {
-    // The prototypes in the header file are only needed for C,
-    // in C++ these prototypes are part of the class declaration.
-    if(support.language == ProtocolSupport::c_language)
-    {
-        if(encode)
-        {
-            // The prototype for the packet encode function
-            header.makeLineSeparator();
-            header.write(getParameterPacketEncodePrototype(std::string()));
-        }
+    return !encodable->isNotEncoded() && !encodable->isNotInMemory() && !encodable->isBitfield() && !encodable->isConstant();
+}
 
-        if(decode)
-        {
-            // The prototype for the packet decode function
-            header.makeLineSeparator();
-            header.write(getParameterPacketDecodePrototype(std::string()));
-        }
-    }
 
-    if(encode)
-    {
-        source.makeLineSeparator();
-        source.write(getParameterPacketEncodeBody());
-    }
+/*!
+ * Determine if an encodable is left out of the diff encoding. Constant and
+ * reserved fields never change, so they are never sent.
+ * \param encodable is the encodable to test.
+ * \return true if the encodable is not part of the diff encoding.
+ */
+bool ProtocolPacket::isDiffOmitted(const Encodable* encodable) const
+{
+    return !encodable->isBitfield() && encodable->isConstant();
+}
 
-    if(decode)
+
+/*!
+ * \return the number of encodables that have a presence bit in the diff encoding
+ */
+int ProtocolPacket::getNumberOfDiffFields(void) const
+{
+    int num = 0;
+
+    for(std::size_t i = 0; i < encodables.size(); i++)
     {
-        source.makeLineSeparator();
-        source.write(getParameterPacketDecodeBody());
+        if(isDiffField(encodables.at(i)))
+            num++;
+    }
 
-    }// if decode function enabled
+    return num;
 
-}// createPacketFunctions
+}// ProtocolPacket::getNumberOfDiffFields
 
 
 /*!
- * Get the signature of the packet encode function, without semicolon or
- * comments or line feed, for the prototype or actual function.
+ * Get the signature of the packet structure diff encode function, without
+ * semicolon or comments or line feed, for the prototype or actual function.
  * \param insource should be true to indicate this signature is in source code
  *        (i.e. not a prototype) which determines if the "_pg_" decoration is
  *        used as well as c++ access specifiers.
- * \return the encode signature
+ * \return the diff encode signature
  */
-std::string ProtocolPacket::getParameterPacketEncodeSignature(bool insource) const
+std::string ProtocolPacket::getDiffEncodeSignature(bool insource) const
 {
     std::string output;
     std::string pg;
@@ -1377,112 +1594,1283 @@ std::string ProtocolPacket::getParameterPacketEncodeSignature(bool insource) con
     if(insource)
         pg = "_pg_";
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
-        output = "void encode" + support.prefix + name + support.packetParameterSuffix + "(" + support.pointerType + " " + pg + "pkt";
+        output = "void encode" + support->prefix + name + support->packetStructureSuffix + "Diff(" + support->pointerType + " " + pg + "pkt";
+        output += ", const " + structName + "* " + pg + "user, " + structName + "* " + pg + "state";
     }
     else
     {
-        // C++ class member, this function should be "static" as it does not depend on any variables in the class
-        if(!insource)
-            output += "static ";
-
         output += "void ";
 
         // In the source the function needs the class scope
         if(insource)
             output += typeName + "::";
 
-        output += "encode(" + support.pointerType + " " + pg + "pkt";
+        output += "encodeDiff(" + support->pointerType + " " + pg + "pkt, " + typeName + "* " + pg + "state";
     }
 
-    output += getDataEncodeParameterList();
-
     if(ids.size() <= 1)
         output += ")";
     else
         output += ", uint32_t " + pg + "id)";
 
+    if(support->language == ProtocolSupport::cpp_language)
+        output += " const";
+
     return output;
-}
+
+}// ProtocolPacket::getDiffEncodeSignature
 
 
 /*!
- * Get the prototype for the parameter packet encode function
- * \param spacing is the offset for each line
- * \return the prototype including semicolon and line fees
+ * Get the signature of the packet structure diff decode function, without
+ * semicolon or comments or line feed, for the prototype or actual function.
+ * \param insource should be true to indicate this signature is in source code
+ *        (i.e. not a prototype) which determines if the "_pg_" decoration is
+ *        used as well as c++ access specifiers.
+ * \return the diff decode signature
  */
-std::string ProtocolPacket::getParameterPacketEncodePrototype(const std::string& spacing) const
+std::string ProtocolPacket::getDiffDecodeSignature(bool insource) const
 {
     std::string output;
+    std::string pg;
 
-    if(!encode)
-        return output;
+    if(insource)
+        pg = "_pg_";
 
-    output += spacing + "//! " + getDataEncodeBriefComment() + "\n";
-    output += spacing + getParameterPacketEncodeSignature(false) + ";\n";
+    if(support->language == ProtocolSupport::c_language)
+        output = "int decode" + support->prefix + name + support->packetStructureSuffix + "Diff(const " + support->pointerType + " " + pg + "pkt, " + structName + "* " + pg + "user)";
+    else
+    {
+        output += "bool ";
+
+        // In the source the function needs the class scope
+        if(insource)
+            output += typeName + "::";
+
+        output += "decodeDiff(const " + support->pointerType + " " + pg + "pkt)";
+    }
 
     return output;
-}
 
+}// ProtocolPacket::getDiffDecodeSignature
 
-//! Get the prototype for the parameter packet encode function
-std::string ProtocolPacket::getParameterPacketEncodeBody(void) const
+
+/*!
+ * Get the prototypes for the diff encode and decode functions
+ * \param spacing is the offset for each line
+ * \return the prototypes including semicolon and line feeds
+ */
+std::string ProtocolPacket::getDiffPrototypes(const std::string& spacing) const
 {
     std::string output;
 
-    std::size_t i;
-    int bitcount = 0;
+    if(encode)
+    {
+        output += spacing + "//! Create the " + support->prefix + name + " packet from the fields which changed since the last encode\n";
+        output += spacing + getDiffEncodeSignature(false) + ";\n";
+    }
+
+    if(encode && decode)
+        output += "\n";
+
+    if(decode)
+    {
+        output += spacing + "//! Apply the changed fields of the " + support->prefix + name + " packet onto the retained data\n";
+        output += spacing + getDiffDecodeSignature(false) + ";\n";
+    }
+
+    return output;
+
+}// ProtocolPacket::getDiffPrototypes
+
+
+/*!
+ * Get the body for the diff encode function. The encoding starts with a
+ * presence bitmap with one bit for each field that can change, followed by
+ * the fields whose bits are set. Bitfields are always encoded.
+ * \return The body of the function that encodes the changes of this packet.
+ */
+std::string ProtocolPacket::getDiffEncodeBody(void) const
+{
+    std::string output;
 
     if(!encode)
         return output;
 
-    // The string that gets the identifier for the packet
-    std::string id;
-    if(ids.size() > 1)
-        id = "_pg_id";
-    else if(support.language == ProtocolSupport::c_language)
-        id = "get" + support.prefix + name + support.packetParameterSuffix + "ID()";
-    else
-        id = "id()";
+    int numbitmap = (getNumberOfDiffFields() + 7)/8;
+
+    // How the user data and the state are accessed
+    std::string user;
+    if(support->language == ProtocolSupport::c_language)
+        user = "_pg_user->";
 
     output += "/*!\n";
-    output += " * \\brief " + getPacketEncodeBriefComment() + "\n";
+    output += " * \\brief Create the " + support->prefix + name + " packet from the fields which changed since the last encode\n";
     output += " *\n";
-    output += ProtocolParser::outputLongComment(" * ", comment) + "\n";
+    output += " * The packet starts with a bitmap of " + std::to_string(numbitmap) + " byte" + ((numbitmap > 1) ? "s" : "") + ", with one bit for each field\n";
+    output += " * that can change, followed by the fields which are different from _pg_state.\n";
+    output += " * Bitfields are always encoded, constant and reserved fields are never encoded.\n";
     output += " * \\param _pg_pkt points to the packet which will be created by this function\n";
-    for(i = 0; i < encodables.size(); i++)
-        output += encodables.at(i)->getEncodeParameterComment();
-
+    if(support->language == ProtocolSupport::c_language)
+        output += " * \\param _pg_user points to the user data that will be encoded in _pg_pkt\n";
+    output += " * \\param _pg_state holds the data of the last encode, the fields which are\n";
+    output += " *        encoded are copied into _pg_state\n";
     if(ids.size() > 1)
-        output += " * \\param id is the packet identifier for _pg_pkt\n";
-
+        output += " * \\param _pg_id is the packet identifier for _pg_pkt\n";
     output += " */\n";
-    output += getParameterPacketEncodeSignature(true) + "\n";
+    output += getDiffEncodeSignature(true) + "\n";
     output += "{\n";
+    output += TAB_IN + "uint8_t* _pg_data = get" + support->protoName + "PacketData(_pg_pkt);\n";
+    output += TAB_IN + "int _pg_byteindex = 0;\n";
+    output += TAB_IN + "uint8_t _pg_bitmap[" + std::to_string(numbitmap) + "] = {0};\n";
 
-    if(!encodedLength.isZeroLength())
+    if(usestempencodebitfields)
+        output += TAB_IN + "unsigned int _pg_tempbitfield = 0;\n";
+
+    if(usestempencodelongbitfields)
+        output += TAB_IN + "uint64_t _pg_templongbitfield = 0;\n";
+
+    if(numbitfieldgroupbytes > 0)
     {
-        output += TAB_IN + "uint8_t* _pg_data = get"+ support.protoName + "PacketData(_pg_pkt);\n";
-        output += TAB_IN + "int _pg_byteindex = 0;\n";
+        output += TAB_IN + "int _pg_bitfieldindex = 0;\n";
+        output += TAB_IN + "uint8_t _pg_bitfieldbytes[" + std::to_string(numbitfieldgroupbytes) + "];\n";
+    }
 
-        if(usestempencodebitfields)
-            output += TAB_IN + "unsigned int _pg_tempbitfield = 0;\n";
+    if(needsCodecEncodeIterator)
+        output += TAB_IN + "unsigned _pg_i = 0;\n";
 
-        if(usestempencodelongbitfields)
-            output += TAB_IN + "uint64_t _pg_templongbitfield = 0;\n";
+    if(needs2ndEncodeIterator)
+        output += TAB_IN + "unsigned _pg_j = 0;\n";
 
-        if(numbitfieldgroupbytes > 0)
-        {
-            output += TAB_IN + "int _pg_bitfieldindex = 0;\n";
-            output += TAB_IN + "uint8_t _pg_bitfieldbytes[" + std::to_string(numbitfieldgroupbytes) + "];\n";
-        }
+    output += "\n";
+    output += TAB_IN + "// Set the presence bit of each field which changed since the last encode.\n";
+    output += TAB_IN + "// Fields whose dependsOn is false are not encoded, so they are not marked\n";
 
-        if(needsEncodeIterator)
-            output += TAB_IN + "unsigned _pg_i = 0;\n";
+    int bit = 0;
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        const Encodable* encodable = encodables.at(i);
 
-        if(needs2ndEncodeIterator)
-            output += TAB_IN + "unsigned _pg_j = 0;\n";
+        if(!isDiffField(encodable))
+            continue;
+
+        std::string mine = user + encodable->name;
+        std::string last = "_pg_state->" + encodable->name;
+        std::string condition;
+
+        if(encodable->isString())
+            condition = "strncmp(" + mine + ", " + last + ", sizeof(" + last + ")) != 0";
+        else if(encodable->isArray())
+            condition = "memcmp(" + mine + ", " + last + ", sizeof(" + last + ")) != 0";
+        else if(!encodable->isPrimitive())
+            condition = "memcmp(&" + mine + ", &" + last + ", sizeof(" + last + ")) != 0";
+        else
+            condition = mine + " != " + last;
+
+        // Only part of a variable length array is encoded, so the receiver
+        // needs the whole array again whenever the length changes
+        if(!encodable->variableArray.empty())
+            condition += " || " + user + encodable->variableArray + " != _pg_state->" + encodable->variableArray;
+
+        if(!encodable->variable2dArray.empty())
+            condition += " || " + user + encodable->variable2dArray + " != _pg_state->" + encodable->variable2dArray;
+
+        if(!encodable->dependsOn.empty())
+        {
+            std::string depends = user + encodable->dependsOn;
+
+            if(!encodable->dependsOnValue.empty())
+                depends += " " + encodable->dependsOnCompare + " " + encodable->dependsOnValue;
+
+            condition = "(" + depends + ") && (" + condition + ")";
+        }
+
+        output += TAB_IN + "if(" + condition + ")\n";
+        output += TAB_IN + TAB_IN + "_pg_bitmap[" + std::to_string(bit/8) + "] |= " + std::to_string(1 << (bit % 8)) + ";\n";
+        bit++;
+    }
+
+    output += "\n";
+    output += TAB_IN + "// The presence bitmap comes first\n";
+    for(int i = 0; i < numbitmap; i++)
+        output += TAB_IN + "_pg_data[_pg_byteindex++] = _pg_bitmap[" + std::to_string(i) + "];\n";
+
+    int bitcount = 0;
+    bit = 0;
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        const Encodable* encodable = encodables.at(i);
+
+        if(isDiffOmitted(encodable))
+            continue;
+
+        output += "\n";
+
+        if(!isDiffField(encodable))
+        {
+            output += encodable->getEncodeString(&bitcount, true);
+            continue;
+        }
+
+        std::string mine = user + encodable->name;
+        std::string last = "_pg_state->" + encodable->name;
+        const ProtocolField* field = dynamic_cast<const ProtocolField*>(encodable);
+
+        output += TAB_IN + "if(_pg_bitmap[" + std::to_string(bit/8) + "] & " + std::to_string(1 << (bit % 8)) + ")\n";
+        output += TAB_IN + "{\n";
+
+        // A difference from the last packet updates the state as it is encoded
+        if((field != nullptr) && field->isDeltaPacket())
+            output += indentCode(field->getDiffEncodeString(&bitcount, true));
+        else
+        {
+            output += indentCode(encodable->getEncodeString(&bitcount, true));
+
+            if(encodable->isArray())
+                output += TAB_IN + TAB_IN + "memcpy(" + last + ", " + mine + ", sizeof(" + last + "));\n";
+            else
+                output += TAB_IN + TAB_IN + last + " = " + mine + ";\n";
+        }
+
+        output += TAB_IN + "}\n";
+        bit++;
+    }
+
+    // Bitfields are always encoded, but they may give the length of an
+    // array, so the state has to follow them
+    std::string bitfields;
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        const Encodable* encodable = encodables.at(i);
+
+        if(encodable->isBitfield() && !encodable->isNotInMemory() && !encodable->isConstant())
+            bitfields += TAB_IN + "_pg_state->" + encodable->name + " = " + user + encodable->name + ";\n";
+    }
+
+    if(!bitfields.empty())
+    {
+        ProtocolFile::makeLineSeparator(output);
+        output += TAB_IN + "// Bitfields are always encoded, keep the state current\n";
+        output += bitfields;
+    }
+
+    std::string id;
+    if(ids.size() > 1)
+        id = "_pg_id";
+    else if(support->language == ProtocolSupport::c_language)
+        id = "get" + support->prefix + name + support->packetParameterSuffix + "ID()";
+    else
+        id = "id()";
+
+    ProtocolFile::makeLineSeparator(output);
+    output += TAB_IN + "// complete the process of creating the packet\n";
+    output += TAB_IN + "finish" + support->protoName + "Packet(_pg_pkt, _pg_byteindex, " + id + ");\n";
+    output += getStatsHook("ENCODED", "_pg_byteindex");
+
+    ProtocolFile::makeLineSeparator(output);
+    if(support->language == ProtocolSupport::c_language)
+        output += "}// encode" + support->prefix + name + support->packetStructureSuffix + "Diff\n";
+    else
+        output += "}// " + typeName + "::encodeDiff\n";
+
+    return output;
+
+}// ProtocolPacket::getDiffEncodeBody
+
+
+/*!
+ * Get the body for the diff decode function. The fields whose presence bits
+ * are set are decoded onto the retained data, all other fields are unchanged.
+ * \return The body of the function that decodes the changes of this packet.
+ */
+std::string ProtocolPacket::getDiffDecodeBody(void) const
+{
+    std::string output;
+
+    if(!decode)
+        return output;
+
+    int numbitmap = (getNumberOfDiffFields() + 7)/8;
+
+    output += "/*!\n";
+    output += " * \\brief Apply the changed fields of the " + support->prefix + name + " packet onto the retained data\n";
+    output += " *\n";
+    output += " * The packet must have been created by the diff encode function. Fields\n";
+    output += " * which are not in the packet keep the value they had before this call.\n";
+    output += " * If the decode fails the retained data are restored, so they only change\n";
+    output += " * when the entire packet is decoded.\n";
+    output += " * \\param _pg_pkt points to the packet being decoded by this function\n";
+    if(support->language == ProtocolSupport::c_language)
+        output += " * \\param _pg_user holds the retained data, and receives the changed fields\n";
+    output += " * \\return " + getReturnCode(false) + " is returned if the packet ID or size is wrong, else " + getReturnCode(true) + "\n";
+    output += " */\n";
+    output += getDiffDecodeSignature(true) + "\n";
+    output += "{\n";
+    output += TAB_IN + "int _pg_numbytes;\n";
+    output += TAB_IN + "int _pg_byteindex = 0;\n";
+    output += TAB_IN + "const uint8_t* _pg_data;\n";
+    output += TAB_IN + "uint8_t _pg_bitmap[" + std::to_string(numbitmap) + "];\n";
+
+    // A copy of the retained data, which every failure restores
+    if(support->language == ProtocolSupport::c_language)
+        output += TAB_IN + structName + " _pg_retained = *_pg_user;\n";
+    else
+        output += TAB_IN + typeName + " _pg_retained(*this);\n";
+
+    if(usestempdecodebitfields)
+        output += TAB_IN + "unsigned int _pg_tempbitfield = 0;\n";
+
+    if(usestempdecodelongbitfields)
+        output += TAB_IN + "uint64_t _pg_templongbitfield = 0;\n";
+
+    if(numbitfieldgroupbytes > 0)
+    {
+        output += TAB_IN + "int _pg_bitfieldindex = 0;\n";
+        output += TAB_IN + "uint8_t _pg_bitfieldbytes[" + std::to_string(numbitfieldgroupbytes) + "];\n";
+    }
+
+    if(needsCodecDecodeIterator)
+        output += TAB_IN + "unsigned _pg_i = 0;\n";
+    if(needs2ndDecodeIterator)
+        output += TAB_IN + "unsigned _pg_j = 0;\n";
+    output += "\n";
+
+    if(ids.size() <= 1)
+    {
+        output += TAB_IN + "// Verify the packet identifier\n";
+        if(support->language == ProtocolSupport::c_language)
+            output += TAB_IN + "if(get"+ support->protoName + "PacketID(_pg_pkt) != get" + support->prefix + name + support->packetParameterSuffix + "ID())\n";
+        else
+            output += TAB_IN + "if(get"+ support->protoName + "PacketID(_pg_pkt) != id())\n";
+    }
+    else
+    {
+        output += TAB_IN + "// Verify the packet identifier, multiple options exist\n";
+        output += TAB_IN + "uint32_t _pg_packetid = get"+ support->protoName + "PacketID(_pg_pkt);\n";
+        output += TAB_IN + "if( _pg_packetid != " + ids.at(0);
+        for(std::size_t i = 1; i < ids.size(); i++)
+            output += " &&\n" + TAB_IN + TAB_IN + "_pg_packetid != " + ids.at(i);
+        output += " )\n";
+    }
+    output += TAB_IN + TAB_IN + "return " + getReturnCode(false) + ";\n";
+    output += "\n";
+    output += getStatsHook("DECODE_BEGIN", std::string());
+    output += TAB_IN + "// Verify the packet size, which must at least hold the presence bitmap\n";
+    output += TAB_IN + "_pg_numbytes = get" + support->protoName + "PacketSize(_pg_pkt);\n";
+    output += TAB_IN + "if(_pg_numbytes < " + std::to_string(numbitmap) + ")\n";
+    output += TAB_IN + TAB_IN + "return " + getDecodeFailedReturn("tooShort", getReturnCode(false)) + ";\n";
+    output += "\n";
+    output += TAB_IN + "// The raw data from the packet\n";
+    output += TAB_IN + "_pg_data = get" + support->protoName + "PacketDataConst(_pg_pkt);\n";
+    output += "\n";
+    output += TAB_IN + "// The presence bitmap comes first\n";
+    for(int i = 0; i < numbitmap; i++)
+        output += TAB_IN + "_pg_bitmap[" + std::to_string(i) + "] = _pg_data[_pg_byteindex++];\n";
+
+    // Bits of the bitmap which do not belong to a field must be zero
+    int unused = (numbitmap*8) - getNumberOfDiffFields();
+    if(unused > 0)
+    {
+        output += "\n";
+        output += TAB_IN + "// Bits which do not belong to a field must be zero\n";
+        output += TAB_IN + "if(_pg_bitmap[" + std::to_string(numbitmap - 1) + "] & " + std::to_string(0xFF & (0xFF << (8 - unused))) + ")\n";
+        output += TAB_IN + TAB_IN + "return " + getDecodeFailedReturn("invalid", getReturnCode(false)) + ";\n";
+    }
+
+    int bitcount = 0;
+    int bit = 0;
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        const Encodable* encodable = encodables.at(i);
+
+        if(isDiffOmitted(encodable))
+            continue;
+
+        output += "\n";
+
+        // The fields of a bitfield group are checked together, before the first one
+        std::string length = getDiffMinimumLength(encodable, bitcount);
+
+        if(!isDiffField(encodable))
+        {
+            if(!length.empty())
+            {
+                output += TAB_IN + "if(_pg_byteindex + " + length + " > _pg_numbytes)\n";
+                output += TAB_IN + TAB_IN + getDiffFailedReturn("tooShort");
+                output += "\n";
+            }
+
+            output += restoreDiffReturns(countDecodeReturns(encodable->getDecodeString(&bitcount, true, false)));
+            continue;
+        }
+
+        output += TAB_IN + "if(_pg_bitmap[" + std::to_string(bit/8) + "] & " + std::to_string(1 << (bit % 8)) + ")\n";
+        output += TAB_IN + "{\n";
+
+        if(!length.empty())
+        {
+            output += TAB_IN + TAB_IN + "if(_pg_byteindex + " + length + " > _pg_numbytes)\n";
+            output += TAB_IN + TAB_IN + TAB_IN + getDiffFailedReturn("tooShort");
+            output += "\n";
+        }
+
+        // A difference from the last packet is added to the retained value
+        const ProtocolField* field = dynamic_cast<const ProtocolField*>(encodable);
+        if((field != nullptr) && field->isDeltaPacket())
+            output += indentCode(restoreDiffReturns(countDecodeReturns(field->getDiffDecodeString(&bitcount, true))));
+        else
+            output += indentCode(restoreDiffReturns(countDecodeReturns(encodable->getDecodeString(&bitcount, true, false))));
+        output += TAB_IN + "}\n";
+        bit++;
+    }
+
+    ProtocolFile::makeLineSeparator(output);
+    output += TAB_IN + "// Variable length fields may have gone past the end, check it\n";
+    output += TAB_IN + "if(_pg_numbytes < _pg_byteindex)\n";
+    output += TAB_IN + TAB_IN + getDiffFailedReturn("tooShort");
+
+    ProtocolFile::makeLineSeparator(output);
+    output += TAB_IN + "return " + getDecodePassedReturn("_pg_numbytes", getReturnCode(true)) + ";\n";
+
+    ProtocolFile::makeLineSeparator(output);
+    if(support->language == ProtocolSupport::c_language)
+        output += "}// decode" + support->prefix + name + support->packetStructureSuffix + "Diff\n";
+    else
+        output += "}// " + typeName + "::decodeDiff\n";
+
+    return output;
+
+}// ProtocolPacket::getDiffDecodeBody
+
+
+/*!
+ * Get the minimum number of bytes that must remain in the packet before an
+ * encodable is decoded by the diff decode function.
+ * \param encodable is the encodable which is about to be decoded.
+ * \param bitcount is the number of bits of the current bitfield run that have
+ *        already been decoded, a bitfield run is checked before its first bit.
+ * \return the minimum length, or an empty string if nothing needs checking.
+ */
+std::string ProtocolPacket::getDiffMinimumLength(const Encodable* encodable, int bitcount) const
+{
+    std::string length;
+
+    if(encodable->isBitfield())
+    {
+        if(bitcount != 0)
+            return std::string();
+
+        // The bytes of all the bitfields in this run, which are counted by its last bitfield
+        std::string total;
+        for(std::size_t i = 0; i < encodables.size(); i++)
+        {
+            if(encodables.at(i) == encodable)
+            {
+                for(std::size_t j = i; (j < encodables.size()) && encodables.at(j)->isBitfield(); j++)
+                    total += "+" + encodables.at(j)->encodedLength.minEncodedLength;
+                break;
+            }
+        }
+
+        length = EncodedLength::collapseLengthString(total);
+    }
+    else
+        length = EncodedLength::collapseLengthString(encodable->encodedLength.minEncodedLength);
+
+    if(length.empty() || (length == "0"))
+        return std::string();
+
+    return length;
+
+}// ProtocolPacket::getDiffMinimumLength
+
+
+/*!
+ * Get the statement which restores the retained data and returns failure
+ * from the diff decode function.
+ * \param reason is the reason for the runtime counters.
+ * \return the return statement, including the line feed.
+ */
+std::string ProtocolPacket::getDiffFailedReturn(const std::string& reason) const
+{
+    std::string restore;
+
+    if(support->language == ProtocolSupport::c_language)
+        restore = "*_pg_user = _pg_retained";
+    else
+        restore = "*this = _pg_retained";
+
+    return "return (" + restore + ", " + getDecodeFailedReturn(reason, getReturnCode(false)) + ");\n";
+
+}// ProtocolPacket::getDiffFailedReturn
+
+
+/*!
+ * Change the failure returns of the decode of a field, so that they restore
+ * the retained data of the diff decode function.
+ * \param code is the decode code, after the runtime counters were added.
+ * \return the code with every failure return restoring the retained data.
+ */
+std::string ProtocolPacket::restoreDiffReturns(std::string code) const
+{
+    std::string failure = "return " + getDecodeFailedReturn("invalid", getReturnCode(false)) + ";\n";
+    std::string restore = getDiffFailedReturn("invalid");
+
+    replaceinplace(code, failure, restore);
+
+    return code;
+
+}// ProtocolPacket::restoreDiffReturns
+
+
+/*!
+ * Get the number of segments the gather encode function can produce, which
+ * is one for each field referenced in place, plus one for the packet data
+ * before each of those fields, plus one for the packet data at the end, plus
+ * one each for the header and checksum segments the finish function can add.
+ * \return the maximum number of segments.
+ */
+int ProtocolPacket::getNumberOfGatherSegments(void) const
+{
+    int number = 3;
+
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        if(encodables.at(i)->isGather())
+            number += 2;
+    }
+
+    return number;
+
+}// ProtocolPacket::getNumberOfGatherSegments
+
+
+/*!
+ * Get the signature of the packet structure gather encode function, without
+ * semicolon or comments or line feed, for the prototype or actual function.
+ * \param insource should be true to indicate this signature is in source code
+ *        (i.e. not a prototype) which determines if the "_pg_" decoration is
+ *        used as well as c++ access specifiers.
+ * \return the gather encode signature
+ */
+std::string ProtocolPacket::getGatherEncodeSignature(bool insource) const
+{
+    std::string output;
+    std::string pg;
+    std::string segment = support->protoName + "Segment" + support->typeSuffix;
+
+    if(insource)
+        pg = "_pg_";
+
+    if(support->language == ProtocolSupport::c_language)
+    {
+        output = "int encode" + support->prefix + name + support->packetStructureSuffix + "Gather(" + support->pointerType + " " + pg + "pkt";
+        output += ", const " + structName + "* " + pg + "user, " + segment + "* " + pg + "segments";
+    }
+    else
+    {
+        output += "int ";
+
+        // In the source the function needs the class scope
+        if(insource)
+            output += typeName + "::";
+
+        output += "encodeGather(" + support->pointerType + " " + pg + "pkt, " + segment + "* " + pg + "segments";
+    }
+
+    if(ids.size() <= 1)
+        output += ")";
+    else
+        output += ", uint32_t " + pg + "id)";
+
+    if(support->language == ProtocolSupport::cpp_language)
+        output += " const";
+
+    return output;
+
+}// ProtocolPacket::getGatherEncodeSignature
+
+
+/*!
+ * Get the prototype for the gather encode function
+ * \param spacing is the offset for each line
+ * \return the prototype including semicolon and line feeds
+ */
+std::string ProtocolPacket::getGatherEncodePrototype(const std::string& spacing) const
+{
+    std::string output;
+
+    if(!encode)
+        return output;
+
+    output += spacing + "//! Create the " + support->prefix + name + " packet as a list of segments, referencing large fields in place\n";
+    output += spacing + getGatherEncodeSignature(false) + ";\n";
+
+    return output;
+
+}// ProtocolPacket::getGatherEncodePrototype
+
+
+/*!
+ * Get the body for the gather encode function. The bytes are the same as the
+ * normal encode, but the fields marked gather are not copied into the packet,
+ * instead they are referenced in place by the segment list.
+ * \return The body of the function that encodes this packet as segments.
+ */
+std::string ProtocolPacket::getGatherEncodeBody(void) const
+{
+    std::string output;
+
+    if(!encode)
+        return output;
+
+    output += "/*!\n";
+    output += " * \\brief Create the " + support->prefix + name + " packet as a list of segments, referencing large fields in place\n";
+    output += " *\n";
+    output += " * The packet data are the concatenation of the segments, which is the same\n";
+    output += " * as the normal encode. Small fields are encoded in the packet and large\n";
+    output += " * fields are referenced in place, so the segments can be sent without a copy.\n";
+    output += " * The referenced fields must not change until the segments are sent. Empty\n";
+    output += " * fields do not have a segment, and the finish function can add a header\n";
+    output += " * segment before the data and a checksum segment after them.\n";
+    output += " * \\param _pg_pkt points to the packet which will hold the small fields\n";
+    if(support->language == ProtocolSupport::c_language)
+        output += " * \\param _pg_user points to the user data that will be encoded\n";
+    output += " * \\param _pg_segments receives the list of segments, which must have room for\n";
+    if(support->language == ProtocolSupport::c_language)
+        output += " *        get" + support->prefix + name + "MaxSegments() entries\n";
+    else
+        output += " *        maxSegments() entries\n";
+    if(ids.size() > 1)
+        output += " * \\param _pg_id is the packet identifier for _pg_pkt\n";
+    output += " * \\return the number of segments\n";
+    output += " */\n";
+    output += getGatherEncodeSignature(true) + "\n";
+    output += "{\n";
+    output += TAB_IN + "uint8_t* _pg_data = get" + support->protoName + "PacketData(_pg_pkt);\n";
+    output += TAB_IN + "int _pg_byteindex = 0;\n";
+    output += TAB_IN + "int _pg_start = 0;\n";
+    output += TAB_IN + "int _pg_numsegments = 0;\n";
+    output += TAB_IN + "int _pg_length = 0;\n";
+    output += TAB_IN + "int _pg_gathered = 0;\n";
+
+    if(usestempencodebitfields)
+        output += TAB_IN + "unsigned int _pg_tempbitfield = 0;\n";
+
+    if(usestempencodelongbitfields)
+        output += TAB_IN + "uint64_t _pg_templongbitfield = 0;\n";
+
+    if(numbitfieldgroupbytes > 0)
+    {
+        output += TAB_IN + "int _pg_bitfieldindex = 0;\n";
+        output += TAB_IN + "uint8_t _pg_bitfieldbytes[" + std::to_string(numbitfieldgroupbytes) + "];\n";
+    }
+
+    // Gathered arrays are referenced in place, only arrays encoded in the packet need the iterator
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        const Encodable* encodable = encodables.at(i);
+
+        if(encodable->isGather())
+            continue;
+
+        if(encodable->isPrimitive() ? (encodable->usesEncodeIterator() && encodable->usesCodecIterator()) : encodable->isArray())
+        {
+            output += TAB_IN + "unsigned _pg_i = 0;\n";
+            break;
+        }
+    }
+
+    if(needs2ndEncodeIterator)
+        output += TAB_IN + "unsigned _pg_j = 0;\n";
+
+    int bitcount = 0;
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        output += "\n";
+
+        if(encodables.at(i)->isGather())
+            output += encodables.at(i)->getGatherEncodeString(true);
+        else
+            output += encodables.at(i)->getEncodeString(&bitcount, true);
+    }
+
+    ProtocolFile::makeLineSeparator(output);
+    output += TAB_IN + "// The packet data after the last field referenced in place are the last segment\n";
+    output += TAB_IN + "if(_pg_byteindex > _pg_start)\n";
+    output += TAB_IN + "{\n";
+    output += TAB_IN + TAB_IN + "_pg_segments[_pg_numsegments].data = _pg_data + _pg_start;\n";
+    output += TAB_IN + TAB_IN + "_pg_segments[_pg_numsegments++].size = _pg_byteindex - _pg_start;\n";
+    output += TAB_IN + "}\n";
+
+    std::string id;
+    if(ids.size() > 1)
+        id = "_pg_id";
+    else if(support->language == ProtocolSupport::c_language)
+        id = "get" + support->prefix + name + support->packetParameterSuffix + "ID()";
+    else
+        id = "id()";
+
+    ProtocolFile::makeLineSeparator(output);
+    output += TAB_IN + "// complete the process of creating the packet, the checksum covers all the segments\n";
+    output += TAB_IN + "_pg_numsegments = finish" + support->protoName + "PacketSegments(_pg_pkt, _pg_segments, _pg_numsegments, " + id + ");\n";
+    output += getStatsHook("ENCODED", "_pg_byteindex + _pg_gathered");
+
+    ProtocolFile::makeLineSeparator(output);
+    output += TAB_IN + "return _pg_numsegments;\n";
+
+    ProtocolFile::makeLineSeparator(output);
+    if(support->language == ProtocolSupport::c_language)
+        output += "}// encode" + support->prefix + name + support->packetStructureSuffix + "Gather\n";
+    else
+        output += "}// " + typeName + "::encodeGather\n";
+
+    return output;
+
+}// ProtocolPacket::getGatherEncodeBody
+
+
+/*!
+ * Determine if every field of this packet can be part of the stream functions,
+ * warning about the first one which cannot.
+ * \return true if the stream functions can be generated.
+ */
+bool ProtocolPacket::isStreamable(void) const
+{
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        const ProtocolField* field = dynamic_cast<const ProtocolField*>(encodables.at(i));
+
+        if((field == nullptr) || !field->isStreamable())
+        {
+            emitWarning("stream does not support structures, bitfields, strings, variable length integers, or delta or rle encoding, ignored", encodables.at(i)->name);
+            return false;
+        }
+    }
+
+    return true;
+
+}// ProtocolPacket::isStreamable
+
+
+/*!
+ * Get the signature of the packet structure stream encode function, without
+ * semicolon or comments or line feed, for the prototype or actual function.
+ * \param insource should be true to indicate this signature is in source code
+ *        (i.e. not a prototype) which determines if the "_pg_" decoration is
+ *        used as well as c++ access specifiers.
+ * \return the stream encode signature
+ */
+std::string ProtocolPacket::getStreamEncodeSignature(bool insource) const
+{
+    std::string output;
+    std::string pg;
+    std::string state = support->protoName + "Stream" + support->typeSuffix;
+
+    if(insource)
+        pg = "_pg_";
+
+    if(support->language == ProtocolSupport::c_language)
+        output = "int encode" + support->prefix + name + support->packetStructureSuffix + "Stream(uint8_t* " + pg + "chunk, int " + pg + "size, const " + structName + "* " + pg + "user, " + state + "* " + pg + "state)";
+    else
+    {
+        output += "int ";
+
+        // In the source the function needs the class scope
+        if(insource)
+            output += typeName + "::";
+
+        output += "encodeStream(uint8_t* " + pg + "chunk, int " + pg + "size, " + state + "* " + pg + "state) const";
+    }
+
+    return output;
+
+}// ProtocolPacket::getStreamEncodeSignature
+
+
+/*!
+ * Get the signature of the packet structure stream decode function, without
+ * semicolon or comments or line feed, for the prototype or actual function.
+ * \param insource should be true to indicate this signature is in source code
+ *        (i.e. not a prototype) which determines if the "_pg_" decoration is
+ *        used as well as c++ access specifiers.
+ * \return the stream decode signature
+ */
+std::string ProtocolPacket::getStreamDecodeSignature(bool insource) const
+{
+    std::string output;
+    std::string pg;
+    std::string state = support->protoName + "Stream" + support->typeSuffix;
+
+    if(insource)
+        pg = "_pg_";
+
+    if(support->language == ProtocolSupport::c_language)
+        output = "int decode" + support->prefix + name + support->packetStructureSuffix + "Stream(const uint8_t* " + pg + "chunk, int " + pg + "size, " + structName + "* " + pg + "user, " + state + "* " + pg + "state)";
+    else
+    {
+        output += "int ";
+
+        // In the source the function needs the class scope
+        if(insource)
+            output += typeName + "::";
+
+        output += "decodeStream(const uint8_t* " + pg + "chunk, int " + pg + "size, " + state + "* " + pg + "state)";
+    }
+
+    return output;
+
+}// ProtocolPacket::getStreamDecodeSignature
+
+
+/*!
+ * Get the prototypes for the stream encode and decode functions
+ * \param spacing is the offset for each line
+ * \return the prototypes including semicolon and line feeds
+ */
+std::string ProtocolPacket::getStreamPrototypes(const std::string& spacing) const
+{
+    std::string output;
+
+    if(encode)
+    {
+        output += spacing + "//! Encode the next bytes of the " + support->prefix + name + " packet data into a chunk\n";
+        output += spacing + getStreamEncodeSignature(false) + ";\n";
+    }
+
+    if(encode && decode)
+        output += "\n";
+
+    if(decode)
+    {
+        output += spacing + "//! Decode the next bytes of the " + support->prefix + name + " packet data from a chunk\n";
+        output += spacing + getStreamDecodeSignature(false) + ";\n";
+    }
+
+    return output;
+
+}// ProtocolPacket::getStreamPrototypes
+
+
+/*!
+ * Get the body for the stream encode function. The fields are encoded one
+ * element at a time into the state, and copied from there into the chunks,
+ * so an element can span two chunks.
+ * \return The body of the function that encodes this packet in chunks.
+ */
+std::string ProtocolPacket::getStreamEncodeBody(void) const
+{
+    std::string output;
+    bool usesi = false;
+    bool usesj = false;
+
+    if(!encode)
+        return output;
+
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        if(encodables.at(i)->isNotEncoded())
+            continue;
+
+        if(encodables.at(i)->isArray())
+            usesi = true;
+
+        if(encodables.at(i)->is2dArray())
+            usesj = true;
+    }
+
+    output += "/*!\n";
+    output += " * \\brief Encode the next bytes of the " + support->prefix + name + " packet data into a chunk\n";
+    output += " *\n";
+    output += " * The packet data are encoded one element at a time, so the packet can be larger\n";
+    output += " * than the working buffer. Start with a state that is all zero, and call again\n";
+    output += " * with each new chunk until the state is complete. Only the packet data are\n";
+    output += " * encoded, the packet header and any checksum belong to the caller.\n";
+    output += " * \\param _pg_chunk receives the next bytes of the packet data\n";
+    output += " * \\param _pg_size is the number of bytes available in _pg_chunk\n";
+    if(support->language == ProtocolSupport::c_language)
+        output += " * \\param _pg_user points to the user data, which must not change until the encode is complete\n";
+    output += " * \\param _pg_state holds the progress of the encode from one call to the next\n";
+    output += " * \\return the number of bytes written to _pg_chunk\n";
+    output += " */\n";
+    output += getStreamEncodeSignature(true) + "\n";
+    output += "{\n";
+    output += TAB_IN + "uint8_t* _pg_data = _pg_state->data;\n";
+    output += TAB_IN + "int _pg_byteindex = 0;\n";
+    output += TAB_IN + "int _pg_count = 0;\n";
+
+    if(usesi)
+        output += TAB_IN + "unsigned _pg_i = 0;\n";
+
+    if(usesj)
+        output += TAB_IN + "unsigned _pg_j = 0;\n";
+
+    output += "\n";
+    output += TAB_IN + "while(!_pg_state->complete)\n";
+    output += TAB_IN + "{\n";
+    output += TAB_IN + TAB_IN + "// Output the bytes of the last element, which may span chunks\n";
+    output += TAB_IN + TAB_IN + "if(_pg_state->index < _pg_state->length)\n";
+    output += TAB_IN + TAB_IN + "{\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "if(_pg_count >= _pg_size)\n";
+    output += TAB_IN + TAB_IN + TAB_IN + TAB_IN + "break;\n";
+    output += "\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "_pg_chunk[_pg_count++] = _pg_data[_pg_state->index++];\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "continue;\n";
+    output += TAB_IN + TAB_IN + "}\n";
+    output += "\n";
+
+    output += TAB_IN + TAB_IN + "// Encode the next element\n";
+    output += TAB_IN + TAB_IN + "_pg_byteindex = 0;\n";
+    if(usesi)
+        output += TAB_IN + TAB_IN + "_pg_i = _pg_state->i;\n";
+    if(usesj)
+        output += TAB_IN + TAB_IN + "_pg_j = _pg_state->j;\n";
+    output += "\n";
+    output += TAB_IN + TAB_IN + "switch(_pg_state->field)\n";
+    output += TAB_IN + TAB_IN + "{\n";
+
+    int index = 0;
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        const ProtocolField* field = dynamic_cast<const ProtocolField*>(encodables.at(i));
+
+        if((field == nullptr) || field->isNotEncoded())
+            continue;
+
+        output += TAB_IN + TAB_IN + "case " + std::to_string(index++) + ":\n";
+        output += field->getStreamEncodeString(TAB_IN + TAB_IN + TAB_IN, true);
+        output += TAB_IN + TAB_IN + TAB_IN + "break;\n";
+        output += "\n";
+    }
+
+    output += TAB_IN + TAB_IN + "default:\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "_pg_state->complete = 1;\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "break;\n";
+    output += TAB_IN + TAB_IN + "}\n";
+    output += "\n";
+    output += TAB_IN + TAB_IN + "_pg_state->index = 0;\n";
+    output += TAB_IN + TAB_IN + "_pg_state->length = _pg_byteindex;\n";
+    output += "\n";
+    output += TAB_IN + "}// while the encode is not complete\n";
+    output += "\n";
+    output += TAB_IN + "return _pg_count;\n";
+    output += "\n";
+
+    if(support->language == ProtocolSupport::c_language)
+        output += "}// encode" + support->prefix + name + support->packetStructureSuffix + "Stream\n";
+    else
+        output += "}// " + typeName + "::encodeStream\n";
+
+    return output;
+
+}// ProtocolPacket::getStreamEncodeBody
+
+
+/*!
+ * Get the body for the stream decode function. The bytes of each element are
+ * collected in the state until the element is complete, and then decoded, so
+ * an element can span two chunks.
+ * \return The body of the function that decodes this packet in chunks.
+ */
+std::string ProtocolPacket::getStreamDecodeBody(void) const
+{
+    std::string output;
+    bool usesi = false;
+    bool usesj = false;
+
+    if(!decode)
+        return output;
+
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        if(encodables.at(i)->isNotEncoded())
+            continue;
+
+        if(encodables.at(i)->isArray())
+            usesi = true;
+
+        if(encodables.at(i)->is2dArray())
+            usesj = true;
+    }
+
+    output += "/*!\n";
+    output += " * \\brief Decode the next bytes of the " + support->prefix + name + " packet data from a chunk\n";
+    output += " *\n";
+    output += " * The packet data are decoded one element at a time, so the packet can be larger\n";
+    output += " * than the working buffer. Start with a state that is all zero, and call again\n";
+    output += " * with each new chunk until the state is complete. Only the packet data are\n";
+    output += " * decoded, the packet header and any checksum belong to the caller.\n";
+    output += " * \\param _pg_chunk holds the next bytes of the packet data\n";
+    output += " * \\param _pg_size is the number of bytes in _pg_chunk\n";
+    if(support->language == ProtocolSupport::c_language)
+        output += " * \\param _pg_user receives the decoded data\n";
+    output += " * \\param _pg_state holds the progress of the decode from one call to the next\n";
+    output += " * \\return the number of bytes used from _pg_chunk, which is less than _pg_size\n";
+    output += " *         only if the decode is complete, or -1 if the data are not valid\n";
+    output += " */\n";
+    output += getStreamDecodeSignature(true) + "\n";
+    output += "{\n";
+    output += TAB_IN + "const uint8_t* _pg_data = _pg_state->data;\n";
+    output += TAB_IN + "int _pg_byteindex = 0;\n";
+    output += TAB_IN + "int _pg_count = 0;\n";
+
+    if(usesi)
+        output += TAB_IN + "unsigned _pg_i = 0;\n";
+
+    if(usesj)
+        output += TAB_IN + "unsigned _pg_j = 0;\n";
+
+    output += "\n";
+    output += TAB_IN + "while(!_pg_state->complete)\n";
+    output += TAB_IN + "{\n";
+    if(usesi)
+        output += TAB_IN + TAB_IN + "_pg_i = _pg_state->i;\n";
+    if(usesj)
+        output += TAB_IN + TAB_IN + "_pg_j = _pg_state->j;\n";
+    if(usesi || usesj)
+        output += "\n";
+    output += TAB_IN + TAB_IN + "if(_pg_state->length == 0)\n";
+    output += TAB_IN + TAB_IN + "{\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "// Find the length of the next element\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "switch(_pg_state->field)\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "{\n";
+
+    int index = 0;
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        const ProtocolField* field = dynamic_cast<const ProtocolField*>(encodables.at(i));
+
+        if((field == nullptr) || field->isNotEncoded())
+            continue;
+
+        output += TAB_IN + TAB_IN + TAB_IN + "case " + std::to_string(index++) + ":\n";
+        output += field->getStreamLengthString(TAB_IN + TAB_IN + TAB_IN + TAB_IN, true);
+        output += TAB_IN + TAB_IN + TAB_IN + TAB_IN + "break;\n";
+        output += "\n";
+    }
+
+    output += TAB_IN + TAB_IN + TAB_IN + "default:\n";
+    output += TAB_IN + TAB_IN + TAB_IN + TAB_IN + "_pg_state->complete = 1;\n";
+    output += TAB_IN + TAB_IN + TAB_IN + TAB_IN + "break;\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "}\n";
+    output += TAB_IN + TAB_IN + "}\n";
+    output += TAB_IN + TAB_IN + "else if(_pg_state->index < _pg_state->length)\n";
+    output += TAB_IN + TAB_IN + "{\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "// Collect the bytes of the element, which may span chunks\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "if(_pg_count >= _pg_size)\n";
+    output += TAB_IN + TAB_IN + TAB_IN + TAB_IN + "break;\n";
+    output += "\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "_pg_state->data[_pg_state->index++] = _pg_chunk[_pg_count++];\n";
+    output += TAB_IN + TAB_IN + "}\n";
+    output += TAB_IN + TAB_IN + "else\n";
+    output += TAB_IN + TAB_IN + "{\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "// Decode the complete element\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "_pg_byteindex = 0;\n";
+    output += "\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "switch(_pg_state->field)\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "{\n";
+
+    index = 0;
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        const ProtocolField* field = dynamic_cast<const ProtocolField*>(encodables.at(i));
+
+        if((field == nullptr) || field->isNotEncoded())
+            continue;
+
+        output += TAB_IN + TAB_IN + TAB_IN + "case " + std::to_string(index++) + ":\n";
+        output += field->getStreamDecodeString(TAB_IN + TAB_IN + TAB_IN + TAB_IN, true);
+        output += TAB_IN + TAB_IN + TAB_IN + TAB_IN + "break;\n";
+        output += "\n";
+    }
+
+    output += TAB_IN + TAB_IN + TAB_IN + "default:\n";
+    output += TAB_IN + TAB_IN + TAB_IN + TAB_IN + "break;\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "}\n";
+    output += "\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "_pg_state->index = 0;\n";
+    output += TAB_IN + TAB_IN + TAB_IN + "_pg_state->length = 0;\n";
+    output += TAB_IN + TAB_IN + "}\n";
+    output += "\n";
+    output += TAB_IN + "}// while the decode is not complete\n";
+    output += "\n";
+    output += TAB_IN + "return _pg_count;\n";
+    output += "\n";
+
+    if(support->language == ProtocolSupport::c_language)
+        output += "}// decode" + support->prefix + name + support->packetStructureSuffix + "Stream\n";
+    else
+        output += "}// " + typeName + "::decodeStream\n";
+
+    return output;
+
+}// ProtocolPacket::getStreamDecodeBody
+
+
+/*!
+ * Create the functions for encoding and decoding the packet to/from parameters
+ */
+void ProtocolPacket::createPacketFunctions(void)
+{
+    // The prototypes in the header file are only needed for C,
+    // in C++ these prototypes are part of the class declaration.
+    if(support->language == ProtocolSupport::c_language)
+    {
+        if(encode)
+        {
+            // The prototype for the packet encode function
+            header.makeLineSeparator();
+            header.write(getParameterPacketEncodePrototype(std::string()));
+        }
+
+        if(decode)
+        {
+            // The prototype for the packet decode function
+            header.makeLineSeparator();
+            header.write(getParameterPacketDecodePrototype(std::string()));
+        }
+    }
+
+    if(encode)
+    {
+        source.makeLineSeparator();
+        source.write(getParameterPacketEncodeBody());
+    }
+
+    if(decode)
+    {
+        source.makeLineSeparator();
+        source.write(getParameterPacketDecodeBody());
+
+    }// if decode function enabled
+
+}// createPacketFunctions
+
+
+/*!
+ * Get the signature of the packet encode function, without semicolon or
+ * comments or line feed, for the prototype or actual function.
+ * \param insource should be true to indicate this signature is in source code
+ *        (i.e. not a prototype) which determines if the "_pg_" decoration is
+ *        used as well as c++ access specifiers.
+ * \return the encode signature
+ */
+std::string ProtocolPacket::getParameterPacketEncodeSignature(bool insource) const
+{
+    std::string output;
+    std::string pg;
+
+    if(insource)
+        pg = "_pg_";
+
+    if(support->language == ProtocolSupport::c_language)
+    {
+        output = "void encode" + support->prefix + name + support->packetParameterSuffix + "(" + support->pointerType + " " + pg + "pkt";
+    }
+    else
+    {
+        // C++ class member, this function should be "static" as it does not depend on any variables in the class
+        if(!insource)
+            output += "static ";
+
+        output += "void ";
+
+        // In the source the function needs the class scope
+        if(insource)
+            output += typeName + "::";
+
+        output += "encode(" + support->pointerType + " " + pg + "pkt";
+    }
+
+    output += getDataEncodeParameterList();
+
+    if(ids.size() <= 1)
+        output += ")";
+    else
+        output += ", uint32_t " + pg + "id)";
+
+    return output;
+}
+
+
+/*!
+ * Get the prototype for the parameter packet encode function
+ * \param spacing is the offset for each line
+ * \return the prototype including semicolon and line fees
+ */
+std::string ProtocolPacket::getParameterPacketEncodePrototype(const std::string& spacing) const
+{
+    std::string output;
+
+    if(!encode)
+        return output;
+
+    output += spacing + "//! " + getDataEncodeBriefComment() + "\n";
+    output += spacing + getParameterPacketEncodeSignature(false) + ";\n";
+
+    return output;
+}
+
+
+//! Get the prototype for the parameter packet encode function
+std::string ProtocolPacket::getParameterPacketEncodeBody(void) const
+{
+    std::string output;
+
+    std::size_t i;
+    int bitcount = 0;
+
+    if(!encode)
+        return output;
+
+    // The string that gets the identifier for the packet
+    std::string id;
+    if(ids.size() > 1)
+        id = "_pg_id";
+    else if(support->language == ProtocolSupport::c_language)
+        id = "get" + support->prefix + name + support->packetParameterSuffix + "ID()";
+    else
+        id = "id()";
+
+    output += "/*!\n";
+    output += " * \\brief " + getPacketEncodeBriefComment() + "\n";
+    output += " *\n";
+    output += ProtocolParser::outputLongComment(" * ", comment) + "\n";
+    output += " * \\param _pg_pkt points to the packet which will be created by this function\n";
+    for(i = 0; i < encodables.size(); i++)
+        output += encodables.at(i)->getEncodeParameterComment();
+
+    if(ids.size() > 1)
+        output += " * \\param id is the packet identifier for _pg_pkt\n";
+
+    output += " */\n";
+    output += getParameterPacketEncodeSignature(true) + "\n";
+    output += "{\n";
+
+    if(!encodedLength.isZeroLength())
+    {
+        output += TAB_IN + "uint8_t* _pg_data = get"+ support->protoName + "PacketData(_pg_pkt);\n";
+        output += TAB_IN + "int _pg_byteindex = 0;\n";
+
+        if(usestempencodebitfields)
+            output += TAB_IN + "unsigned int _pg_tempbitfield = 0;\n";
+
+        if(usestempencodelongbitfields)
+            output += TAB_IN + "uint64_t _pg_templongbitfield = 0;\n";
+
+        if(numbitfieldgroupbytes > 0)
+        {
+            output += TAB_IN + "int _pg_bitfieldindex = 0;\n";
+            output += TAB_IN + "uint8_t _pg_bitfieldbytes[" + std::to_string(numbitfieldgroupbytes) + "];\n";
+        }
+
+        if(needsCodecEncodeIterator)
+            output += TAB_IN + "unsigned _pg_i = 0;\n";
+
+        if(needs2ndEncodeIterator)
+            output += TAB_IN + "unsigned _pg_j = 0;\n";
 
         // Keep our own track of the bitcount so we know what to do when we close the bitfield
         for(i = 0; i < encodables.size(); i++)
@@ -1493,18 +2881,20 @@ std::string ProtocolPacket::getParameterPacketEncodeBody(void) const
 
         ProtocolFile::makeLineSeparator(output);
         output += TAB_IN + "// complete the process of creating the packet\n";
-        output += TAB_IN + "finish" + support.protoName + "Packet(_pg_pkt, _pg_byteindex, " + id + ");\n";
+        output += TAB_IN + "finish" + support->protoName + "Packet(_pg_pkt, _pg_byteindex, " + id + ");\n";
+        output += getStatsHook("ENCODED", "_pg_byteindex");
     }
     else
     {
         ProtocolFile::makeLineSeparator(output);
         output += TAB_IN + "// Zero length packet, no data encoded\n";
-        output += TAB_IN + "finish" + support.protoName + "Packet(_pg_pkt, 0, " + id + ");\n";
+        output += TAB_IN + "finish" + support->protoName + "Packet(_pg_pkt, 0, " + id + ");\n";
+        output += getStatsHook("ENCODED", "0");
     }
 
     ProtocolFile::makeLineSeparator(output);
-    if(support.language == ProtocolSupport::c_language)
-        output += "}// encode" + support.prefix + name + support.packetParameterSuffix + "\n";
+    if(support->language == ProtocolSupport::c_language)
+        output += "}// encode" + support->prefix + name + support->packetParameterSuffix + "\n";
     else
         output += "}// " + typeName + "::encode\n";
 
@@ -1529,9 +2919,9 @@ std::string ProtocolPacket::getParameterPacketDecodeSignature(bool insource) con
     if(insource)
         pg = "_pg_";
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
-        output = "int decode" + support.prefix + name + support.packetParameterSuffix + "(const " + support.pointerType + " " + pg + "pkt";
+        output = "int decode" + support->prefix + name + support->packetParameterSuffix + "(const " + support->pointerType + " " + pg + "pkt";
     }
     else
     {
@@ -1545,7 +2935,7 @@ std::string ProtocolPacket::getParameterPacketDecodeSignature(bool insource) con
         if(insource)
             output += typeName + "::";
 
-        output += "decode(const " + support.pointerType + " " + pg + "pkt";
+        output += "decode(const " + support->pointerType + " " + pg + "pkt";
     }
 
     output += getDataDecodeParameterList() + ")";
@@ -1589,8 +2979,8 @@ std::string ProtocolPacket::getParameterPacketDecodeBody(void) const
     std::string id;
     if(ids.size() <= 1)
     {
-        if(support.language == ProtocolSupport::c_language)
-            id = "get" + support.prefix + name + support.packetParameterSuffix + "ID()";
+        if(support->language == ProtocolSupport::c_language)
+            id = "get" + support->prefix + name + support->packetParameterSuffix + "ID()";
         else
             id = "id()";
     }
@@ -1603,7 +2993,7 @@ std::string ProtocolPacket::getParameterPacketDecodeBody(void) const
     for(i = 0; i < encodables.size(); i++)
         output += encodables.at(i)->getDecodeParameterComment();
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += " * \\return 0 is returned if the packet ID or size is wrong, else 1\n";
     else
         output += " * \\return false is returned if the packet ID or size is wrong, else true\n";
@@ -1626,24 +3016,24 @@ std::string ProtocolPacket::getParameterPacketDecodeBody(void) const
             output += TAB_IN + "uint8_t _pg_bitfieldbytes[" + std::to_string(numbitfieldgroupbytes) + "];\n";
         }
 
-        if(needsDecodeIterator)
+        if(needsCodecDecodeIterator)
             output += TAB_IN + "unsigned _pg_i = 0;\n";
         if(needs2ndDecodeIterator)
             output += TAB_IN + "unsigned _pg_j = 0;\n";
         output += TAB_IN + "int _pg_byteindex = 0;\n";
-        output += TAB_IN + "const uint8_t* _pg_data = get" + support.protoName + "PacketDataConst(_pg_pkt);\n";
-        output += TAB_IN + "int _pg_numbytes = get" + support.protoName + "PacketSize(_pg_pkt);\n";
+        output += TAB_IN + "const uint8_t* _pg_data = get" + support->protoName + "PacketDataConst(_pg_pkt);\n";
+        output += TAB_IN + "int _pg_numbytes = get" + support->protoName + "PacketSize(_pg_pkt);\n";
         output += "\n";
 
         if(ids.size() <= 1)
         {
             output += TAB_IN + "// Verify the packet identifier\n";
-            output += TAB_IN + "if(get"+ support.protoName + "PacketID(_pg_pkt) != " + id + ")\n";
+            output += TAB_IN + "if(get"+ support->protoName + "PacketID(_pg_pkt) != " + id + ")\n";
         }
         else
         {
             output += TAB_IN + "// Verify the packet identifier, multiple options exist\n";
-            output += TAB_IN + "uint32_t packetid = get"+ support.protoName + "PacketID(_pg_pkt);\n";
+            output += TAB_IN + "uint32_t packetid = get"+ support->protoName + "PacketID(_pg_pkt);\n";
             output += TAB_IN + "if( packetid != " + ids.at(0);
             for(i = 1; i < ids.size(); i++)
                 output += " &&\n        packetid != " + ids.at(i);
@@ -1652,11 +3042,12 @@ std::string ProtocolPacket::getParameterPacketDecodeBody(void) const
         output += TAB_IN + TAB_IN + "return 0;\n";
 
         output += "\n";
-        if(support.language == ProtocolSupport::c_language)
-            output += TAB_IN + "if(_pg_numbytes < get" + support.prefix + name + "MinDataLength())\n";
+        output += getStatsHook("DECODE_BEGIN", std::string());
+        if(support->language == ProtocolSupport::c_language)
+            output += TAB_IN + "if(_pg_numbytes < get" + support->prefix + name + "MinDataLength())\n";
         else
             output += TAB_IN + "if(_pg_numbytes < minLength())\n";
-        output += TAB_IN + TAB_IN + "return 0;\n";
+        output += TAB_IN + TAB_IN + "return " + getDecodeFailedReturn("tooShort", "0") + ";\n";
         if(defaults)
         {
             output += "\n";
@@ -1677,7 +3068,7 @@ std::string ProtocolPacket::getParameterPacketDecodeBody(void) const
             if(encodables[i]->isDefault())
                 break;
 
-            output += encodables[i]->getDecodeString(&bitcount, false, true);
+            output += countDecodeReturns(encodables[i]->getDecodeString(&bitcount, false, true));
         }
 
         // Before we write out the decodes for default fields we need to check
@@ -1688,18 +3079,18 @@ std::string ProtocolPacket::getParameterPacketDecodeBody(void) const
             ProtocolFile::makeLineSeparator(output);
             output += TAB_IN + "// Used variable length arrays or dependent fields, check actual length\n";
             output += TAB_IN + "if(_pg_numbytes < _pg_byteindex)\n";
-            output += TAB_IN + TAB_IN + "return " + getReturnCode(false) + ";\n";
+            output += TAB_IN + TAB_IN + "return " + getDecodeFailedReturn("tooShort", getReturnCode(false)) + ";\n";
         }
 
         // Now finish the fields (if any defaults)
         for(; i < encodables.size(); i++)
         {
             ProtocolFile::makeLineSeparator(output);
-            output += encodables[i]->getDecodeString(&bitcount, false, true);
+            output += countDecodeReturns(encodables[i]->getDecodeString(&bitcount, false, true));
         }
 
         ProtocolFile::makeLineSeparator(output);
-        output += TAB_IN + "return 1;\n";
+        output += TAB_IN + "return " + getDecodePassedReturn("_pg_numbytes", "1") + ";\n";
 
     }// if some fields to decode
     else
@@ -1707,12 +3098,12 @@ std::string ProtocolPacket::getParameterPacketDecodeBody(void) const
         if(ids.size() <= 1)
         {
             output += TAB_IN + "// Verify the packet identifier\n";
-            output += TAB_IN + "if(get"+ support.protoName + "PacketID(_pg_pkt) != " + id + ")\n";
+            output += TAB_IN + "if(get"+ support->protoName + "PacketID(_pg_pkt) != " + id + ")\n";
         }
         else
         {
             output += TAB_IN + "// Verify the packet identifier, multiple options exist\n";
-            output += TAB_IN + "uint32_t packetid = get"+ support.protoName + "PacketID(_pg_pkt);\n";
+            output += TAB_IN + "uint32_t packetid = get"+ support->protoName + "PacketID(_pg_pkt);\n";
             output += TAB_IN + "if( packetid != " + ids.at(0);
             for(i = 1; i < ids.size(); i++)
                 output += " &&\n        packetid != " + ids.at(i);
@@ -1725,8 +3116,8 @@ std::string ProtocolPacket::getParameterPacketDecodeBody(void) const
     }// If no fields to decode
 
     ProtocolFile::makeLineSeparator(output);
-    if(support.language == ProtocolSupport::c_language)
-        output += "}// decode" + support.prefix + name + support.packetParameterSuffix + "\n";
+    if(support->language == ProtocolSupport::c_language)
+        output += "}// decode" + support->prefix + name + support->packetParameterSuffix + "\n";
     else
         output += "}// " + typeName + "::decode\n";
 
@@ -1740,7 +3131,7 @@ std::string ProtocolPacket::getParameterPacketDecodeBody(void) const
  */
 std::string ProtocolPacket::getPacketEncodeBriefComment(void) const
 {
-    return std::string("Create the " + support.prefix + name + " packet");
+    return std::string("Create the " + support->prefix + name + " packet");
 }
 
 
@@ -1749,7 +3140,7 @@ std::string ProtocolPacket::getPacketEncodeBriefComment(void) const
  */
 std::string ProtocolPacket::getPacketDecodeBriefComment(void) const
 {
-    return std::string("Decode the " + support.prefix + name + " packet");
+    return std::string("Decode the " + support->prefix + name + " packet");
 }
 
 
@@ -1786,7 +3177,7 @@ std::string ProtocolPacket::getDataDecodeParameterList(void) const
  */
 std::string ProtocolPacket::getDataEncodeBriefComment(void) const
 {
-    return std::string("Create the " + support.prefix + name + " packet from parameters");
+    return std::string("Create the " + support->prefix + name + " packet from parameters");
 }
 
 
@@ -1795,7 +3186,308 @@ std::string ProtocolPacket::getDataEncodeBriefComment(void) const
  */
 std::string ProtocolPacket::getDataDecodeBriefComment(void) const
 {
-    return std::string("Decode the " + support.prefix + name + " packet to parameters");
+    return std::string("Decode the " + support->prefix + name + " packet to parameters");
+}
+
+
+/*!
+ * Get the function that benchmarks the encode and decode of this packet. The
+ * packet is filled with random data, and then decoded and re-encoded, which
+ * puts every field within its encoded range. The benchmark uses the packet
+ * interface functions provided by the user.
+ * \return the benchmark function, or an empty string if this packet cannot
+ *         be benchmarked because it does not have structure functions which
+ *         encode and decode, or does not have an identifier.
+ */
+std::string ProtocolPacket::getBenchmarkFunction(void) const
+{
+    if(!structureFunctions || !encode || !decode || ids.empty() || encodedLength.maxEncodedLength.empty())
+        return std::string();
+
+    if((getNumberOfEncodeParameters() <= 0) || (getNumberOfDecodeParameters() <= 0))
+        return std::string();
+
+    // No code was output
+    if(isHidden() && !neverOmit && support->omitIfHidden)
+        return std::string();
+
+    // The packet is declared on the stack, so we need the type it points to
+    std::string packettype = trimm(support->pointerType);
+    if(packettype.empty() || (packettype.back() != '*'))
+        return std::string();
+
+    packettype = trimm(packettype.substr(0, packettype.size() - 1));
+    if(packettype.empty() || (packettype == "void"))
+        return std::string();
+
+    // The largest packet possible is encoded, which the packet data might not
+    // hold if it is larger than the maximum data size
+    if(support->maxdatasize > 0)
+    {
+        int maxdatasize = (int)(ShuntingYard::computeInfix(parser->replaceEnumerationNameWithValue(encodedLength.maxEncodedLength)) + 0.5);
+        if(maxdatasize > support->maxdatasize)
+            return std::string();
+    }
+
+    std::string id;
+    if(ids.size() > 1)
+        id = ", " + ids.at(0);
+
+    // Encode the largest packet possible
+    std::string length;
+    if(support->language == ProtocolSupport::c_language)
+        length = "get" + support->prefix + name + "MaxDataLength()";
+    else
+        length = typeName + "::maxLength()";
+
+    std::string declarations, prepare, encodeloop, decodeloop;
+
+    if(support->language == ProtocolSupport::c_language)
+    {
+        declarations += TAB_IN + packettype + " pkt;\n";
+        declarations += TAB_IN + structName + " user;\n";
+
+        prepare += TAB_IN + "memset(&pkt, 0, sizeof(pkt));\n";
+        prepare += TAB_IN + "memset(&user, 0, sizeof(user));\n";
+    }
+    else
+    {
+        declarations += TAB_IN + packettype + " pkt{};\n";
+        declarations += TAB_IN + typeName + " user;\n";
+    }
+
+    prepare += TAB_IN + "bytes = " + length + ";\n";
+    prepare += "\n";
+    prepare += TAB_IN + "// Decoding random data puts every field within its encoded range\n";
+    prepare += TAB_IN + "_pg_fillRandom(get" + support->protoName + "PacketData(&pkt), bytes, seed);\n";
+    prepare += TAB_IN + "finish" + support->protoName + "Packet(&pkt, bytes, " + ids.at(0) + ");\n";
+
+    if(support->language == ProtocolSupport::c_language)
+    {
+        prepare += TAB_IN + "decode" + support->prefix + name + support->packetStructureSuffix + "(&pkt, &user);\n";
+        prepare += TAB_IN + "encode" + support->prefix + name + support->packetStructureSuffix + "(&pkt, &user" + id + ");\n";
+
+        encodeloop += TAB_IN + TAB_IN + "encode" + support->prefix + name + support->packetStructureSuffix + "(&pkt, &user" + id + ");\n";
+
+        decodeloop += TAB_IN + TAB_IN + "if(!decode" + support->prefix + name + support->packetStructureSuffix + "(&pkt, &user))\n";
+        decodeloop += TAB_IN + TAB_IN + TAB_IN + "failures++;\n";
+    }
+    else
+    {
+        prepare += TAB_IN + "user.decode(&pkt);\n";
+        prepare += TAB_IN + "user.encode(&pkt" + id + ");\n";
+
+        encodeloop += TAB_IN + TAB_IN + "user.encode(&pkt" + id + ");\n";
+
+        decodeloop += TAB_IN + TAB_IN + "if(!user.decode(&pkt))\n";
+        decodeloop += TAB_IN + TAB_IN + TAB_IN + "failures++;\n";
+    }
+
+    prepare += TAB_IN + "bytes = get" + support->protoName + "PacketSize(&pkt);\n";
+
+    return ProtocolStructureModule::getBenchmarkFunction(declarations, prepare, encodeloop, decodeloop, std::string());
+
+}// ProtocolPacket::getBenchmarkFunction
+
+
+/*!
+ * Get the include directives needed to reference the identifiers of this packet
+ * \param list is appended with any include directives.
+ */
+void ProtocolPacket::getIdIncludeDirectives(std::vector<std::string>& list) const
+{
+    for(std::size_t i = 0; i < ids.size(); i++)
+    {
+        // The ID may be a value defined somewhere else
+        std::string include = parser->lookUpIncludeFilenameForDefinition(ids.at(i));
+        if(!include.empty())
+            list.push_back(include);
+    }
+
+}// ProtocolPacket::getIdIncludeDirectives
+
+
+/*!
+ * Get the handler and the switch case which decode this packet from a batch,
+ * using the packet structure decode function. The case is only output for
+ * packets which have structure functions and which can be decoded.
+ * \param values are the values of the identifiers of the cases which have
+ *        already been output, and are appended with the identifiers of this
+ *        packet. Identifiers which are already in the list are skipped, so
+ *        the switch has no duplicate cases.
+ * \param handler receives the declaration of the handler of this packet.
+ * \param cases receives the case labels and the code which decodes this
+ *        packet and gives it to the handler.
+ * \return true if this packet can be decoded from a batch.
+ */
+bool ProtocolPacket::getBatchDecoder(std::vector<std::string>& values, std::string& handler, std::string& cases) const
+{
+    if(!structureFunctions || !decode || ids.empty() || (getNumberOfDecodeParameters() <= 0))
+        return false;
+
+    // No code was output
+    if(isHidden() && !neverOmit && support->omitIfHidden)
+        return false;
+
+    std::string labels;
+    for(const std::string& id : ids)
+    {
+        // Compare the values, since different names can have the same value
+        bool ok = false;
+        std::string value = id;
+        double number = ShuntingYard::computeInfix(parser->replaceEnumerationNameWithValue(id), &ok);
+        if(ok)
+            value = std::to_string((long long)number);
+
+        if(std::find(values.begin(), values.end(), value) != values.end())
+            continue;
+
+        values.push_back(value);
+        labels += TAB_IN + "case " + id + ":\n";
+    }
+
+    if(labels.empty())
+        return false;
+
+    std::string member = "handle" + name;
+
+    if(support->language == ProtocolSupport::c_language)
+    {
+        handler  = TAB_IN + "//! Receives the decoded " + name + " packets, can be NULL\n";
+        handler += TAB_IN + "void (*" + member + ")(const " + structName + "* user, void* context);\n";
+
+        cases  = labels;
+        cases += TAB_IN + TAB_IN + "if(batch->decoders->" + member + " != NULL)\n";
+        cases += TAB_IN + TAB_IN + "{\n";
+        cases += TAB_IN + TAB_IN + TAB_IN + structName + " user;\n";
+        cases += "\n";
+        cases += TAB_IN + TAB_IN + TAB_IN + "memset(&user, 0, sizeof(user));\n";
+        cases += TAB_IN + TAB_IN + TAB_IN + "if(decode" + support->prefix + name + support->packetStructureSuffix + "(&pkt, &user))\n";
+    }
+    else
+    {
+        handler  = TAB_IN + "//! Receives the decoded " + name + " packets, can be NULL\n";
+        handler += TAB_IN + "void (*" + member + ")(const " + typeName + "* user, void* context);\n";
+
+        cases  = labels;
+        cases += TAB_IN + TAB_IN + "if(batch->decoders->" + member + " != NULL)\n";
+        cases += TAB_IN + TAB_IN + "{\n";
+        cases += TAB_IN + TAB_IN + TAB_IN + typeName + " user;\n";
+        cases += "\n";
+        cases += TAB_IN + TAB_IN + TAB_IN + "if(user.decode(&pkt))\n";
+    }
+
+    cases += TAB_IN + TAB_IN + TAB_IN + "{\n";
+    cases += TAB_IN + TAB_IN + TAB_IN + TAB_IN + "batch->decoders->" + member + "(&user, batch->context);\n";
+    cases += TAB_IN + TAB_IN + TAB_IN + TAB_IN + "return;\n";
+    cases += TAB_IN + TAB_IN + TAB_IN + "}\n";
+    cases += TAB_IN + TAB_IN + "}\n";
+    cases += TAB_IN + TAB_IN + "break;\n";
+
+    return true;
+
+}// ProtocolPacket::getBatchDecoder
+
+
+/*!
+ * Get the code that updates the runtime counters of this packet. The hooks
+ * are macros defined in the packet statistics module.
+ * \param hook is the name of the hook macro, without the protocol prefix.
+ * \param arguments are any arguments of the hook after the packet index.
+ * \return the line of code that calls the hook, which is empty if runtime
+ *         counters are not enabled.
+ */
+std::string ProtocolPacket::getStatsHook(const std::string& hook, const std::string& arguments) const
+{
+    if(!support->packetStats)
+        return std::string();
+
+    if(arguments.empty())
+        return TAB_IN + toUpper(support->protoName) + "_" + hook + "(" + std::to_string(statsIndex) + ");\n";
+    else
+        return TAB_IN + toUpper(support->protoName) + "_" + hook + "(" + std::to_string(statsIndex) + ", " + arguments + ");\n";
+
+}// ProtocolPacket::getStatsHook
+
+
+/*!
+ * Get the return value of a decode that failed
+ * \param reason is the counter in the statistics table that is incremented.
+ * \param code is the value that is returned.
+ * \return the return value, which updates the runtime counters if they are enabled.
+ */
+std::string ProtocolPacket::getDecodeFailedReturn(const std::string& reason, const std::string& code) const
+{
+    if(!support->packetStats)
+        return code;
+
+    return toUpper(support->protoName) + "_DECODE_FAILED(" + std::to_string(statsIndex) + ", " + reason + ", " + code + ")";
+
+}// ProtocolPacket::getDecodeFailedReturn
+
+
+/*!
+ * Get the return value of a decode that passed
+ * \param bytes is the number of bytes that were decoded.
+ * \param code is the value that is returned.
+ * \return the return value, which updates the runtime counters if they are enabled.
+ */
+std::string ProtocolPacket::getDecodePassedReturn(const std::string& bytes, const std::string& code) const
+{
+    if(!support->packetStats)
+        return code;
+
+    return toUpper(support->protoName) + "_DECODE_PASSED(" + std::to_string(statsIndex) + ", " + bytes + ", " + code + ")";
+
+}// ProtocolPacket::getDecodePassedReturn
+
+
+/*!
+ * Change the returns in the decode code of a field of this packet so they
+ * update the runtime counters. Fields fail to decode if a constant value
+ * does not match, or if a child structure fails to decode. Fields with a
+ * default value end the decode successfully if the packet is too short to
+ * hold them, and fail as too short if their variable length integer runs
+ * past the end of the packet.
+ * \param code is the decode code of the field.
+ * \return the code, with returns changed if runtime counters are enabled.
+ */
+std::string ProtocolPacket::countDecodeReturns(std::string code) const
+{
+    if(!support->packetStats)
+        return code;
+
+    std::string failure = "return " + getReturnCode(false) + ";";
+
+    // A variable length integer of a default field that ran past the end of
+    // the packet is checked after it is decoded, the packet is too short
+    std::string overrun = "if(_pg_byteindex > _pg_numbytes)\n";
+    for(std::size_t index = code.find(overrun); index != std::string::npos; index = code.find(overrun, index + 1))
+    {
+        std::size_t end = code.find(failure, index);
+        if(end != std::string::npos)
+            code.replace(end, failure.size(), "return " + getDecodeFailedReturn("tooShort", getReturnCode(false)) + ";");
+    }
+
+    replaceinplace(code, failure, "return " + getDecodeFailedReturn("invalid", getReturnCode(false)) + ";");
+
+    // Default strings return 1 in either language
+    std::string passed = "return " + getDecodePassedReturn("_pg_numbytes", getReturnCode(true)) + ";";
+    replaceinplace(code, "return " + getReturnCode(true) + ";", passed);
+    replaceinplace(code, "return 1;", passed);
+
+    return code;
+
+}// ProtocolPacket::countDecodeReturns
+
+
+/*!
+ * Get the code that counts verifies which had to change data
+ * \return the line of code, which is empty if runtime counters are not enabled.
+ */
+std::string ProtocolPacket::getVerifyCompletionString(void) const
+{
+    return getStatsHook("VERIFIED", "_pg_good");
 }
 
 
@@ -10,7 +10,7 @@ class ProtocolPacket : public ProtocolStructureModule
 {
 public:
     //! Construct the packet parsing object, with details about the overall protocol
-    ProtocolPacket(ProtocolParser* parse, ProtocolSupport supported);
+    ProtocolPacket(ProtocolParser* parse, SharedSupport supported);
 
     ~ProtocolPacket();
 
@@ -35,11 +35,20 @@ public:
     //! Get the string which comments this encodables enumerations in a CAN DBC file
     std::string getDBCMessageEnum(uint32_t baseid, uint8_t typeshift) const;
 
+    //! Get the rate of this packet in packets per second, which may be empty
+    const std::string& getRate(void) const {return rate;}
+
     //! Get all the ID strings of this packet
     void appendIds(std::vector<std::string>& list) const {list.insert(list.end(), ids.begin(), ids.end());}
 
     //! Return the extended packet name
-    std::string extendedName() const { return support.prefix + this->name + support.packetStructureSuffix; }
+    std::string extendedName() const { return support->prefix + this->name + support->packetStructureSuffix; }
+
+    //! Return the flag indicating if this packet has a gather encode function
+    bool usesGather(void) const {return gather;}
+
+    //! Return the flag indicating if this packet has stream encode and decode functions
+    bool usesStream(void) const {return stream;}
 
     //! Return the flag indicating if this packet has DBC transmit turned on
     bool dbctx(void) const {return dbctxon;}
@@ -47,6 +56,15 @@ public:
     //! Return the flag indicating if this packet has DBC receive turned on
     bool dbcrx(void) const {return dbcrxon;}
 
+    //! Get the function that benchmarks the encode and decode of this packet
+    std::string getBenchmarkFunction(void) const override;
+
+    //! Get the include directives needed to reference the identifiers of this packet
+    void getIdIncludeDirectives(std::vector<std::string>& list) const;
+
+    //! Get the handler and the switch case which decode this packet from a batch
+    bool getBatchDecoder(std::vector<std::string>& values, std::string& handler, std::string& cases) const;
+
 protected:
 
     //! Get the class declaration, for this packet only (not its children) for the C++ language
@@ -85,6 +103,69 @@ protected:
     //! Get the prototype for the structure packet decode function
     std::string getStructurePacketDecodeBody(void) const;
 
+    //! True if this encodable has a presence bit in the diff encoding
+    bool isDiffField(const Encodable* encodable) const;
+
+    //! True if this encodable is left out of the diff encoding
+    bool isDiffOmitted(const Encodable* encodable) const;
+
+    //! Get the number of encodables that have a presence bit in the diff encoding
+    int getNumberOfDiffFields(void) const;
+
+    //! Get the signature of the packet structure diff encode function
+    std::string getDiffEncodeSignature(bool insource) const;
+
+    //! Get the signature of the packet structure diff decode function
+    std::string getDiffDecodeSignature(bool insource) const;
+
+    //! Get the prototypes for the diff encode and decode functions
+    std::string getDiffPrototypes(const std::string& spacing) const;
+
+    //! Get the body for the diff encode function
+    std::string getDiffEncodeBody(void) const;
+
+    //! Get the body for the diff decode function
+    std::string getDiffDecodeBody(void) const;
+
+    //! Get the minimum number of bytes that must remain before an encodable is decoded by the diff decode
+    std::string getDiffMinimumLength(const Encodable* encodable, int bitcount) const;
+
+    //! Get the statement which restores the retained data and returns failure from the diff decode
+    std::string getDiffFailedReturn(const std::string& reason) const;
+
+    //! Change the failure returns of a field decode so they restore the retained data of the diff decode
+    std::string restoreDiffReturns(std::string code) const;
+
+    //! Get the number of segments the gather encode function can produce
+    int getNumberOfGatherSegments(void) const;
+
+    //! Get the signature of the packet structure gather encode function
+    std::string getGatherEncodeSignature(bool insource) const;
+
+    //! Get the prototype for the gather encode function
+    std::string getGatherEncodePrototype(const std::string& spacing) const;
+
+    //! Get the body for the gather encode function
+    std::string getGatherEncodeBody(void) const;
+
+    //! Determine if every field of this packet can be part of the stream functions
+    bool isStreamable(void) const;
+
+    //! Get the signature of the packet structure stream encode function
+    std::string getStreamEncodeSignature(bool insource) const;
+
+    //! Get the signature of the packet structure stream decode function
+    std::string getStreamDecodeSignature(bool insource) const;
+
+    //! Get the prototypes for the stream encode and decode functions
+    std::string getStreamPrototypes(const std::string& spacing) const;
+
+    //! Get the body for the stream encode function
+    std::string getStreamEncodeBody(void) const;
+
+    //! Get the body for the stream decode function
+    std::string getStreamDecodeBody(void) const;
+
     //! Get the packet encode signature
     std::string getParameterPacketEncodeSignature(bool insource) const;
 
@@ -121,6 +202,21 @@ protected:
     //! Get the structure decode comment
     std::string getDataDecodeBriefComment(void) const;
 
+    //! Get the code that updates the runtime counters of this packet
+    std::string getStatsHook(const std::string& hook, const std::string& arguments) const;
+
+    //! Get the return value of a decode that failed, which updates the runtime counters
+    std::string getDecodeFailedReturn(const std::string& reason, const std::string& code) const;
+
+    //! Get the return value of a decode that passed, which updates the runtime counters
+    std::string getDecodePassedReturn(const std::string& bytes, const std::string& code) const;
+
+    //! Change the returns in decode code to update the runtime counters
+    std::string countDecodeReturns(std::string code) const;
+
+    //! Get the code that counts verifies which changed data
+    std::string getVerifyCompletionString(void) const override;
+
 protected:
 
     //! Flag to treat this packet as a structure that other structures can reference
@@ -141,6 +237,21 @@ protected:
     //! Packet identifier string
     std::vector<std::string> ids;
 
+    //! Expected rate of this packet in packets per second, used for the rate report
+    std::string rate;
+
+    //! Flag to output the change-only (diff) encode and decode functions
+    bool diff;
+
+    //! Flag to output the scatter/gather encode function
+    bool gather;
+
+    //! Flag to output the resumable stream encode and decode functions
+    bool stream;
+
+    //! Index of this packet in the table of runtime counters
+    int statsIndex;
+
     //! List of document objects
     std::vector<ProtocolDocumentation*> documentList;
 };
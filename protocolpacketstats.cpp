@@ -0,0 +1,254 @@
+#include "protocolpacketstats.h"
+#include "protocolpacket.h"
+
+ProtocolPacketStats::ProtocolPacketStats(ProtocolSupport protocolsupport) :
+    header(protocolsupport),
+    source(protocolsupport),
+    support(protocolsupport),
+    prefix(toUpper(protocolsupport.protoName)),
+    table(protocolsupport.protoName + "PacketStatsTable"),
+    type(protocolsupport.protoName + "PacketStats" + protocolsupport.typeSuffix)
+{}
+
+
+/*!
+ * Perform the generation, writing out the files
+ * \param fileNameList receives the names of the files that were written.
+ * \param filePathList receives the paths of the files that were written.
+ * \param packets are all the packets, in the order of the protocol, which
+ *        is the order of the table.
+ * \return true if the files were written.
+ */
+bool ProtocolPacketStats::generate(std::vector<std::string>& fileNameList, std::vector<std::string>& filePathList, const std::vector<ProtocolPacket*>& packets)
+{
+    if(support.packetStats && !packets.empty() && generateHeader(packets))
+    {
+        fileNameList.push_back(header.fileName());
+        filePathList.push_back(header.filePath());
+
+        if(generateSource(packets))
+        {
+            fileNameList.push_back(source.fileName());
+            filePathList.push_back(source.filePath());
+
+            return true;
+        }
+    }
+
+    return false;
+
+}// ProtocolPacketStats::generate
+
+
+/*!
+ * Generate the header file, which declares the table and the hook macros used
+ * by the packet functions
+ * \param packets are all the packets.
+ * \return true if the file was written.
+ */
+bool ProtocolPacketStats::generateHeader(const std::vector<ProtocolPacket*>& packets)
+{
+    header.setModuleNameAndPath(support.protoName + "PacketStats", support.outputpath);
+
+// Raw string magic here
+header.setFileComment(R"(\brief Runtime counters of the )" + support.protoName + R"( packets
+
+The packet encode, decode and verify functions count the packets encoded and
+decoded, the bytes processed, the decodes that failed and why, and the
+verifies that had to change data. The counters are kept in a table with one
+entry per packet, which can be looked up by packet identifier.
+
+By default counters are incremented with relaxed atomic operations where the
+compiler supports them. Define )" + prefix + R"(_STATS_ADD(counter, amount) to
+change this. Define )" + prefix + R"(_DECODE_BEGIN(index) and
+)" + prefix + R"(_DECODE_END(index) as expressions to time each decode, for
+example using a cycle counter. If )" + prefix + R"(_DISABLE_PACKET_STATS is
+defined all of the hooks compile to nothing.)");
+
+    header.makeLineSeparator();
+    header.writeIncludeDirective("stdint.h", std::string(), true);
+    header.makeLineSeparator();
+
+    header.write("//! Runtime counters of one packet\n");
+    header.write("typedef struct\n");
+    header.write("{\n");
+    header.write("    uint32_t id;            //!< Identifier of the packet\n");
+    header.write("    const char* name;       //!< Name of the packet\n");
+    header.write("    uint32_t encoded;       //!< Number of packets encoded\n");
+    header.write("    uint32_t decoded;       //!< Number of packets decoded successfully\n");
+    header.write("    uint32_t tooShort;      //!< Number of decodes that failed because the packet was too short\n");
+    header.write("    uint32_t invalid;       //!< Number of decodes that failed because a constant or child structure was invalid\n");
+    header.write("    uint32_t clamped;       //!< Number of verifies that changed out of range data\n");
+    header.write("    uint64_t bytesEncoded;  //!< Number of data bytes encoded\n");
+    header.write("    uint64_t bytesDecoded;  //!< Number of data bytes decoded successfully\n");
+    header.write("}" + type + ";\n");
+    header.write("\n");
+    header.write("//! Number of entries in the table of runtime counters\n");
+    header.write("#define " + prefix + "_PACKET_STATS_COUNT " + std::to_string(packets.size()) + "\n");
+    header.write("\n");
+    header.write("//! Table of runtime counters, one entry for each packet\n");
+    header.write("extern " + type + " " + table + "[" + prefix + "_PACKET_STATS_COUNT];\n");
+    header.write("\n");
+    header.write("//! Look up the runtime counters of a packet by its identifier\n");
+    header.write(type + "* get" + support.protoName + "PacketStats(uint32_t id);\n");
+    header.write("\n");
+    header.write("//! Reset all the runtime counters to zero\n");
+    header.write("void reset" + support.protoName + "PacketStats(void);\n");
+    header.write("\n");
+
+    header.write("#ifdef " + prefix + "_DISABLE_PACKET_STATS\n");
+    header.write("\n");
+    header.write("#undef " + prefix + "_DECODE_BEGIN\n");
+    header.write("#define " + prefix + "_DECODE_BEGIN(index) ((void)0)\n");
+    header.write("#define " + prefix + "_ENCODED(index, bytes) ((void)0)\n");
+    header.write("#define " + prefix + "_DECODE_PASSED(index, bytes, result) (result)\n");
+    header.write("#define " + prefix + "_DECODE_FAILED(index, reason, result) (result)\n");
+    header.write("#define " + prefix + "_VERIFIED(index, good) ((void)0)\n");
+    header.write("\n");
+    header.write("#else\n");
+    header.write("\n");
+    header.write("//! User hook called at the start of each decode, once the packet identifier is known to be correct\n");
+    header.write("#ifndef " + prefix + "_DECODE_BEGIN\n");
+    header.write("#define " + prefix + "_DECODE_BEGIN(index) ((void)0)\n");
+    header.write("#endif\n");
+    header.write("\n");
+    header.write("//! User hook called at the end of each decode which called " + prefix + "_DECODE_BEGIN\n");
+    header.write("#ifndef " + prefix + "_DECODE_END\n");
+    header.write("#define " + prefix + "_DECODE_END(index) ((void)0)\n");
+    header.write("#endif\n");
+    header.write("\n");
+    header.write("//! Increment a runtime counter\n");
+    header.write("#ifndef " + prefix + "_STATS_ADD\n");
+    header.write("#if defined(__GNUC__) || defined(__clang__)\n");
+    header.write("#define " + prefix + "_STATS_ADD(counter, amount) ((void)__atomic_fetch_add(&(counter), (amount), __ATOMIC_RELAXED))\n");
+    header.write("#else\n");
+    header.write("#define " + prefix + "_STATS_ADD(counter, amount) ((void)((counter) += (amount)))\n");
+    header.write("#endif\n");
+    header.write("#endif\n");
+    header.write("\n");
+    header.write("//! Count an encoded packet\n");
+    header.write("#define " + prefix + "_ENCODED(index, bytes) (" + prefix + "_STATS_ADD(" + table + "[index].encoded, 1), " + prefix + "_STATS_ADD(" + table + "[index].bytesEncoded, (bytes)))\n");
+    header.write("\n");
+    header.write("//! Count a decoded packet, evaluating to result\n");
+    header.write("#define " + prefix + "_DECODE_PASSED(index, bytes, result) (" + prefix + "_DECODE_END(index), " + prefix + "_STATS_ADD(" + table + "[index].decoded, 1), " + prefix + "_STATS_ADD(" + table + "[index].bytesDecoded, (bytes)), (result))\n");
+    header.write("\n");
+    header.write("//! Count a failed decode, evaluating to result\n");
+    header.write("#define " + prefix + "_DECODE_FAILED(index, reason, result) (" + prefix + "_DECODE_END(index), " + prefix + "_STATS_ADD(" + table + "[index].reason, 1), (result))\n");
+    header.write("\n");
+    header.write("//! Count a verify that changed data\n");
+    header.write("#define " + prefix + "_VERIFIED(index, good) ((good) ? (void)0 : " + prefix + "_STATS_ADD(" + table + "[index].clamped, 1))\n");
+    header.write("\n");
+    header.write("#endif // " + prefix + "_DISABLE_PACKET_STATS\n");
+
+    return header.flush();
+
+}// ProtocolPacketStats::generateHeader
+
+
+/*!
+ * Generate the source file, which defines the table and the functions that
+ * look up and reset the counters
+ * \param packets are all the packets.
+ * \return true if the file was written.
+ */
+bool ProtocolPacketStats::generateSource(const std::vector<ProtocolPacket*>& packets)
+{
+    std::vector<std::string> includes;
+    std::vector<std::string> identifiers;
+    std::string entries;
+
+    for(std::size_t i = 0; i < packets.size(); i++)
+    {
+        std::vector<std::string> ids;
+        packets.at(i)->appendIds(ids);
+        packets.at(i)->getIdIncludeDirectives(includes);
+
+        entries += "    {" + (ids.empty() ? std::string("0") : ids.front()) + ", \"" + packets.at(i)->name + "\", 0, 0, 0, 0, 0, 0, 0}";
+        if(i + 1 < packets.size())
+            entries += ",";
+        entries += "\n";
+
+        for(const std::string& id : ids)
+            identifiers.push_back("    {" + id + ", " + std::to_string(i) + "}");
+    }
+
+    source.setModuleNameAndPath(support.protoName + "PacketStats", support.outputpath);
+    source.writeIncludeDirectives(includes);
+    source.writeIncludeDirective("stddef.h", std::string(), true);
+    source.makeLineSeparator();
+
+    source.write("//! Table of runtime counters, one entry for each packet in the order of the protocol\n");
+    source.write(type + " " + table + "[" + prefix + "_PACKET_STATS_COUNT] =\n");
+    source.write("{\n");
+    source.write(entries);
+    source.write("};\n");
+
+    source.makeLineSeparator();
+    source.write("/*!\n");
+    source.write(" * Look up the runtime counters of a packet by its identifier\n");
+    source.write(" * \\param id is the packet identifier.\n");
+    source.write(" * \\return a pointer to the counters, or NULL if no packet has this identifier.\n");
+    source.write(" */\n");
+    source.write(type + "* get" + support.protoName + "PacketStats(uint32_t id)\n");
+    source.write("{\n");
+
+    if(identifiers.empty())
+    {
+        source.write("    (void)id;\n");
+        source.write("    return NULL;\n");
+    }
+    else
+    {
+        // Some packets have more than one identifier
+        source.write("    // Each identifier and its index in the table\n");
+        source.write("    static const uint32_t identifiers[][2] =\n");
+        source.write("    {\n");
+
+        for(std::size_t i = 0; i < identifiers.size(); i++)
+        {
+            source.write("    " + identifiers.at(i));
+            if(i + 1 < identifiers.size())
+                source.write(",");
+            source.write("\n");
+        }
+
+        source.write("    };\n");
+        source.write("\n");
+        source.write("    unsigned i;\n");
+        source.write("\n");
+        source.write("    for(i = 0; i < sizeof(identifiers)/sizeof(identifiers[0]); i++)\n");
+        source.write("    {\n");
+        source.write("        if(identifiers[i][0] == id)\n");
+        source.write("            return &" + table + "[identifiers[i][1]];\n");
+        source.write("    }\n");
+        source.write("\n");
+        source.write("    return NULL;\n");
+    }
+
+    source.write("\n");
+    source.write("}// get" + support.protoName + "PacketStats\n");
+
+    source.makeLineSeparator();
+    source.write("/*!\n");
+    source.write(" * Reset all the runtime counters to zero\n");
+    source.write(" */\n");
+    source.write("void reset" + support.protoName + "PacketStats(void)\n");
+    source.write("{\n");
+    source.write("    int i;\n");
+    source.write("\n");
+    source.write("    for(i = 0; i < " + prefix + "_PACKET_STATS_COUNT; i++)\n");
+    source.write("    {\n");
+    source.write("        " + table + "[i].encoded = 0;\n");
+    source.write("        " + table + "[i].decoded = 0;\n");
+    source.write("        " + table + "[i].tooShort = 0;\n");
+    source.write("        " + table + "[i].invalid = 0;\n");
+    source.write("        " + table + "[i].clamped = 0;\n");
+    source.write("        " + table + "[i].bytesEncoded = 0;\n");
+    source.write("        " + table + "[i].bytesDecoded = 0;\n");
+    source.write("    }\n");
+    source.write("\n");
+    source.write("}// reset" + support.protoName + "PacketStats\n");
+
+    return source.flush();
+
+}// ProtocolPacketStats::generateSource
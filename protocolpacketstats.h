@@ -0,0 +1,41 @@
+#ifndef PROTOCOLPACKETSTATS_H
+#define PROTOCOLPACKETSTATS_H
+
+/*!
+ * \file
+ * Auto magically generate the table of runtime counters of the packets
+ */
+
+
+#include "protocolfile.h"
+#include "protocolsupport.h"
+#include <string>
+#include <vector>
+
+class ProtocolPacket;
+
+class ProtocolPacketStats
+{
+public:
+    ProtocolPacketStats(ProtocolSupport protocolsupport);
+
+    //! Perform the generation, writing out the files
+    bool generate(std::vector<std::string>& fileNameList, std::vector<std::string>& filePathList, const std::vector<ProtocolPacket*>& packets);
+
+protected:
+
+    //! Generate the header file
+    bool generateHeader(const std::vector<ProtocolPacket*>& packets);
+
+    //! Generate the source file
+    bool generateSource(const std::vector<ProtocolPacket*>& packets);
+
+    ProtocolHeaderFile header;
+    ProtocolSourceFile source;
+    ProtocolSupport support;
+    std::string prefix;     //!< Prefix of the macros, which is the upper case protocol name
+    std::string table;      //!< Name of the table of runtime counters
+    std::string type;       //!< Type name of one entry in the table
+};
+
+#endif // PROTOCOLPACKETSTATS_H
@@ -5,18 +5,32 @@
 #include "protocolscaling.h"
 #include "fieldcoding.h"
 #include "protocolfloatspecial.h"
+#include "protocolbenchmark.h"
+#include "protocolpacketstats.h"
+#include "protocolbatch.h"
+#include "protocolratereport.h"
+#include "protocolflatmap.h"
+#include "protocoljsoncbor.h"
 #include "protocolsupport.h"
 #include "protocolbitfield.h"
 #include "protocoldocumentation.h"
 #include "shuntingyard.h"
+#include "protocolstats.h"
 #include <string>
 #include <iostream>
 #include <filesystem>
 #include <fstream>
+#include <algorithm>
+#include <cctype>
 
 // The version of the protocol generator is set here
 const std::string ProtocolParser::genVersion = "3.6.k";
 
+std::mutex ProtocolParser::helpermutex;
+std::set<std::string> ProtocolParser::helperfingerprints;
+std::mutex ProtocolParser::sharedmutex;
+std::map<std::string, ProtocolParser::SharedDocument> ProtocolParser::shareddocuments;
+
 /*!
  * \brief ProtocolParser::ProtocolParser
  */
@@ -30,6 +44,7 @@ ProtocolParser::ProtocolParser() :
     nohelperfiles(false),
     nodoxygen(false),
     noAboutSection(false),
+    ratereport(false),
     nocss(false),
     tableOfContents(false),
     dbcidtx(0),
@@ -62,9 +77,7 @@ ProtocolParser::~ProtocolParser()
         delete globalenu;
     globalEnums.clear();
 
-    for(auto xmldoc : xmldocs)
-        delete xmldoc;
-    xmldocs.clear();
+    releaseXml();
 
     if(header != nullptr)
         delete header;
@@ -94,25 +107,29 @@ bool ProtocolParser::parse(std::string filename, std::string path, std::vector<s
 
     // Also remember the name of the file, which we use for warning outputs
     inputfile = filepath.filename().string();
-    std::fstream file(filename, std::ios_base::in);
 
-    if(!file.is_open())
+    ProtocolStats::Timer loadtimer("Load XML " + ProtocolFile::sanitizePath(filepath.parent_path().string()) + filepath.filename().string());
+
+    SharedDocument maindocument = takeLoadedFile(filename);
+
+    if(maindocument == nullptr)
     {
         std::cerr << filename << " : error: Failed to open protocol file" << std::endl;
         return false;
     }
 
-    currentxml = new XMLDocument();
-    xmldocs.push_back(currentxml);
-    if(currentxml->Parse(std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>()).c_str()) != XML_SUCCESS)
+    if(maindocument->Error())
     {
-        file.close();
-        std::cerr << currentxml->ErrorStr() << std::endl;
+        std::cerr << maindocument->ErrorStr() << std::endl;
         return false;
     }
 
-    // Done with the file
-    file.close();
+    // The main file is parsed again below, after the other files, using this
+    // same document. Until then it belongs to the list of loaded files.
+    currentxml = maindocument.get();
+    filesloading[getAbsoluteFileName(filename)] = std::async(std::launch::deferred, [maindocument](){return maindocument;});
+
+    loadtimer.stop();
 
     // Set our output directory
     // Make the path as short as possible
@@ -144,7 +161,7 @@ bool ProtocolParser::parse(std::string filename, std::string path, std::vector<s
     }
 
     // The outer most element
-    XMLElement* docElem = currentxml->RootElement();
+    const XMLElement* docElem = currentxml->RootElement();
 
     // This element must have the "Protocol" tag
     if((docElem == nullptr) || (XMLUtil::StringEqual(docElem->Name(), "protocol") == false))
@@ -164,12 +181,14 @@ bool ProtocolParser::parse(std::string filename, std::string path, std::vector<s
 
     title = getAttribute("title", docElem->FirstAttribute());
     comment = getAttribute("comment", docElem->FirstAttribute());
+    framing = getAttribute("framing", docElem->FirstAttribute());
+    linkRate = getAttribute("linkRate", docElem->FirstAttribute());
     support.parse(docElem->FirstAttribute());
 
     if(support.disableunrecognized == false)
     {
         // All the attributes we understand
-        std::vector<std::string> attriblist = {"name", "title", "api", "version", "comment"};
+        std::vector<std::string> attriblist = {"name", "title", "api", "version", "comment", "framing", "linkRate"};
 
         // and the ones understood by the protocol support
         std::vector<std::string> supportlist = support.getAttriblist();
@@ -198,6 +217,10 @@ bool ProtocolParser::parse(std::string filename, std::string path, std::vector<s
         filePathList.push_back(header->filePath());
     }
 
+    // Load the other files in the background, they are parsed in order below
+    for(std::size_t i = 0; i < otherfiles.size(); i++)
+        preloadFile(otherfiles.at(i));
+
     // Now parse the contents of all the files. We do other files first since
     // we expect them to be helpers that the main file may depend on.
     for(std::size_t i = 0; i < otherfiles.size(); i++)
@@ -209,20 +232,17 @@ bool ProtocolParser::parse(std::string filename, std::string path, std::vector<s
     // This is a resource file for bitfield testing
     if(support.bitfieldtest && support.bitfield && !nocode)
     {
-        std::fstream btestfile("bitfieldtester.xml", std::ios_base::out);
-
         // Raw string literal trick, I love this!
         std::string filedata = (
             #include "bitfieldtest.xml"
             );
 
-        if(btestfile.is_open())
-        {
-            btestfile << filedata;
-            btestfile.close();
-            parseFile("bitfieldtester.xml");
-            ProtocolFile::deleteFile("bitfieldtester.xml");
-        }
+        // The test file is parsed from memory rather than written out, so
+        // protocols generated at the same time do not share a file
+        std::shared_ptr<XMLDocument> testdocument = std::make_shared<XMLDocument>();
+        testdocument->Parse(filedata.c_str(), filedata.size());
+        filesloading[getAbsoluteFileName("bitfieldtester.xml")] = std::async(std::launch::deferred, [testdocument]() -> SharedDocument {return testdocument;});
+        parseFile("bitfieldtester.xml");
     }
 
     // Output the global enumerations first, they will go in the main
@@ -230,6 +250,8 @@ bool ProtocolParser::parse(std::string filename, std::string path, std::vector<s
     ProtocolHeaderFile enumfile(support);
     ProtocolSourceFile enumSourceFile(support);
 
+    ProtocolStats::Timer enumtimer("Parse global enumerations");
+
     for(std::size_t i = 0; i < globalEnums.size(); i++)
     {
         EnumCreator* module = globalEnums.at(i);
@@ -276,11 +298,35 @@ bool ProtocolParser::parse(std::string filename, std::string path, std::vector<s
         filePathList.push_back(enumfile.filePath());
     }
 
+    enumtimer.stop();
+
+    // Files written so far (the protocol header and the enumeration files)
+    // are always generated, so modules which write to them cannot be skipped
+    std::vector<std::string> reservedFiles;
+
+    if(cache.isEnabled() && !nocode)
+    {
+        for(std::size_t i = 0; i < fileNameList.size(); i++)
+            reservedFiles.push_back(filePathList.at(i) + fileNameList.at(i));
+
+        cache.load(getLayoutFingerprint());
+    }
+
+    // True if any structure or packet outputs JSON and CBOR functions
+    bool json = false;
+
+    ProtocolStats::Timer structuretimer("Parse structures");
+
     // Now parse the global structures
     for(std::size_t i = 0; i < structures.size(); i++)
     {
         ProtocolStructureModule* module = structures[i];
 
+        ProtocolStats::count("Structure modules");
+
+        // Skip the output if it is current from the previous run
+        setModuleCached(module, reservedFiles);
+
         // Parse its XML and generate the output
         module->parse(nocode);
 
@@ -311,9 +357,21 @@ bool ProtocolParser::parse(std::string filename, std::string path, std::vector<s
         filePathList.push_back(module->getMapSourceFilePath());
         fileNameList.push_back(module->getMapHeaderFileName());
         filePathList.push_back(module->getMapHeaderFilePath());
+        fileNameList.push_back(module->getJsonSourceFileName());
+        filePathList.push_back(module->getJsonSourceFilePath());
+        fileNameList.push_back(module->getJsonHeaderFileName());
+        filePathList.push_back(module->getJsonHeaderFilePath());
+
+        // The JSON and CBOR helper is needed if anyone uses it
+        if(module->hasJson())
+            json = true;
 
     }// for all top level structures
 
+    structuretimer.stop();
+
+    ProtocolStats::Timer packettimer("Parse packets");
+
     // And the global packets. We want to sort the packets into two batches:
     // those packets which can be used by other packets; and those which cannot.
     // This way we can parse the first batch ahead of the second
@@ -324,6 +382,11 @@ bool ProtocolParser::parse(std::string filename, std::string path, std::vector<s
         if(!isFieldSet(packet->getElement(), "useInOtherPackets"))
             continue;
 
+        ProtocolStats::count("Packet modules");
+
+        // Skip the output if it is current from the previous run
+        setModuleCached(packet, reservedFiles);
+
         // Parse its XML
         packet->parse(nocode);
 
@@ -358,6 +421,14 @@ bool ProtocolParser::parse(std::string filename, std::string path, std::vector<s
         filePathList.push_back(packet->getMapSourceFilePath());
         fileNameList.push_back(packet->getMapHeaderFileName());
         filePathList.push_back(packet->getMapHeaderFilePath());
+        fileNameList.push_back(packet->getJsonSourceFileName());
+        filePathList.push_back(packet->getJsonSourceFilePath());
+        fileNameList.push_back(packet->getJsonHeaderFileName());
+        filePathList.push_back(packet->getJsonHeaderFilePath());
+
+        // The JSON and CBOR helper is needed if anyone uses it
+        if(packet->hasJson())
+            json = true;
 
     }
 
@@ -369,6 +440,11 @@ bool ProtocolParser::parse(std::string filename, std::string path, std::vector<s
         if(isFieldSet(packet->getElement(), "useInOtherPackets"))
             continue;
 
+        ProtocolStats::count("Packet modules");
+
+        // Skip the output if it is current from the previous run
+        setModuleCached(packet, reservedFiles);
+
         // Parse its XML
         packet->parse(nocode);
 
@@ -399,9 +475,21 @@ bool ProtocolParser::parse(std::string filename, std::string path, std::vector<s
         filePathList.push_back(packet->getMapSourceFilePath());
         fileNameList.push_back(packet->getMapHeaderFileName());
         filePathList.push_back(packet->getMapHeaderFilePath());
+        fileNameList.push_back(packet->getJsonSourceFileName());
+        filePathList.push_back(packet->getJsonSourceFilePath());
+        fileNameList.push_back(packet->getJsonHeaderFileName());
+        filePathList.push_back(packet->getJsonHeaderFilePath());
+
+        // The JSON and CBOR helper is needed if anyone uses it
+        if(packet->hasJson())
+            json = true;
 
     }
 
+    packettimer.stop();
+
+    ProtocolStats::Timer documenttimer("Parse documentation");
+
     // Parse all of the documentation
     for(std::size_t i = 0; i < documents.size(); i++)
     {
@@ -410,37 +498,119 @@ bool ProtocolParser::parse(std::string filename, std::string path, std::vector<s
         doc->parse();
     }
 
+    documenttimer.stop();
+
+    // Everything has been converted from the XML, the rest of the outputs
+    // come from the parsed objects, so we do not need to hold the DOM
+    releaseXml();
+
     if(!nohelperfiles && !nocode)
     {
-        // Auto-generated files for coding
-        ProtocolScaling(support).generate(fileNameList, filePathList);
-        FieldCoding(support).generate(fileNameList, filePathList);
-        ProtocolFloatSpecial(support).generate(fileNameList, filePathList);
+        ProtocolStats::Timer helpertimer("Helper files");
 
-        // Code for testing bitfields
-        if(support.bitfieldtest && support.bitfield)
-            ProtocolBitfield::generatetest(support);
+        // When several protocols are generated in one run, protocols with the
+        // same output path and options share one copy of the helper files.
+        // Protocols with different options take turns, as their helper files
+        // have the same names.
+        std::unique_lock<std::mutex> helperlock(helpermutex);
+
+        if(helperfingerprints.insert(support.getHelperFingerprint() + "json=" + std::to_string(json) + "\n").second)
+        {
+            // Auto-generated files for coding
+            ProtocolScaling(support).generate(fileNameList, filePathList);
+            FieldCoding(support).generate(fileNameList, filePathList);
+            ProtocolFloatSpecial(support).generate(fileNameList, filePathList);
+            ProtocolFlatMap(support).generate(fileNameList, filePathList);
+
+            if(json)
+                ProtocolJsonCbor(support).generate(fileNameList, filePathList);
+
+            // Code for testing bitfields
+            if(support.bitfieldtest && support.bitfield)
+                ProtocolBitfield::generatetest(support);
+        }
+
+        helperlock.unlock();
+
+        // Code for benchmarking the encode and decode. Packets which are used
+        // in other packets are already in the list of structures.
+        if(support.benchmark)
+        {
+            std::vector<ProtocolStructureModule*> modules(structures.begin(), structures.end());
+
+            for(ProtocolPacket* packet : packets)
+            {
+                if(std::find(structures.begin(), structures.end(), packet) == structures.end())
+                    modules.push_back(packet);
+            }
+
+            ProtocolBenchmark(support).generate(fileNameList, filePathList, modules);
+        }
     }
 
+    // The table of runtime counters is specific to this protocol, so it is
+    // output even when the helper files are not
+    if(support.packetStats && !nocode)
+        ProtocolPacketStats(support).generate(fileNameList, filePathList, packets);
+
+    // The batch functions are also specific to this protocol
+    if(!support.batchID.empty() && !nocode)
+        ProtocolBatch(support).generate(fileNameList, filePathList, lookUpIncludeFilenameForDefinition(support.batchID), packets);
+
     if(!nomarkdown)
+    {
+        ProtocolStats::Timer markdowntimer("Markdown");
         outputMarkdown(inlinecss);
+    }
 
     if(!dbcfile.empty())
+    {
+        ProtocolStats::Timer dbctimer("DBC");
         outputDBC();
+    }
+
+    if(ratereport)
+    {
+        ProtocolStats::Timer ratetimer("Rate report");
+        outputRateReport();
+    }
 
     #ifndef _DEBUG
     if(!nodoxygen)
+    {
+        ProtocolStats::Timer doxygentimer("Doxygen");
         outputDoxygen();
+    }
     #endif
 
     // The last bit of the protocol header
     if(!nocode)
         finishProtocolHeader();
 
+    ProtocolStats::Timer copytimer("Compare and replace files");
+
     // This is fun...replace all the temporary files with real ones if needed
     for(std::size_t i = 0; i < fileNameList.size(); i++)
         ProtocolFile::copyTemporaryFile(filePathList.at(i), fileNameList.at(i));
 
+    copytimer.stop();
+
+    // Remember the fingerprints of the modules for the next run, now that the files are on disk
+    if(cache.isEnabled() && !nocode)
+    {
+        // Packets which can be used by other packets are in the structure list
+        for(std::size_t i = 0; i < structures.size(); i++)
+            updateCache(structures.at(i));
+
+        for(std::size_t i = 0; i < packets.size(); i++)
+        {
+            if(std::find(structures.begin(), structures.end(), packets.at(i)) == structures.end())
+                updateCache(packets.at(i));
+        }
+
+        cache.save();
+    }
+
     // If we are putting the files in our local directory then we don't just want an empty string in our printout
     if(path.empty())
         path = "./";
@@ -468,12 +638,7 @@ bool ProtocolParser::parseFile(std::string xmlFilename)
     // We allow each xml file to alter the global filenames used, but only for the context of that xml.
     ProtocolSupport localsupport(support);
 
-    std::string absolutepathname;
-
-    if(xmlFilename.at(0) == ':')
-        absolutepathname = xmlFilename;
-    else
-        absolutepathname = std::filesystem::absolute(path).string();
+    std::string absolutepathname = getAbsoluteFileName(xmlFilename);
 
     // Don't parse the same file twice
     if(contains(filesparsed, absolutepathname))
@@ -484,46 +649,31 @@ bool ProtocolParser::parseFile(std::string xmlFilename)
 
     std::cout << "Parsing file " << ProtocolFile::sanitizePath(path.parent_path().string()) << path.filename().string() << std::endl;
 
-    std::fstream xmlFile(xmlFilename, std::ios_base::in);
+    ProtocolStats::Timer loadtimer("Load XML " + ProtocolFile::sanitizePath(path.parent_path().string()) + path.filename().string());
+
+    SharedDocument document = takeLoadedFile(xmlFilename);
 
-    if(!xmlFile.is_open())
+    if(document == nullptr)
     {
         std::string warning = "error: Failed to open xml protocol file " + xmlFilename;
         std::cerr << warning << std::endl;
         return false;
     }
 
-    currentxml = new XMLDocument();
-    xmldocs.push_back(currentxml);
-    std::string contents = std::string((std::istreambuf_iterator<char>(xmlFile)), std::istreambuf_iterator<char>());
-
-    // Done with the file
-    xmlFile.close();
-
     // Error parsing
-    std::string error;
-    //int errorLine, errorCol;
-
-    currentxml = new XMLDocument();
-
-    // Extract XML data
-    if(currentxml->Parse(contents.c_str()) != XML_SUCCESS)
+    if(document->Error())
     {
-        std::cerr << currentxml->ErrorStr() << std::endl;
-        delete currentxml;
-
-        if(xmldocs.size() > 0)
-            currentxml = xmldocs.back();
-        else
-            currentxml = nullptr;
-
+        std::cerr << document->ErrorStr() << std::endl;
         return false;
     }
-    else
-        xmldocs.push_back(currentxml);
+
+    currentxml = document.get();
+    xmldocs.push_back(document);
+
+    loadtimer.stop();
 
     // The outer most element
-    XMLElement* docElem = currentxml->RootElement();
+    const XMLElement* docElem = currentxml->RootElement();
 
     // This element must have the "Protocol" tag
     if((docElem == nullptr) || (XMLUtil::StringEqual(docElem->Name(), "protocol") == false))
@@ -537,6 +687,21 @@ bool ProtocolParser::parseFile(std::string xmlFilename)
     localsupport.parseFileNames(docElem->FirstAttribute());
     localsupport.sourcefile = xmlFilename;
 
+    // Every object parsed from this file shares the same support
+    SharedSupport filesupport = std::make_shared<const ProtocolSupport>(localsupport);
+
+    // Load the required files in the background. They are still parsed in
+    // order, when the loop below reaches them
+    for(const XMLElement* element = docElem->FirstChildElement(); element != nullptr; element = element->NextSiblingElement())
+    {
+        if(toLower(trimm(element->Name())) == "require")
+        {
+            std::string subfile = getRequiredFileName(element, xmlFilename);
+            if(!subfile.empty())
+                preloadFile(subfile);
+        }
+    }
+
     for(const XMLElement* element = docElem->FirstChildElement(); element != nullptr; element = element->NextSiblingElement())
     {
         std::string nodename = toLower(trimm(element->Name()));
@@ -546,7 +711,7 @@ bool ProtocolParser::parseFile(std::string xmlFilename)
         // This effectively creates a single flattened XML structure
         if( nodename == "require" )
         {
-            std::string subfile = getAttribute("file", element->FirstAttribute());
+            std::string subfile = getRequiredFileName(element, xmlFilename);
 
             if( subfile.empty() )
             {
@@ -554,18 +719,12 @@ bool ProtocolParser::parseFile(std::string xmlFilename)
                 std::cerr << warning << std::endl;
             }
             else
-            {
-                if(!endsWith(subfile, ".xml"))
-                    subfile += ".xml";
-
-                // The new file is relative to this file
-                parseFile(ProtocolFile::sanitizePath(path.parent_path().string()) + subfile);
-            }
+                parseFile(subfile);
 
         }
         else if( nodename == "struct" || nodename == "structure" )
         {
-            ProtocolStructureModule* module = new ProtocolStructureModule( this, localsupport );
+            ProtocolStructureModule* module = new ProtocolStructureModule( this, filesupport );
 
             // Remember the XML
             module->setElement(element);
@@ -574,7 +733,7 @@ bool ProtocolParser::parseFile(std::string xmlFilename)
         }
         else if( nodename == "enum" || nodename == "enumeration" )
         {
-            EnumCreator* Enum = new EnumCreator( this, nodename, localsupport );
+            EnumCreator* Enum = new EnumCreator( this, nodename, filesupport );
 
             Enum->setElement(element);
 
@@ -584,7 +743,7 @@ bool ProtocolParser::parseFile(std::string xmlFilename)
         // Define a packet
         else if( nodename == "packet" || nodename == "pkt" )
         {
-            ProtocolPacket* packet = new ProtocolPacket( this, localsupport );
+            ProtocolPacket* packet = new ProtocolPacket( this, filesupport );
 
             packet->setElement(element);
 
@@ -593,7 +752,7 @@ bool ProtocolParser::parseFile(std::string xmlFilename)
         }
         else if ( nodename == "doc" || contains(nodename, "document"))
         {
-            ProtocolDocumentation* document = new ProtocolDocumentation( this, nodename, localsupport );
+            ProtocolDocumentation* document = new ProtocolDocumentation( this, nodename, filesupport );
 
             document->setElement(element);
 
@@ -612,6 +771,510 @@ bool ProtocolParser::parseFile(std::string xmlFilename)
 }// ProtocolParser::parseFile
 
 
+/*!
+ * Forget which helper files were generated. Protocols generated in one run
+ * share the helper files of the same options, this starts a new run.
+ */
+void ProtocolParser::forgetHelperFiles(void)
+{
+    std::lock_guard<std::mutex> lock(helpermutex);
+
+    helperfingerprints.clear();
+
+}// ProtocolParser::forgetHelperFiles
+
+
+/*!
+ * Load XML files once, to be shared by the protocols generated at the same
+ * time, such as the support files given for every protocol of a manifest.
+ * The files they require are shared too. Every string in a shared document
+ * is resolved here, since tinyxml2 resolves them on first access, after which
+ * the documents are only read.
+ * \param xmlFilenames are the files to share.
+ */
+void ProtocolParser::shareFiles(const std::vector<std::string>& xmlFilenames)
+{
+    std::vector<std::string> names(xmlFilenames);
+
+    std::lock_guard<std::mutex> lock(sharedmutex);
+
+    // The list grows as required files are found
+    for(std::size_t i = 0; i < names.size(); i++)
+    {
+        std::string absolutepathname = getAbsoluteFileName(names.at(i));
+
+        if(shareddocuments.find(absolutepathname) != shareddocuments.end())
+            continue;
+
+        SharedDocument document = loadFile(names.at(i));
+
+        if(document == nullptr)
+            continue;
+
+        // The error text is resolved on first access too
+        if(document->Error())
+            document->ErrorStr();
+        else
+        {
+            resolveStrings(document.get());
+
+            const XMLElement* docElem = document->RootElement();
+
+            for(const XMLElement* element = (docElem == nullptr) ? nullptr : docElem->FirstChildElement(); element != nullptr; element = element->NextSiblingElement())
+            {
+                if(toLower(trimm(element->Name())) == "require")
+                {
+                    std::string subfile = getRequiredFileName(element, names.at(i));
+                    if(!subfile.empty())
+                        names.push_back(subfile);
+                }
+            }
+        }
+
+        shareddocuments[absolutepathname] = document;
+    }
+
+}// ProtocolParser::shareFiles
+
+
+/*!
+ * Release the XML files shared by the protocols generated at the same time.
+ * Protocols which are still using them keep them until they are done.
+ */
+void ProtocolParser::forgetSharedFiles(void)
+{
+    std::lock_guard<std::mutex> lock(sharedmutex);
+
+    shareddocuments.clear();
+
+}// ProtocolParser::forgetSharedFiles
+
+
+/*!
+ * Get a document shared by the protocols generated at the same time
+ * \param absolutepathname is the absolute name of the file.
+ * \return the shared document, which is null if the file is not shared.
+ */
+ProtocolParser::SharedDocument ProtocolParser::findSharedFile(const std::string& absolutepathname)
+{
+    std::lock_guard<std::mutex> lock(sharedmutex);
+
+    auto shared = shareddocuments.find(absolutepathname);
+
+    if(shared == shareddocuments.end())
+        return SharedDocument();
+
+    return shared->second;
+
+}// ProtocolParser::findSharedFile
+
+
+/*!
+ * Resolve every string in a document. tinyxml2 resolves entities and white
+ * space of names, values and text the first time they are read, which writes
+ * to the document, so a document read by more than one thread must be
+ * resolved first.
+ * \param node is the node to resolve, along with all of its children.
+ */
+void ProtocolParser::resolveStrings(const XMLNode* node)
+{
+    if(node->ToDocument() == nullptr)
+        node->Value();
+
+    const XMLElement* element = node->ToElement();
+    if(element != nullptr)
+    {
+        for(const XMLAttribute* a = element->FirstAttribute(); a != nullptr; a = a->Next())
+        {
+            a->Name();
+            a->Value();
+        }
+    }
+
+    for(const XMLNode* child = node->FirstChild(); child != nullptr; child = child->NextSibling())
+        resolveStrings(child);
+
+}// ProtocolParser::resolveStrings
+
+
+/*!
+ * Start loading and parsing an XML file in the background. The file is only
+ * read and parsed into a document, its contents are registered by
+ * parseFile(), in the same order as if it had not been loaded early.
+ * \param xmlFilename is the file to load.
+ */
+void ProtocolParser::preloadFile(const std::string& xmlFilename)
+{
+    std::string absolutepathname = getAbsoluteFileName(xmlFilename);
+
+    if(contains(filesparsed, absolutepathname) || (filesloading.find(absolutepathname) != filesloading.end()))
+        return;
+
+    SharedDocument shared = findSharedFile(absolutepathname);
+
+    if(shared != nullptr)
+        filesloading[absolutepathname] = std::async(std::launch::deferred, [shared](){return shared;});
+    else
+        filesloading[absolutepathname] = std::async(std::launch::async, &ProtocolParser::loadFile, xmlFilename);
+
+}// ProtocolParser::preloadFile
+
+
+/*!
+ * Get the document of an XML file. If the file is being loaded in the
+ * background this waits for it, otherwise the file is loaded now.
+ * \param xmlFilename is the file to get.
+ * \return the document, which will be null if the file could not be opened.
+ */
+ProtocolParser::SharedDocument ProtocolParser::takeLoadedFile(const std::string& xmlFilename)
+{
+    std::string absolutepathname = getAbsoluteFileName(xmlFilename);
+    auto loading = filesloading.find(absolutepathname);
+
+    if(loading == filesloading.end())
+    {
+        SharedDocument shared = findSharedFile(absolutepathname);
+
+        if(shared != nullptr)
+            return shared;
+
+        return loadFile(xmlFilename);
+    }
+
+    SharedDocument document = loading->second.get();
+    filesloading.erase(loading);
+    return document;
+
+}// ProtocolParser::takeLoadedFile
+
+
+/*!
+ * Release the XML documents, including any files which were loaded but never
+ * parsed. The elements of the parsed objects are not valid after this, so
+ * this must only be called once everything has been parsed from them.
+ */
+void ProtocolParser::releaseXml(void)
+{
+    // Files still loading in the background are waited for by their futures
+    filesloading.clear();
+    xmldocs.clear();
+
+    currentxml = nullptr;
+
+}// ProtocolParser::releaseXml
+
+
+/*!
+ * Read and parse an XML file. This does not touch the parser, so it can be
+ * run on any thread.
+ * \param xmlFilename is the file to read.
+ * \return the document, which will be null if the file could not be opened,
+ *         and which will report an error if the contents could not be parsed.
+ */
+ProtocolParser::SharedDocument ProtocolParser::loadFile(const std::string& xmlFilename)
+{
+    std::ifstream file(xmlFilename, std::ios_base::in | std::ios_base::binary);
+
+    if(!file.is_open())
+        return SharedDocument();
+
+    // Read the whole file in one go
+    file.seekg(0, std::ios_base::end);
+    std::streamoff size = file.tellg();
+    file.seekg(0, std::ios_base::beg);
+
+    std::string contents;
+    if(size > 0)
+    {
+        contents.resize((std::size_t)size);
+        file.read(&contents[0], size);
+        contents.resize((std::size_t)file.gcount());
+    }
+
+    // Done with the file
+    file.close();
+
+    std::shared_ptr<XMLDocument> document = std::make_shared<XMLDocument>();
+    document->Parse(contents.c_str(), contents.size());
+    return document;
+
+}// ProtocolParser::loadFile
+
+
+/*!
+ * Get the absolute name of an XML file, which is used to make sure the same
+ * file is not parsed twice.
+ * \param xmlFilename is the file name, which may be relative.
+ * \return the absolute name of the file.
+ */
+std::string ProtocolParser::getAbsoluteFileName(const std::string& xmlFilename)
+{
+    if(!xmlFilename.empty() && (xmlFilename.at(0) == ':'))
+        return xmlFilename;
+    else
+        return std::filesystem::absolute(std::filesystem::path(xmlFilename)).string();
+
+}// ProtocolParser::getAbsoluteFileName
+
+
+/*!
+ * Get the name of the file required by a "Require" tag. The name is relative
+ * to the file that contains the tag.
+ * \param element is the "Require" element.
+ * \param xmlFilename is the file that contains the element.
+ * \return the name of the required file, which will be empty if the tag does
+ *         not have a file attribute.
+ */
+std::string ProtocolParser::getRequiredFileName(const XMLElement* element, const std::string& xmlFilename)
+{
+    std::string subfile = getAttribute("file", element->FirstAttribute());
+
+    if(subfile.empty())
+        return subfile;
+
+    if(!endsWith(subfile, ".xml"))
+        subfile += ".xml";
+
+    // The new file is relative to this file
+    return ProtocolFile::sanitizePath(std::filesystem::path(xmlFilename).parent_path().string()) + subfile;
+
+}// ProtocolParser::getRequiredFileName
+
+
+/*!
+ * Compute the fingerprint of everything other than the contents of the
+ * modules. This includes the generator version, the options, the global
+ * enumerations, and which files each module writes to. If any of these change
+ * then every module must be generated. This also maps the identifiers defined
+ * by each module so that module fingerprints can include their dependencies.
+ * \return the fingerprint of the layout
+ */
+std::string ProtocolParser::getLayoutFingerprint(void)
+{
+    // Module attributes which determine the files that are written
+    const std::vector<std::string> fileattribs = {"name", "file", "deffile", "verifyfile", "comparefile", "printfile", "mapfile", "jsonfile",
+                                                  "compare", "print", "map", "json", "redefine", "useInOtherPackets", "hidden", "neverOmit"};
+
+    std::string layout = genVersion + "\n" + support.getFingerprint();
+
+    moduleIdentifiers.clear();
+
+    for(const SharedDocument& doc : xmldocs)
+    {
+        const XMLElement* docElem = doc->RootElement();
+
+        if(docElem == nullptr)
+            continue;
+
+        for(const XMLAttribute* a = docElem->FirstAttribute(); a != nullptr; a = a->Next())
+            layout += std::string(a->Name()) + "=" + a->Value() + "\n";
+
+        for(const XMLElement* element = docElem->FirstChildElement(); element != nullptr; element = element->NextSiblingElement())
+        {
+            std::string nodename = toLower(trimm(element->Name()));
+
+            if(getCacheKey(element).empty())
+            {
+                // Documentation only affects the documentation outputs, which are always generated
+                if((nodename == "doc") || contains(nodename, "document"))
+                    continue;
+
+                XMLPrinter printer(nullptr, true);
+                element->Accept(&printer);
+                layout += printer.CStr();
+                layout += "\n";
+            }
+            else
+            {
+                layout += nodename;
+
+                for(const std::string& attrib : fileattribs)
+                    layout += " " + attrib + "=" + getAttribute(attrib, element->FirstAttribute());
+
+                layout += "\n";
+
+                mapModuleIdentifiers(element, element);
+            }
+
+        }// for all top level elements
+
+    }// for all documents
+
+    return ProtocolCache::hash(layout);
+
+}// ProtocolParser::getLayoutFingerprint
+
+
+/*!
+ * Remember the identifiers defined by a module: its own name and the names of
+ * any enumerations and enumeration values it contains.
+ * \param module is the top level element of the module.
+ * \param element is the element to search, which is the module or one of its children.
+ */
+void ProtocolParser::mapModuleIdentifiers(const XMLElement* module, const XMLElement* element)
+{
+    std::string nodename = toLower(trimm(element->Name()));
+
+    if((element == module) || contains(nodename, "enum") || (nodename == "value"))
+    {
+        std::string identifier = trimm(getAttribute("name", element->FirstAttribute()));
+        if(!identifier.empty())
+            moduleIdentifiers[identifier] = module;
+    }
+
+    for(const XMLElement* child = element->FirstChildElement(); child != nullptr; child = child->NextSiblingElement())
+        mapModuleIdentifiers(module, child);
+
+}// ProtocolParser::mapModuleIdentifiers
+
+
+/*!
+ * Compute the fingerprint of a module. This is the XML of the module, and the
+ * XML of every module that it refers to (by structure type, enumeration, or
+ * any other identifier in its attributes), and the modules those modules
+ * refer to, and so on.
+ * \param element is the top level element of the module.
+ * \return the fingerprint of the module
+ */
+std::string ProtocolParser::getModuleFingerprint(const XMLElement* element) const
+{
+    // The XML text of each module, sorted so the fingerprint does not depend on search order
+    std::map<const XMLElement*, std::string> found;
+    std::vector<const XMLElement*> pending = {element};
+
+    while(!pending.empty())
+    {
+        const XMLElement* module = pending.back();
+        pending.pop_back();
+
+        if(found.count(module) > 0)
+            continue;
+
+        XMLPrinter printer(nullptr, true);
+        module->Accept(&printer);
+        found[module] = printer.CStr();
+
+        // Walk the module looking for identifiers in any attribute
+        std::vector<const XMLElement*> children = {module};
+
+        while(!children.empty())
+        {
+            const XMLElement* child = children.back();
+            children.pop_back();
+
+            for(const XMLAttribute* a = child->FirstAttribute(); a != nullptr; a = a->Next())
+            {
+                std::vector<std::string> tokens = splitanyof(a->Value(), " \t\r\n+-*/%()[]{}<>=!&|^~,;:.?\"'");
+
+                for(const std::string& token : tokens)
+                {
+                    auto it = moduleIdentifiers.find(token);
+                    if((it != moduleIdentifiers.end()) && (found.count(it->second) == 0))
+                        pending.push_back(it->second);
+                }
+            }
+
+            for(const XMLElement* next = child->FirstChildElement(); next != nullptr; next = next->NextSiblingElement())
+                children.push_back(next);
+        }
+
+    }// while modules to search
+
+    std::vector<std::string> texts;
+    for(const auto& text : found)
+    {
+        if(text.first != element)
+            texts.push_back(text.second);
+    }
+
+    std::sort(texts.begin(), texts.end());
+
+    std::string fingerprint = found[element];
+    for(const std::string& text : texts)
+        fingerprint += "\n" + text;
+
+    return ProtocolCache::hash(fingerprint);
+
+}// ProtocolParser::getModuleFingerprint
+
+
+/*!
+ * Get the unique name of a module in the cache
+ * \param element is the top level element of the module.
+ * \return the name of the module, or an empty string if element is not a structure or packet
+ */
+std::string ProtocolParser::getCacheKey(const XMLElement* element)
+{
+    std::string nodename = toLower(trimm(element->Name()));
+    std::string modulename = trimm(getAttribute("name", element->FirstAttribute()));
+
+    if((nodename == "struct") || (nodename == "structure"))
+        return "structure " + modulename;
+    else if((nodename == "packet") || (nodename == "pkt"))
+        return "packet " + modulename;
+    else
+        return std::string();
+
+}// ProtocolParser::getCacheKey
+
+
+/*!
+ * Determine if a module is current in the cache, in which case it will be
+ * parsed but its output will not be generated.
+ * \param module is the module to test, which has not been parsed yet.
+ * \param reservedFiles are files which are always generated.
+ */
+void ProtocolParser::setModuleCached(ProtocolStructureModule* module, const std::vector<std::string>& reservedFiles)
+{
+    if(!cache.isEnabled() || nocode)
+        return;
+
+    // The cache is updated after the DOM is released, so remember the fingerprint now
+    const XMLElement* element = module->getElement();
+    module->setCacheRecord(getCacheKey(element), getModuleFingerprint(element));
+
+    // The benchmark needs every module to be parsed
+    if(support.benchmark)
+        return;
+
+    module->setCached(cache.isCurrent(module->getCacheKey(), module->getCacheFingerprint(), reservedFiles));
+
+    if(module->isCached())
+        ProtocolStats::count("Modules skipped as unchanged");
+
+}// ProtocolParser::setModuleCached
+
+
+/*!
+ * Record the output files of a module in the cache. This must be called after
+ * the files are on disk. Modules which were skipped keep their previous record.
+ * \param module is the module to record, which has been parsed.
+ */
+void ProtocolParser::updateCache(ProtocolStructureModule* module)
+{
+    if(module->isCached())
+        return;
+
+    std::vector<std::string> files = {
+        module->getDefinitionFilePath() + module->getDefinitionFileName(),
+        module->getHeaderFilePath() + module->getHeaderFileName(),
+        module->getSourceFilePath() + module->getSourceFileName(),
+        module->getVerifySourceFilePath() + module->getVerifySourceFileName(),
+        module->getVerifyHeaderFilePath() + module->getVerifyHeaderFileName(),
+        module->getCompareSourceFilePath() + module->getCompareSourceFileName(),
+        module->getCompareHeaderFilePath() + module->getCompareHeaderFileName(),
+        module->getPrintSourceFilePath() + module->getPrintSourceFileName(),
+        module->getPrintHeaderFilePath() + module->getPrintHeaderFileName(),
+        module->getMapSourceFilePath() + module->getMapSourceFileName(),
+        module->getMapHeaderFilePath() + module->getMapHeaderFileName(),
+        module->getJsonSourceFilePath() + module->getJsonSourceFileName(),
+        module->getJsonHeaderFilePath() + module->getJsonHeaderFileName()};
+
+    cache.update(module->getCacheKey(), module->getCacheFingerprint(), files);
+
+}// ProtocolParser::updateCache
+
+
 /*!
  * Create the header file for the top level module of the protocol
  * \param docElem is the "protocol" element from the DOM
@@ -696,6 +1359,45 @@ void ProtocolParser::finishProtocolHeader(void)
 
     header->makeLineSeparator();
 
+    // The segment list of the gather encode functions, and the state of the stream functions
+    bool gather = false;
+    bool stream = false;
+    for(std::size_t i = 0; i < packets.size(); i++)
+    {
+        if(packets.at(i)->usesGather())
+            gather = true;
+
+        if(packets.at(i)->usesStream())
+            stream = true;
+    }
+
+    if(gather)
+    {
+        header->write("//! One piece of the data of a packet, like a struct iovec\n");
+        header->write("typedef struct\n");
+        header->write("{\n");
+        header->write("    const uint8_t* data; //!< The bytes of this segment\n");
+        header->write("    int size;            //!< The number of bytes of this segment\n");
+        header->write("}" + name + "Segment" + support.typeSuffix + ";\n");
+        header->write("\n");
+    }
+
+    if(stream)
+    {
+        header->write("//! The progress of a stream encode or decode, which must be all zero to start\n");
+        header->write("typedef struct\n");
+        header->write("{\n");
+        header->write("    int field;       //!< The index of the field being encoded or decoded\n");
+        header->write("    unsigned i;      //!< The first array index of the field\n");
+        header->write("    unsigned j;      //!< The second array index of the field\n");
+        header->write("    int index;       //!< The index of the next byte of the element in data\n");
+        header->write("    int length;      //!< The number of bytes of the element in data\n");
+        header->write("    int complete;    //!< Set once the last byte of the packet data is encoded or decoded\n");
+        header->write("    uint8_t data[8]; //!< The bytes of one element, which may span chunks\n");
+        header->write("}" + name + "Stream" + support.typeSuffix + ";\n");
+        header->write("\n");
+    }
+
     // We want these prototypes to be the last things written to the file, because support.pointerType may be defined above
     header->write("\n");
     header->write("// The prototypes below provide an interface to the packets.\n");
@@ -717,6 +1419,14 @@ void ProtocolParser::finishProtocolHeader(void)
     header->write("uint32_t get" + name + "PacketID(const " + support.pointerType + " pkt);\n");
     header->write("\n");
 
+    if(gather)
+    {
+        header->write("//! Complete a packet whose data are a list of segments, the checksum must cover all of the segments.\n");
+        header->write("//! The list has room for a header segment before the data and a checksum segment after. Return the number of segments\n");
+        header->write("int finish" + name + "PacketSegments(" + support.pointerType + " pkt, " + name + "Segment" + support.typeSuffix + "* segments, int count, uint32_t packetID);\n");
+        header->write("\n");
+    }
+
     header->flush();
 }
 
@@ -949,7 +1659,7 @@ void ProtocolParser::parseEnumerations(const std::string& parent, const XMLNode*
  */
 const EnumCreator* ProtocolParser::parseEnumeration(const std::string& parent, const XMLElement* element, bool nocode)
 {
-    EnumCreator* Enum = new EnumCreator(this, parent, support);
+    EnumCreator* Enum = new EnumCreator(this, parent, std::make_shared<const ProtocolSupport>(support));
 
     Enum->setElement(element);
     Enum->parse(nocode);
@@ -1041,6 +1751,8 @@ void ProtocolParser::outputIncludes(const std::string& parent, ProtocolFile& fil
  */
 std::string ProtocolParser::lookUpIncludeFilenameForImplementation(const std::string& typeName) const
 {
+    ProtocolStats::count("Include lookups");
+
     for(std::size_t i = 0; i < structures.size(); i++)
     {
         if(structures.at(i)->typeName == typeName)
@@ -1073,6 +1785,13 @@ std::string ProtocolParser::lookUpIncludeFilenameForImplementation(const std::st
  */
 std::string ProtocolParser::lookUpIncludeFilenameForDefinition(const std::string& typeName) const
 {
+    ProtocolStats::count("Include lookups");
+
+    // Array sizes are usually numbers, which can never name a type or an
+    // enumeration. Don't search every module for them.
+    if(typeName.empty() || (!std::isalpha((unsigned char)typeName.front()) && (typeName.front() != '_')))
+        return std::string();
+
     for(std::size_t i = 0; i < globalEnums.size(); i++)
     {
         if((globalEnums.at(i)->getName() == typeName) || globalEnums.at(i)->isEnumerationValue(typeName))
@@ -1101,6 +1820,26 @@ std::string ProtocolParser::lookUpIncludeFilenameForDefinition(const std::string
 }
 
 
+/*!
+ * Find the index of a packet in the list of all packets, which is the order
+ * the packets appear in the protocol.
+ * \param packet is the packet to find.
+ * 
+eturn the index of the packet, or -1 if it is not in the list
+ */
+int ProtocolParser::getPacketIndex(const ProtocolPacket* packet) const
+{
+    for(std::size_t i = 0; i < packets.size(); i++)
+    {
+        if(packets.at(i) == packet)
+            return (int)i;
+    }
+
+    return -1;
+
+}// ProtocolParser::getPacketIndex
+
+
 /*!
  * Find the global structure pointer for a specific type
  * \param typeName is the type to lookup
@@ -1108,6 +1847,8 @@ std::string ProtocolParser::lookUpIncludeFilenameForDefinition(const std::string
  */
 const ProtocolStructureModule* ProtocolParser::lookUpStructure(const std::string& typeName) const
 {
+    ProtocolStats::count("Structure lookups");
+
     for(std::size_t i = 0; i < structures.size(); i++)
     {
         if(structures.at(i)->typeName == typeName)
@@ -1136,6 +1877,8 @@ const ProtocolStructureModule* ProtocolParser::lookUpStructure(const std::string
  */
 const EnumCreator* ProtocolParser::lookUpEnumeration(const std::string& enumName) const
 {
+    ProtocolStats::count("Enumeration lookups");
+
     for(std::size_t i = 0; i < globalEnums.size(); i++)
     {
         if(globalEnums.at(i)->getName() == enumName)
@@ -1163,6 +1906,8 @@ const EnumCreator* ProtocolParser::lookUpEnumeration(const std::string& enumName
  */
 std::string ProtocolParser::replaceEnumerationNameWithValue(const std::string& text) const
 {
+    ProtocolStats::count("Enumeration replacements");
+
     std::string replace = text;
 
     for(std::size_t i = 0; i < globalEnums.size(); i++)
@@ -1368,6 +2113,22 @@ void ProtocolParser::outputDBC(void)
 }// ProtocolParser::outputDBC
 
 
+/*!
+ * Output the report of the encoded size and bandwidth of each packet, as
+ * markdown, CSV, and JSON files
+ */
+void ProtocolParser::outputRateReport(void)
+{
+    std::string basepath = support.outputpath;
+
+    if (!docsDir.empty())
+        basepath = docsDir;
+
+    ProtocolRateReport(this, support, framing, linkRate).generate(basepath, name, title, packets);
+
+}// ProtocolParser::outputRateReport
+
+
 /*!
  * Ouptut documentation for the protocol as a markdown file
  * \param inlinecss is the css to use for the markdown output, if blank use default.
@@ -1494,6 +2255,7 @@ void ProtocolParser::outputMarkdown(std::string inlinecss)
     // Write html documentation
     std::string htmlfile =  basepath + name + ".html";
     std::cout << "Writing HTML documentation to " << htmlfile << std::endl;
+    ProtocolStats::Timer multimarkdowntimer("Multimarkdown");
     #if defined(__APPLE__) && defined(__MACH__)
     std::system(("/usr/local/bin/MultiMarkdown " + filename + " > " + htmlfile).c_str());
     #else
@@ -1629,7 +2391,7 @@ most of the work of encoding data from memory to the wire, and vice versa.\n";
     else
         output += "Data for this protocol are sent in LITTLE endian format. Any field larger than one byte is sent with the least signficant byte first, and the most significant byte last. However bitfields are always sent most significant bits first.\n\n";
 
-    output += "Data can be encoded as unsigned integers, signed integers (two's complement), bitfields, and floating point.\n";
+    output += "Data can be encoded as unsigned integers, signed integers (two's complement), variable length integers, bitfields, and floating point.\n";
     output += "\n";
 
     output += "\
@@ -1637,6 +2399,8 @@ most of the work of encoding data from memory to the wire, and vice versa.\n";
 | :--------------------------: | ------------------------------------- | --------------------------------------------------------------------------- |\n\
 | UX                           | Unsigned integer X bits long          | X must be: 8, 16, 24, 32, 40, 48, 56, or 64                                 |\n\
 | IX                           | Signed integer X bits long            | X must be: 8, 16, 24, 32, 40, 48, 56, or 64                                 |\n\
+| VUX                          | Unsigned variable length integer      | X is 32 or 64. 7 bits per byte, top bit set if more bytes follow            |\n\
+| VIX                          | Signed variable length integer        | As VUX after zigzag encoding: 0, -1, 1, -2... are sent as 0, 1, 2, 3...     |\n\
 | BX                           | Unsigned integer bitfield X bits long | X must be greater than 0 and less than 32                                   |\n\
 | F16:X                        | 16 bit float with X significand bits  | 1 sign bit : 15-X exponent bits : X significant bits with implied leading 1 |\n\
 | F24:X                        | 24 bit float with X significand bits  | 1 sign bit : 23-X exponent bits : X significant bits with implied leading 1 |\n\
@@ -1962,6 +2726,11 @@ void ProtocolParser::setDBCOptions(std::string _dbcfile, std::string _dbcidtx, s
  */
 void ProtocolParser::outputDoxygen(void)
 {
+    // The doxygen configuration files are written to the working directory,
+    // so protocols generated at the same time must take turns
+    static std::mutex doxygenmutex;
+    std::lock_guard<std::mutex> lock(doxygenmutex);
+
     std::string fileName = "ProtocolDoxyfile";
     std::fstream file(fileName, std::ios_base::out);
 
@@ -3,7 +3,13 @@
 
 #include "protocolfile.h"
 #include "protocolsupport.h"
+#include "protocolcache.h"
 #include "tinyxml2.h"
+#include <map>
+#include <memory>
+#include <future>
+#include <mutex>
+#include <set>
 
 // Forward declarations
 class ProtocolDocumentation;
@@ -15,6 +21,9 @@ class EnumCreator;
 class ProtocolParser
 {
 public:
+    //! An XML document which is never changed once it is loaded, so it can be shared
+    typedef std::shared_ptr<const tinyxml2::XMLDocument> SharedDocument;
+
     ProtocolParser();
     ~ProtocolParser();
 
@@ -48,6 +57,9 @@ public:
     //! Option to disable doxygen output
     void disableDoxygen(bool disable) {nodoxygen = disable;}
 
+    //! Option to enable the report of packet sizes and rates
+    void enableRateReport(bool enable) {ratereport = enable;}
+
     //! Option to disable 'about this ICD' section
     void disableAboutSection(bool disable) { noAboutSection = disable; }
 
@@ -75,6 +87,24 @@ public:
     //! Disable CSS entirely
     void disableCSS(bool disable) { nocss = disable; }
 
+    //! Set the directory of the regeneration cache, empty to disable the cache
+    void setCacheDirectory(std::string path) {cache.setDirectory(path);}
+
+    //! Get the absolute names of the xml files that were parsed
+    const std::vector<std::string>& getFilesParsed(void) const {return filesparsed;}
+
+    //! Forget which helper files were generated, so the next protocol generates them again
+    static void forgetHelperFiles(void);
+
+    //! Load XML files once, to be shared by the protocols generated at the same time
+    static void shareFiles(const std::vector<std::string>& xmlFilenames);
+
+    //! Release the XML files shared by the protocols generated at the same time
+    static void forgetSharedFiles(void);
+
+    //! Get the absolute name of an XML file, which is used to identify it
+    static std::string getAbsoluteFileName(const std::string& xmlFilename);
+
     //! Parse the DOM from the xml file(s). This kicks off the auto code generation for the protocol
     bool parse(std::string filename, std::string path, std::vector<std::string> otherfiles);
 
@@ -114,6 +144,9 @@ public:
     //! Find the include filename for the definition of a specific type
     std::string lookUpIncludeFilenameForDefinition(const std::string& typeName) const;
 
+    //! Find the index of a packet in the list of all packets
+    int getPacketIndex(const ProtocolPacket* packet) const;
+
     //! Find the enumeration creator for this enum
     const EnumCreator* lookUpEnumeration(const std::string& enumName) const;
 
@@ -169,12 +202,36 @@ protected:
     //! Parses a single XML file handling any require tags to flatten a file
     bool parseFile(std::string xmlFilename);
 
+    //! Start loading and parsing an XML file in the background
+    void preloadFile(const std::string& xmlFilename);
+
+    //! Get the document of an XML file, waiting for it if it is being loaded in the background
+    SharedDocument takeLoadedFile(const std::string& xmlFilename);
+
+    //! Read and parse an XML file
+    static SharedDocument loadFile(const std::string& xmlFilename);
+
+    //! Get a document shared by the protocols generated at the same time
+    static SharedDocument findSharedFile(const std::string& absolutepathname);
+
+    //! Resolve every string in a document, so it can be read from more than one thread
+    static void resolveStrings(const tinyxml2::XMLNode* node);
+
+    //! Release the XML documents, once everything has been parsed from them
+    void releaseXml(void);
+
+    //! Get the name of the file required by a "Require" tag
+    static std::string getRequiredFileName(const XMLElement* element, const std::string& xmlFilename);
+
     //! Create DBC file
     void outputDBC(void);
 
     //! Create markdown documentation
     void outputMarkdown(std::string inlinecss);
 
+    //! Create the report of packet sizes and rates
+    void outputRateReport(void);
+
     //! Get the table of contents, based on the file contents
     std::string getTableOfContents(const std::string& filecontents);
 
@@ -184,14 +241,32 @@ protected:
     //! Output the doxygen HTML documentation
     void outputDoxygen(void);
 
+    //! Compute the fingerprint of everything other than the contents of the modules
+    std::string getLayoutFingerprint(void);
+
+    //! Remember the identifiers defined by a module, so other modules can depend on it
+    void mapModuleIdentifiers(const XMLElement* module, const XMLElement* element);
+
+    //! Compute the fingerprint of a module and all the modules it depends on
+    std::string getModuleFingerprint(const XMLElement* element) const;
+
+    //! Get the unique name of a module in the cache
+    static std::string getCacheKey(const XMLElement* element);
+
+    //! Determine if a module is current in the cache and can be skipped
+    void setModuleCached(ProtocolStructureModule* module, const std::vector<std::string>& reservedFiles);
+
+    //! Record the output files of a module in the cache
+    void updateCache(ProtocolStructureModule* module);
+
     //! Protocol support information
     ProtocolSupport support;
 
     //! The list of xml documents we created by loading files
-    std::vector<tinyxml2::XMLDocument*> xmldocs;
+    std::vector<SharedDocument> xmldocs;
 
     //! The document currently being parsed
-    tinyxml2::XMLDocument* currentxml;
+    const tinyxml2::XMLDocument* currentxml;
 
     //! The protocol header file (*.h)
     ProtocolHeaderFile* header;
@@ -199,6 +274,8 @@ protected:
     std::string name;   //!< Base name of the protocol
     std::string title;  //!< Title name of the protocol used in documentation
     std::string comment;//!< Comment description of the protocol
+    std::string framing;//!< Bytes of framing overhead of each packet, used for the rate report
+    std::string linkRate;//!< Bytes per second of the link, used for the rate report
 
     std::string docsDir;//!< Directory target for storing documentation markdown
 
@@ -209,6 +286,7 @@ protected:
     bool nohelperfiles; //!< Disable helper file output
     bool nodoxygen;     //!< Disable doxygen output
     bool noAboutSection;//!< Disable extra 'about' section in the generated documentation
+    bool ratereport;    //!< Enable the report of packet sizes and rates
 
     std::string inlinecss;  //!< CSS used for markdown output
     bool nocss;         //!< Disable all CSS output
@@ -216,12 +294,22 @@ protected:
     std::string titlePage;     //!< Title page information
 
     std::vector<std::string> filesparsed;
+    std::map<std::string, std::future<SharedDocument>> filesloading; //!< Files being loaded in the background, by absolute name
+
+    static std::mutex helpermutex;                      //!< Protects the helper files of protocols generated at the same time
+    static std::set<std::string> helperfingerprints;    //!< Options of the helper files already generated in this run
+    static std::mutex sharedmutex;                      //!< Protects the documents shared by protocols generated at the same time
+    static std::map<std::string, SharedDocument> shareddocuments; //!< Documents shared by protocols generated at the same time, by absolute name
     std::vector<ProtocolDocumentation*> alldocumentsinorder;
     std::vector<ProtocolDocumentation*> documents;
     std::vector<ProtocolStructureModule*> structures;
     std::vector<ProtocolPacket*> packets;
     std::vector<EnumCreator*> enums;
     std::vector<EnumCreator*> globalEnums;
+
+    ProtocolCache cache;    //!< Fingerprints of modules from the previous run
+    std::map<std::string, const XMLElement*> moduleIdentifiers; //!< Modules by the identifiers they define
+
     std::string inputpath;
     std::string inputfile;
 
@@ -0,0 +1,329 @@
+#include "protocolratereport.h"
+#include "protocolparser.h"
+#include "protocolpacket.h"
+#include "protocolfile.h"
+#include "encodedlength.h"
+#include "shuntingyard.h"
+#include "protocolstats.h"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+
+/*!
+ * Construct the report
+ * \param protocolparser is the parser, used to look up enumeration values.
+ * \param protocolsupport are the protocol options.
+ * \param framingString gives the bytes of framing overhead (header,
+ *        identifier, length, and checksum) added to every packet.
+ * \param linkRateString gives the bytes per second of the link.
+ */
+ProtocolRateReport::ProtocolRateReport(const ProtocolParser* protocolparser, ProtocolSupport protocolsupport, const std::string& framingString, const std::string& linkRateString) :
+    parser(protocolparser),
+    support(protocolsupport),
+    framing(0),
+    linkRate(0),
+    totalTypical(0),
+    totalMax(0)
+{
+    if(!framingString.empty() && (!computeLength(framingString, framing) || (framing < 0)))
+    {
+        std::cerr << support.sourcefile << ": warning: framing \"" << framingString << "\" cannot be computed, using 0" << std::endl;
+        framing = 0;
+    }
+
+    if(!linkRateString.empty() && (!computeLength(linkRateString, linkRate) || (linkRate <= 0)))
+    {
+        std::cerr << support.sourcefile << ": warning: linkRate \"" << linkRateString << "\" cannot be computed" << std::endl;
+        linkRate = 0;
+    }
+
+}// ProtocolRateReport::ProtocolRateReport
+
+
+/*!
+ * Compute the sizes and rates of the packets, and write the markdown, CSV, and JSON reports
+ * \param basepath is the path of the report files.
+ * \param name is the name of the protocol, which is the start of the file names.
+ * \param title is the title of the protocol, used in the markdown.
+ * \param packets are all the packets, in the order of the protocol.
+ */
+void ProtocolRateReport::generate(const std::string& basepath, const std::string& name, const std::string& title, const std::vector<ProtocolPacket*>& packets)
+{
+    entries.clear();
+    totalTypical = totalMax = 0;
+
+    for(const ProtocolPacket* packet : packets)
+    {
+        Entry entry = computeEntry(packet);
+
+        if(entry.known && entry.hasRate)
+        {
+            totalTypical += entry.typical*entry.rate;
+            totalMax += entry.max*entry.rate;
+        }
+
+        entries.push_back(entry);
+    }
+
+    writeMarkdown(basepath + name + "Rates.markdown", title);
+    writeCSV(basepath + name + "Rates.csv");
+    writeJSON(basepath + name + "Rates.json", name);
+
+}// ProtocolRateReport::generate
+
+
+/*!
+ * Compute the sizes and rates of one packet. The typical size is halfway
+ * between the minimum and maximum size, all sizes include the framing.
+ * \param packet is the packet to compute.
+ * \return the sizes and rates of the packet.
+ */
+ProtocolRateReport::Entry ProtocolRateReport::computeEntry(const ProtocolPacket* packet) const
+{
+    Entry entry;
+    std::vector<std::string> ids;
+
+    packet->appendIds(ids);
+
+    entry.name = packet->name;
+    entry.id = join(ids, " ");
+    entry.minLength = EncodedLength::collapseLengthString(packet->encodedLength.minEncodedLength, true);
+    entry.maxLength = EncodedLength::collapseLengthString(packet->encodedLength.maxEncodedLength, true);
+    entry.min = entry.typical = entry.max = 0;
+    entry.rate = 0;
+    entry.fieldBytes = 0;
+    entry.dominant = false;
+
+    entry.known = computeLength(entry.minLength, entry.min) && computeLength(entry.maxLength, entry.max);
+
+    // The largest field is judged by the data only, without the framing
+    for(const Encodable* encodable : packet->getEncodables())
+    {
+        double bytes = 0;
+
+        if(encodable->isNotEncoded() || !computeLength(encodable->encodedLength.maxEncodedLength, bytes))
+            continue;
+
+        if(entry.field.empty() || (bytes > entry.fieldBytes))
+        {
+            entry.field = encodable->name;
+            entry.fieldBytes = bytes;
+        }
+    }
+
+    if(entry.known && (entry.max > 0))
+        entry.dominant = (entry.fieldBytes > 0.5*entry.max);
+
+    if(entry.known)
+    {
+        entry.min += framing;
+        entry.max += framing;
+        entry.typical = std::ceil((entry.min + entry.max)/2);
+    }
+
+    entry.hasRate = !packet->getRate().empty();
+    if(entry.hasRate && (!computeLength(packet->getRate(), entry.rate) || (entry.rate < 0)))
+    {
+        std::cerr << support.sourcefile << ": warning: rate \"" << packet->getRate() << "\" of packet " << packet->name << " cannot be computed" << std::endl;
+        entry.hasRate = false;
+        entry.rate = 0;
+    }
+
+    return entry;
+
+}// ProtocolRateReport::computeEntry
+
+
+/*!
+ * Compute the number of bytes of an encoded length string
+ * \param length is the length string, which may use enumerations.
+ * \param bytes receives the number of bytes.
+ * \return true if the length could be computed.
+ */
+bool ProtocolRateReport::computeLength(const std::string& length, double& bytes) const
+{
+    bool ok = false;
+
+    std::string collapsed = EncodedLength::collapseLengthString(length, true);
+
+    if(collapsed.empty())
+    {
+        bytes = 0;
+        return true;
+    }
+
+    bytes = ShuntingYard::computeInfix(parser->replaceEnumerationNameWithValue(collapsed), &ok);
+
+    return ok;
+
+}// ProtocolRateReport::computeLength
+
+
+/*!
+ * Write the markdown report, with one table row per packet and the totals of the link
+ * \param filename is the name of the file to write.
+ * \param title is the title of the protocol.
+ */
+void ProtocolRateReport::writeMarkdown(const std::string& filename, const std::string& title) const
+{
+    ProtocolFile file(filename, support, false);
+
+    file.write("# " + title + " packet rates\n\n");
+    file.write("Sizes are in bytes and include " + getNumberString(framing) + " bytes of framing per packet. ");
+    file.write("The typical size is halfway between the minimum and maximum size. ");
+    file.write("The largest field is in bold if it is more than half of the data of the packet.\n\n");
+
+    file.write("| Packet | ID | Min | Typical | Max | Rate (Hz) | Typical bytes/s | Max bytes/s | Largest field |\n");
+    file.write("| :--- | :--- | ---: | ---: | ---: | ---: | ---: | ---: | :--- |\n");
+
+    for(const Entry& entry : entries)
+    {
+        std::string field = entry.field;
+
+        if(!field.empty())
+        {
+            field += " (" + getNumberString(entry.fieldBytes) + ")";
+
+            if(entry.dominant)
+                field = "**" + field + "**";
+        }
+
+        file.write("| " + entry.name + " | " + entry.id + " | ");
+
+        if(entry.known)
+            file.write(getNumberString(entry.min) + " | " + getNumberString(entry.typical) + " | " + getNumberString(entry.max) + " | ");
+        else
+            file.write(entry.minLength + " | | " + entry.maxLength + " | ");
+
+        if(entry.hasRate)
+        {
+            file.write(getNumberString(entry.rate) + " | ");
+
+            if(entry.known)
+                file.write(getNumberString(entry.typical*entry.rate) + " | " + getNumberString(entry.max*entry.rate) + " | ");
+            else
+                file.write("| | ");
+        }
+        else
+            file.write("| | | ");
+
+        file.write(field + " |\n");
+    }
+
+    file.write("\nThe packets with a rate use " + getNumberString(totalTypical) + " bytes per second typical, and " + getNumberString(totalMax) + " bytes per second maximum");
+
+    if(linkRate > 0)
+        file.write(", which is " + getNumberString(100*totalTypical/linkRate) + "% and " + getNumberString(100*totalMax/linkRate) + "% of the link rate of " + getNumberString(linkRate) + " bytes per second");
+
+    file.write(".\n");
+
+}// ProtocolRateReport::writeMarkdown
+
+
+/*!
+ * Write the comma separated value report, with one line per packet. Values
+ * which cannot be computed are empty.
+ * \param filename is the name of the file to write.
+ */
+void ProtocolRateReport::writeCSV(const std::string& filename) const
+{
+    ProtocolFile file(filename, support, false);
+
+    file.write("packet,id,min,typical,max,rate,typicalBytesPerSecond,maxBytesPerSecond,largestField,largestFieldBytes,dominant\n");
+
+    for(const Entry& entry : entries)
+    {
+        file.write(entry.name + "," + entry.id + ",");
+
+        if(entry.known)
+            file.write(getNumberString(entry.min) + "," + getNumberString(entry.typical) + "," + getNumberString(entry.max) + ",");
+        else
+            file.write(",,,");
+
+        if(entry.hasRate)
+            file.write(getNumberString(entry.rate));
+
+        file.write(",");
+
+        if(entry.hasRate && entry.known)
+            file.write(getNumberString(entry.typical*entry.rate) + "," + getNumberString(entry.max*entry.rate));
+        else
+            file.write(",");
+
+        file.write("," + entry.field + "," + getNumberString(entry.fieldBytes) + "," + (entry.dominant ? "true" : "false") + "\n");
+    }
+
+}// ProtocolRateReport::writeCSV
+
+
+/*!
+ * Write the JSON report. Values which cannot be computed are null.
+ * \param filename is the name of the file to write.
+ * \param name is the name of the protocol.
+ */
+void ProtocolRateReport::writeJSON(const std::string& filename, const std::string& name) const
+{
+    ProtocolFile file(filename, support, false);
+
+    file.write("{\n");
+    file.write("  \"protocol\": \"" + ProtocolStats::escape(name) + "\",\n");
+    file.write("  \"framing\": " + getNumberString(framing) + ",\n");
+    file.write("  \"linkRate\": " + (linkRate > 0 ? getNumberString(linkRate) : std::string("null")) + ",\n");
+    file.write("  \"packets\": [");
+
+    for(std::size_t i = 0; i < entries.size(); i++)
+    {
+        const Entry& entry = entries.at(i);
+
+        if(i > 0)
+            file.write(",");
+
+        file.write("\n    {\"name\": \"" + ProtocolStats::escape(entry.name) + "\", \"id\": \"" + ProtocolStats::escape(entry.id) + "\", ");
+
+        if(entry.known)
+            file.write("\"min\": " + getNumberString(entry.min) + ", \"typical\": " + getNumberString(entry.typical) + ", \"max\": " + getNumberString(entry.max) + ", ");
+        else
+            file.write("\"min\": null, \"typical\": null, \"max\": null, ");
+
+        file.write("\"rate\": " + (entry.hasRate ? getNumberString(entry.rate) : std::string("null")) + ", ");
+
+        if(entry.hasRate && entry.known)
+            file.write("\"typicalBytesPerSecond\": " + getNumberString(entry.typical*entry.rate) + ", \"maxBytesPerSecond\": " + getNumberString(entry.max*entry.rate) + ", ");
+        else
+            file.write("\"typicalBytesPerSecond\": null, \"maxBytesPerSecond\": null, ");
+
+        file.write("\"largestField\": \"" + ProtocolStats::escape(entry.field) + "\", \"largestFieldBytes\": " + getNumberString(entry.fieldBytes) + ", \"dominant\": " + (entry.dominant ? "true" : "false") + "}");
+    }
+
+    file.write("\n  ],\n");
+    file.write("  \"typicalBytesPerSecond\": " + getNumberString(totalTypical) + ",\n");
+    file.write("  \"maxBytesPerSecond\": " + getNumberString(totalMax) + "\n");
+    file.write("}\n");
+
+}// ProtocolRateReport::writeJSON
+
+
+/*!
+ * Get a number formatted for the reports, without exponents or trailing zeros
+ * \param number is the number to format.
+ * \return the formatted number.
+ */
+std::string ProtocolRateReport::getNumberString(double number)
+{
+    std::stringstream stream;
+
+    stream << std::fixed << std::setprecision(3) << number;
+
+    std::string output = stream.str();
+
+    // Remove trailing zeros, and the decimal point if nothing follows it
+    while(endsWith(output, "0"))
+        output.pop_back();
+
+    if(endsWith(output, "."))
+        output.pop_back();
+
+    return output;
+
+}// ProtocolRateReport::getNumberString
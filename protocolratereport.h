@@ -0,0 +1,72 @@
+#ifndef PROTOCOLRATEREPORT_H
+#define PROTOCOLRATEREPORT_H
+
+/*!
+ * \file
+ * Report of the encoded size and bandwidth of each packet of a protocol
+ */
+
+#include "protocolsupport.h"
+#include <string>
+#include <vector>
+
+class ProtocolParser;
+class ProtocolPacket;
+
+class ProtocolRateReport
+{
+public:
+    //! Construct the report, with the framing overhead and link rate of the protocol
+    ProtocolRateReport(const ProtocolParser* protocolparser, ProtocolSupport protocolsupport, const std::string& framingString, const std::string& linkRateString);
+
+    //! Compute the sizes and rates of the packets, and write the reports
+    void generate(const std::string& basepath, const std::string& name, const std::string& title, const std::vector<ProtocolPacket*>& packets);
+
+protected:
+
+    //! Sizes and rates of one packet
+    struct Entry
+    {
+        std::string name;       //!< Name of the packet
+        std::string id;         //!< Identifiers of the packet
+        std::string minLength;  //!< Minimum encoded length string
+        std::string maxLength;  //!< Maximum encoded length string
+        bool known;             //!< true if the lengths could be computed
+        double min;             //!< Minimum bytes including framing
+        double typical;         //!< Typical bytes including framing
+        double max;             //!< Maximum bytes including framing
+        bool hasRate;           //!< true if the packet has a rate
+        double rate;            //!< Packets per second
+        std::string field;      //!< Name of the field with the largest maximum encoding
+        double fieldBytes;      //!< Maximum bytes of the largest field
+        bool dominant;          //!< true if the largest field is more than half the data of the packet
+    };
+
+    //! Compute the sizes and rates of one packet
+    Entry computeEntry(const ProtocolPacket* packet) const;
+
+    //! Compute the number of bytes of an encoded length string
+    bool computeLength(const std::string& length, double& bytes) const;
+
+    //! Write the markdown report
+    void writeMarkdown(const std::string& filename, const std::string& title) const;
+
+    //! Write the comma separated value report
+    void writeCSV(const std::string& filename) const;
+
+    //! Write the JSON report
+    void writeJSON(const std::string& filename, const std::string& name) const;
+
+    //! Get a number formatted for the reports
+    static std::string getNumberString(double number);
+
+    const ProtocolParser* parser;
+    ProtocolSupport support;
+    double framing;     //!< Bytes of framing overhead added to every packet
+    double linkRate;    //!< Bytes per second of the link, 0 if unknown
+    std::vector<Entry> entries;
+    double totalTypical;//!< Typical bytes per second of all packets with a rate
+    double totalMax;    //!< Maximum bytes per second of all packets with a rate
+};
+
+#endif // PROTOCOLRATEREPORT_H
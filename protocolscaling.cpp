@@ -463,6 +463,36 @@ bool ProtocolScaling::areTypesSupported(inmemorytypes_t inmemory, encodedtypes_t
 }
 
 
+/*!
+ * Determine the integer type used for variable length encoding of an in-memory
+ * type. Variable length encodings are 32 bits wide, unless the in-memory type
+ * is 64 bits wide and 64-bit integers are supported.
+ * \param inmemory is the in-memory type.
+ * \param issigned should be true for the signed (zigzag) encoding.
+ * \return the encoded integer type.
+ */
+ProtocolScaling::encodedtypes_t ProtocolScaling::varintType(inmemorytypes_t inmemory, bool issigned) const
+{
+    if((typeLength(inmemory) > 4) && support.int64)
+        return createEncodedType(issigned, 8);
+    else
+        return createEncodedType(issigned, 4);
+}
+
+
+//! Return the name in function signature of a byte order
+std::string ProtocolScaling::orderSigName(byteorder_t order) const
+{
+    switch(order)
+    {
+    default:
+    case littleendianorder: return "Le";
+    case bigendianorder:    return "Be";
+    case varintorder:       return "Var";
+    }
+}
+
+
 /*!
  * Construct the protocol scaling object
  */
@@ -570,7 +600,14 @@ scaledencode does not include routines that increase the resolution of the
 inmemory value. For example the function floatScaledTo5UnsignedBeBytes() does
 not exist, because expanding a float to 5 bytes does not make any resolution
 improvement over encoding it in 4 bytes. In general the encoded format
-must be equal to or less than the number of bytes of the raw data.)";
+must be equal to or less than the number of bytes of the raw data.
+
+Values can also be scaled to a variable length integer, which is 32 bits wide
+(64 bits for 64-bit inmemory types) but uses only as many bytes as the scaled
+value needs. Signed variable length integers are zigzag encoded, so small
+negative numbers are also short. For example a counter of tenths of a second:
+
+float32ScaledTo4UnsignedVarBytes(time, bytestream, &index, 0, 10);)";
 
     // Document the protocol generation options
     filecomment += "\n\nCode generation for this module was affected by these global flags:\n\n";
@@ -627,19 +664,33 @@ must be equal to or less than the number of bytes of the raw data.)";
 
             // big endian
             header.write("\n");
-            header.write("//! " + briefEncodeComment(inmemorytype, encodedtype, true) + "\n");
-            header.write(encodeSignature(inmemorytype, encodedtype, true) + ";\n");
+            header.write("//! " + briefEncodeComment(inmemorytype, encodedtype, bigendianorder) + "\n");
+            header.write(encodeSignature(inmemorytype, encodedtype, bigendianorder) + ";\n");
 
             // little endian
             if((typeLength(encodedtype) > 1) && !isTypeBitfield(encodedtype))
             {
                 header.write("\n");
-                header.write("//! " + briefEncodeComment(inmemorytype, encodedtype, false) + "\n");
-                header.write(encodeSignature(inmemorytype, encodedtype, false) + ";\n");
+                header.write("//! " + briefEncodeComment(inmemorytype, encodedtype, littleendianorder) + "\n");
+                header.write(encodeSignature(inmemorytype, encodedtype, littleendianorder) + ";\n");
             }
 
         }// for all encodeds
 
+        // Variable length encodings, unsigned and then signed. These are only
+        // 64 bits when the inmemory type is, so the protection above is correct
+        for(int k = 0; k < 2; k++)
+        {
+            encodedtypes_t encodedtype = varintType(inmemorytype, k == 1);
+
+            if(!areTypesSupported(inmemorytype, encodedtype))
+                continue;
+
+            header.write("\n");
+            header.write("//! " + briefEncodeComment(inmemorytype, encodedtype, varintorder) + "\n");
+            header.write(encodeSignature(inmemorytype, encodedtype, varintorder) + ";\n");
+        }
+
     }// for all inmemorys
 
     header.write("\n");
@@ -696,19 +747,33 @@ bool ProtocolScaling::generateEncodeSource(void)
 
             // big endian
             source.write("\n");
-            source.write(fullEncodeComment(inmemorytype, encodedtype, true) + "\n");
-            source.write(fullEncodeFunction(inmemorytype, encodedtype, true) + "\n");
+            source.write(fullEncodeComment(inmemorytype, encodedtype, bigendianorder) + "\n");
+            source.write(fullEncodeFunction(inmemorytype, encodedtype, bigendianorder) + "\n");
 
             // little endian
             if((typeLength(encodedtype) > 1) && !isTypeBitfield(encodedtype))
             {
                 source.write("\n");
-                source.write(fullEncodeComment(inmemorytype, encodedtype, false) + "\n");
-                source.write(fullEncodeFunction(inmemorytype, encodedtype, false) + "\n");
+                source.write(fullEncodeComment(inmemorytype, encodedtype, littleendianorder) + "\n");
+                source.write(fullEncodeFunction(inmemorytype, encodedtype, littleendianorder) + "\n");
             }
 
         }// for all output byte counts
 
+        // Variable length encodings, unsigned and then signed. These are only
+        // 64 bits when the inmemory type is, so the protection above is correct
+        for(int k = 0; k < 2; k++)
+        {
+            encodedtypes_t encodedtype = varintType(inmemorytype, k == 1);
+
+            if(!areTypesSupported(inmemorytype, encodedtype))
+                continue;
+
+            source.write("\n");
+            source.write(fullEncodeComment(inmemorytype, encodedtype, varintorder) + "\n");
+            source.write(fullEncodeFunction(inmemorytype, encodedtype, varintorder) + "\n");
+        }
+
     }// for all input types
 
     source.write("\n");
@@ -725,10 +790,10 @@ bool ProtocolScaling::generateEncodeSource(void)
  * Create the brief function comment, without doxygen decorations.
  * \param inmemory is the type information for the inmemory (in-memory) data.
  * \param encoded is the type information for the encoded (encoded) data.
- * \param bigendian should be true if the function outputs big endian byte order.
+ * \param order is the byte order of the encoding.
  * \return The string that represents the one line function comment.
  */
-std::string ProtocolScaling::briefEncodeComment(inmemorytypes_t inmemory, encodedtypes_t encoded, bool bigendian) const
+std::string ProtocolScaling::briefEncodeComment(inmemorytypes_t inmemory, encodedtypes_t encoded, byteorder_t order) const
 {
     std::string scalingtype;
 
@@ -744,6 +809,15 @@ std::string ProtocolScaling::briefEncodeComment(inmemorytypes_t inmemory, encode
         else
             return std::string("Scale a " + typeName(inmemory) + " using " + scalingtype + " scaling to the base integer type used for bitfields.");
     }
+    else if(order == varintorder)
+    {
+        std::string bitCount = std::to_string(typeLength(encoded)*8);
+
+        if(isTypeSigned(encoded))
+            return std::string("Encode a " + typeName(inmemory) + " on a byte stream by " + scalingtype + " scaling to a signed " + bitCount + "-bit variable length integer.");
+        else
+            return std::string("Encode a " + typeName(inmemory) + " on a byte stream by " + scalingtype + " scaling to an unsigned " + bitCount + "-bit variable length integer.");
+    }
     else
     {
         if(typeLength(encoded) == 1)
@@ -759,7 +833,7 @@ std::string ProtocolScaling::briefEncodeComment(inmemorytypes_t inmemory, encode
             std::string byteLength = std::to_string(typeLength(encoded));
             std::string endian;
 
-            if(bigendian)
+            if(order == bigendianorder)
                 endian = "big";
             else
                 endian = "little";
@@ -779,16 +853,16 @@ std::string ProtocolScaling::briefEncodeComment(inmemorytypes_t inmemory, encode
  * Create the full encode function comment, with doxygen decorations
  * \param inmemory is the type information for the inmemory (in-memory) data.
  * \param encoded is the type information for the encoded (encoded) data.
- * \param bigendian should be true if the function outputs big endian byte order.
+ * \param order is the byte order of the encoding.
  * \return The string that represents the full multi-line function comment.
  */
-std::string ProtocolScaling::fullEncodeComment(inmemorytypes_t inmemory, encodedtypes_t encoded, bool bigendian) const
+std::string ProtocolScaling::fullEncodeComment(inmemorytypes_t inmemory, encodedtypes_t encoded, byteorder_t order) const
 {
     std::string comment= ("/*!\n");
 
     if(isTypeBitfield(encoded))
     {
-        comment += ProtocolParser::outputLongComment(" * ", briefEncodeComment(inmemory, encoded, bigendian)) + "\n";
+        comment += ProtocolParser::outputLongComment(" * ", briefEncodeComment(inmemory, encoded, order)) + "\n";
         comment += " * \\param value is the number to scale.\n";
         comment += " * \\param min is the minimum value that can be encoded.\n";
         comment += " * \\param scaler is multiplied by value to create the encoded integer.\n";
@@ -797,11 +871,14 @@ std::string ProtocolScaling::fullEncodeComment(inmemorytypes_t inmemory, encoded
     }
     else
     {
-        comment += ProtocolParser::outputLongComment(" * ", briefEncodeComment(inmemory, encoded, bigendian)) + "\n";
+        comment += ProtocolParser::outputLongComment(" * ", briefEncodeComment(inmemory, encoded, order)) + "\n";
         comment += " * \\param value is the number to encode.\n";
         comment += " * \\param bytes is a pointer to the byte stream which receives the encoded data.\n";
         comment += " * \\param index gives the location of the first byte in the byte stream, and\n";
-        comment += " *        will be incremented by " + std::to_string(typeLength(encoded)) + " when this function is complete.\n";
+        if(order == varintorder)
+            comment += " *        will be incremented by the number of bytes used, from 1 to " + std::to_string((typeLength(encoded)*8 + 6)/7) + ".\n";
+        else
+            comment += " *        will be incremented by " + std::to_string(typeLength(encoded)) + " when this function is complete.\n";
 
         if(isTypeSigned(encoded))
             comment += " * \\param scaler is multiplied by value to create the encoded integer: encoded = value*scaler.\n";
@@ -823,10 +900,10 @@ std::string ProtocolScaling::fullEncodeComment(inmemorytypes_t inmemory, encoded
  * Create the one line function signature, without a trailing semicolon
  * \param inmemory is the type information for the inmemory (in-memory) data.
  * \param encoded is the type information for the encoded (encoded) data.
- * \param bigendian should be true if the function outputs big endian byte order.
+ * \param order is the byte order of the encoding.
  * \return The string that represents the function signature, without a trailing semicolon
  */
-std::string ProtocolScaling::encodeSignature(inmemorytypes_t inmemory, encodedtypes_t encoded, bool bigendian) const
+std::string ProtocolScaling::encodeSignature(inmemorytypes_t inmemory, encodedtypes_t encoded, byteorder_t order) const
 {
     if(isTypeBitfield(encoded))
     {
@@ -846,12 +923,7 @@ std::string ProtocolScaling::encodeSignature(inmemorytypes_t inmemory, encodedty
     else
     {
         std::string byteLength = std::to_string(typeLength(encoded));
-        std::string endian;
-
-        if(bigendian)
-            endian = "Be";
-        else
-            endian = "Le";
+        std::string endian = orderSigName(order);
 
         if(isTypeSigned(encoded))
             return std::string("void " + typeSigName(inmemory) + "ScaledTo" + byteLength + "Signed" + endian + "Bytes(" + typeName(inmemory) + " value, uint8_t* bytes, int* index, " + typeName(convertTypeToUnsigned(inmemory)) + " scaler)");
@@ -867,17 +939,17 @@ std::string ProtocolScaling::encodeSignature(inmemorytypes_t inmemory, encodedty
  * Generate the full function output, excluding the comment
  * \param inmemory is the type information for the inmemory (in-memory) data.
  * \param encoded is the type information for the encoded (encoded) data.
- * \param bigendian should be true if the function outputs big endian byte order.
+ * \param order is the byte order of the encoding.
  * \return the function as a string
  */
-std::string ProtocolScaling::fullEncodeFunction(inmemorytypes_t inmemory, encodedtypes_t encoded, bool bigendian) const
+std::string ProtocolScaling::fullEncodeFunction(inmemorytypes_t inmemory, encodedtypes_t encoded, byteorder_t order) const
 {
     if(isTypeBitfield(encoded))
-        return fullBitfieldEncodeFunction(inmemory, encoded, bigendian);
+        return fullBitfieldEncodeFunction(inmemory, encoded, order);
     else if(isTypeFloating(inmemory))
-        return fullFloatEncodeFunction(inmemory, encoded, bigendian);
+        return fullFloatEncodeFunction(inmemory, encoded, order);
     else
-        return fullIntegerEncodeFunction(inmemory, encoded, bigendian);
+        return fullIntegerEncodeFunction(inmemory, encoded, order);
 }
 
 
@@ -885,10 +957,10 @@ std::string ProtocolScaling::fullEncodeFunction(inmemorytypes_t inmemory, encode
  * Generate the full bitfield scaling function output, excluding the comment
  * \param inmemory is the type information for the inmemory (in-memory) data.
  * \param encoded is the type information for the encoded (encoded) data.
- * \param bigendian should be true if the function outputs big endian byte order.
+ * \param order is the byte order of the encoding.
  * \return the function as a string
  */
-std::string ProtocolScaling::fullBitfieldEncodeFunction(inmemorytypes_t inmemory, encodedtypes_t encoded, bool bigendian) const
+std::string ProtocolScaling::fullBitfieldEncodeFunction(inmemorytypes_t inmemory, encodedtypes_t encoded, byteorder_t order) const
 {
     std::string constantone;
 
@@ -899,7 +971,7 @@ std::string ProtocolScaling::fullBitfieldEncodeFunction(inmemorytypes_t inmemory
     else
         constantone = "0x1u";
 
-    std::string function = encodeSignature(inmemory, encoded, bigendian) + "\n";
+    std::string function = encodeSignature(inmemory, encoded, order) + "\n";
     function += "{\n";
     function += "    // The largest integer the bitfield can hold\n";
     function += "    " + typeName(encoded) + " max = (" + constantone + " << bits) - 1;\n";
@@ -961,21 +1033,16 @@ std::string ProtocolScaling::fullBitfieldEncodeFunction(inmemorytypes_t inmemory
  * Generate the full floating point scaling function output, excluding the comment
  * \param inmemory is the type information for the inmemory (in-memory) data.
  * \param encoded is the type information for the encoded (encoded) data.
- * \param bigendian should be true if the function outputs big endian byte order.
+ * \param order is the byte order of the encoding.
  * \return the function as a string
  */
-std::string ProtocolScaling::fullFloatEncodeFunction(inmemorytypes_t inmemory, encodedtypes_t encoded, bool bigendian) const
+std::string ProtocolScaling::fullFloatEncodeFunction(inmemorytypes_t inmemory, encodedtypes_t encoded, byteorder_t order) const
 {
-    std::string function = encodeSignature(inmemory, encoded, bigendian) + "\n";
+    std::string function = encodeSignature(inmemory, encoded, order) + "\n";
 
     std::string endian;
-    if(typeLength(encoded) > 1)
-    {
-        if(bigendian)
-            endian = "Be";
-        else
-            endian = "Le";
-    }
+    if((typeLength(encoded) > 1) || (order == varintorder))
+        endian = orderSigName(order);
 
     std::string bitCount = std::to_string(typeLength(encoded)*8);
 
@@ -1135,21 +1202,16 @@ std::string ProtocolScaling::fullFloatEncodeFunction(inmemorytypes_t inmemory, e
  * Generate the full integer scaling function output, excluding the comment
  * \param inmemory is the type information for the inmemory (in-memory) data.
  * \param encoded is the type information for the encoded (encoded) data.
- * \param bigendian should be true if the function outputs big endian byte order.
+ * \param order is the byte order of the encoding.
  * \return the function as a string
  */
-std::string ProtocolScaling::fullIntegerEncodeFunction(inmemorytypes_t inmemory, encodedtypes_t encoded, bool bigendian) const
+std::string ProtocolScaling::fullIntegerEncodeFunction(inmemorytypes_t inmemory, encodedtypes_t encoded, byteorder_t order) const
 {
-    std::string function = encodeSignature(inmemory, encoded, bigendian) + "\n";
+    std::string function = encodeSignature(inmemory, encoded, order) + "\n";
 
     std::string endian;
-    if(typeLength(encoded) > 1)
-    {
-        if(bigendian)
-            endian = "Be";
-        else
-            endian = "Le";
-    }
+    if((typeLength(encoded) > 1) || (order == varintorder))
+        endian = orderSigName(order);
 
     std::string bitCount = std::to_string(typeLength(encoded)*8);
 
@@ -1343,19 +1405,33 @@ in this module are the reverse operation of the routines in scaledencode.)";
 
             // big endian
             header.write("\n");
-            header.write("//! " + briefDecodeComment(inmemorytype, encodedtype, true) + "\n");
-            header.write(decodeSignature(inmemorytype, encodedtype, true) + ";\n");
+            header.write("//! " + briefDecodeComment(inmemorytype, encodedtype, bigendianorder) + "\n");
+            header.write(decodeSignature(inmemorytype, encodedtype, bigendianorder) + ";\n");
 
             // little endian
             if((typeLength(encodedtype) > 1) && !isTypeBitfield(encodedtype))
             {
                 header.write("\n");
-                header.write("//! " + briefDecodeComment(inmemorytype, encodedtype, false) + "\n");
-                header.write(decodeSignature(inmemorytype, encodedtype, false) + ";\n");
+                header.write("//! " + briefDecodeComment(inmemorytype, encodedtype, littleendianorder) + "\n");
+                header.write(decodeSignature(inmemorytype, encodedtype, littleendianorder) + ";\n");
             }
 
         }// for all encodeds
 
+        // Variable length encodings, unsigned and then signed. These are only
+        // 64 bits when the inmemory type is, so the protection above is correct
+        for(int k = 0; k < 2; k++)
+        {
+            encodedtypes_t encodedtype = varintType(inmemorytype, k == 1);
+
+            if(!areTypesSupported(inmemorytype, encodedtype))
+                continue;
+
+            header.write("\n");
+            header.write("//! " + briefDecodeComment(inmemorytype, encodedtype, varintorder) + "\n");
+            header.write(decodeSignature(inmemorytype, encodedtype, varintorder) + ";\n");
+        }
+
     }// for all inmemorys
 
     header.write("\n");
@@ -1412,19 +1488,33 @@ bool ProtocolScaling::generateDecodeSource(void)
 
             // big endian
             source.write("\n");
-            source.write(fullDecodeComment(inmemorytype, encodedtype, true) + "\n");
-            source.write(fullDecodeFunction(inmemorytype, encodedtype, true) + "\n");
+            source.write(fullDecodeComment(inmemorytype, encodedtype, bigendianorder) + "\n");
+            source.write(fullDecodeFunction(inmemorytype, encodedtype, bigendianorder) + "\n");
 
             // little endian
             if((typeLength(encodedtype) > 1) && !isTypeBitfield(encodedtype))
             {
                 source.write("\n");
-                source.write(fullDecodeComment(inmemorytype, encodedtype, false) + "\n");
-                source.write(fullDecodeFunction(inmemorytype, encodedtype, false) + "\n");
+                source.write(fullDecodeComment(inmemorytype, encodedtype, littleendianorder) + "\n");
+                source.write(fullDecodeFunction(inmemorytype, encodedtype, littleendianorder) + "\n");
             }
 
         }// for all output byte counts
 
+        // Variable length encodings, unsigned and then signed. These are only
+        // 64 bits when the inmemory type is, so the protection above is correct
+        for(int k = 0; k < 2; k++)
+        {
+            encodedtypes_t encodedtype = varintType(inmemorytype, k == 1);
+
+            if(!areTypesSupported(inmemorytype, encodedtype))
+                continue;
+
+            source.write("\n");
+            source.write(fullDecodeComment(inmemorytype, encodedtype, varintorder) + "\n");
+            source.write(fullDecodeFunction(inmemorytype, encodedtype, varintorder) + "\n");
+        }
+
     }// for all input types
 
     source.write("\n");
@@ -1441,10 +1531,10 @@ bool ProtocolScaling::generateDecodeSource(void)
  * Create the brief decode function comment, without doxygen decorations
  * \param inmemory is the type information for the inmemory (in-memory) data.
  * \param encoded is the type information for the encoded (encoded) data.
- * \param bigendian should be true if the function outputs big endian byte order.
+ * \param order is the byte order of the encoding.
  * \return The string that represents the one line function comment.
  */
-std::string ProtocolScaling::briefDecodeComment(inmemorytypes_t inmemory, encodedtypes_t encoded, bool bigendian) const
+std::string ProtocolScaling::briefDecodeComment(inmemorytypes_t inmemory, encodedtypes_t encoded, byteorder_t order) const
 {
     std::string scalingtype;
 
@@ -1460,6 +1550,15 @@ std::string ProtocolScaling::briefDecodeComment(inmemorytypes_t inmemory, encode
         else
             return std::string("Compute a " + typeName(inmemory) + " using inverse " + scalingtype + " scaling from the base integer type used for bitfields.");
     }
+    else if(order == varintorder)
+    {
+        std::string bitCount = std::to_string(typeLength(encoded)*8);
+
+        if(isTypeSigned(encoded))
+            return std::string("Decode a " + typeName(inmemory) + " from a byte stream by inverse " + scalingtype + " scaling from a signed " + bitCount + "-bit variable length integer.");
+        else
+            return std::string("Decode a " + typeName(inmemory) + " from a byte stream by inverse " + scalingtype + " scaling from an unsigned " + bitCount + "-bit variable length integer.");
+    }
     else
     {
         if(typeLength(encoded) == 1)
@@ -1475,7 +1574,7 @@ std::string ProtocolScaling::briefDecodeComment(inmemorytypes_t inmemory, encode
             std::string byteLength = std::to_string(typeLength(encoded));
             std::string endian;
 
-            if(bigendian)
+            if(order == bigendianorder)
                 endian = "big";
             else
                 endian = "little";
@@ -1495,16 +1594,16 @@ std::string ProtocolScaling::briefDecodeComment(inmemorytypes_t inmemory, encode
  * Create the full decode function comment, with doxygen decorations
  * \param inmemory is the type information for the inmemory (in-memory) data.
  * \param encoded is the type information for the encoded (encoded) data.
- * \param bigendian should be true if the function outputs big endian byte order.
+ * \param order is the byte order of the encoding.
  * \return The string that represents the full multi-line function comment.
  */
-std::string ProtocolScaling::fullDecodeComment(inmemorytypes_t inmemory, encodedtypes_t encoded, bool bigendian) const
+std::string ProtocolScaling::fullDecodeComment(inmemorytypes_t inmemory, encodedtypes_t encoded, byteorder_t order) const
 {
     std::string comment= ("/*!\n");
 
     if(isTypeBitfield(encoded))
     {
-        comment += ProtocolParser::outputLongComment(" * ", briefDecodeComment(inmemory, encoded, bigendian)) + "\n";
+        comment += ProtocolParser::outputLongComment(" * ", briefDecodeComment(inmemory, encoded, order)) + "\n";
         comment += " * \\param value is the integer bitfield number to inverse scale\n";
         comment += " * \\param min is the minimum value that can be represented.\n";
 
@@ -1522,10 +1621,13 @@ std::string ProtocolScaling::fullDecodeComment(inmemorytypes_t inmemory, encoded
     }
     else
     {
-        comment += ProtocolParser::outputLongComment(" * ", briefDecodeComment(inmemory, encoded, bigendian)) + "\n";
+        comment += ProtocolParser::outputLongComment(" * ", briefDecodeComment(inmemory, encoded, order)) + "\n";
         comment += " * \\param bytes is a pointer to the byte stream to decode.\n";
         comment += " * \\param index gives the location of the first byte in the byte stream, and\n";
-        comment += " *        will be incremented by " + std::to_string(typeLength(encoded)) + " when this function is complete.\n";
+        if(order == varintorder)
+            comment += " *        will be incremented by the number of bytes used, from 1 to " + std::to_string((typeLength(encoded)*8 + 6)/7) + ".\n";
+        else
+            comment += " *        will be incremented by " + std::to_string(typeLength(encoded)) + " when this function is complete.\n";
 
         if(isTypeFloating(inmemory))
         {
@@ -1570,10 +1672,10 @@ std::string ProtocolScaling::fullDecodeComment(inmemorytypes_t inmemory, encoded
  * Create the one line decode function signature, without a trailing semicolon
  * \param inmemory is the type information for the inmemory (in-memory) data.
  * \param encoded is the type information for the encoded (encoded) data.
- * \param bigendian should be true if the function outputs big endian byte order.
+ * \param order is the byte order of the encoding.
  * \return The string that represents the function signature, without a trailing semicolon
  */
-std::string ProtocolScaling::decodeSignature(inmemorytypes_t inmemory, encodedtypes_t encoded, bool bigendian) const
+std::string ProtocolScaling::decodeSignature(inmemorytypes_t inmemory, encodedtypes_t encoded, byteorder_t order) const
 {
     if(isTypeBitfield(encoded))
     {
@@ -1592,13 +1694,8 @@ std::string ProtocolScaling::decodeSignature(inmemorytypes_t inmemory, encodedty
         std::string byteLength = std::to_string(typeLength(encoded));
         std::string endian;
 
-        if(typeLength(encoded) > 1)
-        {
-            if(bigendian)
-                endian = "Be";
-            else
-                endian = "Le";
-        }
+        if((typeLength(encoded) > 1) || (order == varintorder))
+            endian = orderSigName(order);
 
         if(isTypeFloating(inmemory))
         {
@@ -1624,12 +1721,12 @@ std::string ProtocolScaling::decodeSignature(inmemorytypes_t inmemory, encodedty
  * Generate the full function output, excluding the comment
  * \param inmemory is the type information for the inmemory (in-memory) data.
  * \param encoded is the type information for the encoded (encoded) data.
- * \param bigendian should be true if the function outputs big endian byte order.
+ * \param order is the byte order of the encoding.
  * \return the function as a string
  */
-std::string ProtocolScaling::fullDecodeFunction(inmemorytypes_t inmemory, encodedtypes_t encoded, bool bigendian) const
+std::string ProtocolScaling::fullDecodeFunction(inmemorytypes_t inmemory, encodedtypes_t encoded, byteorder_t order) const
 {
-    std::string function = decodeSignature(inmemory, encoded, bigendian) + "\n";
+    std::string function = decodeSignature(inmemory, encoded, order) + "\n";
     function += "{\n";
 
     if(isTypeBitfield(encoded))
@@ -1642,13 +1739,8 @@ std::string ProtocolScaling::fullDecodeFunction(inmemorytypes_t inmemory, encode
     else
     {
         std::string endian;
-        if(typeLength(encoded) > 1)
-        {
-            if(bigendian)
-                endian = "Be";
-            else
-                endian = "Le";
-        }
+        if((typeLength(encoded) > 1) || (order == varintorder))
+            endian = orderSigName(order);
 
         std::string bitCount = std::to_string(typeLength(encoded)*8);
 
@@ -7,8 +7,8 @@
  *
  * Scaling functions convert all built in in-memory types to different
  * to different integer encodings (signed, unsigned, big and little endian,
- * and byte lengths from 1 to 8). That's a lot of functions, hence the desire
- * to auto-generate them.
+ * and byte lengths from 1 to 8, or variable length). That's a lot of
+ * functions, hence the desire to auto-generate them.
  */
 
 
@@ -67,6 +67,15 @@ protected:
 
     }encodedtypes_t;
 
+    //! Enumeration for the byte order of multi-byte encodings
+    typedef enum
+    {
+        littleendianorder,
+        bigendianorder,
+        varintorder     //!< Variable length integer, 7 bits per byte, least significant first
+
+    }byteorder_t;
+
     //! Determine if type is signed
     bool isTypeSigned(inmemorytypes_t type) const;
 
@@ -130,6 +139,12 @@ protected:
     //! Determine if both types are supported by this protocol
     bool areTypesSupported(inmemorytypes_t source, encodedtypes_t encoded) const;
 
+    //! Determine the integer type used for variable length encoding of an in-memory type
+    encodedtypes_t varintType(inmemorytypes_t inmemory, bool issigned) const;
+
+    //! Return the name in function signature of a byte order
+    std::string orderSigName(byteorder_t order) const;
+
     //! Generate the encode header file
     bool generateEncodeHeader(void);
 
@@ -137,25 +152,25 @@ protected:
     bool generateEncodeSource(void);
 
     //! Generate the one line brief comment for the encode function
-    std::string briefEncodeComment(inmemorytypes_t source, encodedtypes_t encoded, bool bigendian) const;
+    std::string briefEncodeComment(inmemorytypes_t source, encodedtypes_t encoded, byteorder_t order) const;
 
     //! Generate the full comment for the encode function
-    std::string fullEncodeComment(inmemorytypes_t source, encodedtypes_t encoded, bool bigendian) const;
+    std::string fullEncodeComment(inmemorytypes_t source, encodedtypes_t encoded, byteorder_t order) const;
 
     //! Generate the encode function signature
-    std::string encodeSignature(inmemorytypes_t source, encodedtypes_t encoded, bool bigendian) const;
+    std::string encodeSignature(inmemorytypes_t source, encodedtypes_t encoded, byteorder_t order) const;
 
     //! Generate the full encode function
-    std::string fullEncodeFunction(inmemorytypes_t source, encodedtypes_t encoded, bool bigendian) const;
+    std::string fullEncodeFunction(inmemorytypes_t source, encodedtypes_t encoded, byteorder_t order) const;
 
     //! Generate the full encode function for integer scaling
-    std::string fullBitfieldEncodeFunction(inmemorytypes_t source, encodedtypes_t encoded, bool bigendian) const;
+    std::string fullBitfieldEncodeFunction(inmemorytypes_t source, encodedtypes_t encoded, byteorder_t order) const;
 
     //! Generate the full encode function for floating point scaling
-    std::string fullFloatEncodeFunction(inmemorytypes_t source, encodedtypes_t encoded, bool bigendian) const ;
+    std::string fullFloatEncodeFunction(inmemorytypes_t source, encodedtypes_t encoded, byteorder_t order) const ;
 
     //! Generate the full encode function for integer scaling
-    std::string fullIntegerEncodeFunction(inmemorytypes_t source, encodedtypes_t encoded, bool bigendian) const;
+    std::string fullIntegerEncodeFunction(inmemorytypes_t source, encodedtypes_t encoded, byteorder_t order) const;
 
     //! Generate the decode header file
     bool generateDecodeHeader(void);
@@ -164,25 +179,25 @@ protected:
     bool generateDecodeSource(void);
 
     //! Generate the one line brief comment for the decode function
-    std::string briefDecodeComment(inmemorytypes_t source, encodedtypes_t encoded, bool bigendian) const;
+    std::string briefDecodeComment(inmemorytypes_t source, encodedtypes_t encoded, byteorder_t order) const;
 
     //! Generate the full comment for the decode function
-    std::string fullDecodeComment(inmemorytypes_t source, encodedtypes_t encoded, bool bigendian) const;
+    std::string fullDecodeComment(inmemorytypes_t source, encodedtypes_t encoded, byteorder_t order) const;
 
     //! Generate the decode function signature
-    std::string decodeSignature(inmemorytypes_t source, encodedtypes_t encoded, bool bigendian) const;
+    std::string decodeSignature(inmemorytypes_t source, encodedtypes_t encoded, byteorder_t order) const;
 
     //! Generate the full decode function
-    std::string fullDecodeFunction(inmemorytypes_t source, encodedtypes_t encoded, bool bigendian) const;
+    std::string fullDecodeFunction(inmemorytypes_t source, encodedtypes_t encoded, byteorder_t order) const;
 
     //! Generate the full decode function for integer scaling
-    std::string fullBitfieldDecodeFunction(inmemorytypes_t source, encodedtypes_t encoded, bool bigendian) const;
+    std::string fullBitfieldDecodeFunction(inmemorytypes_t source, encodedtypes_t encoded, byteorder_t order) const;
 
     //! Generate the full decode function for floating point scaling
-    std::string fullFloatDecodeFunction(inmemorytypes_t source, encodedtypes_t encoded, bool bigendian) const ;
+    std::string fullFloatDecodeFunction(inmemorytypes_t source, encodedtypes_t encoded, byteorder_t order) const ;
 
     //! Generate the full decode function for integer scaling
-    std::string fullIntegerDecodeFunction(inmemorytypes_t source, encodedtypes_t encoded, bool bigendian) const;
+    std::string fullIntegerDecodeFunction(inmemorytypes_t source, encodedtypes_t encoded, byteorder_t order) const;
 
     //! Header file output object
     ProtocolHeaderFile header;
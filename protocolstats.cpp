@@ -0,0 +1,177 @@
+#include "protocolstats.h"
+#include <sstream>
+#include <iomanip>
+
+bool ProtocolStats::enabled = false;
+std::vector<ProtocolStats::Phase> ProtocolStats::phases;
+std::map<std::string, uint64_t> ProtocolStats::counters;
+std::mutex ProtocolStats::mutex;
+
+/*!
+ * Add time to a phase. Phases are reported in the order they are first
+ * entered. Phases may be nested, for example file flushing happens while
+ * structures and packets are being parsed.
+ * \param phase is the name of the phase.
+ * \param seconds is the wall time to add to the phase.
+ */
+void ProtocolStats::addTime(const std::string& phase, double seconds)
+{
+    if(!enabled)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for(Phase& entry : phases)
+    {
+        if(entry.name == phase)
+        {
+            entry.seconds += seconds;
+            entry.calls++;
+            return;
+        }
+    }
+
+    phases.push_back({phase, seconds, 1});
+
+}// ProtocolStats::addTime
+
+
+/*!
+ * Add to a counter. Counters are reported in alphabetical order.
+ * \param counter is the name of the counter.
+ * \param increment is the amount to add to the counter.
+ */
+void ProtocolStats::count(const std::string& counter, uint64_t increment)
+{
+    if(!enabled)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    counters[counter] += increment;
+
+}// ProtocolStats::count
+
+
+/*!
+ * Get the report of all phases and counters
+ * \param json should be true to output JSON, else the output is human readable.
+ * \return the report text
+ */
+std::string ProtocolStats::report(bool json)
+{
+    std::stringstream output;
+
+    output << std::fixed << std::setprecision(6);
+
+    if(json)
+    {
+        output << "{\n  \"phases\": [";
+
+        for(std::size_t i = 0; i < phases.size(); i++)
+        {
+            if(i > 0)
+                output << ",";
+
+            output << "\n    {\"name\": \"" << escape(phases.at(i).name) << "\", \"seconds\": " << phases.at(i).seconds << ", \"calls\": " << phases.at(i).calls << "}";
+        }
+
+        output << "\n  ],\n  \"counters\": {";
+
+        bool first = true;
+        for(const auto& counter : counters)
+        {
+            if(!first)
+                output << ",";
+
+            first = false;
+            output << "\n    \"" << escape(counter.first) << "\": " << counter.second;
+        }
+
+        output << "\n  }\n}\n";
+    }
+    else
+    {
+        output << "Generation statistics" << std::endl;
+        output << "  " << std::left << std::setw(48) << "Phase" << std::right << std::setw(12) << "Seconds" << std::setw(10) << "Calls" << std::endl;
+
+        for(const Phase& phase : phases)
+            output << "  " << std::left << std::setw(48) << phase.name << std::right << std::setw(12) << phase.seconds << std::setw(10) << phase.calls << std::endl;
+
+        output << "  " << std::left << std::setw(48) << "Counter" << std::right << std::setw(22) << "Count" << std::endl;
+
+        for(const auto& counter : counters)
+            output << "  " << std::left << std::setw(48) << counter.first << std::right << std::setw(22) << counter.second << std::endl;
+    }
+
+    return output.str();
+
+}// ProtocolStats::report
+
+
+/*!
+ * Escape a string for use in JSON output. Quotes and backslashes are escaped
+ * with a backslash, and control characters (which JSON does not allow in a
+ * string) are written as \\u00XX.
+ * \param text is the string to escape.
+ * \return the escaped string, without surrounding quotes
+ */
+std::string ProtocolStats::escape(const std::string& text)
+{
+    static const char hex[] = "0123456789abcdef";
+    std::string output;
+
+    for(char character : text)
+    {
+        unsigned char c = (unsigned char)character;
+
+        if((c == '"') || (c == '\\'))
+        {
+            output += '\\';
+            output += character;
+        }
+        else if(c == '\n')
+            output += "\\n";
+        else if(c == '\r')
+            output += "\\r";
+        else if(c == '\t')
+            output += "\\t";
+        else if(c < 0x20)
+        {
+            output += "\\u00";
+            output += hex[c >> 4];
+            output += hex[c & 0x0F];
+        }
+        else
+            output += character;
+    }
+
+    return output;
+
+}// ProtocolStats::escape
+
+
+/*!
+ * Start timing a phase, which does nothing if statistics are not enabled
+ * \param phase is the name of the phase.
+ */
+ProtocolStats::Timer::Timer(const std::string& phase)
+{
+    if(enabled)
+    {
+        name = phase;
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+
+/*!
+ * Stop timing and add the time to the phase. Calling this more than once has no effect.
+ */
+void ProtocolStats::Timer::stop(void)
+{
+    if(!name.empty())
+        addTime(name, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+    name.clear();
+}
@@ -0,0 +1,71 @@
+#ifndef PROTOCOLSTATS_H
+#define PROTOCOLSTATS_H
+
+/*!
+ * \file
+ * Phase timing and counters describing where the generator spends its time
+ */
+
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+class ProtocolStats
+{
+public:
+    //! Enable or disable the collection of statistics
+    static void enable(bool on) {enabled = on;}
+
+    //! Determine if statistics are being collected
+    static bool isEnabled(void) {return enabled;}
+
+    //! Add time to a phase, the phase is created if it does not exist
+    static void addTime(const std::string& phase, double seconds);
+
+    //! Add to a counter, the counter is created if it does not exist
+    static void count(const std::string& counter, uint64_t increment = 1);
+
+    //! Get the report of all phases and counters, either human readable or JSON
+    static std::string report(bool json);
+
+    //! Time the lifetime of this object, adding it to a phase
+    class Timer
+    {
+    public:
+        //! Start timing a phase
+        Timer(const std::string& phase);
+
+        //! Stop timing and add the time to the phase
+        ~Timer() {stop();}
+
+        //! Stop timing early and add the time to the phase
+        void stop(void);
+
+    private:
+        std::string name;                               //!< Phase being timed, empty if statistics are not enabled
+        std::chrono::steady_clock::time_point start;    //!< Time the phase started
+    };
+
+    //! Escape a string for use in JSON output
+    static std::string escape(const std::string& text);
+
+private:
+
+    //! Time and number of entries of a phase
+    typedef struct
+    {
+        std::string name;   //!< Name of the phase
+        double seconds;     //!< Total wall time of the phase in seconds
+        uint64_t calls;     //!< Number of times the phase was entered
+    }Phase;
+
+    static bool enabled;                                //!< True if statistics are being collected
+    static std::vector<Phase> phases;                   //!< Phases in the order they were first entered
+    static std::map<std::string, uint64_t> counters;    //!< Counters by name
+    static std::mutex mutex;                            //!< Protects the phases and counters when protocols are generated in parallel
+};
+
+#endif // PROTOCOLSTATS_H
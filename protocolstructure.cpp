@@ -10,7 +10,7 @@
  * \param parent is the hierarchical name of the object that owns this object.
  * \param support are the protocol support details
  */
-ProtocolStructure::ProtocolStructure(ProtocolParser* parse, std::string parent, ProtocolSupport supported) :
+ProtocolStructure::ProtocolStructure(ProtocolParser* parse, std::string parent, SharedSupport supported) :
     Encodable(parse, parent, supported),
     numbitfieldgroupbytes(0),
     bitfields(false),
@@ -20,6 +20,8 @@ ProtocolStructure::ProtocolStructure(ProtocolParser* parse, std::string parent,
     usestempdecodelongbitfields(false),
     needsEncodeIterator(false),
     needsDecodeIterator(false),
+    needsCodecEncodeIterator(false),
+    needsCodecDecodeIterator(false),
     needsInitIterator(false),
     needsVerifyIterator(false),
     needs2ndEncodeIterator(false),
@@ -29,17 +31,18 @@ ProtocolStructure::ProtocolStructure(ProtocolParser* parse, std::string parent,
     defaults(false),
     hidden(false),
     neverOmit(false),
-    hasinit(supported.language == ProtocolSupport::cpp_language),
+    hasinit(supported->language == ProtocolSupport::cpp_language),
     hasverify(false),
     encode(true),
     decode(true),
     compare(false),
     print(false),
     mapEncode(false),
+    json(false),
     redefines(nullptr)
 {
     // List of attributes understood by ProtocolStructure
-    attriblist = {"name",  "title",  "array",  "variableArray",  "array2d",  "variable2dArray",  "dependsOn",  "comment",  "hidden",  "neverOmit", "limitOnEncode", "dbctx", "dbcrx"};
+    attriblist = {"name",  "title",  "array",  "variableArray",  "array2d",  "variable2dArray",  "dependsOn",  "comment",  "hidden",  "neverOmit", "limitOnEncode", "bitpacked", "dbctx", "dbcrx"};
 
 }
 
@@ -76,6 +79,8 @@ void ProtocolStructure::clear(void)
     usestempdecodelongbitfields = false;
     needsEncodeIterator = false;
     needsDecodeIterator = false;
+    needsCodecEncodeIterator = false;
+    needsCodecDecodeIterator = false;
     needsInitIterator = false;
     needsVerifyIterator = false;
     needs2ndEncodeIterator = false;
@@ -85,10 +90,10 @@ void ProtocolStructure::clear(void)
     defaults = false;
     hidden = false;
     neverOmit = false;
-    hasinit = (support.language == ProtocolSupport::cpp_language);
+    hasinit = (support->language == ProtocolSupport::cpp_language);
     hasverify = false;
     encode = decode = true;
-    print = compare = mapEncode = false;
+    print = compare = mapEncode = json = false;
     structName.clear();
     redefines = nullptr;
 
@@ -122,7 +127,7 @@ void ProtocolStructure::parse(bool nocode)
      * to do: someone might create a structure as a sub of another structure
      * and hide it. In which case this won't be omitted. Not sure how best to
      * deal with that case.
-    if(hidden && !neverOmit && support.omitIfHidden)
+    if(hidden && !neverOmit && support->omitIfHidden)
     {
         std::cout << "Skipping code output for hidden structure " << getHierarchicalName() << std::endl;
         clear();
@@ -135,14 +140,19 @@ void ProtocolStructure::parse(bool nocode)
 
     // This will propagate to any of the children we create
     if(ProtocolParser::isFieldSet("limitOnEncode", map))
-        support.limitonencode = true;
+        changeSupport().limitonencode = true;
     else if(ProtocolParser::isFieldClear("limitOnEncode", map))
-        support.limitonencode = false;
+        changeSupport().limitonencode = false;
+
+    if(ProtocolParser::isFieldSet("bitpacked", map))
+        changeSupport().bitpacked = true;
+    else if(ProtocolParser::isFieldClear("bitpacked", map))
+        changeSupport().bitpacked = false;
 
     testAndWarnAttributes(map);
 
     // for now the typename is derived from the name
-    structName = typeName = support.prefix + name + support.typeSuffix;
+    structName = typeName = support->prefix + name + support->typeSuffix;
 
     // We can't have a variable array length without an array
     if(array.empty() && !variableArray.empty())
@@ -263,7 +273,7 @@ std::string ProtocolStructure::getEncodeString(int* bitcount, bool isStructureMe
     }
 
     // The actual encode function
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += spacing + "encode" + typeName + "(_pg_data, &_pg_byteindex, " + access + ");\n";
     else
     {
@@ -323,7 +333,7 @@ std::string ProtocolStructure::getDecodeString(int* bitcount, bool isStructureMe
             spacing += TAB_IN;
     }
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
         output += spacing + "if(decode" + typeName + "(_pg_data, &_pg_byteindex, " + access + ") == 0)\n";
         output += spacing + TAB_IN + "return 0;\n";
@@ -376,7 +386,7 @@ std::string ProtocolStructure::getVerifyString(void) const
         }
     }
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
         output += spacing + "if(verify" + typeName + "(" + getDecodeFieldAccess(true) + ") == 0)\n";
         output += spacing + TAB_IN + "_pg_good = 0;\n";
@@ -402,7 +412,7 @@ std::string ProtocolStructure::getSetInitialValueString(bool isStructureMember)
     std::string spacing = TAB_IN;
 
     // We only need this function if we are C language, C++ classes initialize themselves
-    if((!hasinit) || (support.language != ProtocolSupport::c_language))
+    if((!hasinit) || (support->language != ProtocolSupport::c_language))
         return output;
 
     if(!comment.empty())
@@ -428,6 +438,67 @@ std::string ProtocolStructure::getSetInitialValueString(bool isStructureMember)
 }// ProtocolStructure::getSetInitialValueString
 
 
+/*!
+ * Get the value of this structure member in the C static initializer of its
+ * parent, which may be an array of the structure type initializer.
+ * \param ok is set to false if the initial values cannot be expressed statically
+ * \return the initializer, which is empty if every member is zero
+ */
+std::string ProtocolStructure::getStaticInitializerString(bool* ok) const
+{
+    if(!hasinit || (support->language != ProtocolSupport::c_language))
+        return std::string();
+
+    std::string initializer = getStaticInitializer(ok);
+    if(initializer.empty())
+        return initializer;
+
+    return getArrayStaticInitializer(initializer, ok);
+
+}// ProtocolStructure::getStaticInitializerString
+
+
+/*!
+ * Get the C static initializer of this structure type, which uses designated
+ * initializers for every member with an initial value. Members which are not
+ * listed are zero.
+ * \param ok is set to false if the initial values cannot be expressed statically
+ * \param spacing is the spacing that begins each member line, if empty the
+ *        initializer is all on one line.
+ * \return the initializer, which is empty if every member is zero
+ */
+std::string ProtocolStructure::getStaticInitializer(bool* ok, const std::string& spacing) const
+{
+    std::vector<std::string> members;
+
+    // Redefined structures and structures with only one member are not
+    // declared with their own members, so we cannot designate them
+    if((redefines != nullptr) || (getNumberInMemory() <= 1))
+    {
+        *ok = false;
+        return std::string();
+    }
+
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        if(encodables.at(i)->isNotInMemory())
+            continue;
+
+        std::string initializer = encodables.at(i)->getStaticInitializerString(ok);
+        if(!initializer.empty())
+            members.push_back("." + encodables.at(i)->name + " = " + initializer);
+    }
+
+    if(members.empty())
+        return std::string();
+    else if(spacing.empty())
+        return "{" + join(members, ", ") + "}";
+    else
+        return "\n{\n" + spacing + join(members, ",\n" + spacing) + "\n}";
+
+}// ProtocolStructure::getStaticInitializer
+
+
 //! Return the strings that #define initial and variable values
 std::string ProtocolStructure::getInitialAndVerifyDefines(bool includeComment) const
 {
@@ -529,7 +600,7 @@ std::string ProtocolStructure::getComparisonString(void) const
 
     /// TODO: obey variable array length limits?
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
         // The dereference of the array gets us back to the object, but we need the pointer
         access1 = "&_pg_user1->" + name;
@@ -560,7 +631,7 @@ std::string ProtocolStructure::getComparisonString(void) const
 
     }// if array of structures
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += spacing + "_pg_report += compare" + typeName + "(_pg_prename + \":" + name + "\"";
     else
         output += spacing + "_pg_report += " + access1 + ".compare(_pg_prename + \":" + name + "\"";
@@ -571,7 +642,7 @@ std::string ProtocolStructure::getComparisonString(void) const
     if(is2dArray())
         output += " + \"[\" + std::to_string(_pg_j) + \"]\"";
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += ", " + access1 + ", " + access2 + ");\n";
     else
         output += ", " + access2 + ");\n";
@@ -606,7 +677,7 @@ std::string ProtocolStructure::getTextPrintString(void) const
             spacing += TAB_IN;
     }
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += spacing + "_pg_report += textPrint" + typeName + "(_pg_prename + \":" + name + "\"";
     else
         output += spacing + "_pg_report += " + getEncodeFieldAccess(true) + ".textPrint(_pg_prename + \":" + name + "\"";
@@ -617,7 +688,7 @@ std::string ProtocolStructure::getTextPrintString(void) const
     if(is2dArray())
         output += " + \"[\" + std::to_string(_pg_j) + \"]\"";
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += ", " + getEncodeFieldAccess(true);
 
     output += ");\n";
@@ -652,7 +723,7 @@ std::string ProtocolStructure::getTextReadString(void) const
             spacing += TAB_IN;
     }
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += spacing + "_pg_fieldcount += textRead" + typeName + "(_pg_prename + \":" + name + "\"";
     else
         output += spacing + "_pg_fieldcount += " + getEncodeFieldAccess(true) + ".textRead(_pg_prename + \":" + name + "\"";
@@ -665,10 +736,10 @@ std::string ProtocolStructure::getTextReadString(void) const
 
     output += ", _pg_source";
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += ", " + getEncodeFieldAccess(true);
 
-    output += ");\n";
+    output += ", _pg_cursor);\n";
 
     return output;
 
@@ -691,7 +762,7 @@ std::string ProtocolStructure::getMapEncodeString(void) const
     if(!comment.empty())
         output += spacing + "// " + comment + "\n";
 
-    std::string key = "\":" + name + "\"";
+    std::string key = "_pg_prename + \":" + name + "\"";
 
     output += getEncodeArrayIterationCode(spacing, true);
     if(isArray())
@@ -706,10 +777,14 @@ std::string ProtocolStructure::getMapEncodeString(void) const
         }
     }
 
-    if(support.language == ProtocolSupport::c_language)
-        output += spacing + "mapEncode" + typeName + "(_pg_prename + " + key + ", _pg_map, " + getEncodeFieldAccess(true);
+    // The flat map key is an integer, which includes the array indices
+    if(support->flatmap)
+        key = getFlatMapKey();
+
+    if(support->language == ProtocolSupport::c_language)
+        output += spacing + "mapEncode" + typeName + "(" + key + ", _pg_map, " + getEncodeFieldAccess(true);
     else
-        output += spacing + getEncodeFieldAccess(true) + ".mapEncode(_pg_prename + " + key + ", _pg_map";
+        output += spacing + getEncodeFieldAccess(true) + ".mapEncode(" + key + ", _pg_map";
 
     output += ");\n";
 
@@ -734,7 +809,7 @@ std::string ProtocolStructure::getMapDecodeString(void) const
     if(!comment.empty())
         output += spacing + "// " + comment + "\n";
 
-    std::string key = "\":" + name + "\"";
+    std::string key = "_pg_prename + \":" + name + "\"";
 
     output += getDecodeArrayIterationCode(spacing, true);
     if(isArray())
@@ -749,10 +824,14 @@ std::string ProtocolStructure::getMapDecodeString(void) const
         }
     }
 
-    if(support.language == ProtocolSupport::c_language)
-        output += spacing + "mapDecode" + typeName + "(_pg_prename + " + key + ", _pg_map, " + getDecodeFieldAccess(true);
+    // The flat map key is an integer, which includes the array indices
+    if(support->flatmap)
+        key = getFlatMapKey();
+
+    if(support->language == ProtocolSupport::c_language)
+        output += spacing + "mapDecode" + typeName + "(" + key + ", _pg_map, " + getDecodeFieldAccess(true);
     else
-        output += spacing + getDecodeFieldAccess(true) + ".mapDecode(_pg_prename + " + key + ", _pg_map";
+        output += spacing + getDecodeFieldAccess(true) + ".mapDecode(" + key + ", _pg_map";
 
     output += ");\n";
 
@@ -761,6 +840,57 @@ std::string ProtocolStructure::getMapDecodeString(void) const
 }// ProtocolStructure::getMapDecodeString
 
 
+/*!
+ * Get the string used for writing this field to a JSON or CBOR writer
+ * \param cbor should be true to write CBOR, else JSON
+ * \return the write string, which may be empty
+ */
+std::string ProtocolStructure::getJsonWriteString(bool cbor) const
+{
+    std::string output;
+    std::string function = cbor ? "toCbor" : "toJson";
+
+    // We must have parameters that we decode to do a write
+    if(!json || (getNumberOfDecodeParameters() == 0))
+        return output;
+
+    if(!comment.empty())
+        output += TAB_IN + "// " + comment + "\n";
+
+    output += TAB_IN + "_pg_writer.key(" + getJsonKeyLiteral(cbor) + ");\n";
+
+    if(support->language == ProtocolSupport::c_language)
+        output += getJsonArrayWriteCode(function + typeName + "(_pg_writer, " + getEncodeFieldAccess(true) + ");");
+    else
+        output += getJsonArrayWriteCode(getEncodeFieldAccess(true) + "." + function + "(_pg_writer);");
+
+    return output;
+
+}// ProtocolStructure::getJsonWriteString
+
+
+/*!
+ * Get the string used for reading this field from a JSON or CBOR reader.
+ * \param spacing is the spacing that begins each line
+ * \param cbor should be true to read CBOR, else JSON
+ * \return the read string, which may be empty
+ */
+std::string ProtocolStructure::getJsonReadString(const std::string& spacing, bool cbor) const
+{
+    std::string function = cbor ? "fromCbor" : "fromJson";
+
+    // We must have parameters that we decode to do a read
+    if(!json || (getNumberOfDecodeParameters() == 0))
+        return std::string();
+
+    if(support->language == ProtocolSupport::c_language)
+        return getJsonArrayReadCode(spacing, "_pg_fieldcount += " + function + typeName + "(_pg_reader, " + getDecodeFieldAccess(true) + ");");
+    else
+        return getJsonArrayReadCode(spacing, "_pg_fieldcount += " + getDecodeFieldAccess(true) + "." + function + "(_pg_reader);");
+
+}// ProtocolStructure::getJsonReadString
+
+
 /*!
  * Parse all enumerations which are direct children of a DomNode
  * \param node is parent node.
@@ -853,6 +983,12 @@ void ProtocolStructure::parseChildren(const XMLElement* field)
                     if(field->usesDecodeIterator())
                         needsDecodeIterator = true;
 
+                    if(field->usesEncodeIterator() && field->usesCodecIterator())
+                        needsCodecEncodeIterator = true;
+
+                    if(field->usesDecodeIterator() && field->usesCodecIterator())
+                        needsCodecDecodeIterator = true;
+
                     if(field->usesInitIterator())
                         needsInitIterator = true;
 
@@ -897,6 +1033,7 @@ void ProtocolStructure::parseChildren(const XMLElement* field)
                     if(encodable->isArray())
                     {
                         needsDecodeIterator = needsEncodeIterator = true;
+                        needsCodecDecodeIterator = needsCodecEncodeIterator = true;
                         needsInitIterator = encodable->hasInit();
                         needsVerifyIterator = encodable->hasVerify();
                     }
@@ -1099,6 +1236,25 @@ void ProtocolStructure::setMapEncode(bool enable)
 }
 
 
+//! Set the json flag for this structure and all children structure
+void ProtocolStructure::setJson(bool enable)
+{
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        // Is this encodable a structure?
+        ProtocolStructure* structure = dynamic_cast<ProtocolStructure*>(encodables.at(i));
+
+        if(structure == nullptr)
+            continue;
+
+        structure->setJson(enable);
+
+    }// for all children
+
+    json = enable;
+}
+
+
 //! Get the maximum number of temporary bytes needed for a bitfield group of our children
 void ProtocolStructure::getBitfieldGroupNumBytes(int* num) const
 {
@@ -1270,6 +1426,20 @@ void ProtocolStructure::getMapIncludeDirectives(std::vector<std::string>& list)
 }
 
 
+/*!
+ * Return the include directives needed for this encodable's JSON and CBOR functions
+ * \param list is appended with any directives this encodable requires.
+ */
+void ProtocolStructure::getJsonIncludeDirectives(std::vector<std::string>& list) const
+{
+    // Includes that our encodable members may need
+    for(std::size_t i = 0; i < encodables.size(); i++)
+        encodables.at(i)->getJsonIncludeDirectives(list);
+
+    removeDuplicates(list);
+}
+
+
 /*!
  * Return the include directives needed for this encodable's compare functions
  * \param list is appended with any directives this encodable requires.
@@ -1372,7 +1542,7 @@ std::string ProtocolStructure::getStructureDeclaration(bool alwaysCreate) const
 
     }// if not redefining
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += getStructureDeclaration_C(alwaysCreate);
     else
         output += getClassDeclaration_CPP();
@@ -1517,6 +1687,13 @@ std::string ProtocolStructure::getClassDeclaration_CPP(void) const
             ProtocolFile::makeLineSeparator(output);
         }
 
+        if(json)
+        {
+            ProtocolFile::makeLineSeparator(output);
+            output += getJsonFunctionPrototype(TAB_IN, false);
+            ProtocolFile::makeLineSeparator(output);
+        }
+
         if(compare)
         {
             ProtocolFile::makeLineSeparator(output);
@@ -1555,53 +1732,74 @@ std::string ProtocolStructure::alignStructureData(const std::string& structure)
     // The strings as a list separated by line feeds
     std::vector<std::string> list = split(structure, "\n");
 
-    // The space separates the typeName from the name,
-    // but skip the indent spaces
-    std::size_t max = 0;
+    // The space separates the typeName from the name, but skip the indent
+    // spaces. The first semicolon separates the name from the comment.
+    std::vector<std::size_t> spaces(list.size()), semicolons(list.size());
+
+    std::size_t maxspace = 0;
+    std::size_t maxsemicolon = 0;
     for(i = 0; i < list.size(); i++)
     {
-        index = list.at(i).find(" ", TAB_IN.size());
-        if((index < list.at(i).size()) && (index > max))
-            max = index;
+        spaces[i] = list.at(i).find(" ", TAB_IN.size());
+        if((spaces[i] < list.at(i).size()) && (spaces[i] > maxspace))
+            maxspace = spaces[i];
     }
 
     for(i = 0; i < list.size(); i++)
     {
-        // Insert spaces until we have reached the max
-        index = list.at(i).find(" ", TAB_IN.size());
-        if((index < list.at(i).size()))
+        // The semicolon moves by the padding inserted at the space. We want the character after the semicolon
+        semicolons[i] = list.at(i).find(";");
+        if(semicolons[i] < list.at(i).size())
         {
-            for(; index < max; index++)
-                list[i].insert(index, " ");
+            if(spaces[i] < semicolons[i])
+                semicolons[i] += maxspace - spaces[i];
+
+            if(semicolons[i] + 1 > maxsemicolon)
+                maxsemicolon = semicolons[i] + 1;
         }
     }
 
-    // The first semicolon we find separates the name from the comment
-    max = 0;
+    // Re-assemble the output in one pass, padding each line as we go and
+    // putting the line feeds back on
+    std::string output;
+    output.reserve(structure.size() + list.size()*(maxspace + maxsemicolon));
+
     for(i = 0; i < list.size(); i++)
     {
-        // we want the character after the semicolon
-        index = list[i].find(";");
-        if(index < list.at(i).size())
+        const std::string& line = list.at(i);
+
+        // Padding goes at the space, and after the semicolon, in the original line
+        std::size_t first = line.size(), firstcount = 0;
+        std::size_t second = line.size(), secondcount = 0;
+
+        if(spaces[i] < line.size())
         {
-            if(index + 1 > max)
-                max = index + 1;
+            first = spaces[i];
+            firstcount = maxspace - spaces[i];
         }
-    }
 
-    for(i = 0; i < list.size(); i++)
-    {
-        // Insert spaces until we have reached the max
-        index = list[i].find(";");
-        if(index < list.at(i).size())
+        index = line.find(";");
+        if(index < line.size())
+        {
+            second = index + 1;
+            secondcount = maxsemicolon - semicolons[i] - 1;
+        }
+
+        if(second < first)
         {
-            for(index += 1; index < max; index++)
-                list[i].insert(index, " ");
+            std::swap(first, second);
+            std::swap(firstcount, secondcount);
         }
+
+        output.append(line, 0, first);
+        output.append(firstcount, ' ');
+        output.append(line, first, second - first);
+        output.append(secondcount, ' ');
+        output.append(line, second, std::string::npos);
+        output += "\n";
     }
 
-    // Re-assemble the output, put the line feeds back on
-    return join(list, "\n") + "\n";
+    return output;
 
 }// ProtocolStructure::alignStructureData
 
@@ -1615,7 +1813,7 @@ std::string ProtocolStructure::getEncodeFunctionSignature(bool insource) const
 {
     std::string output;
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
         std::string pg;
 
@@ -1669,7 +1867,7 @@ std::string ProtocolStructure::getEncodeFunctionPrototype(const std::string& spa
     std::string output;
 
     // Only the C language needs this. C++ declares the prototype within the class
-    if(includeChildren && (support.language == ProtocolSupport::c_language))
+    if(includeChildren && (support->language == ProtocolSupport::c_language))
     {
         for(std::size_t i = 0; i < encodables.size(); i++)
         {
@@ -1728,7 +1926,7 @@ std::string ProtocolStructure::getEncodeFunctionBody(bool includeChildren) const
     output += ProtocolParser::outputLongComment(" * ", comment) + "\n";
     output += " * \\param _pg_data points to the byte array to add encoded data to\n";
     output += " * \\param _pg_bytecount points to the starting location in the byte array, and will be incremented by the number of encoded bytes.\n";
-    if((support.language == ProtocolSupport::c_language) && (getNumberOfEncodeParameters() > 0))
+    if((support->language == ProtocolSupport::c_language) && (getNumberOfEncodeParameters() > 0))
         output += " * \\param _pg_user is the data to encode in the byte array\n";
     output += " */\n";
 
@@ -1749,7 +1947,7 @@ std::string ProtocolStructure::getEncodeFunctionBody(bool includeChildren) const
         output += TAB_IN + "uint8_t _pg_bitfieldbytes[" + std::to_string(numbitfieldgroupbytes) + "];\n";
     }
 
-    if(needsEncodeIterator)
+    if(needsCodecEncodeIterator)
         output += TAB_IN + "unsigned _pg_i = 0;\n";
 
     if(needs2ndEncodeIterator)
@@ -1766,7 +1964,7 @@ std::string ProtocolStructure::getEncodeFunctionBody(bool includeChildren) const
     output += TAB_IN + "*_pg_bytecount = _pg_byteindex;\n";
     output += "\n";
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += "}// encode" + typeName + "\n";
     else
         output += "}// " + typeName + "::encode\n";
@@ -1785,7 +1983,7 @@ std::string ProtocolStructure::getDecodeFunctionSignature(bool insource) const
 {
     std::string output;
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
         std::string pg;
 
@@ -1828,7 +2026,7 @@ std::string ProtocolStructure::getDecodeFunctionPrototype(const std::string& spa
     std::string output;
 
     // Only the C language needs this. C++ declares the prototype within the class
-    if(includeChildren && (support.language == ProtocolSupport::c_language))
+    if(includeChildren && (support->language == ProtocolSupport::c_language))
     {
         for(std::size_t i = 0; i < encodables.size(); i++)
         {
@@ -1884,7 +2082,7 @@ std::string ProtocolStructure::getDecodeFunctionBody(bool includeChildren) const
     output += ProtocolParser::outputLongComment(" * ", comment) + "\n";
     output += " * \\param _pg_data points to the byte array to decoded data from\n";
     output += " * \\param _pg_bytecount points to the starting location in the byte array, and will be incremented by the number of bytes decoded\n";
-    if((support.language == ProtocolSupport::c_language) && (getNumberOfDecodeParameters() > 0))
+    if((support->language == ProtocolSupport::c_language) && (getNumberOfDecodeParameters() > 0))
         output += " * \\param _pg_user is the data to decode from the byte array\n";
 
     output += " * \\return " + getReturnCode(true) + " if the data are decoded, else " + getReturnCode(false) + ".\n";
@@ -1906,7 +2104,7 @@ std::string ProtocolStructure::getDecodeFunctionBody(bool includeChildren) const
         output += TAB_IN + "uint8_t _pg_bitfieldbytes[" + std::to_string(numbitfieldgroupbytes) + "];\n";
     }
 
-    if(needsDecodeIterator)
+    if(needsCodecDecodeIterator)
         output += TAB_IN + "unsigned _pg_i = 0;\n";
 
     if(needs2ndDecodeIterator)
@@ -1924,7 +2122,7 @@ std::string ProtocolStructure::getDecodeFunctionBody(bool includeChildren) const
     output += TAB_IN + "return " + getReturnCode(true) + ";\n";
     output += "\n";
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += "}// decode" + typeName + "\n";
     else
         output += "}// " + typeName + "::decode\n";
@@ -1944,7 +2142,7 @@ std::string ProtocolStructure::getSetToInitialValueFunctionSignature(bool insour
 {
     std::string output;
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
         if(getNumberInMemory() > 0)
         {
@@ -1982,7 +2180,7 @@ std::string ProtocolStructure::getSecondSetToInitialValueFunctionSignature(bool
 {
     std::string output;
 
-    if((support.language == ProtocolSupport::cpp_language) && (redefines != nullptr))
+    if((support->language == ProtocolSupport::cpp_language) && (redefines != nullptr))
     {
         // For C++ this function is the constructor
         if(insource)
@@ -2008,11 +2206,11 @@ std::string ProtocolStructure::getSetToInitialValueFunctionPrototype(const std::
     std::string output;
 
     // C++ always has init (constructor) functions, but not C
-    if(!hasInit() && (support.language == ProtocolSupport::c_language))
+    if(!hasInit() && (support->language == ProtocolSupport::c_language))
         return output;
 
     // Go get any children structures set to initial functions
-    if(includeChildren && (support.language == ProtocolSupport::c_language))
+    if(includeChildren && (support->language == ProtocolSupport::c_language))
     {
         for(std::size_t i = 0; i < encodables.size(); i++)
         {
@@ -2028,12 +2226,15 @@ std::string ProtocolStructure::getSetToInitialValueFunctionPrototype(const std::
     }
 
     // My set to initial values function
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += spacing + "//! Set a " + typeName + " to initial values\n";
     else
         output += spacing + "//! Construct a " + typeName + "\n";
 
-    output += spacing + getSetToInitialValueFunctionSignature(false) + ";\n";
+    if(hasDefaultedConstructor())
+        output += spacing + getSetToInitialValueFunctionSignature(false) + " = default;\n";
+    else
+        output += spacing + getSetToInitialValueFunctionSignature(false) + ";\n";
 
     return output;
 
@@ -2053,7 +2254,7 @@ std::string ProtocolStructure::getSecondSetToInitialValueFunctionPrototype(const
     std::string output;
 
     // My set to initial values function
-    if((support.language == ProtocolSupport::cpp_language) && (redefines != nullptr))
+    if((support->language == ProtocolSupport::cpp_language) && (redefines != nullptr))
     {
         output += spacing + "//! Construct a " + typeName + "\n";
 
@@ -2077,7 +2278,7 @@ std::string ProtocolStructure::getSetToInitialValueFunctionBody(bool includeChil
     std::string output;
 
     // C++ always has init (constructor) functions, but not C
-    if(!hasInit() && (support.language == ProtocolSupport::c_language))
+    if(!hasInit() && (support->language == ProtocolSupport::c_language))
         return output;
 
     // Go get any children structures set to initial functions
@@ -2096,14 +2297,41 @@ std::string ProtocolStructure::getSetToInitialValueFunctionBody(bool includeChil
         ProtocolFile::makeLineSeparator(output);
     }
 
-    if(support.language == ProtocolSupport::c_language)
+    bool ok = true;
+    std::string initializer;
+
+    if(support->language == ProtocolSupport::c_language)
+        initializer = getStaticInitializer(&ok, TAB_IN);
+
+    if(ok && !initializer.empty())
+    {
+        // The initial values are known when we generate, so initialization
+        // is a single copy of a constant structure, rather than a loop for
+        // every array of initial values.
+        output += "//! Initial values of a " + typeName + ", fields without initial values are zero\n";
+        output += "static const " + structName + " _pg_initial" + typeName + " =" + initializer + ";\n";
+        output += "\n";
+        output += "/*!\n";
+        output += " * \\brief Set a " + typeName + " to initial values.\n";
+        output += " *\n";
+        output += " * Set a " + typeName + " to initial values. Fields which the protocol\n";
+        output += " * does not give an initial value are set to zero.\n";
+        output += " * \\param _pg_user is the structure whose data are set to initial values\n";
+        output += " */\n";
+        output += getSetToInitialValueFunctionSignature(true) + "\n";
+        output += "{\n";
+        output += TAB_IN + "*_pg_user = _pg_initial" + typeName + ";\n";
+        output += "}// init" + typeName + "\n";
+
+    }// If the C language output with static initial values
+    else if(support->language == ProtocolSupport::c_language)
     {
         // My set to initial values function
         output += "/*!\n";
         output += " * \\brief Set a " + typeName + " to initial values.\n";
         output += " *\n";
-        output += " * Set a " + typeName + " to initial values. Not all fields are set,\n";
-        output += " * only those which the protocol specifies.\n";
+        output += " * Set a " + typeName + " to initial values. Fields which the protocol\n";
+        output += " * does not give an initial value are set to zero.\n";
         output += " * \\param _pg_user is the structure whose data are set to initial values\n";
         output += " */\n";
         output += getSetToInitialValueFunctionSignature(true) + "\n";
@@ -2115,9 +2343,13 @@ std::string ProtocolStructure::getSetToInitialValueFunctionBody(bool includeChil
         if(needs2ndInitIterator)
             output += TAB_IN + "int _pg_j = 0;\n";
 
+        // Zero first, like the static initializer, so the result does not
+        // depend on which path we took
+        ProtocolFile::makeLineSeparator(output);
+        output += TAB_IN + "memset(_pg_user, 0, sizeof(*_pg_user));\n";
+
         for(std::size_t i = 0; i < encodables.size(); i++)
         {
-            /// TODO: change this to zeroize all fields
             ProtocolFile::makeLineSeparator(output);
             output += encodables[i]->getSetInitialValueString(true);
         }
@@ -2126,28 +2358,11 @@ std::string ProtocolStructure::getSetToInitialValueFunctionBody(bool includeChil
         output += "}// init" + typeName + "\n";
 
     }// If the C language output
-    else
+    else if(!hasDefaultedConstructor())
     {
-        // Set to initial values is just the constructor. We initialize every
-        // member that is not itself another class (they take care of themselves).
-        std::string initializerlist;
-
-        if(redefines == nullptr)
-        {
-            for(std::size_t i = 0; i < encodables.size(); i++)
-            {
-                // Structures (classes really) take care of themselves
-                if(!encodables.at(i)->isPrimitive() || encodables.at(i)->isNotInMemory())
-                    continue;
-
-                initializerlist += encodables.at(i)->getSetInitialValueString(true);
-            }
-        }
-        else
-        {
-            // If we are redefining a different class the initializer list is simpler
-            initializerlist += TAB_IN + redefines->typeName + "()\n";
-        }
+        // Set to initial values is just the constructor. Most members are
+        // initialized in the class declaration, the rest are initialized here.
+        std::string initializerlist = getConstructorInitializerList();
 
         // Get rid of the comma on the last member of the initializer list
         if(endsWith(initializerlist, ",\n"))
@@ -2172,6 +2387,51 @@ std::string ProtocolStructure::getSetToInitialValueFunctionBody(bool includeChil
 }// ProtocolStructure::getSetToInitialValueFunctionBody
 
 
+/*!
+ * Get the C++ constructor initializer list. Members which are not themselves
+ * classes are initialized in the class declaration, except for bitfields,
+ * which are initialized here.
+ * \return the initializer list, one member per line, which may be empty
+ */
+std::string ProtocolStructure::getConstructorInitializerList(void) const
+{
+    std::string initializerlist;
+
+    if(redefines == nullptr)
+    {
+        for(std::size_t i = 0; i < encodables.size(); i++)
+        {
+            // Structures (classes really) take care of themselves
+            if(!encodables.at(i)->isPrimitive() || encodables.at(i)->isNotInMemory())
+                continue;
+
+            initializerlist += encodables.at(i)->getSetInitialValueString(true);
+        }
+    }
+    else
+    {
+        // If we are redefining a different class the initializer list is simpler
+        initializerlist += TAB_IN + redefines->typeName + "()\n";
+    }
+
+    return initializerlist;
+
+}// ProtocolStructure::getConstructorInitializerList
+
+
+/*!
+ * Determine if the C++ constructor can be defaulted. This is true if every
+ * member is initialized in the class declaration, in which case the
+ * compiler can make the constructor constexpr.
+ * \return true if the constructor is declared as default
+ */
+bool ProtocolStructure::hasDefaultedConstructor(void) const
+{
+    return (support->language == ProtocolSupport::cpp_language) && getConstructorInitializerList().empty();
+
+}// ProtocolStructure::hasDefaultedConstructor
+
+
 /*!
  * Return the string that gives the function used to this structure to initial
  * values. This is NOT the call that sets this structure to initial values, this
@@ -2184,7 +2444,7 @@ std::string ProtocolStructure::getSecondSetToInitialValueFunctionBody(bool inclu
     (void)includeChildren;
     std::string output;
 
-    if((support.language == ProtocolSupport::cpp_language) && (redefines != nullptr))
+    if((support->language == ProtocolSupport::cpp_language) && (redefines != nullptr))
     {
         // Set to initial values is just the constructor. We initialize every
         // member that is not itself another class (they take care of themselves).
@@ -2223,7 +2483,7 @@ std::string ProtocolStructure::getSecondSetToInitialValueFunctionBody(bool inclu
  */
 std::string ProtocolStructure::getVerifyFunctionSignature(bool insource) const
 {
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
         if(insource)
             return "int verify" + typeName + "(" + structName + "* _pg_user)";
@@ -2257,7 +2517,7 @@ std::string ProtocolStructure::getVerifyFunctionPrototype(const std::string& spa
         return output;
 
     // Go get any children structures verify functions
-    if(includeChildren && (support.language == ProtocolSupport::c_language))
+    if(includeChildren && (support->language == ProtocolSupport::c_language))
     {
         for(std::size_t i = 0; i < encodables.size(); i++)
         {
@@ -2320,7 +2580,7 @@ std::string ProtocolStructure::getVerifyFunctionBody(bool includeChildren) const
     output += " * verified, only those which the protocol specifies. Fields which are outside\n";
     output += " * the allowable range are changed to the maximum or minimum allowable value. \n";
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
         output += " * \\param _pg_user is the structure whose data are verified\n";
         output += " * \\return 1 if all verifiable data where valid, else 0 if data had to be corrected\n";
@@ -2351,9 +2611,10 @@ std::string ProtocolStructure::getVerifyFunctionBody(bool includeChildren) const
     }
 
     ProtocolFile::makeLineSeparator(output);
+    output += getVerifyCompletionString();
     output += TAB_IN + "return _pg_good;\n";
     output += "\n";
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += "}// verify" + typeName + "\n";
     else
         output += "}// " + typeName + "::verify\n";
@@ -2370,7 +2631,7 @@ std::string ProtocolStructure::getVerifyFunctionBody(bool includeChildren) const
  */
 std::string ProtocolStructure::getComparisonFunctionSignature(bool insource) const
 {
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
         if(insource)
             return "std::string compare" + typeName + "(const std::string& _pg_prename, const " + structName + "* _pg_user1, const " + structName + "* _pg_user2)";
@@ -2403,7 +2664,7 @@ std::string ProtocolStructure::getComparisonFunctionPrototype(const std::string&
         return output;
 
     // Go get any children structures compare functions
-    if(includeChildren && (support.language == ProtocolSupport::c_language))
+    if(includeChildren && (support->language == ProtocolSupport::c_language))
     {
         for(std::size_t i = 0; i < encodables.size(); i++)
         {
@@ -2461,7 +2722,7 @@ std::string ProtocolStructure::getComparisonFunctionBody(bool includeChildren) c
     // My compare function
     output += "/*!\n";
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
         output += " * Compare two " + typeName + " and generate a report of any differences.\n";
         output += " * \\param _pg_prename is prepended to the name of the data field in the comparison report\n";
@@ -2496,7 +2757,7 @@ std::string ProtocolStructure::getComparisonFunctionBody(bool includeChildren) c
     ProtocolFile::makeLineSeparator(output);
     output += TAB_IN + "return _pg_report;\n";
     output += "\n";
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += "}// compare" + typeName + "\n";
     else
         output += "}// " + typeName + "::compare\n";
@@ -2513,7 +2774,7 @@ std::string ProtocolStructure::getComparisonFunctionBody(bool includeChildren) c
  */
 std::string ProtocolStructure::getTextPrintFunctionSignature(bool insource) const
 {
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
         if(insource)
             return "std::string textPrint" + typeName + "(const std::string& _pg_prename, const " + structName + "* _pg_user)";
@@ -2546,7 +2807,7 @@ std::string ProtocolStructure::getTextPrintFunctionPrototype(const std::string&
         return output;
 
     // Go get any children structures textPrint functions
-    if(includeChildren && (support.language == ProtocolSupport::c_language))
+    if(includeChildren && (support->language == ProtocolSupport::c_language))
     {
         for(std::size_t i = 0; i < encodables.size(); i++)
         {
@@ -2604,7 +2865,7 @@ std::string ProtocolStructure::getTextPrintFunctionBody(bool includeChildren) co
     output += "/*!\n";
     output += " * Generate a string that describes the contents of a " + typeName + "\n";
     output += " * \\param _pg_prename is prepended to the name of the data field in the report\n";
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += " * \\param _pg_user is the structure to report\n";
     output += " * \\return a string containing a report of the contents of user\n";
     output += " */\n";
@@ -2627,7 +2888,7 @@ std::string ProtocolStructure::getTextPrintFunctionBody(bool includeChildren) co
     ProtocolFile::makeLineSeparator(output);
     output += TAB_IN + "return _pg_report;\n";
     output += "\n";
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += "}// textPrint" + typeName + "\n";
     else
         output += "}// " + typeName + "::textPrint\n";
@@ -2644,19 +2905,19 @@ std::string ProtocolStructure::getTextPrintFunctionBody(bool includeChildren) co
  */
 std::string ProtocolStructure::getTextReadFunctionSignature(bool insource) const
 {
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
         if(insource)
-            return "int textRead" + typeName + "(const std::string& _pg_prename, const std::string& _pg_source, " + structName + "* _pg_user)";
+            return "int textRead" + typeName + "(const std::string& _pg_prename, const std::string& _pg_source, " + structName + "* _pg_user, std::size_t* _pg_cursor)";
         else
-            return "int textRead" + typeName + "(const std::string& prename, const std::string& source, " + structName + "* user)";
+            return "int textRead" + typeName + "(const std::string& prename, const std::string& source, " + structName + "* user, std::size_t* cursor = nullptr)";
     }
     else
     {
         if(insource)
-            return "int " + typeName + "::textRead(const std::string& _pg_prename, const std::string& _pg_source)";
+            return "int " + typeName + "::textRead(const std::string& _pg_prename, const std::string& _pg_source, std::size_t* _pg_cursor)";
         else
-            return "int textRead(const std::string& prename, const std::string& source)";
+            return "int textRead(const std::string& prename, const std::string& source, std::size_t* cursor = nullptr)";
     }
 
 }// ProtocolStructure::getTextReadFunctionSignature
@@ -2679,7 +2940,7 @@ std::string ProtocolStructure::getTextReadFunctionPrototype(const std::string& s
         return output;
 
     // Go get any children structures textRead functions
-    if(includeChildren && (support.language == ProtocolSupport::c_language))
+    if(includeChildren && (support->language == ProtocolSupport::c_language))
     {
         for(std::size_t i = 0; i < encodables.size(); i++)
         {
@@ -2738,13 +2999,17 @@ std::string ProtocolStructure::getTextReadFunctionBody(bool includeChildren) con
     output += " * Read the contents of a " + typeName + " structure from text\n";
     output += " * \\param _pg_prename is prepended to the name of the data field to form the text key\n";
     output += " * \\param _pg_source is text to search to find the data field keys\n";
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += " * \\param _pg_user receives any data read from the text source\n";
+    output += " * \\param _pg_cursor is the location in the source to start searching for\n";
+    output += " *        keys, which is updated as keys are found. Pass null to start at the\n";
+    output += " *        beginning of the source.\n";
     output += " * \\return The number of fields that were read from the text source\n";
     output += " */\n";
     output += getTextReadFunctionSignature(true) + "\n";
     output += "{\n";
-    output += TAB_IN + "std::string _pg_text;\n";
+    output += TAB_IN + "std::string_view _pg_text;\n";
+    output += TAB_IN + "std::size_t _pg_start = 0;\n";
     output += TAB_IN + "int _pg_fieldcount = 0;\n";
 
     if(needsDecodeIterator)
@@ -2753,6 +3018,11 @@ std::string ProtocolStructure::getTextReadFunctionBody(bool includeChildren) con
     if(needs2ndDecodeIterator)
         output += TAB_IN + "unsigned _pg_j = 0;\n";
 
+    // The text is read in the same order it was printed, so each search picks up where the last one ended
+    output += "\n";
+    output += TAB_IN + "if(_pg_cursor == nullptr)\n";
+    output += TAB_IN + TAB_IN + "_pg_cursor = &_pg_start;\n";
+
     for(std::size_t i = 0; i < encodables.size(); i++)
     {
         ProtocolFile::makeLineSeparator(output);
@@ -2762,7 +3032,7 @@ std::string ProtocolStructure::getTextReadFunctionBody(bool includeChildren) con
     ProtocolFile::makeLineSeparator(output);
     output += TAB_IN + "return _pg_fieldcount;\n";
     output += "\n";
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += "}// textRead" + typeName + "\n";
     else
         output += "}// " + typeName + "::textRead\n";
@@ -2779,7 +3049,25 @@ std::string ProtocolStructure::getTextReadFunctionBody(bool includeChildren) con
  */
 std::string ProtocolStructure::getMapEncodeFunctionSignature(bool insource) const
 {
-    if(support.language == ProtocolSupport::c_language)
+    if(support->flatmap)
+    {
+        if(support->language == ProtocolSupport::c_language)
+        {
+            if(insource)
+                return "void mapEncode" + typeName + "(uint64_t _pg_prekey, pgFlatMap& _pg_map, const " + structName + "* _pg_user)";
+            else
+                return "void mapEncode" + typeName + "(uint64_t prekey, pgFlatMap& map, const " + structName + "* user)";
+        }
+        else
+        {
+            if(insource)
+                return "void " + typeName + "::mapEncode(uint64_t _pg_prekey, pgFlatMap& _pg_map) const";
+            else
+                return "void mapEncode(uint64_t prekey, pgFlatMap& map) const";
+        }
+    }
+
+    if(support->language == ProtocolSupport::c_language)
     {
         if(insource)
             return "void mapEncode" + typeName + "(const QString& _pg_prename, QVariantMap& _pg_map, const " + structName + "* _pg_user)";
@@ -2813,7 +3101,7 @@ std::string ProtocolStructure::getMapEncodeFunctionPrototype(const std::string&
     if(!mapEncode || (getNumberOfDecodeParameters() == 0))
         return output;
 
-    if(includeChildren && (support.language == ProtocolSupport::c_language))
+    if(includeChildren && (support->language == ProtocolSupport::c_language))
     {
         for(std::size_t i = 0; i < encodables.size();  i++)
         {
@@ -2830,8 +3118,17 @@ std::string ProtocolStructure::getMapEncodeFunctionPrototype(const std::string&
         ProtocolFile::makeLineSeparator(output);
     }
 
+    // The flat map key table goes with the mapEncode function
+    if(support->flatmap)
+    {
+        output += getMapKeyTable(spacing, false);
+        ProtocolFile::makeLineSeparator(output);
+        output += spacing + "//! Encode the contents of a " + typeName + " to a flat map\n";
+    }
+    else
+        output += spacing + "//! Encode the contents of a " + typeName + " to a string Key:Value map\n";
+
     // My mapEncode function
-    output += spacing + "//! Encode the contents of a " + typeName + " to a string Key:Value map\n";
     output += spacing + getMapEncodeFunctionSignature(false) + ";\n";
 
     return output;
@@ -2867,17 +3164,33 @@ std::string ProtocolStructure::getMapEncodeFunctionBody(bool includeChildren) co
         ProtocolFile::makeLineSeparator(output);
     }
 
+    if(support->flatmap)
+    {
+        // The flat map key table goes with the mapEncode function
+        output += getMapKeyTable(std::string(), true);
+        ProtocolFile::makeLineSeparator(output);
+
+        output += "/*!\n";
+        output += " * Encode the contents of a " + typeName + " to a flat map\n";
+        output += " * \\param _pg_prekey is the key of the parent of the fields in the map\n";
+    }
+    else
+    {
+        output += "/*!\n";
+        output += " * Encode the contents of a " + typeName + " to a Key:Value string map\n";
+        output += " * \\param _pg_prename is prepended to the key fields in the map\n";
+    }
+
     // My mapEncode function
-    output += "/*!\n";
-    output += " * Encode the contents of a " + typeName + " to a Key:Value string map\n";
-    output += " * \\param _pg_prename is prepended to the key fields in the map\n";
     output += " * \\param _pg_map is a reference to the map\n";
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += " * \\param _pg_user is the structure to encode\n";
     output += " */\n";
     output += getMapEncodeFunctionSignature(true) + "\n";
     output += "{\n";
-    output += TAB_IN + "QString key;\n";
+
+    if(!support->flatmap)
+        output += TAB_IN + "QString key;\n";
 
     if(needsDecodeIterator)
         output += TAB_IN + "unsigned _pg_i = 0;\n";
@@ -2893,7 +3206,7 @@ std::string ProtocolStructure::getMapEncodeFunctionBody(bool includeChildren) co
 
     ProtocolFile::makeLineSeparator(output);
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += "}// mapEncode" + typeName + "\n";
     else
         output += "}// " + typeName + "::mapEncode\n";
@@ -2910,7 +3223,25 @@ std::string ProtocolStructure::getMapEncodeFunctionBody(bool includeChildren) co
  */
 std::string ProtocolStructure::getMapDecodeFunctionSignature(bool insource) const
 {
-    if(support.language == ProtocolSupport::c_language)
+    if(support->flatmap)
+    {
+        if(support->language == ProtocolSupport::c_language)
+        {
+            if(insource)
+                return "void mapDecode" + typeName + "(uint64_t _pg_prekey, const pgFlatMap& _pg_map, " + structName + "* _pg_user)";
+            else
+                return "void mapDecode" + typeName + "(uint64_t prekey, const pgFlatMap& map, " + structName + "* user)";
+        }
+        else
+        {
+            if(insource)
+                return "void " + typeName + "::mapDecode(uint64_t _pg_prekey, const pgFlatMap& _pg_map)";
+            else
+                return "void mapDecode(uint64_t prekey, const pgFlatMap& map)";
+        }
+    }
+
+    if(support->language == ProtocolSupport::c_language)
     {
         if(insource)
             return "void mapDecode" + typeName + "(const QString& _pg_prename, const QVariantMap& _pg_map, " + structName + "* _pg_user)";
@@ -2943,7 +3274,7 @@ std::string ProtocolStructure::getMapDecodeFunctionPrototype(const std::string&
     if(!mapEncode || (getNumberOfDecodeParameters() == 0))
         return output;
 
-    if(includeChildren && (support.language == ProtocolSupport::c_language))
+    if(includeChildren && (support->language == ProtocolSupport::c_language))
     {
         for(std::size_t i = 0; i < encodables.size();  i++)
         {
@@ -2960,8 +3291,11 @@ std::string ProtocolStructure::getMapDecodeFunctionPrototype(const std::string&
         ProtocolFile::makeLineSeparator(output);
     }
 
-    // My mapEncode function
-    output += spacing + "//! Decode the contents of a " + typeName + " from a string Key:Value map\n";
+    // My mapDecode function
+    if(support->flatmap)
+        output += spacing + "//! Decode the contents of a " + typeName + " from a flat map\n";
+    else
+        output += spacing + "//! Decode the contents of a " + typeName + " from a string Key:Value map\n";
     output += spacing + getMapDecodeFunctionSignature(false) + ";\n";
 
     return output;
@@ -3013,19 +3347,37 @@ std::string ProtocolStructure::getMapDecodeFunctionBody(bool includeChildren) co
 
     // My mapDecode function
     output += "/*!\n";
-    output += " * Decode the contents of a " + typeName + " from a Key:Value string map\n";
-    output += " * \\param _pg_prename is prepended to the key fields in the map\n";
+    if(support->flatmap)
+    {
+        output += " * Decode the contents of a " + typeName + " from a flat map\n";
+        output += " * \\param _pg_prekey is the key of the parent of the fields in the map\n";
+    }
+    else
+    {
+        output += " * Decode the contents of a " + typeName + " from a Key:Value string map\n";
+        output += " * \\param _pg_prename is prepended to the key fields in the map\n";
+    }
     output += " * \\param _pg_map is a reference to the map\n";
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += " * \\param _pg_user is the structure to decode\n";
     output += " */\n";
     output += getMapDecodeFunctionSignature(true) + "\n";
     output += "{\n";
-    output += TAB_IN + "QString key;\n";
 
-    // We only need the "ok" variable if this structure contains primitive types.
-    if(containsprimitives)
-        output += TAB_IN + "bool ok = false;\n";
+    if(support->flatmap)
+    {
+        // Primitive types are looked up in the map, structures do their own look up
+        if(containsprimitives)
+            output += TAB_IN + "const pgFlatMapValue* _pg_value = nullptr;\n";
+    }
+    else
+    {
+        output += TAB_IN + "QString key;\n";
+
+        // We only need the "ok" variable if this structure contains primitive types.
+        if(containsprimitives)
+            output += TAB_IN + "bool ok = false;\n";
+    }
 
     if(needsDecodeIterator)
         output += TAB_IN + "unsigned _pg_i = 0;\n";
@@ -3041,7 +3393,7 @@ std::string ProtocolStructure::getMapDecodeFunctionBody(bool includeChildren) co
 
     ProtocolFile::makeLineSeparator(output);
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
         output += "}// mapDecode" + typeName + "\n";
     else
         output += "}// " + typeName + "::mapDecode\n";
@@ -3051,6 +3403,404 @@ std::string ProtocolStructure::getMapDecodeFunctionBody(bool includeChildren) co
 }// ProtocolStructure::getMapDecodeFunctionString
 
 
+/*!
+ * Get the flat map key table of this structure, which lists the identifier
+ * and name of every field that is stored in the flat map.
+ * \param spacing gives the spacing to offset each line.
+ * \param insource should be true for the definition of the table, else this
+ *        is the declaration.
+ * \return the key table string
+ */
+std::string ProtocolStructure::getMapKeyTable(const std::string& spacing, bool insource) const
+{
+    std::string output;
+
+    if(!insource)
+    {
+        output += spacing + "//! Identifiers and names of the " + typeName + " fields in a flat map, terminated by a null name\n";
+
+        if(support->language == ProtocolSupport::c_language)
+            output += spacing + "extern const pgFlatMapKeyEntry mapKeys" + typeName + "[];\n";
+        else
+            output += spacing + "static const pgFlatMapKeyEntry mapKeys[];\n";
+
+        return output;
+    }
+
+    if(support->language == ProtocolSupport::c_language)
+        output += "const pgFlatMapKeyEntry mapKeys" + typeName + "[] =\n";
+    else
+        output += "const pgFlatMapKeyEntry " + typeName + "::mapKeys[] =\n";
+
+    output += "{\n";
+
+    std::vector<std::string> names;
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        const Encodable* encodable = encodables.at(i);
+
+        if(encodable->getMapEncodeString().empty() && encodable->getMapDecodeString().empty())
+            continue;
+
+        // The same field can be listed more than once (for example with different dependsOn values)
+        if(contains(names, encodable->name, true))
+            continue;
+
+        uint32_t id = getFlatMapId(encodable->name);
+        for(std::size_t j = 0; j < names.size(); j++)
+        {
+            if(getFlatMapId(names.at(j)) == id)
+                emitWarning("flat map identifier of field collides with field " + names.at(j), encodable->name);
+        }
+        names.push_back(encodable->name);
+
+        output += TAB_IN + "{" + getFlatMapIdString(encodable->name) + ", \"" + encodable->name + "\"},\n";
+    }
+
+    output += TAB_IN + "{0, nullptr}\n";
+    output += "};\n";
+
+    return output;
+
+}// ProtocolStructure::getMapKeyTable
+
+
+/*!
+ * Get the signature of one of the JSON or CBOR functions.
+ * \param write should be true for the function that writes, else the function that reads.
+ * \param cbor should be true for the CBOR function, else the JSON function.
+ * \param insource should be true to indicate this signature is in source code.
+ * \return the signature of the function.
+ */
+std::string ProtocolStructure::getJsonFunctionSignature(bool write, bool cbor, bool insource) const
+{
+    std::string format = cbor ? "Cbor" : "Json";
+    std::string object = write ? "pg" + format + "Writer& " : "pg" + format + "Reader& ";
+    std::string function = write ? "to" + format : "from" + format;
+    std::string returntype = write ? "void " : "int ";
+    std::string prefix = insource ? "_pg_" : "";
+
+    object += prefix + (write ? "writer" : "reader");
+
+    if(support->language == ProtocolSupport::c_language)
+    {
+        if(write)
+            return returntype + function + typeName + "(" + object + ", const " + structName + "* " + prefix + "user)";
+        else
+            return returntype + function + typeName + "(" + object + ", " + structName + "* " + prefix + "user)";
+    }
+    else
+    {
+        if(insource)
+            return returntype + typeName + "::" + function + "(" + object + ")" + (write ? " const" : "");
+        else
+            return returntype + function + "(" + object + ")" + (write ? " const" : "");
+    }
+
+}// ProtocolStructure::getJsonFunctionSignature
+
+
+/*!
+ * Return the string that gives the prototypes of the functions used to write
+ * and read this structure as JSON and CBOR
+ * \param spacing gives the spacing to offset each line.
+ * \param includeChildren should be true to include the function prototypes of
+ *        the children structures of this structure
+ * \return the function prototype string, which may be empty
+ */
+std::string ProtocolStructure::getJsonFunctionPrototype(const std::string& spacing, bool includeChildren) const
+{
+    std::string output;
+
+    // We must have parameters that we decode to do a write or read
+    if(!json || (getNumberOfDecodeParameters() == 0))
+        return output;
+
+    // Go get any children structures JSON functions
+    if(includeChildren && (support->language == ProtocolSupport::c_language))
+    {
+        for(std::size_t i = 0; i < encodables.size(); i++)
+        {
+            ProtocolStructure* structure = dynamic_cast<ProtocolStructure*>(encodables.at(i));
+
+            if(!structure)
+                continue;
+
+            ProtocolFile::makeLineSeparator(output);
+            output += structure->getJsonFunctionPrototype(spacing, includeChildren);
+        }
+        ProtocolFile::makeLineSeparator(output);
+    }
+
+    // My JSON and CBOR functions
+    output += spacing + "//! Write the contents of a " + typeName + " as a JSON object\n";
+    output += spacing + getJsonFunctionSignature(true, false, false) + ";\n";
+    output += "\n";
+    output += spacing + "//! Write the contents of a " + typeName + " as a CBOR map\n";
+    output += spacing + getJsonFunctionSignature(true, true, false) + ";\n";
+    output += "\n";
+    output += spacing + "//! Read the contents of a " + typeName + " from a JSON object\n";
+    output += spacing + getJsonFunctionSignature(false, false, false) + ";\n";
+    output += "\n";
+    output += spacing + "//! Read the contents of a " + typeName + " from a CBOR map\n";
+    output += spacing + getJsonFunctionSignature(false, true, false) + ";\n";
+
+    return output;
+
+}// ProtocolStructure::getJsonFunctionPrototype
+
+
+/*!
+ * Return the string that gives the functions used to write and read this
+ * structure as JSON and CBOR
+ * \param includeChildren should be true to include the functions of the
+ *        children structures of this structure
+ * \return the function string, which may be empty
+ */
+std::string ProtocolStructure::getJsonFunctionBody(bool includeChildren) const
+{
+    std::string output;
+
+    // We must have parameters that we decode to do a write or read
+    if(!json || (getNumberOfDecodeParameters() == 0))
+        return output;
+
+    // Go get any childrens structure JSON functions
+    if(includeChildren)
+    {
+        for(std::size_t i = 0; i < encodables.size(); i++)
+        {
+            ProtocolStructure* structure = dynamic_cast<ProtocolStructure*>(encodables.at(i));
+
+            if(!structure)
+                continue;
+
+            ProtocolFile::makeLineSeparator(output);
+            output += structure->getJsonFunctionBody(includeChildren);
+        }
+        ProtocolFile::makeLineSeparator(output);
+    }
+
+    output += getJsonWriteFunctionBody(false);
+    output += "\n\n";
+    output += getJsonWriteFunctionBody(true);
+    output += "\n\n";
+    output += getJsonReadFunctionBody(false);
+    output += "\n\n";
+    output += getJsonReadFunctionBody(true);
+
+    return output;
+
+}// ProtocolStructure::getJsonFunctionBody
+
+
+/*!
+ * Get the function that writes this structure as a JSON object or CBOR map
+ * \param cbor should be true for the CBOR function, else the JSON function.
+ * \return the function string
+ */
+std::string ProtocolStructure::getJsonWriteFunctionBody(bool cbor) const
+{
+    std::string output;
+    std::vector<std::string> names;
+
+    output += "/*!\n";
+    if(cbor)
+        output += " * Write the contents of a " + typeName + " as a CBOR map\n";
+    else
+        output += " * Write the contents of a " + typeName + " as a JSON object\n";
+    output += " * \\param _pg_writer receives the output\n";
+    if(support->language == ProtocolSupport::c_language)
+        output += " * \\param _pg_user is the structure to write\n";
+    output += " */\n";
+    output += getJsonFunctionSignature(true, cbor, true) + "\n";
+    output += "{\n";
+
+    if(needsDecodeIterator)
+        output += TAB_IN + "unsigned _pg_i = 0;\n";
+
+    if(needs2ndDecodeIterator)
+        output += TAB_IN + "unsigned _pg_j = 0;\n";
+
+    ProtocolFile::makeLineSeparator(output);
+    output += TAB_IN + "_pg_writer.beginObject();\n";
+
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        // Alternative encodings of the same field are only written once
+        if(contains(names, encodables.at(i)->name, true))
+            continue;
+
+        std::string field = encodables.at(i)->getJsonWriteString(cbor);
+        if(field.empty())
+            continue;
+
+        names.push_back(encodables.at(i)->name);
+        ProtocolFile::makeLineSeparator(output);
+        output += field;
+    }
+
+    ProtocolFile::makeLineSeparator(output);
+    output += TAB_IN + "_pg_writer.endObject();\n";
+    output += "\n";
+    if(support->language == ProtocolSupport::c_language)
+        output += std::string("}// ") + (cbor ? "toCbor" : "toJson") + typeName + "\n";
+    else
+        output += "}// " + typeName + (cbor ? "::toCbor" : "::toJson") + "\n";
+
+    return output;
+
+}// ProtocolStructure::getJsonWriteFunctionBody
+
+
+/*!
+ * Get the function that reads this structure from a JSON object or CBOR map.
+ * The field for each key is found by a switch on a perfect hash of the field
+ * names, so the cost of a key does not depend on the number of fields.
+ * \param cbor should be true for the CBOR function, else the JSON function.
+ * \return the function string
+ */
+std::string ProtocolStructure::getJsonReadFunctionBody(bool cbor) const
+{
+    std::string output;
+    std::vector<std::string> names;
+    std::vector<std::string> fields;
+    std::string spacing = TAB_IN + TAB_IN + TAB_IN + TAB_IN;
+
+    for(std::size_t i = 0; i < encodables.size(); i++)
+    {
+        // Alternative encodings of the same field are only read once
+        if(contains(names, encodables.at(i)->name, true))
+            continue;
+
+        std::string field = encodables.at(i)->getJsonReadString(spacing, cbor);
+        if(field.empty())
+            continue;
+
+        names.push_back(encodables.at(i)->name);
+        fields.push_back(field);
+    }
+
+    output += "/*!\n";
+    if(cbor)
+        output += " * Read the contents of a " + typeName + " from a CBOR map. Keys that are not\n";
+    else
+        output += " * Read the contents of a " + typeName + " from a JSON object. Keys that are not\n";
+    output += " * fields of the structure are skipped.\n";
+    output += " * \\param _pg_reader is the source of the input\n";
+    if(support->language == ProtocolSupport::c_language)
+        output += " * \\param _pg_user receives any data read\n";
+    output += " * \\return The number of fields that were read\n";
+    output += " */\n";
+    output += getJsonFunctionSignature(false, cbor, true) + "\n";
+    output += "{\n";
+    output += TAB_IN + "std::string_view _pg_key;\n";
+    output += TAB_IN + "int _pg_fieldcount = 0;\n";
+
+    if(needsDecodeIterator)
+        output += TAB_IN + "unsigned _pg_i = 0;\n";
+
+    if(needs2ndDecodeIterator)
+        output += TAB_IN + "unsigned _pg_j = 0;\n";
+
+    output += "\n";
+    output += TAB_IN + "if(!_pg_reader.beginObject())\n";
+    output += TAB_IN + TAB_IN + "return _pg_fieldcount;\n";
+    output += "\n";
+    output += TAB_IN + "while(_pg_reader.nextKey(_pg_key))\n";
+    output += TAB_IN + "{\n";
+
+    if(!names.empty())
+    {
+        uint32_t seed = 0, modulus = 1;
+        std::vector<uint32_t> slots;
+
+        getPerfectHash(names, seed, modulus);
+
+        for(std::size_t i = 0; i < names.size(); i++)
+            slots.push_back(getFieldNameHash(names.at(i), seed) % modulus);
+
+        output += TAB_IN + TAB_IN + "// Find the field from a perfect hash of the field names\n";
+        output += TAB_IN + TAB_IN + "switch(pgFieldHash(_pg_key, " + std::to_string(seed) + "u) % " + std::to_string(modulus) + "u)\n";
+        output += TAB_IN + TAB_IN + "{\n";
+
+        // The cases in order of their slots
+        for(uint32_t slot = 0; slot < modulus; slot++)
+        {
+            for(std::size_t i = 0; i < names.size(); i++)
+            {
+                if(slots.at(i) != slot)
+                    continue;
+
+                output += TAB_IN + TAB_IN + "case " + std::to_string(slot) + ":\n";
+                output += TAB_IN + TAB_IN + TAB_IN + "if(_pg_key == \"" + names.at(i) + "\")\n";
+                output += TAB_IN + TAB_IN + TAB_IN + "{\n";
+                output += fields.at(i);
+                output += spacing + "continue;\n";
+                output += TAB_IN + TAB_IN + TAB_IN + "}\n";
+                output += TAB_IN + TAB_IN + TAB_IN + "break;\n";
+            }
+        }
+
+        output += TAB_IN + TAB_IN + "}\n";
+        output += "\n";
+    }
+
+    output += TAB_IN + TAB_IN + "// Keys which are not fields are skipped\n";
+    output += TAB_IN + TAB_IN + "_pg_reader.skipValue();\n";
+    output += "\n";
+    output += TAB_IN + "}// while keys remain\n";
+    output += "\n";
+    output += TAB_IN + "return _pg_fieldcount;\n";
+    output += "\n";
+    if(support->language == ProtocolSupport::c_language)
+        output += std::string("}// ") + (cbor ? "fromCbor" : "fromJson") + typeName + "\n";
+    else
+        output += "}// " + typeName + (cbor ? "::fromCbor" : "::fromJson") + "\n";
+
+    return output;
+
+}// ProtocolStructure::getJsonReadFunctionBody
+
+
+/*!
+ * Find a perfect hash of a list of names, which gives a different value of
+ * getFieldNameHash(name, seed) % modulus for each name. The smallest modulus
+ * is preferred, so the switch that uses the hash is dense.
+ * \param names is the list of unique names.
+ * \param seed receives the seed of the hash.
+ * \param modulus receives the modulus of the hash.
+ */
+void ProtocolStructure::getPerfectHash(const std::vector<std::string>& names, uint32_t& seed, uint32_t& modulus)
+{
+    std::vector<bool> used;
+
+    for(modulus = (uint32_t)names.size(); ; modulus++)
+    {
+        for(seed = 0; seed < 4096; seed++)
+        {
+            std::size_t i = 0;
+
+            used.assign(modulus, false);
+            for(; i < names.size(); i++)
+            {
+                uint32_t slot = getFieldNameHash(names.at(i), seed) % modulus;
+
+                if(used.at(slot))
+                    break;
+
+                used.at(slot) = true;
+            }
+
+            if(i == names.size())
+                return;
+        }
+
+    }// for increasing modulus
+
+}// ProtocolStructure::getPerfectHash
+
+
 /*!
  * Get details needed to produce documentation for this encodable.
  * \param parentName is the name of the parent which will be pre-pended to the name of this encodable
@@ -12,7 +12,7 @@ class ProtocolStructure : public Encodable
 public:
 
     //! Default constructor for protocol structure
-    ProtocolStructure(ProtocolParser* parse, std::string Parent, ProtocolSupport supported);
+    ProtocolStructure(ProtocolParser* parse, std::string Parent, SharedSupport supported);
 
     //! Reset all data to defaults
     void clear(void) override;
@@ -41,6 +41,12 @@ public:
     //! Return the string that sets this encodable to its initial value in code
     std::string getSetInitialValueString(bool isStructureMember) const override;
 
+    //! Return the value of this structure in the static initializer of its parent, empty if zero
+    std::string getStaticInitializerString(bool* ok) const override;
+
+    //! Return the C static initializer of this structure type, empty if zero
+    std::string getStaticInitializer(bool* ok, const std::string& spacing = std::string()) const;
+
     //! Return the strings that #define initial and variable values
     std::string getInitialAndVerifyDefines(bool includeComment = true) const override;
 
@@ -68,6 +74,12 @@ public:
     //! Return the string used for map decoding this structure
     std::string getMapDecodeString(void) const override;
 
+    //! Return the string used for writing this structure to JSON or CBOR
+    std::string getJsonWriteString(bool cbor) const override;
+
+    //! Return the string used for reading this structure from JSON or CBOR
+    std::string getJsonReadString(const std::string& spacing, bool cbor) const override;
+
     //! Parse the DOM data for this structures children
     void parseChildren(const XMLElement* field);
 
@@ -80,6 +92,9 @@ public:
     //! Set the mapEncode flag for this structure and all children structure
     void setMapEncode(bool enable);
 
+    //! Set the json flag for this structure and all children structure
+    void setJson(bool enable);
+
     //! Determine if this encodable is a primitive, rather than a structure
     bool isPrimitive(void) const override {return false;}
 
@@ -211,6 +226,19 @@ public:
     //! Return the string that gives the function used to decode this structure from a map
     virtual std::string getMapDecodeFunctionBody(bool includeChildren = true) const;
 
+    //! Get the flat map key table of this structure
+    std::string getMapKeyTable(const std::string& spacing, bool insource) const;
+
+
+    //! Return the string that gives the signature of one of the functions used to write or read this structure as JSON or CBOR
+    virtual std::string getJsonFunctionSignature(bool write, bool cbor, bool insource) const;
+
+    //! Return the string that gives the prototypes of the functions used to write and read this structure as JSON and CBOR
+    virtual std::string getJsonFunctionPrototype(const std::string& spacing = std::string(), bool includeChildren = true) const;
+
+    //! Return the string that gives the functions used to write and read this structure as JSON and CBOR
+    virtual std::string getJsonFunctionBody(bool includeChildren = true) const;
+
 
     //! Return the string that gives the signature of the function used to initialize this structure
     virtual std::string getSetToInitialValueFunctionSignature(bool insource) const;
@@ -221,6 +249,12 @@ public:
     //! Return the string that gives the function used to initialize this structure
     virtual std::string getSetToInitialValueFunctionBody(bool includeChildren = true) const;
 
+    //! Return the C++ constructor initializer list of members which are not initialized in the class declaration
+    std::string getConstructorInitializerList(void) const;
+
+    //! Determine if the C++ constructor can be defaulted, because every member is initialized in the class declaration
+    bool hasDefaultedConstructor(void) const;
+
 
     //! Return the string that gives the signature of the second function used to initialize this structure
     virtual std::string getSecondSetToInitialValueFunctionSignature(bool insource) const;
@@ -232,6 +266,9 @@ public:
     virtual std::string getSecondSetToInitialValueFunctionBody(bool includeChildren = true) const;
 
 
+    //! Get the children encodables of this structure
+    const std::vector<Encodable*>& getEncodables(void) const {return encodables;}
+
     //! Get the number of fields that are encoded
     int getNumberOfEncodes(void) const;
 
@@ -256,6 +293,9 @@ public:
     //! Return the include directives needed for this encodable's map functions
     void getMapIncludeDirectives(std::vector<std::string>& list) const override;
 
+    //! Return the include directives needed for this encodable's JSON and CBOR functions
+    void getJsonIncludeDirectives(std::vector<std::string>& list) const override;
+
     //! Return the include directives needed for this encodable's compare functions
     void getCompareIncludeDirectives(std::vector<std::string>& list) const override;
 
@@ -294,6 +334,18 @@ protected:
     //! Create utility functions for structure lengths
     virtual std::string createUtilityFunctions(const std::string& spacing) const {(void)spacing; return std::string();}
 
+    //! Get code that runs at the end of the verify function, just before it returns
+    virtual std::string getVerifyCompletionString(void) const {return std::string();}
+
+    //! Get the function that writes this structure as JSON or CBOR
+    std::string getJsonWriteFunctionBody(bool cbor) const;
+
+    //! Get the function that reads this structure from JSON or CBOR
+    std::string getJsonReadFunctionBody(bool cbor) const;
+
+    //! Find a perfect hash of a list of names
+    static void getPerfectHash(const std::vector<std::string>& names, uint32_t& seed, uint32_t& modulus);
+
     //! Make a structure output be prettily aligned
     std::string alignStructureData(const std::string& structure) const;
 
@@ -314,6 +366,8 @@ protected:
     bool usestempdecodelongbitfields;   //!< True if this structure uses a temporary long bitfield for decoding
     bool needsEncodeIterator;           //!< True if this structure uses arrays iterators on encode
     bool needsDecodeIterator;           //!< True if this structure uses arrays iterators on decode
+    bool needsCodecEncodeIterator;      //!< True if this structure uses arrays iterators in the encode function
+    bool needsCodecDecodeIterator;      //!< True if this structure uses arrays iterators in the decode function
     bool needsInitIterator;             //!< True if this structure uses arrays iterators on initialization
     bool needsVerifyIterator;           //!< True if this structure uses arrays iterators on verification
     bool needs2ndEncodeIterator;        //!< True if this structure uses 2nd arrays iterators on encode
@@ -332,6 +386,7 @@ protected:
     bool compare;                       //!< True if the comparison function is output
     bool print;                         //!< True if the textPrint function is output
     bool mapEncode;                     //!< True if the mapEncode function is output
+    bool json;                          //!< True if the JSON and CBOR functions are output
     const ProtocolStructureModule* redefines; //!< Pointer to a structure that we are redefining
 
 };
@@ -7,19 +7,21 @@
  * \param parse points to the global protocol parser that owns everything
  * \param supported gives the supported features of the protocol
  */
-ProtocolStructureModule::ProtocolStructureModule(ProtocolParser* parse, ProtocolSupport supported) :
-    ProtocolStructure(parse, supported.protoName, supported),
-    source(supported),
-    header(supported),
-    _structHeader(supported),
-    _verifySource(supported),
-    _verifyHeader(supported),
-    _compareSource(supported),
-    _compareHeader(supported),
-    _printSource(supported),
-    _printHeader(supported),
-    _mapSource(supported),
-    _mapHeader(supported),
+ProtocolStructureModule::ProtocolStructureModule(ProtocolParser* parse, SharedSupport supported) :
+    ProtocolStructure(parse, supported->protoName, supported),
+    source(*supported),
+    header(*supported),
+    _structHeader(*supported),
+    _verifySource(*supported),
+    _verifyHeader(*supported),
+    _compareSource(*supported),
+    _compareHeader(*supported),
+    _printSource(*supported),
+    _printHeader(*supported),
+    _mapSource(*supported),
+    _mapHeader(*supported),
+    _jsonSource(*supported),
+    _jsonHeader(*supported),
     structHeader(&header),
     verifySource(&source),
     verifyHeader(&header),
@@ -28,11 +30,14 @@ ProtocolStructureModule::ProtocolStructureModule(ProtocolParser* parse, Protocol
     printSource(nullptr),
     printHeader(nullptr),
     mapSource(nullptr),
-    mapHeader(nullptr)
+    mapHeader(nullptr),
+    jsonSource(nullptr),
+    jsonHeader(nullptr),
+    cached(false)
 {
     // In the C language these files must have their modules, because they use
     // c++ features, in c++ they can output to the source and header files
-    if(support.language != ProtocolSupport::c_language)
+    if(support->language != ProtocolSupport::c_language)
     {
         compareSource = &source;
         compareHeader = &header;
@@ -40,10 +45,12 @@ ProtocolStructureModule::ProtocolStructureModule(ProtocolParser* parse, Protocol
         printHeader = &header;
         mapSource = &source;
         mapHeader = &header;
+        jsonSource = &source;
+        jsonHeader = &header;
     }
 
     // These are attributes on top of the normal structure that we support
-    std::vector<std::string> newattribs({"encode", "decode", "file", "deffile", "verifyfile", "comparefile", "printfile", "mapfile", "redefine", "compare", "print", "map"});
+    std::vector<std::string> newattribs({"encode", "decode", "file", "deffile", "verifyfile", "comparefile", "printfile", "mapfile", "jsonfile", "redefine", "compare", "print", "map", "json"});
 
     // Now append the new attributes onto our old list
     attriblist.insert(attriblist.end(), newattribs.begin(), newattribs.end());
@@ -70,12 +77,14 @@ void ProtocolStructureModule::clear(void)
     _printSource.clear();
     _mapSource.clear();
     _mapHeader.clear();
+    _jsonSource.clear();
+    _jsonHeader.clear();
     structHeader = &header;
     verifyHeader = &header;
     verifySource = &source;
 
     // In the C language these files must have their modules, because they use .cpp features
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
         compareSource = nullptr;
         compareHeader = nullptr;
@@ -83,6 +92,8 @@ void ProtocolStructureModule::clear(void)
         printHeader = nullptr;
         mapSource = nullptr;
         mapHeader = nullptr;
+        jsonSource = nullptr;
+        jsonHeader = nullptr;
     }
     else
     {
@@ -92,6 +103,8 @@ void ProtocolStructureModule::clear(void)
         printHeader = &header;
         mapSource = &source;
         mapHeader = &header;
+        jsonSource = &source;
+        jsonHeader = &header;
     }
 
     // Note that api, version, and support are not changed
@@ -154,6 +167,7 @@ void ProtocolStructureModule::parse(bool nocode)
     std::string comparemodulename = ProtocolParser::getAttribute("comparefile", map);
     std::string printmodulename = ProtocolParser::getAttribute("printfile", map);
     std::string mapmodulename = ProtocolParser::getAttribute("mapfile", map);
+    std::string jsonmodulename = ProtocolParser::getAttribute("jsonfile", map);
 
     encode = !ProtocolParser::isFieldClear(ProtocolParser::getAttribute("encode", map));
     decode = !ProtocolParser::isFieldClear(ProtocolParser::getAttribute("decode", map));
@@ -161,9 +175,10 @@ void ProtocolStructureModule::parse(bool nocode)
     // It is possible to suppress the globally specified compare output
     if(ProtocolParser::isFieldClear(ProtocolParser::getAttribute("compare", map)))
     {
-        support.compare = compare = false;
+        ProtocolSupport& changed = changeSupport();
+        changed.compare = compare = false;
+        changed.globalCompareName.clear();
         comparemodulename.clear();
-        support.globalCompareName.clear();
     }
     else if(ProtocolParser::isFieldSet(ProtocolParser::getAttribute("compare", map)))
         compare = true;
@@ -171,9 +186,10 @@ void ProtocolStructureModule::parse(bool nocode)
     // It is possible to suppress the globally specified print output
     if(ProtocolParser::isFieldClear(ProtocolParser::getAttribute("print", map)))
     {
-        support.print = print = false;
+        ProtocolSupport& changed = changeSupport();
+        changed.print = print = false;
+        changed.globalPrintName.clear();
         printmodulename.clear();
-        support.globalPrintName.clear();
     }
     else if(ProtocolParser::isFieldSet(ProtocolParser::getAttribute("print", map)))
         print = true;
@@ -181,13 +197,25 @@ void ProtocolStructureModule::parse(bool nocode)
     // It is possible to suppress the globally specified map output
     if(ProtocolParser::isFieldClear(ProtocolParser::getAttribute("map", map)))
     {
-        support.mapEncode = mapEncode = false;
+        ProtocolSupport& changed = changeSupport();
+        changed.mapEncode = mapEncode = false;
+        changed.globalMapName.clear();
         mapmodulename.clear();
-        support.globalMapName.clear();
     }
     else if(ProtocolParser::isFieldSet(ProtocolParser::getAttribute("map", map)))
         mapEncode = true;
 
+    // It is possible to suppress the globally specified json output
+    if(ProtocolParser::isFieldClear(ProtocolParser::getAttribute("json", map)))
+    {
+        ProtocolSupport& changed = changeSupport();
+        changed.json = json = false;
+        changed.globalJsonName.clear();
+        jsonmodulename.clear();
+    }
+    else if(ProtocolParser::isFieldSet(ProtocolParser::getAttribute("json", map)))
+        json = true;
+
     std::string redefinename = ProtocolParser::getAttribute("redefine", map);
 
     // Warnings for users
@@ -199,13 +227,13 @@ void ProtocolStructureModule::parse(bool nocode)
             emitWarning("Redefine must be different from name");
         else
         {
-            redefines = parser->lookUpStructure(support.prefix + redefinename + support.typeSuffix);
+            redefines = parser->lookUpStructure(support->prefix + redefinename + support->typeSuffix);
             if(redefines == NULL)
                 emitWarning("Could not find structure to redefine");
         }
 
         if(redefines != NULL)
-            structName = support.prefix + redefinename + support.typeSuffix;
+            structName = support->prefix + redefinename + support->typeSuffix;
     }
 
     // Don't output anything if caller asked us not to
@@ -213,14 +241,21 @@ void ProtocolStructureModule::parse(bool nocode)
         return;
 
     // Don't output if hidden and we are omitting hidden items
-    if(isHidden() && !neverOmit && support.omitIfHidden)
+    if(isHidden() && !neverOmit && support->omitIfHidden)
     {
         std::cout << "Skipping code output for hidden global structure " << getHierarchicalName() << std::endl;
         return;
     }
 
     // Do the bulk of the file creation and setup
-    setupFiles(moduleName, defheadermodulename, verifymodulename, comparemodulename, printmodulename, mapmodulename, true, true);
+    setupFiles(moduleName, defheadermodulename, verifymodulename, comparemodulename, printmodulename, mapmodulename, jsonmodulename, true, true);
+
+    // Nothing to write if the files are current from a previous run
+    if(cached)
+    {
+        discardCachedOutput();
+        return;
+    }
 
     // The functions to encoding and ecoding
     createStructureFunctions();
@@ -251,6 +286,13 @@ void ProtocolStructureModule::parse(bool nocode)
         mapHeader->flush();
     }
 
+    // Only write the JSON functions if we have JSON functions to support
+    if(json)
+    {
+        jsonSource->flush();
+        jsonHeader->flush();
+    }
+
     // We don't write the verify files to disk if we are not initializing or verifying anything
     if(hasInit() || hasVerify())
     {
@@ -261,6 +303,201 @@ void ProtocolStructureModule::parse(bool nocode)
 }// ProtocolStructureModule::parse
 
 
+/*!
+ * Discard everything written to the files of this module. This is used when
+ * the files are current from a previous run, in which case the file names are
+ * still needed (so other modules can include them) but nothing is written.
+ */
+void ProtocolStructureModule::discardCachedOutput(void)
+{
+    std::cout << "Skipping code output for unchanged " << getHierarchicalName() << std::endl;
+
+    source.clear();
+    header.clear();
+    _structHeader.clear();
+    _verifySource.clear();
+    _verifyHeader.clear();
+    _compareSource.clear();
+    _compareHeader.clear();
+    _printSource.clear();
+    _printHeader.clear();
+    _mapSource.clear();
+    _mapHeader.clear();
+    _jsonSource.clear();
+    _jsonHeader.clear();
+
+}// ProtocolStructureModule::discardCachedOutput
+
+
+/*!
+ * Get the function that benchmarks the encode and decode of this structure.
+ * The structure is filled by decoding random data, which puts every field
+ * within its encoded range, and then encoded and decoded in loops.
+ * \return the benchmark function, or an empty string if this structure
+ *         cannot be benchmarked because it does not encode and decode.
+ */
+std::string ProtocolStructureModule::getBenchmarkFunction(void) const
+{
+    // Redefined structures use the functions of the original
+    if(!encode || !decode || (redefines != nullptr) || encodedLength.maxEncodedLength.empty())
+        return std::string();
+
+    // No code was output
+    if(isHidden() && !neverOmit && support->omitIfHidden)
+        return std::string();
+
+    std::string declarations, prepare, encodeloop, decodeloop, cleanup;
+
+    if(support->language == ProtocolSupport::c_language)
+    {
+        declarations += TAB_IN + "int index = 0;\n";
+        declarations += TAB_IN + structName + " user;\n";
+        declarations += TAB_IN + "uint8_t* data = (uint8_t*)malloc(getMaxLengthOf" + typeName + "() + 1);\n";
+
+        prepare += TAB_IN + "if(data == NULL)\n";
+        prepare += TAB_IN + TAB_IN + "return 1;\n";
+        prepare += "\n";
+        prepare += TAB_IN + "// Decoding random data puts every field within its encoded range\n";
+        prepare += TAB_IN + "memset(&user, 0, sizeof(user));\n";
+        if(hasInit())
+            prepare += TAB_IN + "init" + typeName + "(&user);\n";
+        prepare += TAB_IN + "_pg_fillRandom(data, getMaxLengthOf" + typeName + "(), seed);\n";
+        prepare += TAB_IN + "decode" + typeName + "(data, &index, &user);\n";
+        prepare += "\n";
+        prepare += TAB_IN + "index = 0;\n";
+        prepare += TAB_IN + "encode" + typeName + "(data, &index, &user);\n";
+        prepare += TAB_IN + "bytes = index;\n";
+
+        encodeloop += TAB_IN + TAB_IN + "index = 0;\n";
+        encodeloop += TAB_IN + TAB_IN + "encode" + typeName + "(data, &index, &user);\n";
+
+        decodeloop += TAB_IN + TAB_IN + "index = 0;\n";
+        decodeloop += TAB_IN + TAB_IN + "if(!decode" + typeName + "(data, &index, &user))\n";
+        decodeloop += TAB_IN + TAB_IN + TAB_IN + "failures++;\n";
+
+        cleanup += TAB_IN + "free(data);\n";
+    }
+    else
+    {
+        declarations += TAB_IN + "int index = 0;\n";
+        declarations += TAB_IN + typeName + " user;\n";
+        declarations += TAB_IN + "std::vector<uint8_t> data(" + typeName + "::maxLength() + 1);\n";
+
+        prepare += TAB_IN + "// Decoding random data puts every field within its encoded range\n";
+        prepare += TAB_IN + "_pg_fillRandom(data.data(), " + typeName + "::maxLength(), seed);\n";
+        prepare += TAB_IN + "user.decode(data.data(), &index);\n";
+        prepare += "\n";
+        prepare += TAB_IN + "index = 0;\n";
+        prepare += TAB_IN + "user.encode(data.data(), &index);\n";
+        prepare += TAB_IN + "bytes = index;\n";
+
+        encodeloop += TAB_IN + TAB_IN + "index = 0;\n";
+        encodeloop += TAB_IN + TAB_IN + "user.encode(data.data(), &index);\n";
+
+        decodeloop += TAB_IN + TAB_IN + "index = 0;\n";
+        decodeloop += TAB_IN + TAB_IN + "if(!user.decode(data.data(), &index))\n";
+        decodeloop += TAB_IN + TAB_IN + TAB_IN + "failures++;\n";
+    }
+
+    return getBenchmarkFunction(declarations, prepare, encodeloop, decodeloop, cleanup);
+
+}// ProtocolStructureModule::getBenchmarkFunction
+
+
+/*!
+ * Assemble a benchmark function. The function is named "benchmark" followed
+ * by the type name, and returns the number of decodes that failed. Each loop
+ * is repeated with twice the iterations until it lasts at least "seconds".
+ * \param declarations are the local variables of the function.
+ * \param prepare fills the structure with random data and sets "bytes".
+ * \param encodeloop is the body of the encode loop.
+ * \param decodeloop is the body of the decode loop, which increments "failures".
+ * \param cleanup releases anything allocated in declarations.
+ * \return the benchmark function
+ */
+std::string ProtocolStructureModule::getBenchmarkFunction(const std::string& declarations, const std::string& prepare, const std::string& encodeloop, const std::string& decodeloop, const std::string& cleanup) const
+{
+    std::string output;
+
+    output += "/*!\n";
+    output += " * Benchmark the encode and decode of " + typeName + "\n";
+    output += " * \\param iterations is the minimum number of times to encode and decode.\n";
+    output += " * \\param seconds is the minimum time of each loop.\n";
+    output += " * \\param seed is the state of the random number generator.\n";
+    output += " * \\return the number of decodes that failed.\n";
+    output += " */\n";
+    output += "static int benchmark" + typeName + "(int iterations, double seconds, uint32_t* seed)\n";
+    output += "{\n";
+    output += TAB_IN + "int i, bytes, failures = 0;\n";
+    output += TAB_IN + "_pg_timing_t encodetiming, decodetiming;\n";
+    output += declarations;
+    output += "\n";
+    output += prepare;
+    output += "\n";
+    output += TAB_IN + "encodetiming.iterations = iterations;\n";
+    output += TAB_IN + "do\n";
+    output += TAB_IN + "{\n";
+    output += TAB_IN + TAB_IN + "_pg_startTiming(&encodetiming);\n";
+    output += TAB_IN + TAB_IN + "for(i = 0; i < encodetiming.iterations; i++)\n";
+    output += TAB_IN + TAB_IN + "{\n";
+    output += indentCode(encodeloop);
+    output += TAB_IN + TAB_IN + "}\n";
+    output += TAB_IN + TAB_IN + "_pg_stopTiming(&encodetiming);\n";
+    output += TAB_IN + "}while(_pg_repeatTiming(&encodetiming, seconds));\n";
+    output += "\n";
+    output += TAB_IN + "decodetiming.iterations = iterations;\n";
+    output += TAB_IN + "do\n";
+    output += TAB_IN + "{\n";
+    output += TAB_IN + TAB_IN + "_pg_startTiming(&decodetiming);\n";
+    output += TAB_IN + TAB_IN + "for(i = 0; i < decodetiming.iterations; i++)\n";
+    output += TAB_IN + TAB_IN + "{\n";
+    output += indentCode(decodeloop);
+    output += TAB_IN + TAB_IN + "}\n";
+    output += TAB_IN + TAB_IN + "_pg_stopTiming(&decodetiming);\n";
+    output += TAB_IN + "}while(_pg_repeatTiming(&decodetiming, seconds));\n";
+    output += "\n";
+    output += TAB_IN + "_pg_report(\"" + typeName + "\", bytes, &encodetiming, &decodetiming);\n";
+    if(!cleanup.empty())
+        output += cleanup;
+    output += "\n";
+    output += TAB_IN + "return failures;\n";
+    output += "\n";
+    output += "}// benchmark" + typeName + "\n";
+
+    return output;
+
+}// ProtocolStructureModule::getBenchmarkFunction
+
+
+/*!
+ * Indent every line of a block of code by one level
+ * \param code is the code to indent.
+ * \return the indented code.
+ */
+std::string ProtocolStructureModule::indentCode(const std::string& code)
+{
+    std::string output;
+    std::size_t start = 0;
+
+    while(start < code.size())
+    {
+        std::size_t end = code.find('\n', start);
+        if(end == std::string::npos)
+            end = code.size() - 1;
+
+        // Empty lines stay empty
+        if(end > start)
+            output += TAB_IN;
+
+        output += code.substr(start, end + 1 - start);
+        start = end + 1;
+    }
+
+    return output;
+
+}// ProtocolStructureModule::indentCode
+
+
 /*!
  * Setup the files, which accounts for all the ways the fils can be organized for this structure.
  * \param moduleName is the module name from the attributes
@@ -268,6 +505,8 @@ void ProtocolStructureModule::parse(bool nocode)
  * \param verifymodulename is the verify module name from the attributes
  * \param comparemodulename is the comparison module name from the attributes
  * \param printmodulename is the print module name from the attributes
+ * \param mapmodulename is the map module name from the attributes
+ * \param jsonmodulename is the JSON and CBOR module name from the attributes
  * \param forceStructureDeclaration should be true to force the declaration of the structure, even if it only has one member
  * \param outputUtilties should be true to output the helper macros
  */
@@ -277,25 +516,30 @@ void ProtocolStructureModule::setupFiles(std::string moduleName,
                                          std::string comparemodulename,
                                          std::string printmodulename,
                                          std::string mapmodulename,
+                                         std::string jsonmodulename,
                                          bool forceStructureDeclaration, bool outputUtilities)
 {
     // User can provide compare flag, or the file name, or set the global flag
-    if(!comparemodulename.empty() || !support.globalCompareName.empty() || support.compare)
+    if(!comparemodulename.empty() || !support->globalCompareName.empty() || support->compare)
         compare = true;
 
     // User can provide print flag, or the file name, or set the global flag
-    if(!printmodulename.empty() || !support.globalPrintName.empty() || support.print)
+    if(!printmodulename.empty() || !support->globalPrintName.empty() || support->print)
         print = true;
 
     // User can provide map flag, or the file name, or set the global flag
-    if(!mapmodulename.empty() || !support.globalMapName.empty() || support.mapEncode)
+    if(!mapmodulename.empty() || !support->globalMapName.empty() || support->mapEncode)
         mapEncode = true;
 
-    // In order to do compare, print, map, verify or init we must actually have some parameters
+    // User can provide json flag, or the file name, or set the global flag
+    if(!jsonmodulename.empty() || !support->globalJsonName.empty() || support->json)
+        json = true;
+
+    // In order to do compare, print, map, json, verify or init we must actually have some parameters
     if((getNumberOfEncodeParameters() <= 0) && (getNumberOfDecodeParameters() <= 0))
-        compare = print = mapEncode = hasverify = hasinit = false;
+        compare = print = mapEncode = json = hasverify = hasinit = false;
 
-    // We need to reflect the compare, print, and mapEncode flags to our child structures
+    // We need to reflect the compare, print, mapEncode, and json flags to our child structures
     for(std::size_t i = 0; i < encodables.size(); i++)
     {
         // Is this encodable a structure?
@@ -312,30 +556,33 @@ void ProtocolStructureModule::setupFiles(std::string moduleName,
 
         if(mapEncode)
             structure->setMapEncode(true);
+
+        if(json)
+            structure->setJson(true);
     }
 
     // Must have a structure definition to do any of these operations
-    if(compare || print || mapEncode || hasverify || hasinit)
+    if(compare || print || mapEncode || json || hasverify || hasinit)
         forceStructureDeclaration = true;
 
     // The file directive tells us if we are creating a separate file, or if we are appending an existing one
     if(moduleName.empty())
-        moduleName = support.globalFileName;
+        moduleName = support->globalFileName;
 
     // The file names
     if(moduleName.empty())
     {
-        header.setModuleNameAndPath(support.prefix, name, support.outputpath);
-        source.setModuleNameAndPath(support.prefix, name, support.outputpath);
+        header.setModuleNameAndPath(support->prefix, name, support->outputpath);
+        source.setModuleNameAndPath(support->prefix, name, support->outputpath);
     }
     else
     {
-        header.setModuleNameAndPath(moduleName, support.outputpath);
-        source.setModuleNameAndPath(moduleName, support.outputpath);
+        header.setModuleNameAndPath(moduleName, support->outputpath);
+        source.setModuleNameAndPath(moduleName, support->outputpath);
     }
 
     if(verifymodulename.empty())
-        verifymodulename = support.globalVerifyName;
+        verifymodulename = support->globalVerifyName;
 
     if(verifymodulename.empty())
     {
@@ -345,8 +592,8 @@ void ProtocolStructureModule::setupFiles(std::string moduleName,
     }
     else if(hasInit() || hasVerify())
     {
-        _verifyHeader.setModuleNameAndPath(verifymodulename, support.outputpath);
-        _verifySource.setModuleNameAndPath(verifymodulename, support.outputpath);
+        _verifyHeader.setModuleNameAndPath(verifymodulename, support->outputpath);
+        _verifySource.setModuleNameAndPath(verifymodulename, support->outputpath);
         verifyHeader = &_verifyHeader;
         verifySource = &_verifySource;
     }
@@ -354,10 +601,10 @@ void ProtocolStructureModule::setupFiles(std::string moduleName,
     if(compare)
     {
         if(comparemodulename.empty())
-            comparemodulename = support.globalCompareName;
+            comparemodulename = support->globalCompareName;
 
-        if(comparemodulename.empty() && (support.language == ProtocolSupport::c_language))
-            comparemodulename = support.prefix + name + "_compare";
+        if(comparemodulename.empty() && (support->language == ProtocolSupport::c_language))
+            comparemodulename = support->prefix + name + "_compare";
 
         if(comparemodulename.empty())
         {
@@ -366,8 +613,8 @@ void ProtocolStructureModule::setupFiles(std::string moduleName,
         }
         else
         {
-            _compareHeader.setModuleNameAndPath(comparemodulename, support.outputpath, ProtocolSupport::cpp_language);
-            _compareSource.setModuleNameAndPath(comparemodulename, support.outputpath, ProtocolSupport::cpp_language);
+            _compareHeader.setModuleNameAndPath(comparemodulename, support->outputpath, ProtocolSupport::cpp_language);
+            _compareSource.setModuleNameAndPath(comparemodulename, support->outputpath, ProtocolSupport::cpp_language);
             compareHeader = &_compareHeader;
             compareSource = &_compareSource;
         }
@@ -381,11 +628,11 @@ void ProtocolStructureModule::setupFiles(std::string moduleName,
     if(mapEncode)
     {
         if(mapmodulename.empty())
-            mapmodulename = support.globalMapName;
+            mapmodulename = support->globalMapName;
 
         // In C the map outputs cannot be in the main code files, because they are c++
-        if(mapmodulename.empty() && (support.language == ProtocolSupport::c_language))
-            mapmodulename = support.prefix + name + "_map";
+        if(mapmodulename.empty() && (support->language == ProtocolSupport::c_language))
+            mapmodulename = support->prefix + name + "_map";
 
         if(mapmodulename.empty())
         {
@@ -394,21 +641,44 @@ void ProtocolStructureModule::setupFiles(std::string moduleName,
         }
         else
         {
-            _mapHeader.setModuleNameAndPath(mapmodulename, support.outputpath, ProtocolSupport::cpp_language);
-            _mapSource.setModuleNameAndPath(mapmodulename, support.outputpath, ProtocolSupport::cpp_language);
+            _mapHeader.setModuleNameAndPath(mapmodulename, support->outputpath, ProtocolSupport::cpp_language);
+            _mapSource.setModuleNameAndPath(mapmodulename, support->outputpath, ProtocolSupport::cpp_language);
             mapHeader = &_mapHeader;
             mapSource = &_mapSource;
         }
     }
 
+    if(json)
+    {
+        if(jsonmodulename.empty())
+            jsonmodulename = support->globalJsonName;
+
+        // In C the JSON outputs cannot be in the main code files, because they are c++
+        if(jsonmodulename.empty() && (support->language == ProtocolSupport::c_language))
+            jsonmodulename = support->prefix + name + "_json";
+
+        if(jsonmodulename.empty())
+        {
+            jsonHeader = &header;
+            jsonSource = &source;
+        }
+        else
+        {
+            _jsonHeader.setModuleNameAndPath(jsonmodulename, support->outputpath, ProtocolSupport::cpp_language);
+            _jsonSource.setModuleNameAndPath(jsonmodulename, support->outputpath, ProtocolSupport::cpp_language);
+            jsonHeader = &_jsonHeader;
+            jsonSource = &_jsonSource;
+        }
+    }
+
     if(print)
     {
         if(printmodulename.empty())
-            printmodulename = support.globalPrintName;
+            printmodulename = support->globalPrintName;
 
         // In C the print outputs cannot be in the main code files, because they are c++
-        if(printmodulename.empty() && (support.language == ProtocolSupport::c_language))
-            printmodulename = support.prefix + name + "_print";
+        if(printmodulename.empty() && (support->language == ProtocolSupport::c_language))
+            printmodulename = support->prefix + name + "_print";
 
         if(printmodulename.empty())
         {
@@ -417,8 +687,8 @@ void ProtocolStructureModule::setupFiles(std::string moduleName,
         }
         else
         {
-            _printHeader.setModuleNameAndPath(printmodulename, support.outputpath, ProtocolSupport::cpp_language);
-            _printSource.setModuleNameAndPath(printmodulename, support.outputpath, ProtocolSupport::cpp_language);
+            _printHeader.setModuleNameAndPath(printmodulename, support->outputpath, ProtocolSupport::cpp_language);
+            _printSource.setModuleNameAndPath(printmodulename, support->outputpath, ProtocolSupport::cpp_language);
             printHeader = &_printHeader;
             printSource = &_printSource;
         }
@@ -429,11 +699,13 @@ void ProtocolStructureModule::setupFiles(std::string moduleName,
         printSource->makeLineSeparator();
         printSource->writeOnce(getExtractTextFunction());
         printSource->makeLineSeparator();
+        printSource->writeOnce(getTextToNumberFunction());
+        printSource->makeLineSeparator();
 
     }
 
     // Include the protocol top level module. This module may already be included, but in that case it won't be included twice
-    header.writeIncludeDirective(support.protoName + "Protocol");
+    header.writeIncludeDirective(support->protoName + "Protocol");
 
     std::vector<std::string> list;
 
@@ -448,7 +720,7 @@ void ProtocolStructureModule::setupFiles(std::string moduleName,
         if(!defheadermodulename.empty())
         {
             // Handle the idea that the structure might be defined in a different file
-            _structHeader.setModuleNameAndPath(defheadermodulename, support.outputpath, support.language);
+            _structHeader.setModuleNameAndPath(defheadermodulename, support->outputpath, support->language);
             structHeader = &_structHeader;
         }
 
@@ -480,7 +752,7 @@ void ProtocolStructureModule::setupFiles(std::string moduleName,
         compareSource->writeIncludeDirective("iomanip", std::string(), true, false);
         compareSource->writeIncludeDirective("cstring", std::string(), true, false);
 
-        if(support.language == ProtocolSupport::cpp_language)
+        if(support->language == ProtocolSupport::cpp_language)
         {
             // In C++ these function declarations are in the class declaration
             structHeader->writeIncludeDirective("string", std::string(), true, false);
@@ -501,8 +773,13 @@ void ProtocolStructureModule::setupFiles(std::string moduleName,
         printSource->writeIncludeDirective("sstream", std::string(), true, false);
         printSource->writeIncludeDirective("iomanip", std::string(), true, false);
         printSource->writeIncludeDirective("cstring", std::string(), true, false);
+        printSource->writeIncludeDirective("cstdlib", std::string(), true, false);
+        printSource->writeIncludeDirective("string_view", std::string(), true, false);
+        printSource->writeIncludeDirective("charconv", std::string(), true, false);
+        printSource->writeIncludeDirective("type_traits", std::string(), true, false);
+        printSource->writeIncludeDirective("algorithm", std::string(), true, false);
 
-        if(support.language == ProtocolSupport::cpp_language)
+        if(support->language == ProtocolSupport::cpp_language)
         {
             // In C++ these function declarations are in the class declaration
             structHeader->writeIncludeDirective("string", std::string(), true, false);
@@ -522,14 +799,32 @@ void ProtocolStructureModule::setupFiles(std::string moduleName,
     {
         mapHeader->writeIncludeDirective(structHeader->fileName());
         mapHeader->writeIncludeDirective(header.fileName());
-        mapHeader->writeIncludeDirective("QVariant", std::string(), true, false);
-        mapHeader->writeIncludeDirective("QString", std::string(), true, false);
 
-        if(support.language == ProtocolSupport::cpp_language)
+        if(support->flatmap)
         {
-            // In C++ these function declarations are in the class declaration
-            structHeader->writeIncludeDirective("QString", std::string(), true, false);
-            structHeader->writeIncludeDirective("QVariant", std::string(), true, false);
+            mapHeader->writeIncludeDirective("flatmap.hpp", std::string(), false, false);
+
+            // pgstrncpy() is used to decode strings
+            if(support->language == ProtocolSupport::cpp_language)
+            {
+                // In C++ these function declarations are in the class declaration
+                structHeader->writeIncludeDirective("flatmap.hpp", std::string(), false, false);
+                mapSource->writeIncludeDirective("fieldencode.hpp", std::string(), false);
+            }
+            else
+                mapSource->writeIncludeDirective("fieldencode.h", std::string(), false);
+        }
+        else
+        {
+            mapHeader->writeIncludeDirective("QVariant", std::string(), true, false);
+            mapHeader->writeIncludeDirective("QString", std::string(), true, false);
+
+            if(support->language == ProtocolSupport::cpp_language)
+            {
+                // In C++ these function declarations are in the class declaration
+                structHeader->writeIncludeDirective("QString", std::string(), true, false);
+                structHeader->writeIncludeDirective("QVariant", std::string(), true, false);
+            }
         }
 
         list.clear();
@@ -538,6 +833,25 @@ void ProtocolStructureModule::setupFiles(std::string moduleName,
         mapHeader->makeLineSeparator();
     }
 
+    // The JSON and CBOR details may be spread across multiple files
+    if(json)
+    {
+        jsonHeader->writeIncludeDirective(structHeader->fileName());
+        jsonHeader->writeIncludeDirective(header.fileName());
+        jsonHeader->writeIncludeDirective("jsoncbor.hpp", std::string(), false, false);
+
+        if(support->language == ProtocolSupport::cpp_language)
+        {
+            // In C++ these function declarations are in the class declaration
+            structHeader->writeIncludeDirective("jsoncbor.hpp", std::string(), false, false);
+        }
+
+        list.clear();
+        getJsonIncludeDirectives(list);
+        jsonHeader->writeIncludeDirectives(list);
+        jsonHeader->makeLineSeparator();
+    }
+
     // Add other includes specific to this structure
     parser->outputIncludes(getHierarchicalName(), *structHeader, e);
 
@@ -583,7 +897,7 @@ void ProtocolStructureModule::setupFiles(std::string moduleName,
     header.makeLineSeparator();
 
     // The encoded size of this structure as a macro that others can access
-    if(((encode != false) || (decode != false)) && outputUtilities && (support.language == ProtocolSupport::c_language))
+    if(((encode != false) || (decode != false)) && outputUtilities && (support->language == ProtocolSupport::c_language))
     {
         // White space is good
         header.makeLineSeparator();
@@ -609,7 +923,7 @@ std::string ProtocolStructureModule::createUtilityFunctions(const std::string& s
 {
     std::string output;
 
-    if(support.language == ProtocolSupport::c_language)
+    if(support->language == ProtocolSupport::c_language)
     {
         // The macro for the minimum packet length
         output += spacing + "//! return the minimum encoded length for the " + typeName + " structure\n";
@@ -676,7 +990,7 @@ void ProtocolStructureModule::getIncludeDirectives(std::vector<std::string>& lis
  */
 void ProtocolStructureModule::getSourceIncludeDirectives(std::vector<std::string>& list) const
 {
-    if(support.specialFloat)
+    if(support->specialFloat)
         list.push_back("floatspecial");
 
     list.push_back("fielddecode");
@@ -725,6 +1039,23 @@ void ProtocolStructureModule::getMapIncludeDirectives(std::vector<std::string>&
 }
 
 
+/*!
+ * Return the include directives needed for this encodable's JSON and CBOR functions
+ * \param list is appended with any directives this encodable requires.
+ */
+void ProtocolStructureModule::getJsonIncludeDirectives(std::vector<std::string>& list) const
+{
+    // Our header
+    if(jsonHeader != nullptr)
+        list.push_back(jsonHeader->fileName());
+
+    // And any of our children's headers
+    ProtocolStructure::getJsonIncludeDirectives(list);
+
+    removeDuplicates(list);
+}
+
+
 /*!
  * Return the include directives needed for this encodable's compare functions
  * \param list is appended with any directives this encodable requires.
@@ -849,7 +1180,7 @@ void ProtocolStructureModule::createSubStructureFunctions()
         if(!structure)
             continue;
 
-        if(support.language == ProtocolSupport::cpp_language)
+        if(support->language == ProtocolSupport::cpp_language)
         {
             // In this case the initialization function is the constructor,
             // which always exists if we have any parameters. It always goes
@@ -868,6 +1199,9 @@ void ProtocolStructureModule::createSubStructureFunctions()
             verifyHeader->makeLineSeparator();
             verifyHeader->write(structure->getSetToInitialValueFunctionPrototype());
 
+            // memset() for the structures without static initial values
+            verifySource->writeIncludeDirective("string.h", std::string(), true);
+
             verifySource->makeLineSeparator();
             verifySource->write(structure->getSetToInitialValueFunctionBody());
         }
@@ -875,33 +1209,33 @@ void ProtocolStructureModule::createSubStructureFunctions()
         if(encode)
         {
             // In C++ this is part of the class declaration
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
             {
                 header.makeLineSeparator();
                 header.write(structure->getEncodeFunctionPrototype());
             }
 
             source.makeLineSeparator();
-            source.write(structure->getEncodeFunctionBody(support.bigendian));
+            source.write(structure->getEncodeFunctionBody(support->bigendian));
         }
 
         if(decode)
         {
             // In C++ this is part of the class declaration
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
             {
                 header.makeLineSeparator();
                 header.write(structure->getDecodeFunctionPrototype());
             }
 
             source.makeLineSeparator();
-            source.write(structure->getDecodeFunctionBody(support.bigendian));
+            source.write(structure->getDecodeFunctionBody(support->bigendian));
         }
 
         if(hasVerify() && (verifyHeader != nullptr) && (verifySource != nullptr))
         {
             // In C++ this is part of the class declaration
-            if(support.language == ProtocolSupport::c_language)
+            if(support->language == ProtocolSupport::c_language)
             {
                 verifyHeader->makeLineSeparator();
                 verifyHeader->write(structure->getVerifyFunctionPrototype());
@@ -914,7 +1248,7 @@ void ProtocolStructureModule::createSubStructureFunctions()
         if(compare && (compareSource != nullptr))
         {
             // In C++ this is part of the class declaration
-            if((support.language == ProtocolSupport::c_language) && (compareHeader != nullptr))
+            if((support->language == ProtocolSupport::c_language) && (compareHeader != nullptr))
             {
                 compareHeader->makeLineSeparator();
                 compareHeader->write(structure->getComparisonFunctionPrototype());
@@ -927,7 +1261,7 @@ void ProtocolStructureModule::createSubStructureFunctions()
         if(print && (printSource != nullptr))
         {
             // In C++ this is part of the class declaration
-            if((support.language == ProtocolSupport::c_language) && (printHeader != nullptr))
+            if((support->language == ProtocolSupport::c_language) && (printHeader != nullptr))
             {
                 printHeader->makeLineSeparator();
                 printHeader->write(structure->getTextPrintFunctionPrototype());
@@ -944,7 +1278,7 @@ void ProtocolStructureModule::createSubStructureFunctions()
         if(mapEncode && (mapSource != nullptr))
         {
             // In C++ this is part of the class declaration
-            if((support.language == ProtocolSupport::c_language) && (mapHeader != nullptr))
+            if((support->language == ProtocolSupport::c_language) && (mapHeader != nullptr))
             {
                 mapHeader->makeLineSeparator();
                 mapHeader->write(structure->getMapEncodeFunctionPrototype());
@@ -958,6 +1292,19 @@ void ProtocolStructureModule::createSubStructureFunctions()
             mapSource->write(structure->getMapDecodeFunctionBody());
         }
 
+        if(json && (jsonSource != nullptr))
+        {
+            // In C++ this is part of the class declaration
+            if((support->language == ProtocolSupport::c_language) && (jsonHeader != nullptr))
+            {
+                jsonHeader->makeLineSeparator();
+                jsonHeader->write(structure->getJsonFunctionPrototype());
+            }
+
+            jsonSource->makeLineSeparator();
+            jsonSource->write(structure->getJsonFunctionBody());
+        }
+
     }// for all of our structure children
 
     source.makeLineSeparator();
@@ -976,7 +1323,7 @@ void ProtocolStructureModule::createTopLevelStructureFunctions()
     if(hasInit() && (verifySource != nullptr))
     {
         // In C++ this is part of the class declaration
-        if((support.language == ProtocolSupport::c_language) && (verifyHeader != nullptr))
+        if((support->language == ProtocolSupport::c_language) && (verifyHeader != nullptr))
         {
             verifyHeader->makeLineSeparator();
             verifyHeader->write(getSetToInitialValueFunctionPrototype(std::string(), false));
@@ -985,6 +1332,10 @@ void ProtocolStructureModule::createTopLevelStructureFunctions()
             verifyHeader->makeLineSeparator();
         }
 
+        // memset() for the structures without static initial values
+        if(support->language == ProtocolSupport::c_language)
+            verifySource->writeIncludeDirective("string.h", std::string(), true);
+
         verifySource->makeLineSeparator();
         verifySource->write(getSetToInitialValueFunctionBody(false));
         verifySource->makeLineSeparator();
@@ -995,7 +1346,7 @@ void ProtocolStructureModule::createTopLevelStructureFunctions()
     if(encode)
     {
         // In C++ this is part of the class declaration
-        if(support.language == ProtocolSupport::c_language)
+        if(support->language == ProtocolSupport::c_language)
         {
             header.makeLineSeparator();
             header.write(getEncodeFunctionPrototype(std::string(), false));
@@ -1008,7 +1359,7 @@ void ProtocolStructureModule::createTopLevelStructureFunctions()
     if(decode)
     {
         // In C++ this is part of the class declaration
-        if(support.language == ProtocolSupport::c_language)
+        if(support->language == ProtocolSupport::c_language)
         {
             header.makeLineSeparator();
             header.write(getDecodeFunctionPrototype(std::string(), false));
@@ -1040,7 +1391,7 @@ void ProtocolStructureModule::createTopLevelStructureHelperFunctions(void)
     if(hasVerify() && (verifySource != nullptr))
     {
         // In C++ this is part of the class declaration
-        if((support.language == ProtocolSupport::c_language) && (verifyHeader != nullptr))
+        if((support->language == ProtocolSupport::c_language) && (verifyHeader != nullptr))
         {
             verifyHeader->makeLineSeparator();
             verifyHeader->write(getVerifyFunctionPrototype(std::string(), false));
@@ -1056,7 +1407,7 @@ void ProtocolStructureModule::createTopLevelStructureHelperFunctions(void)
     if(compare && (compareSource != nullptr))
     {
         // In C++ this is part of the class declaration
-        if((support.language == ProtocolSupport::c_language) && (compareHeader != nullptr))
+        if((support->language == ProtocolSupport::c_language) && (compareHeader != nullptr))
         {
             compareHeader->makeLineSeparator();
             compareHeader->write(getComparisonFunctionPrototype(std::string(), false));
@@ -1072,7 +1423,7 @@ void ProtocolStructureModule::createTopLevelStructureHelperFunctions(void)
     if(print && (printSource != nullptr))
     {
         // In C++ this is part of the class declaration
-        if((support.language == ProtocolSupport::c_language) && (printHeader != nullptr))
+        if((support->language == ProtocolSupport::c_language) && (printHeader != nullptr))
         {
             printHeader->makeLineSeparator();
             printHeader->write(getTextPrintFunctionPrototype(std::string(), false));
@@ -1091,7 +1442,7 @@ void ProtocolStructureModule::createTopLevelStructureHelperFunctions(void)
     if(mapEncode && (mapSource != nullptr))
     {
         // In C++ this is part of the class declaration
-        if((support.language == ProtocolSupport::c_language) && (mapHeader != nullptr))
+        if((support->language == ProtocolSupport::c_language) && (mapHeader != nullptr))
         {
             mapHeader->makeLineSeparator();
             mapHeader->write(getMapEncodeFunctionPrototype(std::string(), false));
@@ -1107,6 +1458,21 @@ void ProtocolStructureModule::createTopLevelStructureHelperFunctions(void)
         mapSource->makeLineSeparator();
     }
 
+    if(json && (jsonSource != nullptr))
+    {
+        // In C++ this is part of the class declaration
+        if((support->language == ProtocolSupport::c_language) && (jsonHeader != nullptr))
+        {
+            jsonHeader->makeLineSeparator();
+            jsonHeader->write(getJsonFunctionPrototype(std::string(), false));
+            jsonHeader->makeLineSeparator();
+        }
+
+        jsonSource->makeLineSeparator();
+        jsonSource->write(getJsonFunctionBody(false));
+        jsonSource->makeLineSeparator();
+    }
+
 }// ProtocolStructureModule::createTopLevelStructureFunctions
 
 
@@ -1141,51 +1507,98 @@ std::string to_formatted_string(double number, int precision)
 std::string ProtocolStructureModule::getExtractTextFunction(void)
 {
     return R"(//! Extract text that is identified by a key
-static std::string extractText(const std::string& key, const std::string& source, int* fieldcount);
+static std::string_view extractText(const std::string& key, const std::string& source, int* fieldcount, std::size_t* cursor);
 
 /*!
  * Extract text that is identified by a key
  * \param key is the key, the text to extract follows the key and is on the same line
  * \param source is the source information to find the key in
  * \param fieldcount is incremented whenever the key is found in the source
- * \return the extracted text, which may be empty
+ * \param cursor is the location in source to start searching, which is moved
+ *        to the start of the line after the key whenever the key is found
+ * \return the extracted text, which may be empty, and which refers to source
  */
-std::string extractText(const std::string& key, const std::string& source, int* fieldcount)
+std::string_view extractText(const std::string& key, const std::string& source, int* fieldcount, std::size_t* cursor)
 {
-    std::string text;
-
     // All fields follow the key with " '". Use that as part of the search; to
     // prevent detecting shorter keys that are repeated within longer keys
-    std::string::size_type index = source.find(key + " '");
+    std::string search = key + " '";
 
-    if(index < source.size())
+    // The keys are usually read in the same order they were printed, so the
+    // key should be found after the cursor. If not wrap around to the start
+    std::string::size_type index = source.find(search, *cursor);
+    if(index >= source.size())
     {
-        // This is the location of the first character after the key
-        std::string::size_type first = index + key.size() + 2;
+        index = std::string_view(source.data(), std::min(*cursor, source.size())).find(search);
+        if(index >= source.size())
+            return std::string_view();
+    }
 
-        // The location of the next linefeed after the key
-        std::string::size_type linefeed = source.find("\n", first);
+    // This is the location of the first character after the key
+    std::string::size_type first = index + search.size();
 
-        // This is how many characters until we get to the linefeed
-        if((linefeed > first) && (linefeed < source.size()))
-        {
-            // This is the number of characters to remove
-            std::string::size_type length = linefeed - first;
+    // The location of the next linefeed after the key, or the end of the source
+    std::string::size_type linefeed = std::min(source.find('\n', first), source.size());
 
-            // Increment our field count
-            (*fieldcount)++;
+    if(linefeed <= first)
+        return std::string_view();
 
-            // Extract the text between the key and the linefeed
-            text = source.substr(first, length);
+    // Increment our field count
+    (*fieldcount)++;
 
-            // Remove the last "'" from the string
-            if((text.size() > 0) && (text.back() == '\''))
-                text.erase(text.size()-1, 1);
-        }
-    }
+    // The next search starts on the line after this one
+    *cursor = linefeed;
+
+    // Extract the text between the key and the linefeed
+    std::string_view text(source.data() + first, linefeed - first);
+
+    // Remove the last "'" from the string
+    if((text.size() > 0) && (text.back() == '\''))
+        text.remove_suffix(1);
 
     return text;
 
 }// extractText)";
 
 }// ProtocolStructureModule::getExtractTextFunction
+
+
+//! Get the text used to convert text to numbers for text read functions
+std::string ProtocolStructureModule::getTextToNumberFunction(void)
+{
+    return R"(/*!
+ * Convert text to a number. Integers try std::from_chars first because it
+ * does not allocate or depend on the locale. If it cannot consume all the
+ * text (for example "0x" hexadecimal) then std::strtox is used instead.
+ * Floating point always uses std::strtod on a bounded copy of the text,
+ * since std::from_chars for floating point is not available everywhere.
+ * \param text is the text to convert
+ * \return the number, which will be zero if the text cannot be converted
+ */
+template <typename T>
+static T textToNumber(std::string_view text)
+{
+    if constexpr (std::is_floating_point<T>::value)
+    {
+        std::string copy(text);
+        return (T)std::strtod(copy.c_str(), 0);
+    }
+    else
+    {
+        T number = 0;
+
+        std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), number);
+        if((result.ec == std::errc()) && (result.ptr == text.data() + text.size()))
+            return number;
+
+        std::string copy(text);
+
+        if constexpr (std::is_signed<T>::value)
+            return (T)std::strtoll(copy.c_str(), 0, 0);
+        else
+            return (T)std::strtoull(copy.c_str(), 0, 0);
+    }
+
+}// textToNumber)";
+
+}// ProtocolStructureModule::getTextToNumberFunction
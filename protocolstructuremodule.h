@@ -10,7 +10,7 @@ class ProtocolStructureModule : public ProtocolStructure
 public:
 
     //! Construct the structure parsing object, with details about the overall protocol
-    ProtocolStructureModule(ProtocolParser* parse, ProtocolSupport supported);
+    ProtocolStructureModule(ProtocolParser* parse, SharedSupport supported);
 
     //! Parse a packet from the DOM
     void parse(bool nocode = false) override;
@@ -33,6 +33,9 @@ public:
     //! Return the include directives needed for this encodable's map functions
     void getMapIncludeDirectives(std::vector<std::string>& list) const override;
 
+    //! Return the include directives needed for this encodable's JSON and CBOR functions
+    void getJsonIncludeDirectives(std::vector<std::string>& list) const override;
+
     //! Return the include directives needed for this encodable's compare functions
     void getCompareIncludeDirectives(std::vector<std::string>& list) const override;
 
@@ -114,6 +117,39 @@ public:
     //! Get the path of the source file that encompasses this structure map functions
     std::string getMapSourceFilePath(void) const {return (mapSource == nullptr) ? std::string() : mapSource->filePath();}
 
+    //! Get the name of the header file that encompasses this structure JSON and CBOR functions
+    std::string getJsonHeaderFileName(void) const {return (jsonHeader == nullptr) ? std::string() : jsonHeader->fileName();}
+
+    //! Get the name of the source file that encompasses this structure JSON and CBOR functions
+    std::string getJsonSourceFileName(void) const {return (jsonSource == nullptr) ? std::string() : jsonSource->fileName();}
+
+    //! Get the path of the header file that encompasses this structure JSON and CBOR functions
+    std::string getJsonHeaderFilePath(void) const {return (jsonHeader == nullptr) ? std::string() : jsonHeader->filePath();}
+
+    //! Get the path of the source file that encompasses this structure JSON and CBOR functions
+    std::string getJsonSourceFilePath(void) const {return (jsonSource == nullptr) ? std::string() : jsonSource->filePath();}
+
+    //! Determine if this structure outputs JSON and CBOR functions
+    bool hasJson(void) const {return json;}
+
+    //! Set if the output files of this module are current and need not be generated
+    void setCached(bool iscached) {cached = iscached;}
+
+    //! Determine if the output files of this module are current and need not be generated
+    bool isCached(void) const {return cached;}
+
+    //! Remember the name and fingerprint of this module in the regeneration cache
+    void setCacheRecord(const std::string& key, const std::string& fingerprint) {cacheKey = key; cacheFingerprint = fingerprint;}
+
+    //! Get the name of this module in the regeneration cache
+    const std::string& getCacheKey(void) const {return cacheKey;}
+
+    //! Get the fingerprint of the inputs of this module in the regeneration cache
+    const std::string& getCacheFingerprint(void) const {return cacheFingerprint;}
+
+    //! Get the function that benchmarks the encode and decode of this structure
+    virtual std::string getBenchmarkFunction(void) const;
+
 protected:
 
     //! Setup the files, which accounts for all the ways the files can be organized for this structure.
@@ -123,8 +159,18 @@ protected:
                     std::string comparemodulename,
                     std::string printmodulename,
                     std::string mapmodulename,
+                    std::string jsonmodulename,
                     bool forceStructureDeclaration = true, bool outputUtilities = true);
 
+    //! Discard everything written to the files, because they are current from a previous run
+    void discardCachedOutput(void);
+
+    //! Assemble a benchmark function from the statements that are specific to the structure or packet
+    std::string getBenchmarkFunction(const std::string& declarations, const std::string& prepare, const std::string& encodeloop, const std::string& decodeloop, const std::string& cleanup) const;
+
+    //! Indent every line of a block of code
+    static std::string indentCode(const std::string& code);
+
     //! Create utility functions for structure lengths
     std::string createUtilityFunctions(const std::string& spacing) const override;
 
@@ -149,6 +195,9 @@ protected:
     //! Get the text used to extract text for text read functions
     static std::string getExtractTextFunction(void);
 
+    //! Get the text used to convert text to numbers for text read functions
+    static std::string getTextToNumberFunction(void);
+
     // These files are always used
     ProtocolSourceFile source;          //!< The source file (*.c)
     ProtocolHeaderFile header;          //!< The header file (*.h)
@@ -163,6 +212,8 @@ protected:
     ProtocolHeaderFile _printHeader;    //!< Optional header file for print code (*.h)
     ProtocolSourceFile _mapSource;      //!< Optional source file for map code (*.cpp)
     ProtocolHeaderFile _mapHeader;      //!< Optional header file for map code (*.h)
+    ProtocolSourceFile _jsonSource;     //!< Optional source file for JSON and CBOR code (*.cpp)
+    ProtocolHeaderFile _jsonHeader;     //!< Optional header file for JSON and CBOR code (*.h)
 
     // These are the pointers that get aliased to the correct output file
     ProtocolHeaderFile* structHeader;   //!< Pointer to the header file for the structure definition
@@ -174,6 +225,12 @@ protected:
     ProtocolHeaderFile* printHeader;    //!< Pointer to the header file for print code (*.h)
     ProtocolSourceFile* mapSource;      //!< Pointer to the source file for map code (*.cpp)
     ProtocolHeaderFile* mapHeader;      //!< Pointer to the header file for map code (*.h)
+    ProtocolSourceFile* jsonSource;     //!< Pointer to the source file for JSON and CBOR code (*.cpp)
+    ProtocolHeaderFile* jsonHeader;     //!< Pointer to the header file for JSON and CBOR code (*.h)
+
+    bool cached;                        //!< True if the output files are current from a previous run
+    std::string cacheKey;               //!< Name of this module in the regeneration cache
+    std::string cacheFingerprint;       //!< Fingerprint of the inputs of this module, taken before the DOM is released
 };
 
 #endif // PROTOCOLSTRUCTUREMODULE_H
@@ -428,13 +428,18 @@ ProtocolSupport::ProtocolSupport() :
     bitfield(true),
     longbitfield(false),
     bitfieldtest(false),
+    benchmark(false),
+    packetStats(false),
     disableunrecognized(false),
     bigendian(true),
     supportbool(false),
     limitonencode(false),
+    bitpacked(false),
     compare(false),
     print(false),
     mapEncode(false),
+    flatmap(false),
+    json(false),
     showAllItems(false),
     omitIfHidden(false),
     packetStructureSuffix("PacketStructure"),
@@ -458,11 +463,15 @@ std::vector<std::string> ProtocolSupport::getAttriblist(void) const
     attribs.push_back("supportBitfield");
     attribs.push_back("supportLongBitfield");
     attribs.push_back("bitfieldTest");
+    attribs.push_back("benchmark");
+    attribs.push_back("packetStats");
+    attribs.push_back("batchID");
     attribs.push_back("file");
     attribs.push_back("verifyfile");
     attribs.push_back("comparefile");
     attribs.push_back("printfile");
     attribs.push_back("mapfile");
+    attribs.push_back("jsonfile");
     attribs.push_back("prefix");
     attribs.push_back("prefixC");
     attribs.push_back("prefixCPP");
@@ -477,11 +486,14 @@ std::vector<std::string> ProtocolSupport::getAttriblist(void) const
     attribs.push_back("pointerCPP");
     attribs.push_back("supportBool");
     attribs.push_back("limitOnEncode");
+    attribs.push_back("bitpacked");
     attribs.push_back("C");
     attribs.push_back("CPP");
     attribs.push_back("compare");
     attribs.push_back("print");
     attribs.push_back("map");
+    attribs.push_back("flatMap");
+    attribs.push_back("json");
     attribs.push_back("api");
     attribs.push_back("version");
     attribs.push_back("translate");
@@ -490,6 +502,88 @@ std::vector<std::string> ProtocolSupport::getAttriblist(void) const
 }
 
 
+/*!
+ * Get a text representation of all the options, which changes if any option
+ * changes, whether it comes from the protocol file or the command line.
+ * \return the options, one per line
+ */
+std::string ProtocolSupport::getFingerprint(void) const
+{
+    std::string output;
+
+    output += "language=" + std::to_string(language) + "\n";
+    output += "maxdatasize=" + std::to_string(maxdatasize) + "\n";
+    output += "int64=" + std::to_string(int64) + "\n";
+    output += "float64=" + std::to_string(float64) + "\n";
+    output += "specialFloat=" + std::to_string(specialFloat) + "\n";
+    output += "bitfield=" + std::to_string(bitfield) + "\n";
+    output += "longbitfield=" + std::to_string(longbitfield) + "\n";
+    output += "bitfieldtest=" + std::to_string(bitfieldtest) + "\n";
+    output += "benchmark=" + std::to_string(benchmark) + "\n";
+    output += "packetStats=" + std::to_string(packetStats) + "\n";
+    output += "batchID=" + batchID + "\n";
+    output += "bigendian=" + std::to_string(bigendian) + "\n";
+    output += "supportbool=" + std::to_string(supportbool) + "\n";
+    output += "limitonencode=" + std::to_string(limitonencode) + "\n";
+    output += "bitpacked=" + std::to_string(bitpacked) + "\n";
+    output += "compare=" + std::to_string(compare) + "\n";
+    output += "print=" + std::to_string(print) + "\n";
+    output += "mapEncode=" + std::to_string(mapEncode) + "\n";
+    output += "flatmap=" + std::to_string(flatmap) + "\n";
+    output += "json=" + std::to_string(json) + "\n";
+    output += "showAllItems=" + std::to_string(showAllItems) + "\n";
+    output += "omitIfHidden=" + std::to_string(omitIfHidden) + "\n";
+    output += "api=" + api + "\n";
+    output += "version=" + version + "\n";
+    output += "globalFileName=" + globalFileName + "\n";
+    output += "globalVerifyName=" + globalVerifyName + "\n";
+    output += "globalCompareName=" + globalCompareName + "\n";
+    output += "globalPrintName=" + globalPrintName + "\n";
+    output += "globalMapName=" + globalMapName + "\n";
+    output += "globalJsonName=" + globalJsonName + "\n";
+    output += "outputpath=" + outputpath + "\n";
+    output += "packetStructureSuffix=" + packetStructureSuffix + "\n";
+    output += "packetParameterSuffix=" + packetParameterSuffix + "\n";
+    output += "protoName=" + protoName + "\n";
+    output += "prefix=" + prefix + "\n";
+    output += "typeSuffix=" + typeSuffix + "\n";
+    output += "pointerType=" + pointerType + "\n";
+    output += "licenseText=" + licenseText + "\n";
+    output += "globaltranslate=" + globaltranslate + "\n";
+
+    return output;
+
+}// ProtocolSupport::getFingerprint
+
+
+/*!
+ * Get a text representation of the options which affect the helper files
+ * (fieldencode, scaledencode, floatspecial, etc.). Protocols with the same
+ * helper fingerprint can share one copy of the helper files.
+ * \return the options, one per line
+ */
+std::string ProtocolSupport::getHelperFingerprint(void) const
+{
+    std::string output;
+
+    output += "language=" + std::to_string(language) + "\n";
+    output += "int64=" + std::to_string(int64) + "\n";
+    output += "float64=" + std::to_string(float64) + "\n";
+    output += "specialFloat=" + std::to_string(specialFloat) + "\n";
+    output += "bitfield=" + std::to_string(bitfield) + "\n";
+    output += "longbitfield=" + std::to_string(longbitfield) + "\n";
+    output += "bitfieldtest=" + std::to_string(bitfieldtest) + "\n";
+    output += "supportbool=" + std::to_string(supportbool) + "\n";
+    output += "flatmap=" + std::to_string(flatmap) + "\n";
+    output += "outputpath=" + outputpath + "\n";
+    output += "typeSuffix=" + typeSuffix + "\n";
+    output += "licenseText=" + licenseText + "\n";
+
+    return output;
+
+}// ProtocolSupport::getHelperFingerprint
+
+
 /*!
  * Parse the attributes for this support object from the DOM map
  * \param map is the DOM map
@@ -535,6 +629,17 @@ void ProtocolSupport::parse(const XMLAttribute* map)
     if(ProtocolParser::isFieldSet("bitfieldTest", map))
         bitfieldtest = true;
 
+    // benchmark support can be turned on
+    if(ProtocolParser::isFieldSet("benchmark", map))
+        benchmark = true;
+
+    // Runtime counters in the packet functions can be turned on
+    if(ProtocolParser::isFieldSet("packetStats", map))
+        packetStats = true;
+
+    // Batches of packets in one frame can be turned on by giving their identifier
+    batchID = ProtocolParser::getAttribute("batchID", map);
+
     // bool support default is based on language type
     if(language == c_language)
         supportbool = false;
@@ -551,10 +656,19 @@ void ProtocolSupport::parse(const XMLAttribute* map)
     if(ProtocolParser::isFieldSet("limitOnEncode", map))
         limitonencode = true;
 
-    // Global flags to force output for compare, print, and map functions
+    // Bit packing can be turned on
+    if(ProtocolParser::isFieldSet("bitpacked", map))
+        bitpacked = true;
+
+    // Global flags to force output for compare, print, map, and json functions
     compare = ProtocolParser::isFieldSet(ProtocolParser::getAttribute("compare", map));
     print = ProtocolParser::isFieldSet(ProtocolParser::getAttribute("print", map));
     mapEncode = ProtocolParser::isFieldSet(ProtocolParser::getAttribute("map", map));
+    json = ProtocolParser::isFieldSet(ProtocolParser::getAttribute("json", map));
+
+    // The map functions can use the flat map instead of Qt
+    if(ProtocolParser::isFieldSet("flatMap", map))
+        flatmap = true;
 
     // The global file names
     parseFileNames(map);
@@ -625,11 +739,13 @@ void ProtocolSupport::parseFileNames(const XMLAttribute* map)
     globalCompareName = ProtocolParser::getAttribute("comparefile", map);
     globalPrintName = ProtocolParser::getAttribute("printfile", map);
     globalMapName = ProtocolParser::getAttribute("mapfile", map);
+    globalJsonName = ProtocolParser::getAttribute("jsonfile", map);
 
     replaceinplace(globalFileName, ".");
     replaceinplace(globalVerifyName, ".");
     replaceinplace(globalCompareName, ".");
     replaceinplace(globalPrintName, ".");
     replaceinplace(globalMapName, ".");
+    replaceinplace(globalJsonName, ".");
 
 }// ProtocolSupport::parseFileNames
@@ -4,6 +4,7 @@
 #include "tinyxml2.h"
 #include <vector>
 #include <string>
+#include <memory>
 
 using namespace tinyxml2;
 
@@ -72,6 +73,12 @@ public:
     //! Return the list of attributes understood by ProtocolSupport
     std::vector<std::string> getAttriblist(void) const;
 
+    //! Return a text representation of all the options, used to detect changes
+    std::string getFingerprint(void) const;
+
+    //! Return a text representation of the options which affect the helper files
+    std::string getHelperFingerprint(void) const;
+
     //! The type of language being output
     typedef enum
     {
@@ -94,13 +101,18 @@ public:
     bool bitfield;                     //!< true if support for bitfields is included
     bool longbitfield;                 //!< true to support long bitfields
     bool bitfieldtest;                 //!< true to output the bitfield test function
+    bool benchmark;                    //!< true to output the encode and decode benchmark function
+    bool packetStats;                  //!< true to output runtime counters and timing hooks in the packet functions
     bool disableunrecognized;          //!< true to disable warnings about unrecognized attributes
     bool bigendian;                    //!< Protocol bigendian flag
     bool supportbool;                  //!< true if support for 'bool' is included
     bool limitonencode;                //!< true to enforce verification limits on encode
+    bool bitpacked;                    //!< true to encode integer fields as a continuous stream of bits
     bool compare;                      //!< True if the compare function is output for all structures
     bool print;                        //!< True if the textPrint and textRead function is output for all structures
     bool mapEncode;                    //!< True if the mapEncode and mapDecode function is output for all structures
+    bool flatmap;                      //!< True if the map functions use the Qt-free flat map instead of QVariantMap
+    bool json;                         //!< True if the JSON and CBOR writers and readers are output for all structures
     bool showAllItems;                 //!< Generate documentation even for elements marked hidden
     bool omitIfHidden;                 //!< Omit code generation for items marked hidden
     std::string api;                   //!< The protocol API enumeration
@@ -110,6 +122,7 @@ public:
     std::string globalCompareName;     //!< Comparison file name to be used if a name is not given
     std::string globalPrintName;       //!< Print file name to be used if a name is not given
     std::string globalMapName;         //!< Map file name to be used if a name is not given
+    std::string globalJsonName;        //!< JSON file name to be used if a name is not given
     std::string outputpath;            //!< path to output files to
     std::string packetStructureSuffix; //!< Name to use at end of encode/decode Packet structure functions
     std::string packetParameterSuffix; //!< Name to use at end of encode/decode Packet parameter functions
@@ -117,6 +130,7 @@ public:
     std::string prefix;                //!< Prefix name
     std::string typeSuffix;            //!< Suffix on typedef structures
     std::string pointerType;           //!< Packet pointer type - default is "void*"
+    std::string batchID;               //!< Identifier of the packet that holds a batch of packets, empty if no batches
     std::string licenseText;           //!< License text to be added to each generated file
     std::string sourcefile;            //!< Source file name, used for warning outputs
     std::string globaltranslate;       //!< Name of function used for translation of strings, empty if none.
@@ -130,4 +144,8 @@ protected:
     bool enabletranslationoverride;
 };
 
+//! Protocol support which is shared by the objects parsed from one file. An
+//! object which changes an option makes its own copy, which its children share.
+typedef std::shared_ptr<const ProtocolSupport> SharedSupport;
+
 #endif // PROTOCOLSUPPORT_H
@@ -0,0 +1,142 @@
+#include "protocolwatcher.h"
+#include <thread>
+#include <chrono>
+#include <set>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+/*!
+ * Start watching a list of files. The modified time of each file is recorded
+ * now, so a change made after this is never missed. On Linux the directories
+ * of the files are watched with inotify, elsewhere the files are polled.
+ * \param files are the names of the files to watch.
+ */
+ProtocolWatcher::ProtocolWatcher(const std::vector<std::string>& files) :
+    notify(-1)
+{
+    std::set<std::string> directories;
+
+    for(const std::string& file : files)
+    {
+        std::string name = std::filesystem::absolute(file).lexically_normal().string();
+
+        modified[name] = getModifiedTime(name);
+        directories.insert(std::filesystem::path(name).parent_path().string());
+    }
+
+    #if defined(__linux__)
+    notify = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+
+    // Editors often save by writing a new file and renaming it over the old one,
+    // so watch the directories rather than the files
+    for(const std::string& directory : directories)
+    {
+        if((notify >= 0) && (inotify_add_watch(notify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0))
+        {
+            close(notify);
+            notify = -1;
+        }
+    }
+    #endif
+
+}// ProtocolWatcher::ProtocolWatcher
+
+
+ProtocolWatcher::~ProtocolWatcher()
+{
+    #if defined(__linux__)
+    if(notify >= 0)
+        close(notify);
+    #endif
+}
+
+
+/*!
+ * Wait until one of the files changes. Changes are only reported once the
+ * file has been quiet for a short time, so a save that takes several writes
+ * causes only one regeneration.
+ * \return the name of the file that changed.
+ */
+std::string ProtocolWatcher::waitForChange(void)
+{
+    std::string changed;
+
+    while(changed.empty())
+    {
+        #if defined(__linux__)
+        if(notify >= 0)
+        {
+            // The events only say something happened in a directory, the
+            // modified times tell us if it was one of our files
+            struct pollfd descriptor = {notify, POLLIN, 0};
+            if(poll(&descriptor, 1, 1000) > 0)
+            {
+                char buffer[4096];
+                while(read(notify, buffer, sizeof(buffer)) > 0)
+                    continue;
+            }
+        }
+        else
+        #endif
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(250));
+        }
+
+        changed = findChangedFile();
+    }
+
+    // Wait for the writes to settle
+    std::map<std::string, std::filesystem::file_time_type> settled;
+    do
+    {
+        for(const auto& file : modified)
+            settled[file.first] = getModifiedTime(file.first);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        modified.swap(settled);
+
+    }while(!findChangedFile().empty());
+
+    return changed;
+
+}// ProtocolWatcher::waitForChange
+
+
+/*!
+ * Find a file whose modified time is different from the recorded time
+ * \return the name of the first file that changed, or an empty string.
+ */
+std::string ProtocolWatcher::findChangedFile(void) const
+{
+    for(const auto& file : modified)
+    {
+        if(getModifiedTime(file.first) != file.second)
+            return file.first;
+    }
+
+    return std::string();
+
+}// ProtocolWatcher::findChangedFile
+
+
+/*!
+ * Get the time a file was last modified
+ * \param fileName is the name of the file.
+ * \return the modified time, or the minimum time if the file does not exist.
+ */
+std::filesystem::file_time_type ProtocolWatcher::getModifiedTime(const std::string& fileName)
+{
+    std::error_code ec;
+    std::filesystem::file_time_type time = std::filesystem::last_write_time(fileName, ec);
+
+    if(ec)
+        return std::filesystem::file_time_type::min();
+    else
+        return time;
+
+}// ProtocolWatcher::getModifiedTime
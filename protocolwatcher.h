@@ -0,0 +1,42 @@
+#ifndef PROTOCOLWATCHER_H
+#define PROTOCOLWATCHER_H
+
+/*!
+ * \file
+ * Watch the input files of a protocol, so the protocol can be regenerated
+ * when they change
+ */
+
+#include <string>
+#include <vector>
+#include <map>
+#include <filesystem>
+
+class ProtocolWatcher
+{
+public:
+    //! Start watching a list of files
+    ProtocolWatcher(const std::vector<std::string>& files);
+
+    //! Stop watching
+    ~ProtocolWatcher();
+
+    //! Wait until one of the files changes, returning the name of the file
+    std::string waitForChange(void);
+
+    //! Get the number of distinct files being watched
+    std::size_t getNumberOfFiles(void) const {return modified.size();}
+
+protected:
+
+    //! Get the time a file was last modified, or the minimum time if it does not exist
+    static std::filesystem::file_time_type getModifiedTime(const std::string& fileName);
+
+    //! Find a file whose modified time has changed since watching started
+    std::string findChangedFile(void) const;
+
+    std::map<std::string, std::filesystem::file_time_type> modified; //!< Modified times of the files when watching started
+    int notify;     //!< inotify descriptor, or -1 if changes are found by polling
+};
+
+#endif // PROTOCOLWATCHER_H
@@ -0,0 +1,116 @@
+# Test that the regeneration cache skips unchanged modules and regenerates
+# changed ones. This is run by ctest as:
+#
+#   cmake -DPROTOGEN=<exe> -DWORKDIR=<dir> -P cachetest.cmake
+#
+# A protocol of two packets, each in its own file, is generated with -cache
+# several times. Each run reads the "Modules skipped as unchanged" counter of
+# -stats-json, and checks which output files hold the latest definitions.
+cmake_minimum_required(VERSION 3.19)
+
+if(NOT PROTOGEN OR NOT WORKDIR)
+    message(FATAL_ERROR "PROTOGEN and WORKDIR must be defined")
+endif()
+
+set(XMLFILE ${WORKDIR}/CacheTest.xml)
+set(OUTDIR ${WORKDIR}/out)
+set(CACHEDIR ${WORKDIR}/cache)
+
+# Write the protocol, ENDIAN is the protocol option and SECONDTYPE the type
+# of the field of the second packet
+function(write_protocol ENDIAN SECONDTYPE)
+    file(WRITE ${XMLFILE}
+"<?xml version=\"1.0\"?>
+<Protocol name=\"CacheTest\" prefix=\"\" api=\"1\" version=\"1.0\" endian=\"${ENDIAN}\" comment=\"Protocol used to test the regeneration cache\">
+    <Packet name=\"First\" ID=\"1\" file=\"First\" structureInterface=\"true\" comment=\"First packet, which is never changed\">
+        <Data name=\"count\" inMemoryType=\"unsigned16\" comment=\"A count\"/>
+    </Packet>
+    <Packet name=\"Second\" ID=\"2\" file=\"Second\" structureInterface=\"true\" comment=\"Second packet, whose field changes\">
+        <Data name=\"value\" inMemoryType=\"${SECONDTYPE}\" comment=\"A value\"/>
+    </Packet>
+</Protocol>
+")
+endfunction()
+
+# Run ProtoGen with the cache and give the number of modules it skipped
+function(run_protogen DESCRIPTION RESULT)
+    execute_process(
+        COMMAND ${PROTOGEN} ${XMLFILE} ${OUTDIR} -cache ${CACHEDIR} -no-markdown -stats-json
+        WORKING_DIRECTORY ${WORKDIR}
+        OUTPUT_VARIABLE OUTPUT
+        ERROR_QUIET
+        RESULT_VARIABLE PROTOGENRESULT)
+
+    if(NOT PROTOGENRESULT EQUAL 0)
+        message(FATAL_ERROR "ProtoGen failed ${DESCRIPTION}")
+    endif()
+
+    # The statistics are the last thing printed
+    string(FIND "${OUTPUT}" "\n{\n" START REVERSE)
+    if(START LESS 0)
+        message(FATAL_ERROR "No statistics found in ProtoGen output ${DESCRIPTION}")
+    endif()
+
+    string(SUBSTRING "${OUTPUT}" ${START} -1 STATS)
+
+    # The counter is not reported if nothing was skipped
+    string(JSON SKIPPED ERROR_VARIABLE MISSING GET "${STATS}" counters "Modules skipped as unchanged")
+    if(MISSING)
+        set(SKIPPED 0)
+    endif()
+
+    set(${RESULT} ${SKIPPED} PARENT_SCOPE)
+endfunction()
+
+# Check the number of modules skipped by a run
+function(expect_skipped DESCRIPTION SKIPPED EXPECTED)
+    if(NOT SKIPPED EQUAL EXPECTED)
+        message(FATAL_ERROR "${SKIPPED} modules skipped ${DESCRIPTION}, expected ${EXPECTED}")
+    endif()
+endfunction()
+
+# Check that a file contains a pattern
+function(expect_contents FILENAME PATTERN DESCRIPTION)
+    if(NOT EXISTS ${FILENAME})
+        message(FATAL_ERROR "${FILENAME} is missing ${DESCRIPTION}")
+    endif()
+
+    file(READ ${FILENAME} CONTENTS)
+    if(NOT CONTENTS MATCHES "${PATTERN}")
+        message(FATAL_ERROR "${FILENAME} does not match \"${PATTERN}\" ${DESCRIPTION}")
+    endif()
+endfunction()
+
+# Start with no output and no cache
+file(REMOVE_RECURSE ${OUTDIR} ${CACHEDIR})
+file(MAKE_DIRECTORY ${WORKDIR})
+
+write_protocol(big unsigned16)
+run_protogen("on the first run" SKIPPED)
+expect_skipped("on the first run" ${SKIPPED} 0)
+expect_contents(${OUTDIR}/Second.h "uint16_t +value" "after the first run")
+
+run_protogen("when nothing changed" SKIPPED)
+expect_skipped("when nothing changed" ${SKIPPED} 2)
+
+# A change to one packet only regenerates that packet
+write_protocol(big unsigned32)
+run_protogen("after the second packet changed" SKIPPED)
+expect_skipped("after the second packet changed" ${SKIPPED} 1)
+expect_contents(${OUTDIR}/Second.c "uint32ToBeBytes" "after the second packet changed")
+expect_contents(${OUTDIR}/First.h "uint16_t +count" "after the second packet changed")
+
+# An output file which is deleted is written again
+file(REMOVE ${OUTDIR}/First.c)
+run_protogen("after an output file was deleted" SKIPPED)
+expect_skipped("after an output file was deleted" ${SKIPPED} 1)
+expect_contents(${OUTDIR}/First.c "encodeFirstPacketStructure" "after it was deleted")
+
+# A change to the protocol options regenerates every packet
+write_protocol(little unsigned32)
+run_protogen("after the protocol options changed" SKIPPED)
+expect_skipped("after the protocol options changed" ${SKIPPED} 0)
+expect_contents(${OUTDIR}/First.c "uint16ToLeBytes" "after the protocol options changed")
+expect_contents(${OUTDIR}/Second.c "uint32ToLeBytes" "after the protocol options changed")
+
+message(STATUS "Cache test passed")
@@ -0,0 +1,106 @@
+# Test that generating protocols from a manifest gives the same output as
+# generating each protocol on its own, however many jobs run at once. This is
+# run by ctest as:
+#
+#   cmake -DPROTOGEN=<exe> -DWORKDIR=<dir> -P manifesttest.cmake
+#
+# Two protocols use enumerations and a structure from a support file, which
+# is given on the command line so it is shared by every protocol of the
+# manifest. The manifest is run with one job and with several jobs, and every
+# output file is compared against the output of the single protocol runs.
+cmake_minimum_required(VERSION 3.19)
+
+if(NOT PROTOGEN OR NOT WORKDIR)
+    message(FATAL_ERROR "PROTOGEN and WORKDIR must be defined")
+endif()
+
+set(PROTOCOLS Alpha Beta)
+
+file(REMOVE_RECURSE ${WORKDIR})
+file(MAKE_DIRECTORY ${WORKDIR})
+
+file(WRITE ${WORKDIR}/Shared.xml
+"<?xml version=\"1.0\"?>
+<Protocol name=\"Shared\" comment=\"Definitions shared by the protocols\">
+    <Enum name=\"SharedIds\" comment=\"Packet identifiers\">
+        <Value name=\"SHARED_FIRST\" value=\"1\" comment=\"First packet\"/>
+        <Value name=\"SHARED_SECOND\" comment=\"Second packet\"/>
+    </Enum>
+    <Structure name=\"SharedPoint\" file=\"SharedPoint\" comment=\"A point\">
+        <Data name=\"x\" inMemoryType=\"float32\" encodedType=\"signed16\" scaler=\"100\" comment=\"X coordinate\"/>
+        <Data name=\"y\" inMemoryType=\"float32\" encodedType=\"signed16\" scaler=\"100\" comment=\"Y coordinate\"/>
+    </Structure>
+</Protocol>
+")
+
+foreach(PROTOCOL ${PROTOCOLS})
+    file(WRITE ${WORKDIR}/${PROTOCOL}.xml
+"<?xml version=\"1.0\"?>
+<Protocol name=\"${PROTOCOL}\" prefix=\"${PROTOCOL}\" api=\"1\" version=\"1.0\" endian=\"big\" comment=\"Protocol ${PROTOCOL} of the manifest test\">
+    <Packet name=\"Position\" ID=\"SHARED_FIRST\" file=\"${PROTOCOL}Packets\" structureInterface=\"true\" comment=\"Position of ${PROTOCOL}\">
+        <Data name=\"point\" struct=\"SharedPoint\" comment=\"The position\"/>
+    </Packet>
+    <Packet name=\"Status\" ID=\"SHARED_SECOND\" file=\"${PROTOCOL}Packets\" structureInterface=\"true\" comment=\"Status of ${PROTOCOL}\">
+        <Data name=\"flags\" inMemoryType=\"unsigned8\" comment=\"Status flags\"/>
+    </Packet>
+</Protocol>
+")
+endforeach()
+
+# Run ProtoGen in the work directory, failing the test if it fails
+function(run_protogen DESCRIPTION)
+    execute_process(
+        COMMAND ${PROTOGEN} ${ARGN}
+        WORKING_DIRECTORY ${WORKDIR}
+        OUTPUT_QUIET
+        ERROR_VARIABLE ERRORS
+        RESULT_VARIABLE RESULT)
+
+    if(NOT RESULT EQUAL 0)
+        message(FATAL_ERROR "ProtoGen failed ${DESCRIPTION}:\n${ERRORS}")
+    endif()
+endfunction()
+
+# Each protocol on its own gives the expected output
+foreach(PROTOCOL ${PROTOCOLS})
+    run_protogen("on ${PROTOCOL}" ${PROTOCOL}.xml single/${PROTOCOL} Shared.xml -no-markdown)
+endforeach()
+
+# The same protocols from a manifest, with one job and with several
+foreach(JOBS 1 4)
+    set(MANIFEST ${WORKDIR}/manifest${JOBS}.txt)
+    file(WRITE ${MANIFEST} "# Manifest test with ${JOBS} jobs\n")
+
+    foreach(PROTOCOL ${PROTOCOLS})
+        file(APPEND ${MANIFEST} "${PROTOCOL}.xml jobs${JOBS}/${PROTOCOL}\n")
+    endforeach()
+
+    run_protogen("on the manifest with ${JOBS} jobs" -manifest ${MANIFEST} Shared.xml -jobs ${JOBS} -no-markdown)
+endforeach()
+
+# Every file must be the same, and no run may have files the others do not
+file(GLOB_RECURSE EXPECTED RELATIVE ${WORKDIR}/single ${WORKDIR}/single/*)
+list(LENGTH EXPECTED COUNT)
+if(COUNT EQUAL 0)
+    message(FATAL_ERROR "No files were generated")
+endif()
+
+foreach(JOBS 1 4)
+    file(GLOB_RECURSE ACTUAL RELATIVE ${WORKDIR}/jobs${JOBS} ${WORKDIR}/jobs${JOBS}/*)
+
+    if(NOT "${ACTUAL}" STREQUAL "${EXPECTED}")
+        message(FATAL_ERROR "The manifest with ${JOBS} jobs generated files ${ACTUAL}, expected ${EXPECTED}")
+    endif()
+
+    foreach(FILENAME ${EXPECTED})
+        execute_process(
+            COMMAND ${CMAKE_COMMAND} -E compare_files ${WORKDIR}/single/${FILENAME} ${WORKDIR}/jobs${JOBS}/${FILENAME}
+            RESULT_VARIABLE DIFFERENT)
+
+        if(NOT DIFFERENT EQUAL 0)
+            message(FATAL_ERROR "${FILENAME} from the manifest with ${JOBS} jobs differs from the single protocol output")
+        endif()
+    endforeach()
+endforeach()
+
+message(STATUS "Manifest test passed, ${COUNT} files compared")